@@ -1,14 +1,25 @@
 import 'dart:async';
-import 'dart:typed_data';
-import 'dart:math' as math;
-import 'package:record/record.dart';
+import 'dart:ffi';
+import 'dart:io';
+import 'package:ffi/ffi.dart';
+import '../../native/capture/capture_bindings.dart';
+
+/// Receives captured 16 kHz mono samples. [samples] points into a scratch
+/// buffer that is reused as soon as the callback returns.
+typedef AudioSamplesCallback = void Function(Pointer<Float> samples, int length);
 
 class AudioCaptureService {
-  final AudioRecorder _record = AudioRecorder();
-  StreamSubscription<Uint8List>? _subscription;
-  
-  final _samplesController = StreamController<List<double>>.broadcast();
-  Stream<List<double>> get samplesStream => _samplesController.stream;
+  static const int sampleRate = 16000;
+  static const int _drainIntervalMs = 50;
+  static const int _scratchSamples = sampleRate; // 1s, well above one drain interval
+
+  CaptureBindings? _bindings;
+  Pointer<capture_context> _context = nullptr;
+  Pointer<Float> _scratch = nullptr;
+  Timer? _drainTimer;
+
+  /// Called from the drain timer with every chunk pulled from the native ring.
+  AudioSamplesCallback? onSamples;
 
   final _volumeController = StreamController<double>.broadcast();
   Stream<double> get volumeStream => _volumeController.stream;
@@ -16,55 +27,77 @@ class AudioCaptureService {
   bool _isRecording = false;
   bool get isRecording => _isRecording;
 
-  int _sampleCounter = 0;
-  
+  int _drainCounter = 0;
+
+  Future<void> initialize({String? libraryPath}) async {
+    if (_bindings != null) return;
+
+    print('DEBUG: AudioCaptureService.initialize(libraryPath: $libraryPath)');
+    final DynamicLibrary lib;
+    try {
+      if (libraryPath != null) {
+        print('DEBUG: Opening capture library at $libraryPath');
+        lib = DynamicLibrary.open(libraryPath);
+      } else {
+        final libName = Platform.isLinux ? 'libcapture.so' : 'capture.dll';
+        print('DEBUG: Opening capture library $libName');
+        lib = DynamicLibrary.open(libName);
+      }
+    } catch (e) {
+      print('DEBUG: Failed to open capture library: $e');
+      rethrow;
+    }
+
+    final bindings = CaptureBindings(lib);
+    final context = bindings.capture_init(bindings.capture_default_config());
+    if (context == nullptr) {
+      throw Exception('Failed to initialize audio capture');
+    }
+
+    _bindings = bindings;
+    _context = context;
+    _scratch = calloc<Float>(_scratchSamples);
+    print('DEBUG: Audio capture initialized successfully');
+  }
+
   Future<void> start() async {
     print('DEBUG: [AudioCapture] start() called, _isRecording=$_isRecording');
     if (_isRecording) {
       print('DEBUG: [AudioCapture] Already recording, returning early');
       return;
     }
+    if (_context == nullptr) {
+      throw Exception('Audio capture not initialized');
+    }
 
-    if (await _record.hasPermission()) {
-      final config = RecordConfig(
-        encoder: AudioEncoder.pcm16bits,
-        sampleRate: 16000,
-        numChannels: 1,
-      );
-
-      print('DEBUG: [AudioCapture] Starting stream...');
-      final stream = await _record.startStream(config);
-      print('DEBUG: [AudioCapture] Stream started, setting up subscription...');
-      
-      _sampleCounter = 0;
-      _subscription = stream.listen((Uint8List data) {
-        // Convert PCM16 (Int16) to Float32 [-1.0, 1.0]
-        final floatSamples = <double>[];
-        double maxAbs = 0;
-        for (var i = 0; i < data.length; i += 2) {
-          if (i + 1 < data.length) {
-            // Little-endian PCM16
-            int sample = data[i] | (data[i + 1] << 8);
-            if (sample > 32767) sample -= 65536;
-            final floatSample = sample / 32768.0;
-            floatSamples.add(floatSample);
-            maxAbs = math.max(maxAbs, floatSample.abs());
-          }
-        }
-        _samplesController.add(floatSamples);
-        _volumeController.add(maxAbs);
-        
-        // Debug: log every 10th sample batch
-        _sampleCounter++;
-        if (_sampleCounter % 10 == 0) {
-          print('DEBUG: [AudioCapture] Emitted ${floatSamples.length} samples (batch #$_sampleCounter)');
-        }
-      });
-
-      _isRecording = true;
-      print('DEBUG: [AudioCapture] Recording started successfully');
-    } else {
-      throw Exception('Microphone permission denied');
+    final result = _bindings!.capture_start(_context);
+    if (result != 0) {
+      throw Exception('Failed to start audio capture (code $result)');
+    }
+
+    _drainCounter = 0;
+    _drainTimer = Timer.periodic(const Duration(milliseconds: _drainIntervalMs), (_) => _drain());
+
+    _isRecording = true;
+    print('DEBUG: [AudioCapture] Recording started with backend ${_bindings!.capture_active_backend(_context)}');
+  }
+
+  void _drain() {
+    // Samples stay in native memory, Dart only sees pointers and levels
+    while (true) {
+      final n = _bindings!.capture_read(_context, _scratch, _scratchSamples);
+      if (n == 0) break;
+      onSamples?.call(_scratch, n);
+      if (n < _scratchSamples) break;
+    }
+
+    final levels = _bindings!.capture_get_levels(_context);
+    _volumeController.add(levels.peak);
+
+    // Debug: log roughly every second
+    _drainCounter++;
+    if (_drainCounter % 20 == 0) {
+      print('DEBUG: [AudioCapture] captured=${levels.n_captured}, dropped=${levels.n_dropped}, rms=${levels.rms.toStringAsFixed(3)}');
     }
   }
 
@@ -75,16 +108,23 @@ class AudioCaptureService {
       return;
     }
 
-    await _subscription?.cancel();
-    _subscription = null;
-    await _record.stop();
+    _drainTimer?.cancel();
+    _drainTimer = null;
+    _bindings!.capture_stop(_context);
     _isRecording = false;
     print('DEBUG: [AudioCapture] Recording stopped');
   }
 
   void dispose() {
     stop();
-    _samplesController.close();
-    _record.dispose();
+    _volumeController.close();
+    if (_context != nullptr) {
+      _bindings!.capture_free(_context);
+      _context = nullptr;
+    }
+    if (_scratch != nullptr) {
+      calloc.free(_scratch);
+      _scratch = nullptr;
+    }
   }
 }
@@ -0,0 +1,83 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'package:ffi/ffi.dart';
+import '../../native/cleaner/cleaner_bindings.dart';
+
+class CleanedText {
+  final String text;
+
+  /// 0 to 1: how sure the cleaner is that an LLM pass would not change much.
+  final double confidence;
+  final int fillers;
+  final int hedges;
+  final int stutters;
+  final int replacements;
+
+  const CleanedText(this.text, this.confidence, this.fillers, this.hedges, this.stutters, this.replacements);
+
+  @override
+  String toString() => 'CleanedText(confidence: ${confidence.toStringAsFixed(2)}, fillers: $fillers, '
+      'hedges: $hedges, stutters: $stutters, replacements: $replacements)';
+}
+
+/// Deterministic transcript cleanup in native code: fillers, stutters,
+/// spacing, punctuation, capitals and the user dictionary. It takes
+/// microseconds, so it runs on the calling isolate before any LLM pass.
+class TextCleaner {
+  final CleanerBindings _bindings;
+  Pointer<cleaner_context> _context;
+
+  TextCleaner._(this._bindings, this._context);
+
+  static TextCleaner initialize({String? libraryPath}) {
+    final libName = libraryPath ?? (Platform.isLinux ? 'libcleaner.so' : 'cleaner.dll');
+    print('DEBUG: Opening cleaner library $libName');
+    final bindings = CleanerBindings(DynamicLibrary.open(libName));
+
+    final context = bindings.cleaner_init(bindings.cleaner_default_config());
+    if (context == nullptr) {
+      throw Exception('Failed to initialize text cleaner');
+    }
+    return TextCleaner._(bindings, context);
+  }
+
+  /// Replaces the user dictionary with [entries] of the form "from=to".
+  /// Malformed entries are skipped.
+  void setReplacements(List<String> entries) {
+    if (_context == nullptr) throw Exception('Text cleaner disposed');
+    _bindings.cleaner_clear_replacements(_context);
+    for (final entry in entries) {
+      final separator = entry.indexOf('=');
+      if (separator <= 0) continue;
+      final fromPtr = entry.substring(0, separator).toNativeUtf8();
+      final toPtr = entry.substring(separator + 1).trim().toNativeUtf8();
+      if (_bindings.cleaner_add_replacement(_context, fromPtr.cast(), toPtr.cast()) != 0) {
+        print('DEBUG: [Cleaner] Skipping replacement "$entry"');
+      }
+      calloc.free(fromPtr);
+      calloc.free(toPtr);
+    }
+  }
+
+  CleanedText clean(String text) {
+    if (_context == nullptr) throw Exception('Text cleaner disposed');
+    final textPtr = text.toNativeUtf8();
+    final result = _bindings.cleaner_clean(_context, textPtr.cast());
+    calloc.free(textPtr);
+    return CleanedText(
+      result.text.cast<Utf8>().toDartString(),
+      result.confidence,
+      result.n_fillers,
+      result.n_hedges,
+      result.n_stutters,
+      result.n_replacements,
+    );
+  }
+
+  void dispose() {
+    if (_context != nullptr) {
+      _bindings.cleaner_free(_context);
+      _context = nullptr;
+    }
+  }
+}
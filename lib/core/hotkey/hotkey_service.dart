@@ -1,18 +1,41 @@
 import 'dart:async';
 import 'dart:ffi';
 import 'dart:io';
+import 'dart:isolate';
 import 'package:ffi/ffi.dart';
 import '../../native/hotkey/hotkey_bindings.dart';
 
+class HotkeyEvent {
+  /// X11 KeyCode of the key.
+  final int keyCode;
+  final bool pressed;
+
+  /// When the key changed state, in CLOCK_MONOTONIC microseconds.
+  final int timestampUs;
+
+  const HotkeyEvent(this.keyCode, this.pressed, this.timestampUs);
+
+  @override
+  String toString() => 'HotkeyEvent($keyCode, ${pressed ? 'pressed' : 'released'}, $timestampUs)';
+}
+
 class HotkeyService {
   HotkeyBindings? _bindings;
   int _pttKeyCode = 0;
   bool _isPressed = false;
+  // Only used when no native listener backend is available
   Timer? _timer;
+  // Key edges posted by the native listener thread
+  ReceivePort? _eventPort;
 
   final _stateController = StreamController<bool>.broadcast();
   Stream<bool> get pttStateStream => _stateController.stream;
 
+  final _eventController = StreamController<HotkeyEvent>.broadcast();
+
+  /// Every key press and release while the native listener runs.
+  Stream<HotkeyEvent> get keyEvents => _eventController.stream;
+
   HotkeyService();
 
   Future<void> initialize({String? libraryPath}) async {
@@ -35,6 +58,7 @@ class HotkeyService {
     }
 
     _bindings = HotkeyBindings(lib);
+    _bindings!.hotkey_dart_init(NativeApi.postCObject.cast());
     print('DEBUG: Hotkey service initialized successfully');
   }
 
@@ -52,6 +76,17 @@ class HotkeyService {
   Future<String?> getNextPressedKey() async {
     if (_bindings == null) return null;
 
+    if (_eventPort != null) {
+      try {
+        final event = await keyEvents
+            .firstWhere((event) => event.pressed && _keysymName(event.keyCode) != null)
+            .timeout(const Duration(seconds: 10));
+        return _keysymName(event.keyCode);
+      } on TimeoutException {
+        return null;
+      }
+    }
+
     final completer = Completer<String?>();
     Timer? listenTimer;
 
@@ -78,8 +113,53 @@ class HotkeyService {
     return completer.future;
   }
 
-  void startPolling() {
+  String? _keysymName(int keyCode) {
+    final namePtr = _bindings!.x11_get_keysym_name(keyCode);
+    return namePtr == nullptr ? null : namePtr.cast<Utf8>().toDartString();
+  }
+
+  /// Starts the native listener thread, which reports key edges as they
+  /// happen. Falls back to polling the X keymap when no backend can be opened.
+  void startListening() {
     if (_bindings == null) return;
+    stopListening();
+
+    final port = ReceivePort();
+    final backend = _bindings!.hotkey_listener_start(port.sendPort.nativePort);
+    if (backend == hotkey_backend.HOTKEY_BACKEND_NONE) {
+      port.close();
+      print('DEBUG: No hotkey listener backend available, polling instead');
+      _startPolling();
+      return;
+    }
+
+    _eventPort = port;
+    port.listen((message) {
+      final values = message as List;
+      final event = HotkeyEvent(values[0] as int, values[1] as bool, values[2] as int);
+      _eventController.add(event);
+      if (event.keyCode == _pttKeyCode && event.pressed != _isPressed) {
+        _isPressed = event.pressed;
+        _stateController.add(_isPressed);
+      }
+    });
+    print('DEBUG: Hotkey listener started (${_backendName(backend)})');
+  }
+
+  static String _backendName(int backend) {
+    switch (backend) {
+      case hotkey_backend.HOTKEY_BACKEND_XI2:
+        return 'XInput2';
+      case hotkey_backend.HOTKEY_BACKEND_EVDEV:
+        return 'evdev';
+      case hotkey_backend.HOTKEY_BACKEND_X11_KEYMAP:
+        return 'X11 keymap';
+      default:
+        return 'none';
+    }
+  }
+
+  void _startPolling() {
     _timer?.cancel();
     _timer = Timer.periodic(const Duration(milliseconds: 20), (_) {
       if (_pttKeyCode == 0) return;
@@ -92,13 +172,19 @@ class HotkeyService {
     });
   }
 
-  void stopPolling() {
+  void stopListening() {
+    if (_eventPort != null) {
+      _bindings?.hotkey_listener_stop();
+      _eventPort!.close();
+      _eventPort = null;
+    }
     _timer?.cancel();
     _timer = null;
   }
 
   void dispose() {
-    stopPolling();
+    stopListening();
     _stateController.close();
+    _eventController.close();
   }
 }
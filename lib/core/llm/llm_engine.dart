@@ -0,0 +1,208 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:async';
+import 'dart:isolate';
+import 'package:ffi/ffi.dart';
+import '../../native/llm/llm_bindings.dart';
+
+/// Transcript cleanup on a llama model kept resident in-process. The model
+/// and its context live on a worker isolate; the fixed system prompt is
+/// decoded once and snapshotted, so a request only prefills the transcript.
+class LlmEngine {
+  final SendPort _commandPort;
+  // Aborts are issued from this isolate while the worker is busy in native code
+  final LlmBindings _bindings;
+  final Pointer<llm_context> _context;
+  bool _initialized = true;
+
+  LlmEngine._(this._commandPort, this._bindings, this._context);
+
+  static Future<LlmEngine> initialize({
+    required String modelPath,
+    String? libraryPath,
+    int nCtx = 2048,
+    int nThreads = 0,
+    int nGpuLayers = -1,
+    int nPredict = 512,
+  }) async {
+    print('DEBUG: LlmEngine.initialize(modelPath: $modelPath)');
+
+    final resolvedLibraryPath = libraryPath ?? (Platform.isLinux ? 'libllm.so' : 'llm.dll');
+    final receivePort = ReceivePort();
+    await Isolate.spawn(_llmIsolate, [
+      receivePort.sendPort,
+      resolvedLibraryPath,
+      modelPath,
+      nCtx,
+      nThreads,
+      nGpuLayers,
+      nPredict,
+    ]);
+
+    final reply = await receivePort.first as List;
+    receivePort.close();
+    if (reply[0] == null) {
+      throw LlmException('Failed to load LLM model: $modelPath');
+    }
+
+    final bindings = LlmBindings(DynamicLibrary.open(resolvedLibraryPath));
+    final context = Pointer<llm_context>.fromAddress(reply[1] as int);
+    return LlmEngine._(reply[0] as SendPort, bindings, context);
+  }
+
+  /// Cleans up [text] and returns the model's reply, trimmed.
+  Future<String> processTranscription(String text) async {
+    if (!_initialized) {
+      throw LlmException('LLM engine not initialized');
+    }
+
+    final responsePort = ReceivePort();
+    _commandPort.send(_CleanupRequest(responsePort.sendPort, text));
+
+    final result = await responsePort.first;
+    if (result is String) {
+      return result;
+    } else if (result is LlmException) {
+      throw result;
+    } else {
+      throw LlmException('Unknown error during cleanup');
+    }
+  }
+
+  /// Cleans up [text], yielding the reply piece by piece as it is generated.
+  /// Time to the first piece is the prefill of the transcript alone. Leading
+  /// whitespace is dropped, trailing whitespace is not. Cancelling the
+  /// subscription stops generation at the next piece.
+  Stream<String> streamTranscription(String text) {
+    if (!_initialized) {
+      return Stream.error(LlmException('LLM engine not initialized'));
+    }
+
+    ReceivePort? piecePort;
+    late final StreamController<String> controller;
+    controller = StreamController<String>(
+      onListen: () {
+        // Pieces are posted here straight from native code, then the worker
+        // sends _CleanupDone or an LlmException on the same port
+        final port = ReceivePort();
+        piecePort = port;
+        port.listen((message) {
+          if (message is String) {
+            controller.add(message);
+            return;
+          }
+          if (message is LlmException) {
+            controller.addError(message);
+          } else if (message is! _CleanupDone) {
+            controller.addError(LlmException('Unknown error during cleanup'));
+          }
+          port.close();
+          controller.close();
+        });
+        _commandPort.send(_CleanupRequest(port.sendPort, text, stream: true));
+      },
+      onCancel: () => piecePort?.close(),
+    );
+    return controller.stream;
+  }
+
+  /// Stops the cleanup that is running, which then fails with [LlmException].
+  void abort() {
+    if (_initialized) _bindings.llm_abort(_context);
+  }
+
+  static void _llmIsolate(List<dynamic> args) async {
+    final SendPort mainSendPort = args[0];
+    final String libraryPath = args[1];
+    final String modelPath = args[2];
+
+    print('DEBUG: [LLM Isolate] Opening library at $libraryPath');
+    final bindings = LlmBindings(DynamicLibrary.open(libraryPath));
+
+    final config = bindings.llm_default_config();
+    config.n_ctx = args[3];
+    config.n_threads = args[4];
+    config.n_gpu_layers = args[5];
+    config.n_predict = args[6];
+    // The decoded system prompt is kept next to the model, so only the first
+    // load with a given prompt pays for it
+    final sessionPtr = _sessionPath(modelPath).toNativeUtf8();
+    config.session_path = sessionPtr.cast();
+
+    final modelPtr = modelPath.toNativeUtf8();
+    final context = bindings.llm_init(modelPtr.cast(), config);
+    calloc.free(modelPtr);
+    calloc.free(sessionPtr);
+
+    if (context == nullptr) {
+      print('DEBUG: [LLM Isolate] Failed to load model');
+      mainSendPort.send([null, 0]);
+      return;
+    }
+
+    // Lets streamed cleanups post pieces to native ports
+    bindings.llm_dart_init(NativeApi.postCObject.cast());
+
+    final commandPort = ReceivePort();
+    mainSendPort.send([commandPort.sendPort, context.address]);
+
+    await for (final msg in commandPort) {
+      if (msg is _CleanupRequest) {
+        final textPtr = msg.text.toNativeUtf8();
+        final result = msg.stream
+            ? bindings.llm_cleanup_port(context, textPtr.cast(), msg.responsePort.nativePort)
+            : bindings.llm_cleanup(context, textPtr.cast(), nullptr, nullptr);
+        calloc.free(textPtr);
+
+        if (result == nullptr) {
+          msg.responsePort.send(LlmException('Cleanup failed or was aborted'));
+          continue;
+        }
+
+        final stats = bindings.llm_get_stats(context);
+        print('DEBUG: [LLM Isolate] Cleanup: ${stats.n_prefix} prompt tokens restored, '
+            '${stats.n_prompt} decoded in ${stats.t_prompt_ms.toStringAsFixed(1)} ms, '
+            '${stats.n_generated} generated in ${stats.t_generate_ms.toStringAsFixed(1)} ms');
+        final cleaned = result.cast<Utf8>().toDartString();
+        msg.responsePort.send(msg.stream ? _CleanupDone(cleaned) : cleaned);
+      } else if (msg == 'dispose') {
+        bindings.llm_free(context);
+        commandPort.close();
+        break;
+      }
+    }
+  }
+
+  static String _sessionPath(String modelPath) => '$modelPath.session';
+
+  void dispose() {
+    if (_initialized) {
+      abort();
+      _initialized = false;
+      _commandPort.send('dispose');
+    }
+  }
+}
+
+class _CleanupRequest {
+  final SendPort responsePort;
+  final String text;
+  // Pieces are posted to responsePort as they are generated
+  final bool stream;
+
+  _CleanupRequest(this.responsePort, this.text, {this.stream = false});
+}
+
+class _CleanupDone {
+  final String text;
+
+  _CleanupDone(this.text);
+}
+
+class LlmException implements Exception {
+  final String message;
+  LlmException(this.message);
+
+  @override
+  String toString() => 'LlmException: $message';
+}
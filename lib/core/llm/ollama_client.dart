@@ -1,3 +1,4 @@
+import 'dart:convert';
 import 'package:dio/dio.dart';
 import 'package:flutter_riverpod/flutter_riverpod.dart';
 
@@ -58,18 +59,81 @@ class OllamaClient {
     }
   }
 
-  Future<String> processTranscription(String text) async {
-    final targetModel = model ?? 'llama3';
-    final prompt = '''Clean up the following speech-to-text transcription. 
+  /// Like [generateText], but yields the response as Ollama streams it: one
+  /// NDJSON object per line, each carrying the next piece in `response`,
+  /// until one has `done` set.
+  Stream<String> streamText({
+    required String model,
+    required String prompt,
+    String? systemPrompt,
+    int? numPredict,
+    double temperature = 0.7,
+  }) async* {
+    print('DEBUG: OllamaClient.streamText hit: ${baseUrl}/api/generate with model: $model');
+    final Response<ResponseBody> response;
+    try {
+      final data = {
+        'model': model,
+        'prompt': prompt,
+        'stream': true,
+        'temperature': temperature,
+        if (systemPrompt != null) 'system': systemPrompt,
+        if (numPredict != null) 'num_predict': numPredict,
+      };
+
+      response = await _dio.post<ResponseBody>(
+        '/api/generate',
+        data: data,
+        options: Options(responseType: ResponseType.stream),
+      );
+    } catch (e) {
+      throw OllamaException('Failed to generate text: $e');
+    }
+
+    final lines = response.data!.stream
+        .cast<List<int>>()
+        .transform(utf8.decoder)
+        .transform(const LineSplitter());
+    try {
+      await for (final line in lines) {
+        if (line.trim().isEmpty) continue;
+        final chunk = jsonDecode(line) as Map<String, dynamic>;
+        if (chunk['error'] != null) {
+          throw OllamaException('Failed to generate text: ${chunk['error']}');
+        }
+        final piece = chunk['response'] as String? ?? '';
+        if (piece.isNotEmpty) yield piece;
+        if (chunk['done'] == true) break;
+      }
+    } on OllamaException {
+      rethrow;
+    } catch (e) {
+      throw OllamaException('Failed to read streamed response: $e');
+    }
+  }
+
+  static const _cleanupSystemPrompt = 'You are a helpful assistant that cleans up speech-to-text transcriptions.';
+
+  static String _cleanupPrompt(String text) => '''Clean up the following speech-to-text transcription. 
 Fix capitalization, punctuation, and obvious speech recognition errors. 
 Return only the cleaned text, no additional commentary.
 
 Original text: $text''';
 
+  Future<String> processTranscription(String text) async {
     return generateText(
-      model: targetModel,
-      prompt: prompt,
-      systemPrompt: 'You are a helpful assistant that cleans up speech-to-text transcriptions.',
+      model: model ?? 'llama3',
+      prompt: _cleanupPrompt(text),
+      systemPrompt: _cleanupSystemPrompt,
+    );
+  }
+
+  /// Streamed [processTranscription]: the cleaned text as it is generated.
+  Stream<String> streamTranscription(String text) {
+    return streamText(
+      model: model ?? 'llama3',
+      prompt: _cleanupPrompt(text),
+      systemPrompt: _cleanupSystemPrompt,
     );
   }
 
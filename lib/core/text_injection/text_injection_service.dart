@@ -1,11 +1,54 @@
+import 'dart:async';
+import 'dart:ffi';
 import 'dart:io';
+import 'dart:isolate';
+import 'package:ffi/ffi.dart';
 import 'package:flutter/services.dart';
+import '../../native/inject/inject_bindings.dart';
 
 class TextInjectionService {
   bool _isWayland = Platform.environment['XDG_SESSION_TYPE'] == 'wayland';
   bool lastInjectionWasFallback = false;
 
-  Future<bool> injectText(String text, {String method = 'dotool'}) async {
+  // Persistent virtual keyboard (uinput, or XTest on X11). The external tools
+  // are only run for what it cannot type.
+  InjectBindings? _bindings;
+  Pointer<inject_context> _native = nullptr;
+
+  // uinput sends US-layout keycodes, so on any other layout (or one that
+  // cannot be detected) the layout-aware tools go first, unless the user
+  // says the keycodes are right. XTest types keysyms and works on any layout.
+  bool _layoutIndependent = false;
+  bool _usLayout = false;
+  bool uinputOnAnyLayout = false;
+
+  bool get _nativeFirst => _native != nullptr && (_layoutIndependent || _usLayout || uinputOnAnyLayout);
+
+  /// Opens the native injector. Without it, every injection runs one of the
+  /// external tools.
+  Future<void> initialize({String? libraryPath}) async {
+    if (_native != nullptr) return;
+
+    final libName = libraryPath ?? (Platform.isLinux ? 'libinject.so' : 'inject.dll');
+    print('DEBUG: [Injection] Opening inject library $libName');
+    final bindings = InjectBindings(DynamicLibrary.open(libName));
+    bindings.inject_dart_init(NativeApi.postCObject.cast());
+
+    final context = bindings.inject_init(bindings.inject_default_config());
+    if (context == nullptr) {
+      throw Exception('No native injection backend available');
+    }
+    _bindings = bindings;
+    _native = context;
+    _layoutIndependent = bindings.inject_get_backend(context) == inject_backend.INJECT_BACKEND_XTEST;
+    _usLayout = bindings.inject_detect_layout() == inject_layout.INJECT_LAYOUT_US;
+    final backend = _layoutIndependent ? 'XTest' : 'uinput';
+    print('DEBUG: [Injection] Native injector ready ($backend, US layout: $_usLayout)');
+  }
+
+  /// Types [text] into the focused window. With [preserveSpacing], leading
+  /// and trailing spaces are typed as well, for text injected in pieces.
+  Future<bool> injectText(String text, {String method = 'dotool', bool preserveSpacing = false}) async {
     lastInjectionWasFallback = false;
     print('DEBUG: [Injection] Injecting text using method: $method (Wayland: $_isWayland)');
     
@@ -13,27 +56,40 @@ class TextInjectionService {
       return await _injectClipboard(text);
     }
 
+    if (_nativeFirst && await _injectNative(text, preserveSpacing: preserveSpacing)) {
+      return true;
+    }
+
     if (_isWayland) {
-      return await _injectWayland(text);
+      return await _injectWayland(text, preserveSpacing: preserveSpacing);
     } else {
       return await _injectX11(text);
     }
   }
 
-  Future<bool> _injectClipboard(String text) async {
+  /// Puts [text] on the clipboard without pasting it.
+  Future<bool> copyToClipboard(String text) async {
     print('DEBUG: [Injection] Setting clipboard data');
     try {
       await Clipboard.setData(ClipboardData(text: text));
       print('DEBUG: [Injection] Clipboard data set successfully');
+      return true;
     } catch (e) {
       print('DEBUG: [Injection] Failed to set clipboard data: $e');
       return false;
     }
+  }
+
+  Future<bool> _injectClipboard(String text) async {
+    if (!await copyToClipboard(text)) return false;
     
     // Optional: simulate Ctrl+V
     print('DEBUG: [Injection] Attempting to simulate Ctrl+V...');
-    bool pasteSuccess = false;
-    if (_isWayland) {
+    // Ctrl+V is a keycode too: on Dvorak, uinput's KEY_V is Ctrl+K
+    bool pasteSuccess = _nativeFirst && _bindings!.inject_paste(_native) == 0;
+    if (pasteSuccess) {
+      print('DEBUG: [Injection] Ctrl+V sent by the native injector');
+    } else if (_isWayland) {
       pasteSuccess = await _tryRun('dotool', [], stdinText: 'key ctrl+v\n');
       if (!pasteSuccess) {
         pasteSuccess = await _tryRun('ydotool', ['key', '29:1', '47:1', '47:0', '29:0']);
@@ -54,6 +110,43 @@ class TextInjectionService {
     return true; // Consider success if clipboard was set
   }
 
+  /// Types [text] on the native virtual keyboard. Returns false, having typed
+  /// nothing, when there is no native injector or the text has characters it
+  /// cannot type; the external tools take it then.
+  Future<bool> _injectNative(String text, {bool preserveSpacing = false}) async {
+    if (_native == nullptr) return false;
+
+    // Newlines would press Enter, as in the Wayland tool path
+    var sanitizedText = text.replaceAll('\n', ' ').replaceAll('\r', ' ');
+    if (!preserveSpacing) sanitizedText = sanitizedText.trim();
+
+    // Typed on the injector's writer thread, which posts the result here
+    final resultPort = ReceivePort();
+    final textPtr = sanitizedText.toNativeUtf8();
+    final queued = _bindings!.inject_type_port(_native, textPtr.cast(), resultPort.sendPort.nativePort);
+    calloc.free(textPtr);
+    if (!queued) {
+      resultPort.close();
+      print('DEBUG: [Injection] Native injector cannot type this text, using external tools');
+      return false;
+    }
+
+    final typed = await resultPort.first as int;
+    if (typed < 0) {
+      print('DEBUG: [Injection] Native injection failed, using external tools');
+      return false;
+    }
+    print('DEBUG: [Injection] Native injection typed $typed characters');
+    return true;
+  }
+
+  void dispose() {
+    if (_native != nullptr) {
+      _bindings!.inject_free(_native);
+      _native = nullptr;
+    }
+  }
+
   Future<bool> _tryRun(String command, List<String> args, {String? stdinText}) async {
     try {
       // For ydotool, ensure we point to the correct socket if it exists
@@ -106,11 +199,12 @@ class TextInjectionService {
     return true;
   }
 
-  Future<bool> _injectWayland(String text) async {
+  Future<bool> _injectWayland(String text, {bool preserveSpacing = false}) async {
     print('DEBUG: [Injection] Attempting Wayland injection...');
     
     // Escape or sanitize text for shell safety - replace newlines with spaces
-    final sanitizedText = text.replaceAll('\n', ' ').replaceAll('\r', ' ').trim();
+    var sanitizedText = text.replaceAll('\n', ' ').replaceAll('\r', ' ');
+    if (!preserveSpacing) sanitizedText = sanitizedText.trim();
     print('DEBUG: [Injection] Sanitized text: "$sanitizedText"');
     
     // Try ydotool first - it's the most reliable on KDE (wtype doesn't work on KDE)
@@ -138,3 +232,98 @@ class TextInjectionService {
     }
   }
 }
+
+/// Types text while it is still being generated. Pieces are committed at word
+/// boundaries, so a word is never typed in halves, and committed text goes out
+/// in order, one injection at a time: whatever is committed while an
+/// injection runs is typed together by the next one.
+class StreamingInjector {
+  final TextInjectionService _service;
+  final String method;
+
+  final StringBuffer _uncommitted = StringBuffer();
+  final StringBuffer _queued = StringBuffer();
+  Future<void>? _draining;
+  bool _started = false;
+
+  /// Characters typed so far, and whether any injection fell back to the
+  /// clipboard or failed outright (nothing more is typed after a failure).
+  int injectedLength = 0;
+  bool usedFallback = false;
+  bool failed = false;
+
+  /// Completes with the time of the first injection that went out.
+  final Completer<DateTime> firstInjection = Completer<DateTime>();
+
+  StreamingInjector(this._service, {this.method = 'dotool'});
+
+  bool get hasInjected => injectedLength > 0;
+
+  void add(String piece) {
+    _uncommitted.write(piece);
+    final pending = _uncommitted.toString();
+
+    // Up to and including the last whitespace that follows a word
+    var end = pending.length;
+    while (end > 0 && !_isSpace(pending.codeUnitAt(end - 1))) {
+      end--;
+    }
+    if (end == 0) return;
+
+    _uncommitted.clear();
+    _uncommitted.write(pending.substring(end));
+    _commit(pending.substring(0, end));
+  }
+
+  /// Commits what is left and waits for every injection to finish. Returns
+  /// false if an injection failed.
+  Future<bool> close() async {
+    final rest = _uncommitted.toString().trimRight();
+    _uncommitted.clear();
+    if (rest.isNotEmpty) _commit(rest);
+    while (_draining != null) {
+      await _draining;
+    }
+    return !failed;
+  }
+
+  /// Drops the uncommitted tail and waits for the injections already
+  /// queued, for a stream that broke off mid-word.
+  Future<void> abort() async {
+    _uncommitted.clear();
+    while (_draining != null) {
+      await _draining;
+    }
+  }
+
+  void _commit(String text) {
+    // The reply starts at its first word
+    if (!_started) {
+      text = text.trimLeft();
+      if (text.isEmpty) return;
+      _started = true;
+    }
+    _queued.write(text);
+    _draining ??= _drain();
+  }
+
+  Future<void> _drain() async {
+    // Let the caller's add() return before the first injection starts
+    await Future<void>.value();
+    while (_queued.isNotEmpty && !failed) {
+      final chunk = _queued.toString();
+      _queued.clear();
+      final ok = await _service.injectText(chunk, method: method, preserveSpacing: true);
+      if (!ok) {
+        failed = true;
+        break;
+      }
+      if (!firstInjection.isCompleted) firstInjection.complete(DateTime.now());
+      injectedLength += chunk.length;
+      usedFallback = usedFallback || _service.lastInjectionWasFallback;
+    }
+    _draining = null;
+  }
+
+  static bool _isSpace(int c) => c == 0x20 || c == 0x0A || c == 0x0D || c == 0x09;
+}
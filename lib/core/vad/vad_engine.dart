@@ -1,8 +1,24 @@
 import 'dart:ffi';
 import 'dart:io';
+import 'dart:typed_data';
 import 'package:ffi/ffi.dart';
 import '../../native/vad_bindings.dart';
 
+enum VadEventType { speechStart, speechEnd }
+
+class VadEvent {
+  final VadEventType type;
+
+  /// Absolute sample offset since the engine was created or last reset,
+  /// already padded by speechPadMs.
+  final int offset;
+
+  const VadEvent(this.type, this.offset);
+
+  @override
+  String toString() => 'VadEvent(${type.name}, $offset)';
+}
+
 class VadEngine {
   final VadBindings _bindings;
   Pointer<vad_context>? _context;
@@ -18,6 +34,8 @@ class VadEngine {
     int sampleRate = 16000,
     int frameSize = 512,
     double threshold = 0.5,
+    int minSilenceDurationMs = 1000,
+    int speechPadMs = 500,
   }) async {
     print('DEBUG: VadEngine.initialize(modelPath: $modelPath)');
     final DynamicLibrary lib;
@@ -42,8 +60,8 @@ class VadEngine {
     config.ref.sample_rate = sampleRate;
     config.ref.frame_size = frameSize;
     config.ref.threshold = threshold;
-    config.ref.min_silence_duration_ms = 100;
-    config.ref.speech_pad_ms = 30;
+    config.ref.min_silence_duration_ms = minSilenceDurationMs;
+    config.ref.speech_pad_ms = speechPadMs;
 
     print('DEBUG: Converting model path to native string...');
     final modelPathPtr = modelPath.toNativeUtf8();
@@ -64,67 +82,84 @@ class VadEngine {
 
   void setThreshold(double threshold) {
     this.threshold = threshold;
+    if (_context != nullptr) {
+      _bindings.vad_set_threshold(_context!, threshold);
+    }
   }
 
+  static const int _maxEvents = 16;
+
   int _debugCounter = 0;
-  double _maxProbSeen = 0.0;
-  
-  bool isSpeech(List<double> samples) {
-    _vadBuffer.addAll(samples);
-    
-    // Silero VAD works best with frames of 512, 1024, or 1536 samples at 16kHz
-    // We'll use 512 as our target frame size
-    const int targetFrameSize = 512;
-    
-    bool speechDetected = false;
-    double maxProb = 0.0;
-    
-    // Debug: check sample amplitude
-    double maxAmp = 0.0;
-    for (final s in samples) {
-      if (s.abs() > maxAmp) maxAmp = s.abs();
-    }
-    
-    while (_vadBuffer.length >= targetFrameSize) {
-      final frame = _vadBuffer.sublist(0, targetFrameSize);
-      _vadBuffer.removeRange(0, targetFrameSize);
-      
-      final prob = process(frame);
-      if (prob > maxProb) maxProb = prob;
-      if (prob >= threshold) {
-        speechDetected = true;
-      }
+
+  Pointer<vad_event> _events = nullptr;
+
+  // Output of vad_process_batch, grown to the largest chunk seen
+  Pointer<Float> _probs = nullptr;
+  int _probsCapacity = 0;
+
+  bool get isSpeaking => _context != nullptr && _bindings.vad_is_speaking(_context!);
+
+  /// Runs a chunk of any length through the native segmenter and returns the
+  /// speech start/end events it produced. Partial frames are kept natively.
+  List<VadEvent> feed(Pointer<Float> samples, int length) {
+    if (_context == nullptr) throw Exception('VAD engine disposed');
+    if (_events == nullptr) {
+      _events = calloc<vad_event>(_maxEvents);
     }
-    
-    // Track max probability seen for debugging
-    if (maxProb > _maxProbSeen) {
-      _maxProbSeen = maxProb;
+
+    final n = _bindings.vad_feed(_context!, samples, length, _events, _maxEvents);
+    if (n < 0) {
+      throw Exception('VAD feed failed');
     }
-    
-    // Debug log every ~2 seconds, OR when amplitude is high (likely speech)
+
+    // Debug log every ~2 seconds
     _debugCounter++;
-    final bool isLoudAudio = maxAmp > 0.15;
-    if (_debugCounter % 20 == 0 || isLoudAudio) {
-      print('DEBUG: [VAD] maxProb=$maxProb, maxAmp=${maxAmp.toStringAsFixed(3)}, threshold=$threshold, detected=$speechDetected, allTimeMax=$_maxProbSeen${isLoudAudio ? " [LOUD]" : ""}');
+    if (_debugCounter % 40 == 0) {
+      print('DEBUG: [VAD] speaking=$isSpeaking, threshold=$threshold');
     }
-    
-    return speechDetected;
+
+    if (n == 0) return const [];
+    return List.generate(n, (i) {
+      final event = _events[i];
+      return VadEvent(
+        event.type == vad_event_type.VAD_EVENT_SPEECH_START ? VadEventType.speechStart : VadEventType.speechEnd,
+        event.offset,
+      );
+    });
   }
 
-  final List<double> _vadBuffer = [];
+  /// Copies the audio retained from [offset] up to the last sample fed into
+  /// [out]. Returns the number of samples written.
+  int copyPreroll(int offset, Pointer<Float> out, int maxSamples) {
+    if (_context == nullptr) throw Exception('VAD engine disposed');
+    final n = _bindings.vad_copy_preroll(_context!, offset, out, maxSamples);
+    if (n < 0) {
+      throw Exception('VAD pre-roll at $offset is no longer available');
+    }
+    return n;
+  }
 
-  double process(List<double> samples) {
+  double process(Pointer<Float> samples, int length) {
     if (_context == nullptr) throw Exception('VAD engine disposed');
-    
-    final samplesPtr = calloc<Float>(samples.length);
-    for (var i = 0; i < samples.length; i++) {
-      samplesPtr[i] = samples[i];
+    return _bindings.vad_process(_context!, samples, length);
+  }
+
+  /// Runs [nFrames] consecutive frames of [frameSize] samples. The returned
+  /// list views native memory that is reused by the next call.
+  Float32List processBatch(Pointer<Float> samples, int nFrames) {
+    if (_context == nullptr) throw Exception('VAD engine disposed');
+
+    if (nFrames > _probsCapacity) {
+      if (_probs != nullptr) calloc.free(_probs);
+      _probs = calloc<Float>(nFrames);
+      _probsCapacity = nFrames;
     }
 
-    final prob = _bindings.vad_process(_context!, samplesPtr, samples.length);
-    calloc.free(samplesPtr);
-    
-    return prob;
+    final processed = _bindings.vad_process_batch(_context!, samples, nFrames, _probs);
+    if (processed < 0) {
+      throw Exception('VAD batch processing failed');
+    }
+    return _probs.asTypedList(processed);
   }
 
   void reset() {
@@ -138,5 +173,14 @@ class VadEngine {
       _bindings.vad_free(_context!);
       _context = nullptr;
     }
+    if (_events != nullptr) {
+      calloc.free(_events);
+      _events = nullptr;
+    }
+    if (_probs != nullptr) {
+      calloc.free(_probs);
+      _probs = nullptr;
+      _probsCapacity = 0;
+    }
   }
 }
@@ -13,23 +13,55 @@ enum WhisperStrategy {
   const WhisperStrategy(this.value);
 }
 
+/// Which pooled decoding state a job runs on. Each purpose has its own KV
+/// cache and isolate, so a final pass never queues behind interim work.
+enum WhisperStatePurpose {
+  interim(0),
+  finalPass(1);
+
+  final int value;
+  const WhisperStatePurpose(this.value);
+}
+
+/// Which cores the persistent decoding threads are pinned to.
+enum WhisperCoreAffinity {
+  any(whisper_threadpool_affinity.WHISPER_THREADPOOL_AFFINITY_ANY),
+  /// Only the fastest cores, e.g. the P-cores of a hybrid CPU
+  performance(whisper_threadpool_affinity.WHISPER_THREADPOOL_AFFINITY_PERFORMANCE);
+
+  final int value;
+  const WhisperCoreAffinity(this.value);
+}
+
 class WhisperEngine {
+  // Interim jobs and the stream session run here; it also owns the model slot
   final SendPort _commandPort;
+  // Final transcriptions run here, on their own state of the same model
+  final SendPort _finalPort;
+  final WhisperBindings _bindings;
+  final String _libraryPath;
+  // Native holder of the current model; every job acquires it for its duration
+  final Pointer<ModelSlot> _slot;
   bool _initialized = false;
   Map<String, dynamic>? _metadata;
 
-  WhisperEngine._(this._commandPort, this._metadata) : _initialized = true;
+  WhisperEngine._(this._commandPort, this._finalPort, this._bindings, this._libraryPath, this._slot, this._metadata)
+      : _initialized = true;
 
   static Future<WhisperEngine> initialize({
     String modelPath = '',
     String? libraryPath,
+    int nThreads = 4,
+    WhisperCoreAffinity affinity = WhisperCoreAffinity.performance,
+    bool lockModel = false,
+    String draftModelPath = '',
   }) async {
     print('DEBUG: WhisperEngine.initialize(modelPath: $modelPath)');
     
     final resolvedLibraryPath = libraryPath ?? (Platform.isLinux ? 'libwhisper.so' : 'whisper.dll');
     final receivePort = ReceivePort();
     
-    await Isolate.spawn(_whisperIsolate, [receivePort.sendPort, resolvedLibraryPath, modelPath]);
+    await Isolate.spawn(_whisperIsolate, [receivePort.sendPort, resolvedLibraryPath, modelPath, nThreads, affinity.value, lockModel]);
     
     final events = receivePort.asBroadcastStream();
     final commandPort = await events.first as SendPort;
@@ -38,34 +70,176 @@ class WhisperEngine {
     final metadataPort = ReceivePort();
     commandPort.send(['get_metadata', metadataPort.sendPort]);
     final metadata = await metadataPort.first as Map<String, dynamic>;
+
+    // The final-pass worker shares the model slot. With a draft model (a
+    // small one with the same tokenizer, e.g. tiny or base) its greedy decodes
+    // are speculative: the draft proposes tokens the model verifies in batches.
+    final finalReceivePort = ReceivePort();
+    await Isolate.spawn(_finalIsolate, [
+      finalReceivePort.sendPort,
+      resolvedLibraryPath,
+      metadata['slot'] as int,
+      draftModelPath,
+    ]);
+    final finalPort = await finalReceivePort.first as SendPort;
+
+    // Aborts are issued from this isolate while the workers are busy in native code
+    final bindings = WhisperBindings(DynamicLibrary.open(resolvedLibraryPath));
+    final slot = Pointer<ModelSlot>.fromAddress(metadata['slot'] as int);
     
-    return WhisperEngine._(commandPort, metadata);
+    return WhisperEngine._(commandPort, finalPort, bindings, resolvedLibraryPath, slot, metadata);
+  }
+
+  /// Switches to the model at [modelPath] without a gap in service. The new
+  /// model is loaded and warmed up on a background isolate while the current
+  /// one keeps serving; decodes already running finish on the old model, which
+  /// is freed once they are done. Returns false and keeps the current model
+  /// if the new one fails to load or the two would not fit in memory together
+  /// ([maxBytes] total, or the available system memory when 0).
+  Future<bool> swapModel(String modelPath, {int maxBytes = 0, bool lockModel = false}) async {
+    if (!_initialized) {
+      throw WhisperException('Whisper engine not initialized');
+    }
+
+    print('DEBUG: WhisperEngine.swapModel(modelPath: $modelPath)');
+    final libraryPath = _libraryPath;
+    final slotAddress = _slot.address;
+    final status = await Isolate.run(() {
+      final bindings = WhisperBindings(DynamicLibrary.open(libraryPath));
+      final cparams = bindings.contextDefaultParams();
+      cparams.use_gpu = true;
+      cparams.use_mmap = true;
+      cparams.use_mlock = lockModel;
+      final repackPtr = _repackCachePath(modelPath).toNativeUtf8();
+      cparams.repack_cache_path = repackPtr.cast();
+      final modelPtr = modelPath.toNativeUtf8();
+      final result = bindings.modelSlotSwap(
+        Pointer<ModelSlot>.fromAddress(slotAddress),
+        modelPtr.cast(),
+        cparams,
+        maxBytes,
+      );
+      calloc.free(modelPtr);
+      calloc.free(repackPtr);
+      return result;
+    });
+
+    final memory = _bindings.modelSlotGetMemory(_slot);
+    print('DEBUG: WhisperEngine swap status $status, '
+        'live=${(memory.live_bytes / 1e6).toStringAsFixed(1)} MB, '
+        'peak=${(memory.peak_bytes / 1e6).toStringAsFixed(1)} MB, '
+        'estimate=${(memory.last_estimate / 1e6).toStringAsFixed(1)} MB');
+    if (status != whisper_swap_status.WHISPER_SWAP_OK) {
+      return false;
+    }
+
+    final metadataPort = ReceivePort();
+    _commandPort.send(['get_metadata', metadataPort.sendPort]);
+    _metadata = await metadataPort.first as Map<String, dynamic>;
+    return true;
+  }
+
+  /// Pays the first-decode costs (graph reservation, weight repacking, page
+  /// faults, buffer growth) on both workers ahead of the first dictation.
+  /// Jobs sent meanwhile queue behind it, so call it right after [initialize].
+  /// [allBuckets] warms every encoder size instead of the smallest and the
+  /// full one; [beamSearch] sizes the KV cache for beam search decoding.
+  Future<bool> warmup({bool allBuckets = false, bool beamSearch = false}) async {
+    if (!_initialized) return false;
+
+    var flags = whisper_warmup_flags.WHISPER_WARMUP_DEFAULT;
+    if (allBuckets) flags |= whisper_warmup_flags.WHISPER_WARMUP_ALL_BUCKETS;
+    if (beamSearch) flags |= whisper_warmup_flags.WHISPER_WARMUP_BEAM_SEARCH;
+
+    // The weights are shared, so only one worker needs to fault them in
+    final interimDone = ReceivePort();
+    final finalDone = ReceivePort();
+    _commandPort.send(['warmup', flags, interimDone.sendPort]);
+    _finalPort.send(['warmup', flags & ~whisper_warmup_flags.WHISPER_WARMUP_PREFAULT, finalDone.sendPort]);
+    final results = await Future.wait([interimDone.first, finalDone.first]);
+    return results.every((ok) => ok == true);
+  }
+
+  /// Keeps the interim decoding threads spinning between graphs while a
+  /// recording is running, and parks them again when it ends.
+  void setInterimActive(bool active) {
+    if (!_initialized) return;
+    _bindings.modelSlotSetActive(_slot, WhisperStatePurpose.interim.value, active);
   }
 
+  /// Makes an in-flight interim decode or stream poll return early so the
+  /// final pass gets the CPU/GPU to itself.
+  void preemptInterim() {
+    if (!_initialized) return;
+    print('DEBUG: WhisperEngine preempting interim decode');
+    _bindings.modelSlotAbort(_slot, WhisperStatePurpose.interim.value);
+  }
+
+  /// Bytes held by live models, and the most held at once (during swaps).
+  int get liveModelBytes => _initialized ? _bindings.modelSlotGetMemory(_slot).live_bytes : 0;
+  int get peakModelBytes => _initialized ? _bindings.modelSlotGetMemory(_slot).peak_bytes : 0;
+
+  /// With [adaptiveAudioCtx], the encoder context is sized to the audio
+  /// instead of a full 30 s window. It is faster on short clips but off by
+  /// default until its WER cost is measured (native/whisper/tests/bench_audio_ctx).
   Future<String> transcribe({
-    required List<double> audioSamples,
+    required WhisperAudioBuffer audio,
+    int offset = 0,
+    int? length,
     WhisperStrategy strategy = WhisperStrategy.greedy,
     String language = 'en',
     int nThreads = 4,
     bool translate = false,
+    bool adaptiveAudioCtx = false,
+    WhisperStatePurpose purpose = WhisperStatePurpose.finalPass,
+    bool preempt = true,
+    void Function(WhisperSegment segment)? onSegment,
   }) async {
     if (!_initialized) {
       throw WhisperException('Whisper engine not initialized');
     }
 
-    print('DEBUG: WhisperEngine.transcribe called with ${audioSamples.length} samples');
+    final nSamples = length ?? audio.length - offset;
+    print('DEBUG: WhisperEngine.transcribe called with $nSamples samples (${purpose.name})');
+
+    if (purpose == WhisperStatePurpose.finalPass && preempt) {
+      preemptInterim();
+    }
     
+    // Segments are posted by the decoder straight to this isolate as they are produced
+    ReceivePort? segmentPort;
+    if (onSegment != null) {
+      segmentPort = ReceivePort();
+      segmentPort.listen((message) {
+        final fields = message as List;
+        onSegment(WhisperSegment(
+          text: fields[3] as String,
+          startTimeMs: (fields[1] as int) * 10,
+          endTimeMs: (fields[2] as int) * 10,
+          tokens: const [],
+        ));
+      });
+    }
+
+    // Only the buffer handle and range cross the isolate boundary
     final responsePort = ReceivePort();
-    _commandPort.send(_TranscribeRequest(
+    final port = purpose == WhisperStatePurpose.finalPass ? _finalPort : _commandPort;
+    port.send(_TranscribeRequest(
       responsePort: responsePort.sendPort,
-      audioSamples: audioSamples,
+      buffer: audio.address,
+      offset: offset,
+      length: nSamples,
       strategy: strategy,
       language: language,
       nThreads: nThreads,
       translate: translate,
+      adaptiveAudioCtx: adaptiveAudioCtx,
+      segmentPort: segmentPort?.sendPort.nativePort ?? 0,
     ));
 
+    // The decoder's posts are queued ahead of the result, so no segment is lost here
     final result = await responsePort.first;
+    segmentPort?.close();
     if (result is String) {
       return result;
     } else if (result is WhisperException) {
@@ -75,10 +249,101 @@ class WhisperEngine {
     }
   }
 
+  /// Starts an incremental transcription session. Audio is fed with
+  /// [pushStream] and only the uncommitted tail is re-decoded on [pollStream].
+  /// [adaptiveAudioCtx] is as for [transcribe].
+  void beginStream({
+    WhisperStrategy strategy = WhisperStrategy.greedy,
+    String language = 'en',
+    int nThreads = 4,
+    bool translate = false,
+    bool adaptiveAudioCtx = false,
+  }) {
+    if (!_initialized) {
+      throw WhisperException('Whisper engine not initialized');
+    }
+
+    _commandPort.send(_StreamBeginRequest(
+      strategy: strategy,
+      language: language,
+      nThreads: nThreads,
+      translate: translate,
+      adaptiveAudioCtx: adaptiveAudioCtx,
+    ));
+  }
+
+  /// Feeds [length] samples starting at [offset] of [audio] to the stream session.
+  void pushStream(WhisperAudioBuffer audio, int offset, int length) {
+    if (!_initialized || length <= 0) return;
+    _commandPort.send(_StreamPushRequest(audio.address, offset, length));
+  }
+
+  Future<WhisperStreamResult> pollStream() async {
+    if (!_initialized) {
+      throw WhisperException('Whisper engine not initialized');
+    }
+
+    final responsePort = ReceivePort();
+    _commandPort.send(_StreamPollRequest(responsePort.sendPort));
+
+    final result = await responsePort.first;
+    if (result is WhisperStreamResult) {
+      return result;
+    } else if (result is WhisperException) {
+      throw result;
+    } else {
+      throw WhisperException('Unknown error during stream poll');
+    }
+  }
+
+  /// Decodes whatever audio is left, closes the session and returns the full text.
+  /// With [preempt], a poll that is still decoding is aborted first.
+  Future<String> endStream({bool preempt = true}) async {
+    if (!_initialized) {
+      throw WhisperException('Whisper engine not initialized');
+    }
+
+    if (preempt) preemptInterim();
+
+    final responsePort = ReceivePort();
+    _commandPort.send(_StreamEndRequest(responsePort.sendPort));
+
+    final result = await responsePort.first;
+    if (result is String) {
+      return result;
+    } else if (result is WhisperException) {
+      throw result;
+    } else {
+      throw WhisperException('Unknown error during stream end');
+    }
+  }
+
+  /// Completes once the interim worker has handled everything sent to it
+  /// before, so no stream push or interim decode still reads an audio buffer.
+  /// Final passes are not covered; their [transcribe] future says when they are done.
+  Future<void> sync() async {
+    if (!_initialized) return;
+    final responsePort = ReceivePort();
+    _commandPort.send(_SyncRequest(responsePort.sendPort));
+    await responsePort.first;
+  }
+
+  /// Closes the session without decoding the audio it has not seen yet,
+  /// aborting a poll that is still running. For when the text comes from a
+  /// final [transcribe] of the whole recording instead.
+  void cancelStream() {
+    if (!_initialized) return;
+    preemptInterim();
+    _commandPort.send(_StreamCancelRequest());
+  }
+
   static void _whisperIsolate(List<dynamic> args) async {
     final SendPort mainSendPort = args[0];
     final String libraryPath = args[1];
     final String modelPath = args[2];
+    final int nThreads = args[3];
+    final int affinity = args[4];
+    final bool lockModel = args[5];
 
     final commandPort = ReceivePort();
     mainSendPort.send(commandPort.sendPort);
@@ -92,122 +357,526 @@ class WhisperEngine {
     // Enable GPU support
     cparams.use_gpu = true;
     print('DEBUG: [Isolate] GPU support enabled: ${cparams.use_gpu}');
+    // Weights come straight from the page cache, shared with anything else
+    // that maps the same model file
+    cparams.use_mmap = true;
+    cparams.use_mlock = lockModel;
+    // Quantized weights re-laid out for the CPU kernels are kept next to the
+    // model, so only the first load of a model pays for it
+    final repackPtr = _repackCachePath(modelPath).toNativeUtf8();
+    cparams.repack_cache_path = repackPtr.cast();
     
+    // The model and its persistent decoding states, one per purpose; this
+    // isolate uses the interim one
     final modelPtr = modelPath.toNativeUtf8();
-    final context = bindings.initFromFileWithParams(modelPtr.cast(), cparams);
+    final slot = bindings.modelSlotInit(modelPtr.cast(), cparams);
     calloc.free(modelPtr);
+    calloc.free(repackPtr);
 
-    if (context == nullptr) {
+    if (slot == nullptr) {
       print('DEBUG: [Isolate] Failed to load model');
       return;
     }
 
-    print('DEBUG: [Isolate] Model loaded and ready');
+    // Lets decodes in any isolate post segments to native ports
+    bindings.dartInit(NativeApi.postCObject.cast());
+
+    for (final purpose in WhisperStatePurpose.values) {
+      _attachThreadpool(bindings, slot, purpose, nThreads, affinity);
+    }
 
-    // Pre-calculate metadata
     final version = bindings.version().cast<Utf8>().toDartString();
-    final vocabSize = bindings.nVocab(context);
-    final textContextSize = bindings.nTextCtx(context);
-    final audioContextSize = bindings.nAudioCtx(context);
-    final isMultilingual = bindings.isMultilingual(context) != 0;
+
+    // A stream session keeps the model it started on, even across a swap
+    Pointer<WhisperStream> stream = nullptr;
+    Pointer<WhisperModel> streamModel = nullptr;
+
+    void freeStream() {
+      if (stream != nullptr) {
+        bindings.streamFree(stream);
+        stream = nullptr;
+      }
+      if (streamModel != nullptr) {
+        bindings.modelRelease(streamModel);
+        streamModel = nullptr;
+      }
+    }
 
     await for (final msg in commandPort) {
       if (msg is _TranscribeRequest) {
-        try {
-          print('DEBUG: [Isolate] Starting transcription task...');
-          final params = bindings.fullDefaultParams(msg.strategy.value);
-          params.strategy = msg.strategy.value;
-          params.n_threads = msg.nThreads;
-          params.translate = msg.translate;
-          params.detect_language = msg.language == 'auto';
-
-          final langPtr = msg.language.toNativeUtf8();
-          params.language = langPtr.cast();
-
-          final samplesPtr = calloc<Float>(msg.audioSamples.length);
-          for (var i = 0; i < msg.audioSamples.length; i++) {
-            samplesPtr[i] = msg.audioSamples[i];
-          }
-
-          final result = bindings.full(
-            context,
-            params,
-            samplesPtr,
-            msg.audioSamples.length,
-          );
-
-          malloc.free(langPtr);
-          calloc.free(samplesPtr);
-
-          if (result != 0) {
-            msg.responsePort.send(WhisperException('Whisper transcription failed with code $result'));
-            continue;
-          }
-
-          final nSegments = bindings.fullNSegments(context);
-          final buffer = StringBuffer();
-
-          for (var i = 0; i < nSegments; i++) {
-            final textPtr = bindings.fullGetSegmentText(context, i);
-            final text = textPtr.cast<Utf8>().toDartString();
-            buffer.write(text);
-            buffer.write(' ');
-          }
-
-          final finalResult = buffer.toString().trim();
-          print('DEBUG: [Isolate] Transcription finished, result length: ${finalResult.length}');
-          msg.responsePort.send(finalResult);
-        } catch (e) {
-          msg.responsePort.send(WhisperException('Transcription error: $e'));
+        _transcribeOn(bindings, slot, WhisperStatePurpose.interim, msg);
+      } else if (msg is _StreamBeginRequest) {
+        freeStream();
+        final params = bindings.fullDefaultParams(msg.strategy.value);
+        params.strategy = msg.strategy.value;
+        params.n_threads = msg.nThreads;
+        params.translate = msg.translate;
+        // "auto" detects the language and then transcribes; detect_language
+        // would stop after the detection and return no text
+        params.detect_language = false;
+        // Encoder context is sized to the audio length natively
+        if (msg.adaptiveAudioCtx) params.audio_ctx = WHISPER_AUDIO_CTX_AUTO;
+
+        // The native session copies the language string
+        final langPtr = msg.language.toNativeUtf8();
+        params.language = langPtr.cast();
+        streamModel = bindings.modelSlotAcquire(slot);
+        stream = bindings.streamBeginWithState(
+          bindings.modelContext(streamModel),
+          bindings.modelState(streamModel, WhisperStatePurpose.interim.value),
+          params,
+        );
+        malloc.free(langPtr);
+        print('DEBUG: [Isolate] Stream session started');
+      } else if (msg is _StreamPushRequest) {
+        if (stream == nullptr) continue;
+        final samplesPtr = bindings.audioBufferView(
+          Pointer<AudioBuffer>.fromAddress(msg.buffer),
+          msg.offset,
+          msg.length,
+        );
+        if (samplesPtr != nullptr) {
+          bindings.streamPush(stream, samplesPtr, msg.length);
+        }
+      } else if (msg is _StreamPollRequest) {
+        if (stream == nullptr) {
+          msg.responsePort.send(WhisperException('No active stream session'));
+          continue;
+        }
+        final partialPtr = calloc<Pointer<Char>>();
+        final committedPtr = calloc<Pointer<Char>>();
+        final result = bindings.streamPoll(stream, partialPtr, committedPtr);
+        if (result != 0) {
+          msg.responsePort.send(WhisperException('Whisper stream poll failed with code $result'));
+        } else {
+          msg.responsePort.send(WhisperStreamResult(
+            committed: committedPtr.value.cast<Utf8>().toDartString(),
+            partial: partialPtr.value.cast<Utf8>().toDartString(),
+          ));
+        }
+        calloc.free(partialPtr);
+        calloc.free(committedPtr);
+      } else if (msg is _StreamEndRequest) {
+        if (stream == nullptr) {
+          msg.responsePort.send(WhisperException('No active stream session'));
+          continue;
+        }
+        final text = bindings.streamEnd(stream).cast<Utf8>().toDartString().trim();
+        freeStream();
+        print('DEBUG: [Isolate] Stream session ended, result length: ${text.length}');
+        msg.responsePort.send(text);
+      } else if (msg is _StreamCancelRequest) {
+        freeStream();
+        print('DEBUG: [Isolate] Stream session cancelled');
+      } else if (msg is List && msg[0] == 'warmup') {
+        // The stream session owns the interim state while it runs
+        if (stream != nullptr) {
+          (msg[2] as SendPort).send(false);
+        } else {
+          _warmupOn(bindings, slot, WhisperStatePurpose.interim, msg);
         }
       } else if (msg is List && msg[0] == 'get_metadata') {
+        // Describes whichever model is current, so it is rebuilt after a swap
         final SendPort replyPort = msg[1];
+        final model = bindings.modelSlotAcquire(slot);
+        final context = bindings.modelContext(model);
+        final loadStats = bindings.getLoadStats(context);
+        final loadTimeMs = loadStats.t_load_us / 1000.0;
+        final pageCacheHit = loadStats.page_cache_hit;
+        print('DEBUG: [Isolate] Model loaded in ${loadTimeMs.toStringAsFixed(1)} ms '
+            '(mmap=${loadStats.use_mmap}, mlock=${loadStats.use_mlock}, '
+            'mapped=${(loadStats.n_bytes_mapped / 1e6).toStringAsFixed(1)} MB, '
+            'copied=${(loadStats.n_bytes_copied / 1e6).toStringAsFixed(1)} MB, '
+            'repacked=${(loadStats.n_bytes_repacked / 1e6).toStringAsFixed(1)} MB, '
+            'from repack cache=${(loadStats.n_bytes_repack_cached / 1e6).toStringAsFixed(1)} MB, '
+            'page cache=${pageCacheHit < 0 ? 'n/a' : '${(pageCacheHit * 100).toStringAsFixed(0)}%'})');
         replyPort.send({
           'version': version,
-          'vocabSize': vocabSize,
-          'textContextSize': textContextSize,
-          'audioContextSize': audioContextSize,
-          'isMultilingual': isMultilingual,
+          'vocabSize': bindings.nVocab(context),
+          'textContextSize': bindings.nTextCtx(context),
+          'audioContextSize': bindings.nAudioCtx(context),
+          'isMultilingual': bindings.isMultilingual(context) != 0,
+          'loadTimeMs': loadTimeMs,
+          'pageCacheHit': pageCacheHit,
+          'slot': slot.address,
         });
-      } else if (msg == 'dispose') {
-        bindings.free(context);
+        bindings.modelRelease(model);
+      } else if (msg is _SyncRequest) {
+        msg.responsePort.send(true);
+      } else if (msg is List && msg[0] == 'dispose') {
+        freeStream();
+        bindings.modelSlotFree(slot);
+        final SendPort donePort = msg[1];
+        donePort.send(true);
+        break;
+      }
+    }
+  }
+
+  static void _finalIsolate(List<dynamic> args) async {
+    final SendPort mainSendPort = args[0];
+    final String libraryPath = args[1];
+    final slot = Pointer<ModelSlot>.fromAddress(args[2] as int);
+    final String draftModelPath = args[3];
+
+    final commandPort = ReceivePort();
+    mainSendPort.send(commandPort.sendPort);
+
+    final bindings = WhisperBindings(DynamicLibrary.open(libraryPath));
+
+    // Only this isolate decodes with the draft model, so it owns it outright.
+    // It is loaded by the first job that uses it, the warm-up or a greedy
+    // final pass, rather than up front.
+    Pointer<Context> draftContext = nullptr;
+    Pointer<WhisperState> draftState = nullptr;
+    var draftTried = draftModelPath.isEmpty;
+
+    void loadDraft() {
+      if (draftTried) return;
+      draftTried = true;
+      final cparams = bindings.contextDefaultParams();
+      cparams.use_gpu = true;
+      cparams.use_mmap = true;
+      final repackPtr = _repackCachePath(draftModelPath).toNativeUtf8();
+      cparams.repack_cache_path = repackPtr.cast();
+      final draftPtr = draftModelPath.toNativeUtf8();
+      draftContext = bindings.initFromFileWithParams(draftPtr.cast(), cparams);
+      calloc.free(draftPtr);
+      calloc.free(repackPtr);
+      if (draftContext != nullptr) {
+        draftState = bindings.initState(draftContext);
+      }
+      if (draftState == nullptr) {
+        print('DEBUG: [Final Isolate] Failed to load draft model $draftModelPath, decoding without it');
+        if (draftContext != nullptr) bindings.free(draftContext);
+        draftContext = nullptr;
+      } else {
+        print('DEBUG: [Final Isolate] Loaded draft model $draftModelPath');
+      }
+    }
+
+    print('DEBUG: [Final Isolate] Ready');
+
+    await for (final msg in commandPort) {
+      if (msg is _TranscribeRequest) {
+        if (msg.strategy == WhisperStrategy.greedy) loadDraft();
+        _transcribeOn(bindings, slot, WhisperStatePurpose.finalPass, msg,
+            draftContext: draftContext, draftState: draftState);
+      } else if (msg is List && msg[0] == 'warmup') {
+        loadDraft();
+        if (draftState != nullptr) {
+          bindings.warmupWithState(draftContext, draftState, whisper_warmup_flags.WHISPER_WARMUP_DEFAULT);
+        }
+        _warmupOn(bindings, slot, WhisperStatePurpose.finalPass, msg);
+      } else if (msg is List && msg[0] == 'dispose') {
+        if (draftState != nullptr) {
+          bindings.freeState(draftState);
+          bindings.free(draftContext);
+        }
+        // The slot is freed by the interim isolate once this one is done
+        final SendPort donePort = msg[1];
+        donePort.send(true);
         break;
       }
     }
   }
 
+  // Long-lived workers for the states of this purpose instead of a fresh set
+  // per graph; models swapped in later get the same
+  static void _attachThreadpool(
+    WhisperBindings bindings,
+    Pointer<ModelSlot> slot,
+    WhisperStatePurpose purpose,
+    int nThreads,
+    int affinity,
+  ) {
+    final params = bindings.threadpoolDefaultParams();
+    params.n_threads = nThreads;
+    params.affinity = affinity;
+    if (bindings.modelSlotSetThreadpool(slot, purpose.value, params) != 0) {
+      print('DEBUG: [Isolate] Failed to create threadpool, using per-graph threads');
+    }
+  }
+
+  static String _repackCachePath(String modelPath) => '$modelPath.repack';
+
+  static void _warmupOn(
+    WhisperBindings bindings,
+    Pointer<ModelSlot> slot,
+    WhisperStatePurpose purpose,
+    List<dynamic> msg,
+  ) {
+    final int flags = msg[1];
+    final SendPort replyPort = msg[2];
+    final stopwatch = Stopwatch()..start();
+    final result = bindings.modelSlotWarmup(slot, purpose.value, flags);
+    print('DEBUG: [Isolate] Warm-up of the ${purpose.name} state '
+        '${result == 0 ? 'done' : 'failed ($result)'} in ${stopwatch.elapsedMilliseconds} ms');
+    replyPort.send(result == 0);
+  }
+
+  // Runs the job on the current model, which a swap cannot free until it is released
+  static void _transcribeOn(
+    WhisperBindings bindings,
+    Pointer<ModelSlot> slot,
+    WhisperStatePurpose purpose,
+    _TranscribeRequest msg, {
+    Pointer<Context>? draftContext,
+    Pointer<WhisperState>? draftState,
+  }) {
+    final model = bindings.modelSlotAcquire(slot);
+    try {
+      _transcribeOnModel(bindings, bindings.modelContext(model), bindings.modelState(model, purpose.value), msg,
+          draftContext: draftContext, draftState: draftState);
+    } finally {
+      bindings.modelRelease(model);
+    }
+  }
+
+  static void _transcribeOnModel(
+    WhisperBindings bindings,
+    Pointer<Context> context,
+    Pointer<WhisperState> state,
+    _TranscribeRequest msg, {
+    Pointer<Context>? draftContext,
+    Pointer<WhisperState>? draftState,
+  }) {
+    if (state == nullptr) {
+      msg.responsePort.send(WhisperException('No decoding state available'));
+      return;
+    }
+
+    try {
+      print('DEBUG: [Isolate] Starting transcription task...');
+      final params = bindings.fullDefaultParams(msg.strategy.value);
+      params.strategy = msg.strategy.value;
+      params.n_threads = msg.nThreads;
+      params.translate = msg.translate;
+      // "auto" detects the language and then transcribes, see _StreamBeginRequest
+      params.detect_language = false;
+      if (msg.adaptiveAudioCtx) params.audio_ctx = WHISPER_AUDIO_CTX_AUTO;
+      params.new_segment_port = msg.segmentPort;
+      // Beam search and the temperature fallback decode without it
+      final speculative = draftState != null && draftState != nullptr && msg.strategy == WhisperStrategy.greedy;
+      if (speculative) {
+        params.draft_ctx = draftContext!;
+        params.draft_state = draftState;
+      }
+
+      final langPtr = msg.language.toNativeUtf8();
+      params.language = langPtr.cast();
+
+      // whisper_full reads the shared buffer in place
+      final samplesPtr = bindings.audioBufferView(
+        Pointer<AudioBuffer>.fromAddress(msg.buffer),
+        msg.offset,
+        msg.length,
+      );
+      if (samplesPtr == nullptr) {
+        malloc.free(langPtr);
+        msg.responsePort.send(WhisperException('Audio range ${msg.offset}+${msg.length} is not available'));
+        return;
+      }
+
+      final result = bindings.fullWithState(
+        context,
+        state,
+        params,
+        samplesPtr,
+        msg.length,
+      );
+
+      malloc.free(langPtr);
+
+      if (result != 0) {
+        msg.responsePort.send(WhisperException('Whisper transcription failed with code $result'));
+        return;
+      }
+
+      if (speculative) {
+        final stats = bindings.getSpeculativeStats(state);
+        print('DEBUG: [Isolate] Speculative decoding: ${stats.n_accepted}/${stats.n_drafted} draft tokens accepted '
+            'in ${stats.n_verify} batches, draft model ${(stats.t_draft_us / 1000).toStringAsFixed(0)} ms');
+      }
+
+      final nSegments = bindings.fullNSegmentsFromState(state);
+      final buffer = StringBuffer();
+
+      for (var i = 0; i < nSegments; i++) {
+        final textPtr = bindings.fullGetSegmentTextFromState(state, i);
+        final text = textPtr.cast<Utf8>().toDartString();
+        buffer.write(text);
+        buffer.write(' ');
+      }
+
+      final finalResult = buffer.toString().trim();
+      print('DEBUG: [Isolate] Transcription finished, result length: ${finalResult.length}');
+      msg.responsePort.send(finalResult);
+    } catch (e) {
+      msg.responsePort.send(WhisperException('Transcription error: $e'));
+    }
+  }
+
   String get version => _metadata?['version'] ?? 'unknown';
   int get vocabSize => _metadata?['vocabSize'] ?? 0;
   int get textContextSize => _metadata?['textContextSize'] ?? 0;
   int get audioContextSize => _metadata?['audioContextSize'] ?? 0;
   bool get isMultilingual => _metadata?['isMultilingual'] ?? false;
 
-  void dispose() {
-    if (_initialized) {
-      _commandPort.send('dispose');
-      _initialized = false;
-    }
+  /// Model load time, and the fraction of the model file that was already in
+  /// the page cache beforehand (-1 when it was not mapped): near 1 is a warm start.
+  double get loadTimeMs => _metadata?['loadTimeMs'] ?? 0.0;
+  double get pageCacheHit => _metadata?['pageCacheHit'] ?? -1.0;
+
+  /// Completes once both workers are done, so no decode reads an audio buffer anymore.
+  Future<void> dispose() async {
+    if (!_initialized) return;
+    preemptInterim();
+    _initialized = false;
+    // Let the final worker finish before the slot goes away
+    final finalDone = ReceivePort();
+    _finalPort.send(['dispose', finalDone.sendPort]);
+    await finalDone.first;
+    final interimDone = ReceivePort();
+    _commandPort.send(['dispose', interimDone.sendPort]);
+    await interimDone.first;
   }
 }
 
 class _TranscribeRequest {
   final SendPort responsePort;
-  final List<double> audioSamples;
+  final int buffer;
+  final int offset;
+  final int length;
   final WhisperStrategy strategy;
   final String language;
   final int nThreads;
   final bool translate;
+  final bool adaptiveAudioCtx;
+  final int segmentPort;
 
   _TranscribeRequest({
     required this.responsePort,
-    required this.audioSamples,
+    required this.buffer,
+    required this.offset,
+    required this.length,
+    required this.strategy,
+    required this.language,
+    required this.nThreads,
+    required this.translate,
+    required this.adaptiveAudioCtx,
+    this.segmentPort = 0,
+  });
+}
+
+class _StreamBeginRequest {
+  final WhisperStrategy strategy;
+  final String language;
+  final int nThreads;
+  final bool translate;
+  final bool adaptiveAudioCtx;
+
+  _StreamBeginRequest({
     required this.strategy,
     required this.language,
     required this.nThreads,
     required this.translate,
+    required this.adaptiveAudioCtx,
   });
 }
 
+class _StreamPushRequest {
+  final int buffer;
+  final int offset;
+  final int length;
+
+  _StreamPushRequest(this.buffer, this.offset, this.length);
+}
+
+class _StreamPollRequest {
+  final SendPort responsePort;
+
+  _StreamPollRequest(this.responsePort);
+}
+
+class _StreamEndRequest {
+  final SendPort responsePort;
+
+  _StreamEndRequest(this.responsePort);
+}
+
+class _StreamCancelRequest {}
+
+class _SyncRequest {
+  final SendPort responsePort;
+  _SyncRequest(this.responsePort);
+}
+
+/// 16 kHz float samples in native memory, shared with the whisper isolate by
+/// address. Capture writes into it once and whisper reads it in place.
+class WhisperAudioBuffer {
+  final WhisperBindings _bindings;
+  Pointer<AudioBuffer> _buffer;
+
+  WhisperAudioBuffer._(this._bindings, this._buffer);
+
+  /// Starts with room for [capacitySeconds] and grows as audio is appended.
+  static WhisperAudioBuffer create({
+    String? libraryPath,
+    int capacitySeconds = 60,
+  }) {
+    final lib = DynamicLibrary.open(libraryPath ?? (Platform.isLinux ? 'libwhisper.so' : 'whisper.dll'));
+    final bindings = WhisperBindings(lib);
+    final buffer = bindings.audioBufferCreate(capacitySeconds * 16000);
+    if (buffer == nullptr) {
+      throw WhisperException('Failed to allocate native audio buffer');
+    }
+    return WhisperAudioBuffer._(bindings, buffer);
+  }
+
+  int get address => _buffer.address;
+  int get length => _bindings.audioBufferSize(_buffer);
+  bool get isEmpty => length == 0;
+  bool get isNotEmpty => length != 0;
+
+  /// Appends [nSamples] native floats and returns the offset they were written at.
+  /// Throws when the buffer could not grow; nothing is appended then.
+  int append(Pointer<Float> samples, int nSamples) {
+    final offset = length;
+    final result = _bindings.audioBufferAppend(_buffer, samples, nSamples);
+    if (result != 0) {
+      throw WhisperException('Failed to append $nSamples samples to the audio buffer (code $result)');
+    }
+    return offset;
+  }
+
+  /// Drops the oldest [nSamples]. Must not be called while whisper reads the
+  /// buffer, see [WhisperEngine.sync].
+  void discard(int nSamples) => _bindings.audioBufferDiscard(_buffer, nSamples);
+
+  /// Must not be called while whisper reads the buffer, see [WhisperEngine.sync].
+  void clear() => _bindings.audioBufferClear(_buffer);
+
+  void dispose() {
+    if (_buffer != nullptr) {
+      _bindings.audioBufferFree(_buffer);
+      _buffer = nullptr;
+    }
+  }
+}
+
+class WhisperStreamResult {
+  /// Text of segments that are frozen and will not change anymore.
+  final String committed;
+
+  /// Text of the re-decoded tail, may still change on the next poll.
+  final String partial;
+
+  WhisperStreamResult({required this.committed, required this.partial});
+
+  String get text => '$committed$partial'.trim();
+}
+
 class WhisperSegment {
   final String text;
   final int startTimeMs;
@@ -1,5 +1,7 @@
 import 'dart:async';
+import 'dart:ffi';
 import 'dart:io';
+import 'package:ffi/ffi.dart';
 import 'package:uuid/uuid.dart';
 import 'package:path_provider/path_provider.dart';
 import 'package:path/path.dart' as p;
@@ -9,6 +11,8 @@ import '../../core/audio/audio_capture_service.dart';
 import '../../core/text_injection/text_injection_service.dart';
 import '../../core/hotkey/hotkey_service.dart';
 import '../../core/llm/ollama_client.dart';
+import '../../core/llm/llm_engine.dart';
+import '../../core/cleanup/text_cleaner.dart';
 import '../history/history_entry.dart';
 import '../settings/settings_service.dart';
 import '../history/history_manager.dart';
@@ -30,9 +34,14 @@ class VoiceSyncManager {
   void Function(String?)? onInjectionError;
   Timer? _interimTimer;
   bool _isProcessingInterim = false;
+  bool _isStreaming = false;
 
   WhisperEngine? _whisper;
   VadEngine? _vad;
+  // In-process cleanup model; Ollama is used when no model is configured
+  LlmEngine? _llm;
+  // Fast deterministic cleanup in front of the LLM
+  TextCleaner? _cleaner;
   DateTime? _recordingStartTime;
 
   RecordingState _state = RecordingState.idle;
@@ -50,7 +59,7 @@ class VoiceSyncManager {
   /// Callback to directly notify state changes (bypasses stream for immediate updates)
   void Function(RecordingState state)? onStateChange;
 
-  final List<double> _audioBuffer = [];
+  late final WhisperAudioBuffer _audioBuffer;
   bool _isSpeechDetected = false;
 
   VoiceSyncManager(this._settings, this._history)
@@ -68,10 +77,18 @@ class VoiceSyncManager {
     final whisperLibPath = p.join(projectRoot, 'native', 'whisper', 'build', 'lib', 'libwhisper.so');
     final vadLibPath = p.join(projectRoot, 'native', 'vad', 'build', 'lib', 'libvad.so');
     final hotkeyLibPath = p.join(projectRoot, 'native', 'hotkey', 'build', 'lib', 'libhotkey.so');
+    final captureLibPath = p.join(projectRoot, 'native', 'capture', 'build', 'lib', 'libcapture.so');
+    final llmLibPath = p.join(projectRoot, 'native', 'llm', 'build', 'lib', 'libllm.so');
+    final cleanerLibPath = p.join(projectRoot, 'native', 'cleaner', 'build', 'lib', 'libcleaner.so');
+    final injectLibPath = p.join(projectRoot, 'native', 'inject', 'build', 'lib', 'libinject.so');
 
     print('DEBUG: Using whisper library at: $whisperLibPath');
     print('DEBUG: Using VAD library at: $vadLibPath');
     print('DEBUG: Using hotkey library at: $hotkeyLibPath');
+    print('DEBUG: Using capture library at: $captureLibPath');
+    print('DEBUG: Using LLM library at: $llmLibPath');
+    print('DEBUG: Using cleaner library at: $cleanerLibPath');
+    print('DEBUG: Using inject library at: $injectLibPath');
 
     try {
       await _hotkey.initialize(
@@ -82,9 +99,19 @@ class VoiceSyncManager {
       await _hotkey.initialize();
     }
 
+    try {
+      await _audio.initialize(
+        libraryPath: (await File(captureLibPath).exists()) ? captureLibPath : null,
+      );
+    } catch (e) {
+      print('DEBUG: Audio capture initialization failed: $e');
+      await _audio.initialize();
+    }
+
     try {
       _whisper = await WhisperEngine.initialize(
         modelPath: _settings.whisperModelPath,
+        draftModelPath: _settings.whisperDraftModelPath,
         libraryPath: (await File(whisperLibPath).exists()) ? whisperLibPath : null,
       );
       _lastWhisperModelPath = _settings.whisperModelPath;
@@ -94,12 +121,21 @@ class VoiceSyncManager {
       // Try default path if the build path didn't work or exist
       _whisper = await WhisperEngine.initialize(
         modelPath: _settings.whisperModelPath,
+        draftModelPath: _settings.whisperDraftModelPath,
       );
     }
 
+    // Runs on the worker isolates while the rest of the app comes up, so the
+    // first dictation is not the slow one
+    unawaited(_whisper?.warmup());
+
+    _audioBuffer = WhisperAudioBuffer.create(
+      libraryPath: (await File(whisperLibPath).exists()) ? whisperLibPath : null,
+    );
+
     // Get absolute path for VAD model
     final docsDir = await getApplicationSupportDirectory();
-    final vadModelPath = p.join(docsDir.path, 'models', 'silero_vad.onnx');
+    final vadModelPath = p.join(docsDir.path, 'models', 'ggml-silero-v5.1.2.bin');
 
     try {
       _vad = await VadEngine.initialize(
@@ -116,8 +152,30 @@ class VoiceSyncManager {
       );
     }
 
+    _injector.uinputOnAnyLayout = _settings.nativeInjectionAnyLayout;
+    try {
+      await _injector.initialize(
+        libraryPath: (await File(injectLibPath).exists()) ? injectLibPath : null,
+      );
+    } catch (e) {
+      print('DEBUG: Native injector unavailable, injecting through external tools: $e');
+    }
+
+    try {
+      _cleaner = TextCleaner.initialize(
+        libraryPath: (await File(cleanerLibPath).exists()) ? cleanerLibPath : null,
+      );
+      _cleaner!.setReplacements(_settings.cleanupReplacements);
+      print('DEBUG: Text cleaner initialized.');
+    } catch (e) {
+      print('DEBUG: Text cleaner initialization failed, every transcript goes to the LLM: $e');
+    }
+
+    _lastLlmModelPath = _settings.llmModelPath;
+    await _reinitializeLlm();
+
     _hotkey.setPttKey(_settings.pttKey);
-    _hotkey.startPolling();
+    _hotkey.startListening();
 
     _hotkey.pttStateStream.listen((isPressed) async {
       // Auto-switch to PTT mode when hotkey is pressed (regardless of current mode)
@@ -138,83 +196,89 @@ class VoiceSyncManager {
       }
     });
 
-    _audio.samplesStream.listen(_handleAudioSamples);
+    _audio.onSamples = _handleAudioSamples;
   }
 
   int _sampleDebugCounter = 0;
   
-  void _handleAudioSamples(List<double> samples) {
-    // Debug: log every 10th chunk
+  void _handleAudioSamples(Pointer<Float> samples, int length) {
+    // Debug: log every 20th chunk
     _sampleDebugCounter++;
-    if (_sampleDebugCounter % 10 == 0) {
-      print('DEBUG: [Audio] mode=${_settings.recordingMode}, state=$_state, samples=${samples.length}, buffer=${_audioBuffer.length}');
-    }
-    
-    if (_settings.recordingMode == 'Live') {
-      _processLiveVAD(samples);
-      return;
+    if (_sampleDebugCounter % 20 == 0) {
+      print('DEBUG: [Audio] mode=${_settings.recordingMode}, state=$_state, samples=$length, buffer=${_audioBuffer.length}');
     }
 
-    if (_state != RecordingState.recording) return;
+    if (_state == RecordingState.recording) {
+      try {
+        final offset = _audioBuffer.append(samples, length);
+        if (_isStreaming) _whisper?.pushStream(_audioBuffer, offset, length);
+      } on WhisperException catch (e) {
+        // Out of memory for more audio: transcribe what was kept
+        print('DEBUG: [Audio] $e, stopping the recording');
+        stopRecording();
+      }
+    }
 
-    _audioBuffer.addAll(samples);
+    if (_settings.recordingMode == 'Live') {
+      _processLiveVAD(samples, length);
+    }
   }
 
-  DateTime? _lastSpeechTime;
-  bool _isCurrentlySpeaking = false;
+  // Pre-roll copied out of the VAD ring on speech start (2s at 16kHz)
+  static const int _prerollCapacity = 32000;
+  Pointer<Float> _preroll = nullptr;
 
   int _vadDebugCounter = 0;
   
-  void _processLiveVAD(List<double> samples) {
+  void _processLiveVAD(Pointer<Float> samples, int length) {
     // In Live mode, we always want to see the volume spikes, which is handled
-    // by AudioCaptureService.volumeStream.
-    
-    // We only add to _audioBuffer if we are recording or if we want some pre-roll
-    if (_state == RecordingState.recording) {
-      _audioBuffer.addAll(samples);
-    } else if (_state == RecordingState.idle) {
-      // Keep a small pre-roll buffer (e.g., 500ms)
-      _audioBuffer.addAll(samples);
-      const int maxPreRoll = 8000; // 0.5s at 16kHz
-      if (_audioBuffer.length > maxPreRoll) {
-        _audioBuffer.removeRange(0, _audioBuffer.length - maxPreRoll);
-      }
+    // by AudioCaptureService.volumeStream. Segmentation, hangover and pre-roll
+    // all happen in the native VAD, one call per chunk.
+    if (_vad == null) return;
+
+    final events = _vad!.feed(samples, length);
+
+    // Debug log every ~1 second (50ms drain interval = 20 per second)
+    _vadDebugCounter++;
+    if (_vadDebugCounter % 20 == 0) {
+      print('DEBUG: [Live VAD] speaking=${_vad!.isSpeaking}, state=$_state');
     }
-    
-    // In Live mode, we use VAD to trigger recording
-    if (_vad != null) {
-      final isSpeech = _vad!.isSpeech(samples);
-      
-      // Debug log every ~1 second (assuming 100ms chunks = 10 per second)
-      _vadDebugCounter++;
-      if (_vadDebugCounter % 10 == 0) {
-        print('DEBUG: [Live VAD] isSpeech=$isSpeech, speaking=$_isCurrentlySpeaking, state=$_state');
-      }
-      
-      if (isSpeech) {
-        _lastSpeechTime = DateTime.now();
-        if (!_isCurrentlySpeaking) {
-          print('DEBUG: [Live] Speech detected! Starting recording...');
-          _isCurrentlySpeaking = true;
-          if (_state == RecordingState.idle) {
-            startRecording(isAutomatic: true);
+
+    for (final event in events) {
+      if (event.type == VadEventType.speechStart) {
+        print('DEBUG: [Live] Speech detected at sample ${event.offset}! Starting recording...');
+        if (_state == RecordingState.idle) {
+          // The pre-roll already covers this chunk up to its last sample
+          if (_preroll == nullptr) {
+            _preroll = calloc<Float>(_prerollCapacity);
+          }
+          final n = _vad!.copyPreroll(event.offset, _preroll, _prerollCapacity);
+          // Idle means stopRecording has synced the workers and cleared the
+          // buffer, so nothing reads it and it holds nothing to keep
+          try {
+            _audioBuffer.append(_preroll, n);
+          } on WhisperException catch (e) {
+            print('DEBUG: [Live] Pre-roll not kept: $e');
           }
+          startRecording(isAutomatic: true);
         }
       } else {
-        if (_isCurrentlySpeaking && _lastSpeechTime != null) {
-          // Wait for 1000ms of silence before stopping (more robust than 500ms)
-          if (DateTime.now().difference(_lastSpeechTime!).inMilliseconds > 1000) {
-            print('DEBUG: [Live] Silence detected, stopping');
-            _isCurrentlySpeaking = false;
-            if (_state == RecordingState.recording) {
-              stopRecording();
-            }
-          }
+        print('DEBUG: [Live] Silence detected at sample ${event.offset}, stopping');
+        if (_state == RecordingState.recording) {
+          stopRecording();
         }
       }
     }
   }
 
+  /// Clears the audio buffer once no stream push or interim decode sent
+  /// before still reads it. Callers have awaited their final pass already.
+  Future<void> _releaseAudioBuffer() async {
+    _whisper?.preemptInterim();
+    await _whisper?.sync();
+    _audioBuffer.clear();
+  }
+
   Future<void> _processInterim() async {
     // Allow processing even if we just moved to processing state to get that last bit of text
     if ((_state != RecordingState.recording && _state != RecordingState.processing) || 
@@ -225,14 +289,22 @@ class VoiceSyncManager {
 
     _isProcessingInterim = true;
     try {
-      final samples = List<double>.from(_audioBuffer);
-      print('DEBUG: [Interim] Processing ${samples.length} samples...');
+      final nSamples = _audioBuffer.length;
+      print('DEBUG: [Interim] Processing $nSamples samples...');
       
-      if (samples.length > 4000) { // Reduced to 0.25s for faster interim results
-        final text = await _whisper!.transcribe(
-          audioSamples: samples,
-          language: _settings.language,
-        );
+      if (nSamples > 4000) { // Reduced to 0.25s for faster interim results
+        // The stream session only re-decodes the uncommitted tail
+        final String text;
+        if (_isStreaming) {
+          text = (await _whisper!.pollStream()).text;
+        } else {
+          text = await _whisper!.transcribe(
+            audio: _audioBuffer,
+            length: nSamples,
+            language: _settings.language,
+            purpose: WhisperStatePurpose.interim,
+          );
+        }
         
         // Check state again as it might have changed during transcription
         if ((_state == RecordingState.recording || _state == RecordingState.processing) && text.isNotEmpty) {
@@ -242,7 +314,7 @@ class VoiceSyncManager {
           print('DEBUG: [Interim] Result not sent - state=$_state, textEmpty=${text.isEmpty}');
         }
       } else {
-        print('DEBUG: [Interim] Not enough samples (${samples.length} < 4000)');
+        print('DEBUG: [Interim] Not enough samples ($nSamples < 4000)');
       }
     } catch (e) {
       print('DEBUG: Interim transcription failed: $e');
@@ -284,8 +356,11 @@ class VoiceSyncManager {
     
     try {
       if (!isAutomatic && _settings.recordingMode != 'Live') {
-        print('DEBUG: Clearing audio buffer...');
-        _audioBuffer.clear();
+        // Normally already empty, as stopRecording clears it once the workers are done
+        if (_audioBuffer.isNotEmpty) {
+          print('DEBUG: Clearing audio buffer...');
+          await _releaseAudioBuffer();
+        }
       } else {
         print('DEBUG: Keeping existing buffer (${_audioBuffer.length} samples) for automatic/live recording');
       }
@@ -298,6 +373,17 @@ class VoiceSyncManager {
       _stateController.add(_state);
       onStateChange?.call(_state);  // Immediate callback for UI
 
+      if (_whisper != null) {
+        _whisper!.beginStream(language: _settings.language);
+        _isStreaming = true;
+        // Interim polls come every 500 ms, keep their threads hot until the final pass is done
+        _whisper!.setInterimActive(true);
+        // Live mode keeps a pre-roll that belongs to this utterance
+        if (_audioBuffer.isNotEmpty) {
+          _whisper!.pushStream(_audioBuffer, 0, _audioBuffer.length);
+        }
+      }
+
       await _audio.start();
       print('DEBUG: Audio capture started successfully');
 
@@ -309,6 +395,15 @@ class VoiceSyncManager {
     } catch (e, stack) {
       print('DEBUG: Failed to start recording: $e');
       print('DEBUG: Stack trace: $stack');
+      _interimTimer?.cancel();
+      _interimTimer = null;
+      if (_isStreaming) {
+        _isStreaming = false;
+        _whisper?.cancelStream();
+      }
+      _whisper?.setInterimActive(false);
+      // Idle promises an empty buffer nobody reads, see _processLiveVAD
+      await _releaseAudioBuffer();
       _state = RecordingState.idle;
       _stateController.add(_state);
       onStateChange?.call(_state);  // Immediate callback for UI
@@ -341,6 +436,11 @@ class VoiceSyncManager {
 
       if (_audioBuffer.isEmpty) {
         print('DEBUG: Audio buffer is empty, nothing to transcribe');
+        if (_isStreaming) {
+          _isStreaming = false;
+          _whisper?.cancelStream();
+        }
+        _whisper?.setInterimActive(false);
         _state = RecordingState.idle;
         _stateController.add(_state);
         onStateChange?.call(_state);  // Immediate callback for UI
@@ -349,39 +449,120 @@ class VoiceSyncManager {
 
       // 1. Transcribe with Whisper
       print('DEBUG: Starting Whisper transcription with language: ${_settings.language}');
+      // The stream session only fed the interim display. The final pass
+      // decodes the whole recording on its own state, so it sees the full
+      // context (and the PCM the draft model needs); a still-running interim
+      // poll is aborted so it starts immediately.
+      if (_isStreaming) {
+        _isStreaming = false;
+        _whisper!.cancelStream();
+      }
+      // Show the final pass growing segment by segment instead of all at the end
+      final partial = StringBuffer();
       final text = await _whisper!.transcribe(
-        audioSamples: _audioBuffer,
+        audio: _audioBuffer,
         language: _settings.language,
+        onSegment: (segment) {
+          partial.write(segment.text);
+          onInterimResult?.call(partial.toString().trim());
+        },
       );
+      _whisper!.setInterimActive(false);
       print('DEBUG: Whisper transcription result: "$text"');
       
-      if (text.trim().isNotEmpty) {
-        onInterimResult?.call(text);
-        // 2. Cleanup with Ollama (Optional)
-        String finalOutput = text;
-        try {
-          print('DEBUG: Starting Ollama cleanup...');
-          finalOutput = await _ollama.processTranscription(text);
-          print('DEBUG: Ollama cleanup result: "$finalOutput"');
-        } catch (e) {
-          print('DEBUG: Ollama cleanup failed: $e');
+      // 2. Fast native cleanup. Short or already clean dictations it is sure
+      // of are typed as it leaves them; the rest go on to the LLM cleaned.
+      // A dictation of nothing but fillers leaves nothing to type.
+      final fast = text.trim().isNotEmpty ? _cleaner?.clean(text) : null;
+      final input = fast?.text ?? text;
+      final skipLlm = fast != null && fast.confidence >= _settings.cleanupConfidenceThreshold;
+      if (fast != null) {
+        print('DEBUG: Fast cleanup result: "${fast.text}" $fast, ${skipLlm ? 'skipping' : 'escalating to'} the LLM');
+      }
+
+      if (input.trim().isNotEmpty) {
+        onInterimResult?.call(input);
+        // 3. Cleanup with the in-process model, or Ollama (Optional). The
+        // reply is typed while it streams in, so the first words land after
+        // the prompt prefill rather than the whole generation; the clipboard
+        // takes it whole.
+        final method = _settings.injectionMethod;
+        final llm = _llm;
+        final injector = method == 'Clipboard' ? null : StreamingInjector(_injector, method: method);
+        final cleanupStart = DateTime.now();
+        final cleaned = StringBuffer();
+        var cleanupFailed = false;
+        if (!skipLlm) {
+          try {
+            print('DEBUG: Starting ${llm != null ? 'LLM' : 'Ollama'} cleanup...');
+            final pieces = llm != null ? llm.streamTranscription(input) : _ollama.streamTranscription(input);
+            await for (final piece in pieces) {
+              cleaned.write(piece);
+              injector?.add(piece);
+            }
+            print('DEBUG: Cleanup result: "${cleaned.toString().trim()}"');
+          } catch (e) {
+            print('DEBUG: Cleanup failed: $e');
+            cleanupFailed = true;
+          }
         }
 
-        // 3. Inject text
-        print('DEBUG: [Process] Injecting text with method: ${_settings.injectionMethod}');
-        final success = await _injector.injectText(finalOutput, method: _settings.injectionMethod);
+        // 4. Inject text
+        print('DEBUG: [Process] Injecting text with method: $method');
+        final streamed = cleaned.toString().trim();
+        final String finalOutput;
+        bool success;
+        bool usedFallback;
+        var copiedInFull = false;
+        if (cleanupFailed) {
+          // A reply cut off mid-stream is not the text, the fast-cleaned
+          // transcription is. Once part of the reply is typed, the whole
+          // transcription goes to the clipboard rather than after it.
+          await injector?.abort();
+          finalOutput = input;
+          if (injector != null && injector.hasInjected) {
+            success = await _injector.copyToClipboard(input);
+            usedFallback = true;
+            copiedInFull = true;
+          } else {
+            success = await _injector.injectText(input, method: method);
+            usedFallback = _injector.lastInjectionWasFallback;
+          }
+        } else if (injector != null && streamed.isNotEmpty) {
+          finalOutput = streamed;
+          success = await injector.close();
+          usedFallback = injector.usedFallback;
+          if (!success) {
+            // Hand what was not typed to the clipboard
+            final rest = streamed.substring(injector.injectedLength.clamp(0, streamed.length));
+            success = rest.isEmpty || await _injector.injectText(rest, method: 'Clipboard');
+            usedFallback = true;
+          }
+          if (injector.firstInjection.isCompleted) {
+            final first = await injector.firstInjection.future;
+            print('DEBUG: [Process] First cleaned text typed ${first.difference(cleanupStart).inMilliseconds} ms after cleanup started');
+          }
+        } else {
+          // Nothing streamed: the fast-cleaned transcription goes out as it is
+          finalOutput = streamed.isNotEmpty ? streamed : input;
+          success = await _injector.injectText(finalOutput, method: method);
+          usedFallback = _injector.lastInjectionWasFallback;
+        }
         
         if (!success) {
           print('DEBUG: [Process] Injection FAILED completely');
           onInjectionError?.call('Injection failed. Please check dependencies.');
-        } else if (_injector.lastInjectionWasFallback && _settings.injectionMethod != 'Clipboard') {
+        } else if (copiedInFull) {
+          print('DEBUG: [Process] Cleanup stopped after ${injector!.injectedLength} typed characters, full text copied');
+          onInjectionError?.call('Cleanup stopped early. Full text copied to clipboard.');
+        } else if (usedFallback && method != 'Clipboard') {
           print('DEBUG: [Process] Injection succeeded via FALLBACK (Clipboard)');
           onInjectionError?.call('Direct injection failed. Copied to clipboard.');
         } else {
           print('DEBUG: [Process] Injection completed successfully');
         }
 
-        // 4. Save to history
+        // 5. Save to history
         final entry = HistoryEntry(
           id: _uuid.v4(),
           rawText: text,
@@ -389,7 +570,7 @@ class VoiceSyncManager {
           timestamp: _recordingStartTime ?? DateTime.now(),
           durationMs: endTime.difference(_recordingStartTime ?? endTime).inMilliseconds,
           modelUsed: 'Whisper Turbo',
-          llmModelUsed: _settings.ollamaModel,
+          llmModelUsed: skipLlm || cleanupFailed ? null : (llm != null ? p.basename(_settings.llmModelPath) : _settings.ollamaModel),
         );
         await _history.addEntry(entry);
         print('DEBUG: History entry saved');
@@ -399,15 +580,16 @@ class VoiceSyncManager {
       print('DEBUG: Stack trace: $stack');
     }
 
-    _audioBuffer.clear();
+    _isStreaming = false;
+    await _releaseAudioBuffer();
     _state = RecordingState.idle;
-    _isCurrentlySpeaking = false; // Reset speech detection state
     _stateController.add(_state);
     onStateChange?.call(_state);  // Immediate callback for UI
     print('DEBUG: Returning to idle state');
   }
 
   String? _lastWhisperModelPath;
+  String? _lastLlmModelPath;
 
   void _onSettingsChanged() {
     print('DEBUG: Settings changed, updating engine configuration...');
@@ -422,6 +604,9 @@ class VoiceSyncManager {
     if (_vad != null) {
       _vad!.setThreshold(_settings.vadThreshold);
     }
+
+    _cleaner?.setReplacements(_settings.cleanupReplacements);
+    _injector.uinputOnAnyLayout = _settings.nativeInjectionAnyLayout;
     
     // Check if whisper model changed
     if (_lastWhisperModelPath != _settings.whisperModelPath) {
@@ -429,22 +614,36 @@ class VoiceSyncManager {
       _reinitializeWhisper();
     }
 
+    if (_lastLlmModelPath != _settings.llmModelPath) {
+      _lastLlmModelPath = _settings.llmModelPath;
+      _reinitializeLlm();
+    }
+
     print('DEBUG: VAD Threshold updated to: ${_settings.vadThreshold}');
     print('DEBUG: PTT Key updated to: ${_settings.pttKey}');
   }
 
   Future<void> _reinitializeWhisper() async {
     print('DEBUG: Re-initializing Whisper engine with new model: ${_settings.whisperModelPath}');
+    // Swap in place: the current model keeps serving until the new one is
+    // loaded and warmed up, and stays if the new one cannot be loaded
+    final current = _whisper;
+    if (current != null) {
+      if (await current.swapModel(_settings.whisperModelPath)) {
+        print('DEBUG: Whisper model swapped.');
+      } else {
+        print('DEBUG: Whisper model swap failed, keeping the current model');
+      }
+      return;
+    }
+
     final projectRoot = Directory.current.path;
     final whisperLibPath = p.join(projectRoot, 'native', 'whisper', 'build', 'lib', 'libwhisper.so');
     
-    final oldWhisper = _whisper;
-    _whisper = null; // Mark as null while initializing
-    oldWhisper?.dispose();
-
     try {
       _whisper = await WhisperEngine.initialize(
         modelPath: _settings.whisperModelPath,
+        draftModelPath: _settings.whisperDraftModelPath,
         libraryPath: (await File(whisperLibPath).exists()) ? whisperLibPath : null,
       );
       print('DEBUG: Whisper engine re-initialized.');
@@ -453,12 +652,56 @@ class VoiceSyncManager {
     }
   }
 
+  Future<void> _reinitializeLlm() async {
+    _llm?.dispose();
+    _llm = null;
+
+    final modelPath = _settings.llmModelPath;
+    if (modelPath.isEmpty) {
+      print('DEBUG: No LLM model set, cleaning up through Ollama');
+      return;
+    }
+
+    final projectRoot = Directory.current.path;
+    final llmLibPath = p.join(projectRoot, 'native', 'llm', 'build', 'lib', 'libllm.so');
+
+    try {
+      final llm = await LlmEngine.initialize(
+        modelPath: modelPath,
+        libraryPath: (await File(llmLibPath).exists()) ? llmLibPath : null,
+      );
+      // The setting may have moved on while the model was loading
+      if (_settings.llmModelPath != modelPath) {
+        llm.dispose();
+        return;
+      }
+      _llm = llm;
+      print('DEBUG: LLM engine initialized.');
+    } catch (e) {
+      print('DEBUG: LLM initialization failed, cleaning up through Ollama: $e');
+    }
+  }
+
   void dispose() {
     _settings.removeListener(_onSettingsChanged);
     _audio.dispose();
     _hotkey.dispose();
-    _whisper?.dispose();
+    // The buffer goes once no worker can still be reading it
+    final whisper = _whisper;
+    final audioBuffer = _audioBuffer;
+    if (whisper != null) {
+      whisper.dispose().whenComplete(audioBuffer.dispose);
+    } else {
+      audioBuffer.dispose();
+    }
     _vad?.dispose();
+    _llm?.dispose();
+    _cleaner?.dispose();
+    _injector.dispose();
+    if (_preroll != nullptr) {
+      calloc.free(_preroll);
+      _preroll = nullptr;
+    }
     _stateController.close();
   }
 }
@@ -1251,6 +1251,30 @@ class _SettingsPageState extends ConsumerState<SettingsPage> {
               ),
             ],
           ),
+          const SizedBox(height: 12),
+          Row(
+            mainAxisAlignment: MainAxisAlignment.spaceBetween,
+            children: [
+              Expanded(
+                child: Text(
+                  'Type directly on any keyboard layout (Wayland)',
+                  style: Theme.of(context).textTheme.bodySmall?.copyWith(
+                        color: AppTheme.textDark,
+                      ),
+                ),
+              ),
+              Transform.scale(
+                scale: 0.8,
+                child: Switch(
+                  value: settings.nativeInjectionAnyLayout,
+                  onChanged: (value) {
+                    settings.nativeInjectionAnyLayout = value;
+                  },
+                  activeColor: AppTheme.skyBlue,
+                ),
+              ),
+            ],
+          ),
         ],
       ),
     );
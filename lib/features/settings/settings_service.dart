@@ -7,11 +7,16 @@ import 'package:path/path.dart' as p;
 
 class SettingsService extends ChangeNotifier {
   static const String _keyModelPath = 'whisper_model_path';
+  static const String _keyDraftModelPath = 'whisper_draft_model_path';
   static const String _keyVADThreshold = 'vad_threshold';
   static const String _keyPTTKey = 'ptt_key';
   static const String _keyOllamaEndpoint = 'ollama_endpoint';
   static const String _keyOllamaModel = 'ollama_model';
+  static const String _keyLlmModelPath = 'llm_model_path';
+  static const String _keyCleanupConfidence = 'cleanup_confidence_threshold';
+  static const String _keyCleanupReplacements = 'cleanup_replacements';
   static const String _keyInjectionMethod = 'injection_method';
+  static const String _keyNativeInjectionAnyLayout = 'native_injection_any_layout';
   static const String _keyAutoCleanup = 'auto_cleanup';
   static const String _keyLanguage = 'language';
   static const String _keyRecordingMode = 'recording_mode';
@@ -107,10 +112,10 @@ class SettingsService extends ChangeNotifier {
     }
 
     // Copy VAD model
-    final vadModelFile = File(p.join(modelsDir.path, 'silero_vad.onnx'));
+    final vadModelFile = File(p.join(modelsDir.path, 'ggml-silero-v5.1.2.bin'));
     if (!await vadModelFile.exists()) {
       print('DEBUG: Copying VAD model to ${vadModelFile.path}');
-      final data = await rootBundle.load('assets/models/silero_vad.onnx');
+      final data = await rootBundle.load('assets/models/ggml-silero-v5.1.2.bin');
       final bytes = data.buffer.asUint8List(data.offsetInBytes, data.lengthInBytes);
       await vadModelFile.writeAsBytes(bytes);
     }
@@ -122,6 +127,14 @@ class SettingsService extends ChangeNotifier {
     notifyListeners();
   }
 
+  /// Small model with the same tokenizer used to speed up final transcriptions
+  /// by speculative decoding; empty to decode with the main model alone.
+  String get whisperDraftModelPath => _prefs.getString(_keyDraftModelPath) ?? '';
+  set whisperDraftModelPath(String value) {
+    _prefs.setString(_keyDraftModelPath, value);
+    notifyListeners();
+  }
+
   double get vadThreshold => _prefs.getDouble(_keyVADThreshold) ?? 0.5;
   set vadThreshold(double value) {
     _prefs.setDouble(_keyVADThreshold, value);
@@ -146,12 +159,43 @@ class SettingsService extends ChangeNotifier {
     notifyListeners();
   }
 
+  /// GGUF model for the in-process cleanup engine; empty to clean up through
+  /// Ollama instead.
+  String get llmModelPath => _prefs.getString(_keyLlmModelPath) ?? '';
+  set llmModelPath(String value) {
+    _prefs.setString(_keyLlmModelPath, value);
+    notifyListeners();
+  }
+
+  /// Transcripts the fast native cleaner is at least this sure of are typed
+  /// without an LLM pass; 0 always skips the LLM, above 1 always uses it.
+  double get cleanupConfidenceThreshold => _prefs.getDouble(_keyCleanupConfidence) ?? 0.75;
+  set cleanupConfidenceThreshold(double value) {
+    _prefs.setDouble(_keyCleanupConfidence, value);
+    notifyListeners();
+  }
+
+  /// User dictionary for the fast cleaner, one "from=to" entry per item.
+  List<String> get cleanupReplacements => _prefs.getStringList(_keyCleanupReplacements) ?? const [];
+  set cleanupReplacements(List<String> value) {
+    _prefs.setStringList(_keyCleanupReplacements, value);
+    notifyListeners();
+  }
+
   String get injectionMethod => _prefs.getString(_keyInjectionMethod) ?? 'dotool';
   set injectionMethod(String value) {
     _prefs.setString(_keyInjectionMethod, value);
     notifyListeners();
   }
 
+  /// Types through the uinput virtual keyboard even when the keyboard layout
+  /// is not detected as US, e.g. when the layout is set per user in the desktop.
+  bool get nativeInjectionAnyLayout => _prefs.getBool(_keyNativeInjectionAnyLayout) ?? false;
+  set nativeInjectionAnyLayout(bool value) {
+    _prefs.setBool(_keyNativeInjectionAnyLayout, value);
+    notifyListeners();
+  }
+
   bool get autoCleanup => _prefs.getBool(_keyAutoCleanup) ?? true;
   set autoCleanup(bool value) {
     _prefs.setBool(_keyAutoCleanup, value);
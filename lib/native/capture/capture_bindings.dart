@@ -0,0 +1,405 @@
+// AUTO GENERATED FILE, DO NOT EDIT.
+//
+// Generated by `package:ffigen`.
+// ignore_for_file: type=lint
+import 'dart:ffi' as ffi;
+
+/// FFI bindings for native PCM capture
+class CaptureBindings {
+  /// Holds the symbol lookup function.
+  final ffi.Pointer<T> Function<T extends ffi.NativeType>(String symbolName)
+  _lookup;
+
+  /// The symbols are looked up in [dynamicLibrary].
+  CaptureBindings(ffi.DynamicLibrary dynamicLibrary)
+    : _lookup = dynamicLibrary.lookup;
+
+  /// The symbols are looked up with [lookup].
+  CaptureBindings.fromLookup(
+    ffi.Pointer<T> Function<T extends ffi.NativeType>(String symbolName) lookup,
+  ) : _lookup = lookup;
+
+  capture_config capture_default_config() {
+    return _capture_default_config();
+  }
+
+  late final _capture_default_configPtr =
+      _lookup<ffi.NativeFunction<capture_config Function()>>(
+        'capture_default_config',
+      );
+  late final _capture_default_config = _capture_default_configPtr
+      .asFunction<capture_config Function()>();
+
+  ffi.Pointer<capture_context> capture_init(capture_config config) {
+    return _capture_init(config);
+  }
+
+  late final _capture_initPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<capture_context> Function(capture_config)>>(
+        'capture_init',
+      );
+  late final _capture_init = _capture_initPtr
+      .asFunction<ffi.Pointer<capture_context> Function(capture_config)>();
+
+  void capture_free(ffi.Pointer<capture_context> ctx) {
+    return _capture_free(ctx);
+  }
+
+  late final _capture_freePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<capture_context>)>>(
+        'capture_free',
+      );
+  late final _capture_free = _capture_freePtr
+      .asFunction<void Function(ffi.Pointer<capture_context>)>();
+
+  int capture_start(ffi.Pointer<capture_context> ctx) {
+    return _capture_start(ctx);
+  }
+
+  late final _capture_startPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<capture_context>)>>(
+        'capture_start',
+      );
+  late final _capture_start = _capture_startPtr
+      .asFunction<int Function(ffi.Pointer<capture_context>)>();
+
+  void capture_stop(ffi.Pointer<capture_context> ctx) {
+    return _capture_stop(ctx);
+  }
+
+  late final _capture_stopPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<capture_context>)>>(
+        'capture_stop',
+      );
+  late final _capture_stop = _capture_stopPtr
+      .asFunction<void Function(ffi.Pointer<capture_context>)>();
+
+  bool capture_is_running(ffi.Pointer<capture_context> ctx) {
+    return _capture_is_running(ctx);
+  }
+
+  late final _capture_is_runningPtr =
+      _lookup<ffi.NativeFunction<ffi.Bool Function(ffi.Pointer<capture_context>)>>(
+        'capture_is_running',
+      );
+  late final _capture_is_running = _capture_is_runningPtr
+      .asFunction<bool Function(ffi.Pointer<capture_context>)>();
+
+  int capture_active_backend(ffi.Pointer<capture_context> ctx) {
+    return _capture_active_backend(ctx);
+  }
+
+  late final _capture_active_backendPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<capture_context>)>>(
+        'capture_active_backend',
+      );
+  late final _capture_active_backend = _capture_active_backendPtr
+      .asFunction<int Function(ffi.Pointer<capture_context>)>();
+
+  int capture_available(ffi.Pointer<capture_context> ctx) {
+    return _capture_available(ctx);
+  }
+
+  late final _capture_availablePtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<capture_context>)>>(
+        'capture_available',
+      );
+  late final _capture_available = _capture_availablePtr
+      .asFunction<int Function(ffi.Pointer<capture_context>)>();
+
+  int capture_read(
+    ffi.Pointer<capture_context> ctx,
+    ffi.Pointer<ffi.Float> dst,
+    int max_samples,
+  ) {
+    return _capture_read(ctx, dst, max_samples);
+  }
+
+  late final _capture_readPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<capture_context>, ffi.Pointer<ffi.Float>, ffi.Int)>>(
+        'capture_read',
+      );
+  late final _capture_read = _capture_readPtr
+      .asFunction<int Function(ffi.Pointer<capture_context>, ffi.Pointer<ffi.Float>, int)>();
+
+  capture_levels capture_get_levels(ffi.Pointer<capture_context> ctx) {
+    return _capture_get_levels(ctx);
+  }
+
+  late final _capture_get_levelsPtr =
+      _lookup<ffi.NativeFunction<capture_levels Function(ffi.Pointer<capture_context>)>>(
+        'capture_get_levels',
+      );
+  late final _capture_get_levels = _capture_get_levelsPtr
+      .asFunction<capture_levels Function(ffi.Pointer<capture_context>)>();
+
+  void capture_convert_pcm16(
+    ffi.Pointer<ffi.Int16> src,
+    ffi.Pointer<ffi.Float> dst,
+    int n_samples,
+    ffi.Pointer<ffi.Float> peak,
+    ffi.Pointer<ffi.Float> rms,
+  ) {
+    return _capture_convert_pcm16(src, dst, n_samples, peak, rms);
+  }
+
+  late final _capture_convert_pcm16Ptr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Int16>, ffi.Pointer<ffi.Float>, ffi.Int, ffi.Pointer<ffi.Float>, ffi.Pointer<ffi.Float>)>>(
+        'capture_convert_pcm16',
+      );
+  late final _capture_convert_pcm16 = _capture_convert_pcm16Ptr
+      .asFunction<void Function(ffi.Pointer<ffi.Int16>, ffi.Pointer<ffi.Float>, int, ffi.Pointer<ffi.Float>, ffi.Pointer<ffi.Float>)>();
+}
+
+final class capture_context extends ffi.Opaque {}
+
+abstract class capture_backend {
+  static const int CAPTURE_BACKEND_AUTO = 0;
+  static const int CAPTURE_BACKEND_PULSE = 1;
+  static const int CAPTURE_BACKEND_ALSA = 2;
+  static const int CAPTURE_BACKEND_FILE = 3;
+  static const int CAPTURE_BACKEND_NULL = 4;
+}
+
+final class capture_config extends ffi.Struct {
+  @ffi.Int()
+  external int backend;
+
+  @ffi.Int()
+  external int sample_rate;
+
+  @ffi.Int()
+  external int period_ms;
+
+  @ffi.Int()
+  external int ring_ms;
+
+  external ffi.Pointer<ffi.Char> device;
+
+  @ffi.Bool()
+  external bool realtime;
+}
+
+final class capture_levels extends ffi.Struct {
+  @ffi.Float()
+  external double peak;
+
+  @ffi.Float()
+  external double rms;
+
+  @ffi.Uint64()
+  external int n_captured;
+
+  @ffi.Uint64()
+  external int n_dropped;
+}
+
+const int _STDINT_H = 1;
+
+const int _FEATURES_H = 1;
+
+const int _DEFAULT_SOURCE = 1;
+
+const int __USE_ISOC11 = 1;
+
+const int __USE_ISOC99 = 1;
+
+const int __USE_ISOC95 = 1;
+
+const int _POSIX_SOURCE = 1;
+
+const int _POSIX_C_SOURCE = 200809;
+
+const int __USE_POSIX = 1;
+
+const int __USE_POSIX2 = 1;
+
+const int __USE_POSIX199309 = 1;
+
+const int __USE_POSIX199506 = 1;
+
+const int __USE_XOPEN2K = 1;
+
+const int __USE_XOPEN2K8 = 1;
+
+const int _ATFILE_SOURCE = 1;
+
+const int __WORDSIZE = 64;
+
+const int __WORDSIZE_TIME64_COMPAT32 = 1;
+
+const int __SYSCALL_WORDSIZE = 64;
+
+const int __TIMESIZE = 64;
+
+const int __USE_MISC = 1;
+
+const int __USE_ATFILE = 1;
+
+const int __USE_FORTIFY_LEVEL = 0;
+
+const int __GLIBC_USE_DEPRECATED_GETS = 0;
+
+const int __GLIBC_USE_DEPRECATED_SCANF = 0;
+
+const int _STDC_PREDEF_H = 1;
+
+const int __STDC_IEC_559__ = 1;
+
+const int __STDC_IEC_559_COMPLEX__ = 1;
+
+const int __STDC_ISO_10646__ = 201706;
+
+const int __GNU_LIBRARY__ = 6;
+
+const int __GLIBC__ = 2;
+
+const int __GLIBC_MINOR__ = 31;
+
+const int _SYS_CDEFS_H = 1;
+
+const int __glibc_c99_flexarr_available = 1;
+
+const int __HAVE_GENERIC_SELECTION = 0;
+
+const int __GLIBC_USE_LIB_EXT2 = 1;
+
+const int __GLIBC_USE_IEC_60559_BFP_EXT = 1;
+
+const int __GLIBC_USE_IEC_60559_FUNCS_EXT = 1;
+
+const int __GLIBC_USE_IEC_60559_TYPES_EXT = 1;
+
+const int _BITS_TYPES_H = 1;
+
+const int _BITS_TYPESIZES_H = 1;
+
+const int __OFF_T_MATCHES_OFF64_T = 1;
+
+const int __INO_T_MATCHES_INO64_T = 1;
+
+const int __RLIM_T_MATCHES_RLIM64_T = 1;
+
+const int __STATFS_MATCHES_STATFS64 = 1;
+
+const int __FD_SETSIZE = 1024;
+
+const int _BITS_TIME64_H = 1;
+
+const int _BITS_WCHAR_H = 1;
+
+const int __WCHAR_MAX = 2147483647;
+
+const int __WCHAR_MIN = -2147483648;
+
+const int _BITS_STDINT_INTN_H = 1;
+
+const int _BITS_STDINT_UINTN_H = 1;
+
+const int INT8_MIN = -128;
+
+const int INT16_MIN = -32768;
+
+const int INT32_MIN = -2147483648;
+
+const int INT64_MIN = -9223372036854775808;
+
+const int INT8_MAX = 127;
+
+const int INT16_MAX = 32767;
+
+const int INT32_MAX = 2147483647;
+
+const int INT64_MAX = 9223372036854775807;
+
+const int UINT8_MAX = 255;
+
+const int UINT16_MAX = 65535;
+
+const int UINT32_MAX = 4294967295;
+
+const int UINT64_MAX = -1;
+
+const int INT_LEAST8_MIN = -128;
+
+const int INT_LEAST16_MIN = -32768;
+
+const int INT_LEAST32_MIN = -2147483648;
+
+const int INT_LEAST64_MIN = -9223372036854775808;
+
+const int INT_LEAST8_MAX = 127;
+
+const int INT_LEAST16_MAX = 32767;
+
+const int INT_LEAST32_MAX = 2147483647;
+
+const int INT_LEAST64_MAX = 9223372036854775807;
+
+const int UINT_LEAST8_MAX = 255;
+
+const int UINT_LEAST16_MAX = 65535;
+
+const int UINT_LEAST32_MAX = 4294967295;
+
+const int UINT_LEAST64_MAX = -1;
+
+const int INT_FAST8_MIN = -128;
+
+const int INT_FAST16_MIN = -9223372036854775808;
+
+const int INT_FAST32_MIN = -9223372036854775808;
+
+const int INT_FAST64_MIN = -9223372036854775808;
+
+const int INT_FAST8_MAX = 127;
+
+const int INT_FAST16_MAX = 9223372036854775807;
+
+const int INT_FAST32_MAX = 9223372036854775807;
+
+const int INT_FAST64_MAX = 9223372036854775807;
+
+const int UINT_FAST8_MAX = 255;
+
+const int UINT_FAST16_MAX = -1;
+
+const int UINT_FAST32_MAX = -1;
+
+const int UINT_FAST64_MAX = -1;
+
+const int INTPTR_MIN = -9223372036854775808;
+
+const int INTPTR_MAX = 9223372036854775807;
+
+const int UINTPTR_MAX = -1;
+
+const int INTMAX_MIN = -9223372036854775808;
+
+const int INTMAX_MAX = 9223372036854775807;
+
+const int UINTMAX_MAX = -1;
+
+const int PTRDIFF_MIN = -9223372036854775808;
+
+const int PTRDIFF_MAX = 9223372036854775807;
+
+const int SIG_ATOMIC_MIN = -2147483648;
+
+const int SIG_ATOMIC_MAX = 2147483647;
+
+const int SIZE_MAX = -1;
+
+const int WCHAR_MIN = -2147483648;
+
+const int WCHAR_MAX = 2147483647;
+
+const int WINT_MIN = 0;
+
+const int WINT_MAX = 4294967295;
+
+const int true1 = 1;
+
+const int false1 = 0;
+
+const int __bool_true_false_are_defined = 1;
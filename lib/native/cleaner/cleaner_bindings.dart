@@ -0,0 +1,364 @@
+// AUTO GENERATED FILE, DO NOT EDIT.
+//
+// Generated by `package:ffigen`.
+// ignore_for_file: type=lint
+import 'dart:ffi' as ffi;
+
+/// FFI bindings for the deterministic transcript cleaner
+class CleanerBindings {
+  /// Holds the symbol lookup function.
+  final ffi.Pointer<T> Function<T extends ffi.NativeType>(String symbolName)
+  _lookup;
+
+  /// The symbols are looked up in [dynamicLibrary].
+  CleanerBindings(ffi.DynamicLibrary dynamicLibrary)
+    : _lookup = dynamicLibrary.lookup;
+
+  /// The symbols are looked up with [lookup].
+  CleanerBindings.fromLookup(
+    ffi.Pointer<T> Function<T extends ffi.NativeType>(String symbolName) lookup,
+  ) : _lookup = lookup;
+
+  cleaner_config cleaner_default_config() {
+    return _cleaner_default_config();
+  }
+
+  late final _cleaner_default_configPtr =
+      _lookup<ffi.NativeFunction<cleaner_config Function()>>(
+        'cleaner_default_config',
+      );
+  late final _cleaner_default_config = _cleaner_default_configPtr
+      .asFunction<cleaner_config Function()>();
+
+  ffi.Pointer<cleaner_context> cleaner_init(cleaner_config config) {
+    return _cleaner_init(config);
+  }
+
+  late final _cleaner_initPtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Pointer<cleaner_context> Function(cleaner_config)>
+      >('cleaner_init');
+  late final _cleaner_init = _cleaner_initPtr
+      .asFunction<ffi.Pointer<cleaner_context> Function(cleaner_config)>();
+
+  void cleaner_free(ffi.Pointer<cleaner_context> ctx) {
+    return _cleaner_free(ctx);
+  }
+
+  late final _cleaner_freePtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Void Function(ffi.Pointer<cleaner_context>)>
+      >('cleaner_free');
+  late final _cleaner_free = _cleaner_freePtr
+      .asFunction<void Function(ffi.Pointer<cleaner_context>)>();
+
+  int cleaner_add_replacement(
+    ffi.Pointer<cleaner_context> ctx,
+    ffi.Pointer<ffi.Char> from,
+    ffi.Pointer<ffi.Char> to,
+  ) {
+    return _cleaner_add_replacement(ctx, from, to);
+  }
+
+  late final _cleaner_add_replacementPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Pointer<cleaner_context>,
+            ffi.Pointer<ffi.Char>,
+            ffi.Pointer<ffi.Char>,
+          )
+        >
+      >('cleaner_add_replacement');
+  late final _cleaner_add_replacement = _cleaner_add_replacementPtr
+      .asFunction<
+        int Function(
+          ffi.Pointer<cleaner_context>,
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Char>,
+        )
+      >();
+
+  void cleaner_clear_replacements(ffi.Pointer<cleaner_context> ctx) {
+    return _cleaner_clear_replacements(ctx);
+  }
+
+  late final _cleaner_clear_replacementsPtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Void Function(ffi.Pointer<cleaner_context>)>
+      >('cleaner_clear_replacements');
+  late final _cleaner_clear_replacements = _cleaner_clear_replacementsPtr
+      .asFunction<void Function(ffi.Pointer<cleaner_context>)>();
+
+  cleaner_result cleaner_clean(
+    ffi.Pointer<cleaner_context> ctx,
+    ffi.Pointer<ffi.Char> text,
+  ) {
+    return _cleaner_clean(ctx, text);
+  }
+
+  late final _cleaner_cleanPtr =
+      _lookup<
+        ffi.NativeFunction<
+          cleaner_result Function(
+            ffi.Pointer<cleaner_context>,
+            ffi.Pointer<ffi.Char>,
+          )
+        >
+      >('cleaner_clean');
+  late final _cleaner_clean = _cleaner_cleanPtr
+      .asFunction<
+        cleaner_result Function(
+          ffi.Pointer<cleaner_context>,
+          ffi.Pointer<ffi.Char>,
+        )
+      >();
+}
+
+final class cleaner_context extends ffi.Opaque {}
+
+final class cleaner_config extends ffi.Struct {
+  @ffi.Bool()
+  external bool remove_fillers;
+
+  @ffi.Bool()
+  external bool remove_stutters;
+
+  @ffi.Bool()
+  external bool capitalize;
+
+  @ffi.Bool()
+  external bool terminal_punctuation;
+}
+
+final class cleaner_result extends ffi.Struct {
+  external ffi.Pointer<ffi.Char> text;
+
+  @ffi.Float()
+  external double confidence;
+
+  @ffi.Int()
+  external int n_words;
+
+  @ffi.Int()
+  external int n_fillers;
+
+  @ffi.Int()
+  external int n_hedges;
+
+  @ffi.Int()
+  external int n_stutters;
+
+  @ffi.Int()
+  external int n_replacements;
+}
+
+const int _STDINT_H = 1;
+
+const int _FEATURES_H = 1;
+
+const int _DEFAULT_SOURCE = 1;
+
+const int __USE_ISOC11 = 1;
+
+const int __USE_ISOC99 = 1;
+
+const int __USE_ISOC95 = 1;
+
+const int _POSIX_SOURCE = 1;
+
+const int _POSIX_C_SOURCE = 200809;
+
+const int __USE_POSIX = 1;
+
+const int __USE_POSIX2 = 1;
+
+const int __USE_POSIX199309 = 1;
+
+const int __USE_POSIX199506 = 1;
+
+const int __USE_XOPEN2K = 1;
+
+const int __USE_XOPEN2K8 = 1;
+
+const int _ATFILE_SOURCE = 1;
+
+const int __WORDSIZE = 64;
+
+const int __WORDSIZE_TIME64_COMPAT32 = 1;
+
+const int __SYSCALL_WORDSIZE = 64;
+
+const int __TIMESIZE = 64;
+
+const int __USE_MISC = 1;
+
+const int __USE_ATFILE = 1;
+
+const int __USE_FORTIFY_LEVEL = 0;
+
+const int __GLIBC_USE_DEPRECATED_GETS = 0;
+
+const int __GLIBC_USE_DEPRECATED_SCANF = 0;
+
+const int _STDC_PREDEF_H = 1;
+
+const int __STDC_IEC_559__ = 1;
+
+const int __STDC_IEC_559_COMPLEX__ = 1;
+
+const int __STDC_ISO_10646__ = 201706;
+
+const int __GNU_LIBRARY__ = 6;
+
+const int __GLIBC__ = 2;
+
+const int __GLIBC_MINOR__ = 31;
+
+const int _SYS_CDEFS_H = 1;
+
+const int __glibc_c99_flexarr_available = 1;
+
+const int __HAVE_GENERIC_SELECTION = 0;
+
+const int __GLIBC_USE_LIB_EXT2 = 1;
+
+const int __GLIBC_USE_IEC_60559_BFP_EXT = 1;
+
+const int __GLIBC_USE_IEC_60559_FUNCS_EXT = 1;
+
+const int __GLIBC_USE_IEC_60559_TYPES_EXT = 1;
+
+const int _BITS_TYPES_H = 1;
+
+const int _BITS_TYPESIZES_H = 1;
+
+const int __OFF_T_MATCHES_OFF64_T = 1;
+
+const int __INO_T_MATCHES_INO64_T = 1;
+
+const int __RLIM_T_MATCHES_RLIM64_T = 1;
+
+const int __STATFS_MATCHES_STATFS64 = 1;
+
+const int __FD_SETSIZE = 1024;
+
+const int _BITS_TIME64_H = 1;
+
+const int _BITS_WCHAR_H = 1;
+
+const int __WCHAR_MAX = 2147483647;
+
+const int __WCHAR_MIN = -2147483648;
+
+const int _BITS_STDINT_INTN_H = 1;
+
+const int _BITS_STDINT_UINTN_H = 1;
+
+const int INT8_MIN = -128;
+
+const int INT16_MIN = -32768;
+
+const int INT32_MIN = -2147483648;
+
+const int INT64_MIN = -9223372036854775808;
+
+const int INT8_MAX = 127;
+
+const int INT16_MAX = 32767;
+
+const int INT32_MAX = 2147483647;
+
+const int INT64_MAX = 9223372036854775807;
+
+const int UINT8_MAX = 255;
+
+const int UINT16_MAX = 65535;
+
+const int UINT32_MAX = 4294967295;
+
+const int UINT64_MAX = -1;
+
+const int INT_LEAST8_MIN = -128;
+
+const int INT_LEAST16_MIN = -32768;
+
+const int INT_LEAST32_MIN = -2147483648;
+
+const int INT_LEAST64_MIN = -9223372036854775808;
+
+const int INT_LEAST8_MAX = 127;
+
+const int INT_LEAST16_MAX = 32767;
+
+const int INT_LEAST32_MAX = 2147483647;
+
+const int INT_LEAST64_MAX = 9223372036854775807;
+
+const int UINT_LEAST8_MAX = 255;
+
+const int UINT_LEAST16_MAX = 65535;
+
+const int UINT_LEAST32_MAX = 4294967295;
+
+const int UINT_LEAST64_MAX = -1;
+
+const int INT_FAST8_MIN = -128;
+
+const int INT_FAST16_MIN = -9223372036854775808;
+
+const int INT_FAST32_MIN = -9223372036854775808;
+
+const int INT_FAST64_MIN = -9223372036854775808;
+
+const int INT_FAST8_MAX = 127;
+
+const int INT_FAST16_MAX = 9223372036854775807;
+
+const int INT_FAST32_MAX = 9223372036854775807;
+
+const int INT_FAST64_MAX = 9223372036854775807;
+
+const int UINT_FAST8_MAX = 255;
+
+const int UINT_FAST16_MAX = -1;
+
+const int UINT_FAST32_MAX = -1;
+
+const int UINT_FAST64_MAX = -1;
+
+const int INTPTR_MIN = -9223372036854775808;
+
+const int INTPTR_MAX = 9223372036854775807;
+
+const int UINTPTR_MAX = -1;
+
+const int INTMAX_MIN = -9223372036854775808;
+
+const int INTMAX_MAX = 9223372036854775807;
+
+const int UINTMAX_MAX = -1;
+
+const int PTRDIFF_MIN = -9223372036854775808;
+
+const int PTRDIFF_MAX = 9223372036854775807;
+
+const int SIG_ATOMIC_MIN = -2147483648;
+
+const int SIG_ATOMIC_MAX = 2147483647;
+
+const int SIZE_MAX = -1;
+
+const int WCHAR_MIN = -2147483648;
+
+const int WCHAR_MAX = 2147483647;
+
+const int WINT_MIN = 0;
+
+const int WINT_MAX = 4294967295;
+
+const int true1 = 1;
+
+const int false1 = 0;
+
+const int __bool_true_false_are_defined = 1;
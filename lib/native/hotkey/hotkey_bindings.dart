@@ -4,7 +4,7 @@
 // ignore_for_file: type=lint
 import 'dart:ffi' as ffi;
 
-/// FFI bindings for X11 hotkey polling
+/// FFI bindings for the global hotkey listener
 class HotkeyBindings {
   /// Holds the symbol lookup function.
   final ffi.Pointer<T> Function<T extends ffi.NativeType>(String symbolName)
@@ -62,6 +62,46 @@ class HotkeyBindings {
       );
   late final _x11_get_keysym_name = _x11_get_keysym_namePtr
       .asFunction<ffi.Pointer<ffi.Char> Function(int)>();
+
+  void hotkey_dart_init(ffi.Pointer<ffi.Void> post_cobject) {
+    return _hotkey_dart_init(post_cobject);
+  }
+
+  late final _hotkey_dart_initPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+        'hotkey_dart_init',
+      );
+  late final _hotkey_dart_init = _hotkey_dart_initPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
+  int hotkey_listener_start(int port) {
+    return _hotkey_listener_start(port);
+  }
+
+  late final _hotkey_listener_startPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Int64)>>(
+        'hotkey_listener_start',
+      );
+  late final _hotkey_listener_start = _hotkey_listener_startPtr
+      .asFunction<int Function(int)>();
+
+  void hotkey_listener_stop() {
+    return _hotkey_listener_stop();
+  }
+
+  late final _hotkey_listener_stopPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function()>>(
+        'hotkey_listener_stop',
+      );
+  late final _hotkey_listener_stop = _hotkey_listener_stopPtr
+      .asFunction<void Function()>();
+}
+
+abstract class hotkey_backend {
+  static const int HOTKEY_BACKEND_NONE = -1;
+  static const int HOTKEY_BACKEND_XI2 = 0;
+  static const int HOTKEY_BACKEND_EVDEV = 1;
+  static const int HOTKEY_BACKEND_X11_KEYMAP = 2;
 }
 
 final class __fsid_t extends ffi.Struct {
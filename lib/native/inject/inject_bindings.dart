@@ -0,0 +1,383 @@
+// AUTO GENERATED FILE, DO NOT EDIT.
+//
+// Generated by `package:ffigen`.
+// ignore_for_file: type=lint
+import 'dart:ffi' as ffi;
+
+/// FFI bindings for the native virtual keyboard text injector
+class InjectBindings {
+  /// Holds the symbol lookup function.
+  final ffi.Pointer<T> Function<T extends ffi.NativeType>(String symbolName)
+  _lookup;
+
+  /// The symbols are looked up in [dynamicLibrary].
+  InjectBindings(ffi.DynamicLibrary dynamicLibrary)
+    : _lookup = dynamicLibrary.lookup;
+
+  /// The symbols are looked up with [lookup].
+  InjectBindings.fromLookup(
+    ffi.Pointer<T> Function<T extends ffi.NativeType>(String symbolName) lookup,
+  ) : _lookup = lookup;
+
+  inject_config inject_default_config() {
+    return _inject_default_config();
+  }
+
+  late final _inject_default_configPtr =
+      _lookup<ffi.NativeFunction<inject_config Function()>>(
+        'inject_default_config',
+      );
+  late final _inject_default_config = _inject_default_configPtr
+      .asFunction<inject_config Function()>();
+
+  ffi.Pointer<inject_context> inject_init(inject_config config) {
+    return _inject_init(config);
+  }
+
+  late final _inject_initPtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Pointer<inject_context> Function(inject_config)>
+      >('inject_init');
+  late final _inject_init = _inject_initPtr
+      .asFunction<ffi.Pointer<inject_context> Function(inject_config)>();
+
+  void inject_free(ffi.Pointer<inject_context> ctx) {
+    return _inject_free(ctx);
+  }
+
+  late final _inject_freePtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Void Function(ffi.Pointer<inject_context>)>
+      >('inject_free');
+  late final _inject_free = _inject_freePtr
+      .asFunction<void Function(ffi.Pointer<inject_context>)>();
+
+  int inject_get_backend(ffi.Pointer<inject_context> ctx) {
+    return _inject_get_backend(ctx);
+  }
+
+  late final _inject_get_backendPtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<inject_context>)>
+      >('inject_get_backend');
+  late final _inject_get_backend = _inject_get_backendPtr
+      .asFunction<int Function(ffi.Pointer<inject_context>)>();
+
+  bool inject_can_type(
+    ffi.Pointer<inject_context> ctx,
+    ffi.Pointer<ffi.Char> text,
+  ) {
+    return _inject_can_type(ctx, text);
+  }
+
+  late final _inject_can_typePtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Bool Function(ffi.Pointer<inject_context>, ffi.Pointer<ffi.Char>)
+        >
+      >('inject_can_type');
+  late final _inject_can_type = _inject_can_typePtr
+      .asFunction<
+        bool Function(ffi.Pointer<inject_context>, ffi.Pointer<ffi.Char>)
+      >();
+
+  int inject_type(ffi.Pointer<inject_context> ctx, ffi.Pointer<ffi.Char> text) {
+    return _inject_type(ctx, text);
+  }
+
+  late final _inject_typePtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<inject_context>, ffi.Pointer<ffi.Char>)
+        >
+      >('inject_type');
+  late final _inject_type = _inject_typePtr
+      .asFunction<
+        int Function(ffi.Pointer<inject_context>, ffi.Pointer<ffi.Char>)
+      >();
+
+  int inject_paste(ffi.Pointer<inject_context> ctx) {
+    return _inject_paste(ctx);
+  }
+
+  late final _inject_pastePtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Int Function(ffi.Pointer<inject_context>)>
+      >('inject_paste');
+  late final _inject_paste = _inject_pastePtr
+      .asFunction<int Function(ffi.Pointer<inject_context>)>();
+
+  int inject_detect_layout() {
+    return _inject_detect_layout();
+  }
+
+  late final _inject_detect_layoutPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function()>>(
+        'inject_detect_layout',
+      );
+  late final _inject_detect_layout = _inject_detect_layoutPtr
+      .asFunction<int Function()>();
+
+  void inject_dart_init(ffi.Pointer<ffi.Void> post_cobject) {
+    return _inject_dart_init(post_cobject);
+  }
+
+  late final _inject_dart_initPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+        'inject_dart_init',
+      );
+  late final _inject_dart_init = _inject_dart_initPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
+  bool inject_type_port(
+    ffi.Pointer<inject_context> ctx,
+    ffi.Pointer<ffi.Char> text,
+    int port,
+  ) {
+    return _inject_type_port(ctx, text, port);
+  }
+
+  late final _inject_type_portPtr =
+      _lookup<ffi.NativeFunction<ffi.Bool Function(ffi.Pointer<inject_context>, ffi.Pointer<ffi.Char>, ffi.Int64)>>(
+        'inject_type_port',
+      );
+  late final _inject_type_port = _inject_type_portPtr
+      .asFunction<bool Function(ffi.Pointer<inject_context>, ffi.Pointer<ffi.Char>, int)>();
+}
+
+final class inject_context extends ffi.Opaque {}
+
+abstract class inject_backend {
+  static const int INJECT_BACKEND_NONE = -1;
+  static const int INJECT_BACKEND_UINPUT = 0;
+  static const int INJECT_BACKEND_XTEST = 1;
+}
+
+abstract class inject_layout {
+  static const int INJECT_LAYOUT_UNKNOWN = -1;
+  static const int INJECT_LAYOUT_OTHER = 0;
+  static const int INJECT_LAYOUT_US = 1;
+}
+
+final class inject_config extends ffi.Struct {
+  @ffi.Int()
+  external int chars_per_batch;
+
+  @ffi.Int()
+  external int batch_delay_us;
+
+  @ffi.Bool()
+  external bool prefer_xtest;
+
+  external ffi.Pointer<ffi.Char> device_name;
+}
+
+const int _STDINT_H = 1;
+
+const int _FEATURES_H = 1;
+
+const int _DEFAULT_SOURCE = 1;
+
+const int __USE_ISOC11 = 1;
+
+const int __USE_ISOC99 = 1;
+
+const int __USE_ISOC95 = 1;
+
+const int _POSIX_SOURCE = 1;
+
+const int _POSIX_C_SOURCE = 200809;
+
+const int __USE_POSIX = 1;
+
+const int __USE_POSIX2 = 1;
+
+const int __USE_POSIX199309 = 1;
+
+const int __USE_POSIX199506 = 1;
+
+const int __USE_XOPEN2K = 1;
+
+const int __USE_XOPEN2K8 = 1;
+
+const int _ATFILE_SOURCE = 1;
+
+const int __WORDSIZE = 64;
+
+const int __WORDSIZE_TIME64_COMPAT32 = 1;
+
+const int __SYSCALL_WORDSIZE = 64;
+
+const int __TIMESIZE = 64;
+
+const int __USE_MISC = 1;
+
+const int __USE_ATFILE = 1;
+
+const int __USE_FORTIFY_LEVEL = 0;
+
+const int __GLIBC_USE_DEPRECATED_GETS = 0;
+
+const int __GLIBC_USE_DEPRECATED_SCANF = 0;
+
+const int _STDC_PREDEF_H = 1;
+
+const int __STDC_IEC_559__ = 1;
+
+const int __STDC_IEC_559_COMPLEX__ = 1;
+
+const int __STDC_ISO_10646__ = 201706;
+
+const int __GNU_LIBRARY__ = 6;
+
+const int __GLIBC__ = 2;
+
+const int __GLIBC_MINOR__ = 31;
+
+const int _SYS_CDEFS_H = 1;
+
+const int __glibc_c99_flexarr_available = 1;
+
+const int __HAVE_GENERIC_SELECTION = 0;
+
+const int __GLIBC_USE_LIB_EXT2 = 1;
+
+const int __GLIBC_USE_IEC_60559_BFP_EXT = 1;
+
+const int __GLIBC_USE_IEC_60559_FUNCS_EXT = 1;
+
+const int __GLIBC_USE_IEC_60559_TYPES_EXT = 1;
+
+const int _BITS_TYPES_H = 1;
+
+const int _BITS_TYPESIZES_H = 1;
+
+const int __OFF_T_MATCHES_OFF64_T = 1;
+
+const int __INO_T_MATCHES_INO64_T = 1;
+
+const int __RLIM_T_MATCHES_RLIM64_T = 1;
+
+const int __STATFS_MATCHES_STATFS64 = 1;
+
+const int __FD_SETSIZE = 1024;
+
+const int _BITS_TIME64_H = 1;
+
+const int _BITS_WCHAR_H = 1;
+
+const int __WCHAR_MAX = 2147483647;
+
+const int __WCHAR_MIN = -2147483648;
+
+const int _BITS_STDINT_INTN_H = 1;
+
+const int _BITS_STDINT_UINTN_H = 1;
+
+const int INT8_MIN = -128;
+
+const int INT16_MIN = -32768;
+
+const int INT32_MIN = -2147483648;
+
+const int INT64_MIN = -9223372036854775808;
+
+const int INT8_MAX = 127;
+
+const int INT16_MAX = 32767;
+
+const int INT32_MAX = 2147483647;
+
+const int INT64_MAX = 9223372036854775807;
+
+const int UINT8_MAX = 255;
+
+const int UINT16_MAX = 65535;
+
+const int UINT32_MAX = 4294967295;
+
+const int UINT64_MAX = -1;
+
+const int INT_LEAST8_MIN = -128;
+
+const int INT_LEAST16_MIN = -32768;
+
+const int INT_LEAST32_MIN = -2147483648;
+
+const int INT_LEAST64_MIN = -9223372036854775808;
+
+const int INT_LEAST8_MAX = 127;
+
+const int INT_LEAST16_MAX = 32767;
+
+const int INT_LEAST32_MAX = 2147483647;
+
+const int INT_LEAST64_MAX = 9223372036854775807;
+
+const int UINT_LEAST8_MAX = 255;
+
+const int UINT_LEAST16_MAX = 65535;
+
+const int UINT_LEAST32_MAX = 4294967295;
+
+const int UINT_LEAST64_MAX = -1;
+
+const int INT_FAST8_MIN = -128;
+
+const int INT_FAST16_MIN = -9223372036854775808;
+
+const int INT_FAST32_MIN = -9223372036854775808;
+
+const int INT_FAST64_MIN = -9223372036854775808;
+
+const int INT_FAST8_MAX = 127;
+
+const int INT_FAST16_MAX = 9223372036854775807;
+
+const int INT_FAST32_MAX = 9223372036854775807;
+
+const int INT_FAST64_MAX = 9223372036854775807;
+
+const int UINT_FAST8_MAX = 255;
+
+const int UINT_FAST16_MAX = -1;
+
+const int UINT_FAST32_MAX = -1;
+
+const int UINT_FAST64_MAX = -1;
+
+const int INTPTR_MIN = -9223372036854775808;
+
+const int INTPTR_MAX = 9223372036854775807;
+
+const int UINTPTR_MAX = -1;
+
+const int INTMAX_MIN = -9223372036854775808;
+
+const int INTMAX_MAX = 9223372036854775807;
+
+const int UINTMAX_MAX = -1;
+
+const int PTRDIFF_MIN = -9223372036854775808;
+
+const int PTRDIFF_MAX = 9223372036854775807;
+
+const int SIG_ATOMIC_MIN = -2147483648;
+
+const int SIG_ATOMIC_MAX = 2147483647;
+
+const int SIZE_MAX = -1;
+
+const int WCHAR_MIN = -2147483648;
+
+const int WCHAR_MAX = 2147483647;
+
+const int WINT_MIN = 0;
+
+const int WINT_MAX = 4294967295;
+
+const int true1 = 1;
+
+const int false1 = 0;
+
+const int __bool_true_false_are_defined = 1;
@@ -0,0 +1,384 @@
+// AUTO GENERATED FILE, DO NOT EDIT.
+//
+// Generated by `package:ffigen`.
+// ignore_for_file: type=lint
+import 'dart:ffi' as ffi;
+
+/// FFI bindings for the in-process LLM cleanup engine
+class LlmBindings {
+  /// Holds the symbol lookup function.
+  final ffi.Pointer<T> Function<T extends ffi.NativeType>(String symbolName)
+  _lookup;
+
+  /// The symbols are looked up in [dynamicLibrary].
+  LlmBindings(ffi.DynamicLibrary dynamicLibrary)
+    : _lookup = dynamicLibrary.lookup;
+
+  /// The symbols are looked up with [lookup].
+  LlmBindings.fromLookup(
+    ffi.Pointer<T> Function<T extends ffi.NativeType>(String symbolName) lookup,
+  ) : _lookup = lookup;
+
+  llm_config llm_default_config() {
+    return _llm_default_config();
+  }
+
+  late final _llm_default_configPtr =
+      _lookup<ffi.NativeFunction<llm_config Function()>>(
+        'llm_default_config',
+      );
+  late final _llm_default_config = _llm_default_configPtr
+      .asFunction<llm_config Function()>();
+
+  ffi.Pointer<llm_context> llm_init(
+    ffi.Pointer<ffi.Char> model_path,
+    llm_config config,
+  ) {
+    return _llm_init(model_path, config);
+  }
+
+  late final _llm_initPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Pointer<llm_context> Function(ffi.Pointer<ffi.Char>, llm_config)
+        >
+      >('llm_init');
+  late final _llm_init = _llm_initPtr
+      .asFunction<
+        ffi.Pointer<llm_context> Function(ffi.Pointer<ffi.Char>, llm_config)
+      >();
+
+  void llm_free(ffi.Pointer<llm_context> ctx) {
+    return _llm_free(ctx);
+  }
+
+  late final _llm_freePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<llm_context>)>>(
+        'llm_free',
+      );
+  late final _llm_free = _llm_freePtr
+      .asFunction<void Function(ffi.Pointer<llm_context>)>();
+
+  ffi.Pointer<ffi.Char> llm_cleanup(
+    ffi.Pointer<llm_context> ctx,
+    ffi.Pointer<ffi.Char> text,
+    llm_piece_callback cb,
+    ffi.Pointer<ffi.Void> user_data,
+  ) {
+    return _llm_cleanup(ctx, text, cb, user_data);
+  }
+
+  late final _llm_cleanupPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<ffi.Char> Function(ffi.Pointer<llm_context>, ffi.Pointer<ffi.Char>, llm_piece_callback, ffi.Pointer<ffi.Void>)>>(
+        'llm_cleanup',
+      );
+  late final _llm_cleanup = _llm_cleanupPtr
+      .asFunction<ffi.Pointer<ffi.Char> Function(ffi.Pointer<llm_context>, ffi.Pointer<ffi.Char>, llm_piece_callback, ffi.Pointer<ffi.Void>)>();
+
+  void llm_dart_init(ffi.Pointer<ffi.Void> post_cobject) {
+    return _llm_dart_init(post_cobject);
+  }
+
+  late final _llm_dart_initPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+        'llm_dart_init',
+      );
+  late final _llm_dart_init = _llm_dart_initPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
+  ffi.Pointer<ffi.Char> llm_cleanup_port(
+    ffi.Pointer<llm_context> ctx,
+    ffi.Pointer<ffi.Char> text,
+    int piece_port,
+  ) {
+    return _llm_cleanup_port(ctx, text, piece_port);
+  }
+
+  late final _llm_cleanup_portPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<ffi.Char> Function(ffi.Pointer<llm_context>, ffi.Pointer<ffi.Char>, ffi.Int64)>>(
+        'llm_cleanup_port',
+      );
+  late final _llm_cleanup_port = _llm_cleanup_portPtr
+      .asFunction<ffi.Pointer<ffi.Char> Function(ffi.Pointer<llm_context>, ffi.Pointer<ffi.Char>, int)>();
+
+  void llm_abort(ffi.Pointer<llm_context> ctx) {
+    return _llm_abort(ctx);
+  }
+
+  late final _llm_abortPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<llm_context>)>>(
+        'llm_abort',
+      );
+  late final _llm_abort = _llm_abortPtr
+      .asFunction<void Function(ffi.Pointer<llm_context>)>();
+
+  llm_stats llm_get_stats(ffi.Pointer<llm_context> ctx) {
+    return _llm_get_stats(ctx);
+  }
+
+  late final _llm_get_statsPtr =
+      _lookup<ffi.NativeFunction<llm_stats Function(ffi.Pointer<llm_context>)>>(
+        'llm_get_stats',
+      );
+  late final _llm_get_stats = _llm_get_statsPtr
+      .asFunction<llm_stats Function(ffi.Pointer<llm_context>)>();
+}
+
+final class llm_context extends ffi.Opaque {}
+
+final class llm_config extends ffi.Struct {
+  @ffi.Int()
+  external int n_ctx;
+
+  @ffi.Int()
+  external int n_threads;
+
+  @ffi.Int()
+  external int n_gpu_layers;
+
+  @ffi.Int()
+  external int n_predict;
+
+  @ffi.Float()
+  external double temperature;
+
+  @ffi.Uint32()
+  external int seed;
+
+  external ffi.Pointer<ffi.Char> system_prompt;
+
+  external ffi.Pointer<ffi.Char> instructions;
+
+  external ffi.Pointer<ffi.Char> session_path;
+}
+
+final class llm_stats extends ffi.Struct {
+  @ffi.Int()
+  external int n_prefix;
+
+  @ffi.Int()
+  external int n_prompt;
+
+  @ffi.Int()
+  external int n_generated;
+
+  @ffi.Double()
+  external double t_prompt_ms;
+
+  @ffi.Double()
+  external double t_generate_ms;
+}
+
+typedef llm_piece_callback = ffi.Pointer<ffi.NativeFunction<llm_piece_callbackFunction>>;
+typedef llm_piece_callbackFunction = ffi.Bool Function(ffi.Pointer<ffi.Char> piece, ffi.Int n_bytes, ffi.Pointer<ffi.Void> user_data);
+typedef Dartllm_piece_callbackFunction = bool Function(ffi.Pointer<ffi.Char> piece, int n_bytes, ffi.Pointer<ffi.Void> user_data);
+
+const int _STDINT_H = 1;
+
+const int _FEATURES_H = 1;
+
+const int _DEFAULT_SOURCE = 1;
+
+const int __USE_ISOC11 = 1;
+
+const int __USE_ISOC99 = 1;
+
+const int __USE_ISOC95 = 1;
+
+const int _POSIX_SOURCE = 1;
+
+const int _POSIX_C_SOURCE = 200809;
+
+const int __USE_POSIX = 1;
+
+const int __USE_POSIX2 = 1;
+
+const int __USE_POSIX199309 = 1;
+
+const int __USE_POSIX199506 = 1;
+
+const int __USE_XOPEN2K = 1;
+
+const int __USE_XOPEN2K8 = 1;
+
+const int _ATFILE_SOURCE = 1;
+
+const int __WORDSIZE = 64;
+
+const int __WORDSIZE_TIME64_COMPAT32 = 1;
+
+const int __SYSCALL_WORDSIZE = 64;
+
+const int __TIMESIZE = 64;
+
+const int __USE_MISC = 1;
+
+const int __USE_ATFILE = 1;
+
+const int __USE_FORTIFY_LEVEL = 0;
+
+const int __GLIBC_USE_DEPRECATED_GETS = 0;
+
+const int __GLIBC_USE_DEPRECATED_SCANF = 0;
+
+const int _STDC_PREDEF_H = 1;
+
+const int __STDC_IEC_559__ = 1;
+
+const int __STDC_IEC_559_COMPLEX__ = 1;
+
+const int __STDC_ISO_10646__ = 201706;
+
+const int __GNU_LIBRARY__ = 6;
+
+const int __GLIBC__ = 2;
+
+const int __GLIBC_MINOR__ = 31;
+
+const int _SYS_CDEFS_H = 1;
+
+const int __glibc_c99_flexarr_available = 1;
+
+const int __HAVE_GENERIC_SELECTION = 0;
+
+const int __GLIBC_USE_LIB_EXT2 = 1;
+
+const int __GLIBC_USE_IEC_60559_BFP_EXT = 1;
+
+const int __GLIBC_USE_IEC_60559_FUNCS_EXT = 1;
+
+const int __GLIBC_USE_IEC_60559_TYPES_EXT = 1;
+
+const int _BITS_TYPES_H = 1;
+
+const int _BITS_TYPESIZES_H = 1;
+
+const int __OFF_T_MATCHES_OFF64_T = 1;
+
+const int __INO_T_MATCHES_INO64_T = 1;
+
+const int __RLIM_T_MATCHES_RLIM64_T = 1;
+
+const int __STATFS_MATCHES_STATFS64 = 1;
+
+const int __FD_SETSIZE = 1024;
+
+const int _BITS_TIME64_H = 1;
+
+const int _BITS_WCHAR_H = 1;
+
+const int __WCHAR_MAX = 2147483647;
+
+const int __WCHAR_MIN = -2147483648;
+
+const int _BITS_STDINT_INTN_H = 1;
+
+const int _BITS_STDINT_UINTN_H = 1;
+
+const int INT8_MIN = -128;
+
+const int INT16_MIN = -32768;
+
+const int INT32_MIN = -2147483648;
+
+const int INT64_MIN = -9223372036854775808;
+
+const int INT8_MAX = 127;
+
+const int INT16_MAX = 32767;
+
+const int INT32_MAX = 2147483647;
+
+const int INT64_MAX = 9223372036854775807;
+
+const int UINT8_MAX = 255;
+
+const int UINT16_MAX = 65535;
+
+const int UINT32_MAX = 4294967295;
+
+const int UINT64_MAX = -1;
+
+const int INT_LEAST8_MIN = -128;
+
+const int INT_LEAST16_MIN = -32768;
+
+const int INT_LEAST32_MIN = -2147483648;
+
+const int INT_LEAST64_MIN = -9223372036854775808;
+
+const int INT_LEAST8_MAX = 127;
+
+const int INT_LEAST16_MAX = 32767;
+
+const int INT_LEAST32_MAX = 2147483647;
+
+const int INT_LEAST64_MAX = 9223372036854775807;
+
+const int UINT_LEAST8_MAX = 255;
+
+const int UINT_LEAST16_MAX = 65535;
+
+const int UINT_LEAST32_MAX = 4294967295;
+
+const int UINT_LEAST64_MAX = -1;
+
+const int INT_FAST8_MIN = -128;
+
+const int INT_FAST16_MIN = -9223372036854775808;
+
+const int INT_FAST32_MIN = -9223372036854775808;
+
+const int INT_FAST64_MIN = -9223372036854775808;
+
+const int INT_FAST8_MAX = 127;
+
+const int INT_FAST16_MAX = 9223372036854775807;
+
+const int INT_FAST32_MAX = 9223372036854775807;
+
+const int INT_FAST64_MAX = 9223372036854775807;
+
+const int UINT_FAST8_MAX = 255;
+
+const int UINT_FAST16_MAX = -1;
+
+const int UINT_FAST32_MAX = -1;
+
+const int UINT_FAST64_MAX = -1;
+
+const int INTPTR_MIN = -9223372036854775808;
+
+const int INTPTR_MAX = 9223372036854775807;
+
+const int UINTPTR_MAX = -1;
+
+const int INTMAX_MIN = -9223372036854775808;
+
+const int INTMAX_MAX = 9223372036854775807;
+
+const int UINTMAX_MAX = -1;
+
+const int PTRDIFF_MIN = -9223372036854775808;
+
+const int PTRDIFF_MAX = 9223372036854775807;
+
+const int SIG_ATOMIC_MIN = -2147483648;
+
+const int SIG_ATOMIC_MAX = 2147483647;
+
+const int SIZE_MAX = -1;
+
+const int WCHAR_MIN = -2147483648;
+
+const int WCHAR_MAX = 2147483647;
+
+const int WINT_MIN = 0;
+
+const int WINT_MAX = 4294967295;
+
+const int true1 = 1;
+
+const int false1 = 0;
+
+const int __bool_true_false_are_defined = 1;
@@ -4,7 +4,7 @@
 // ignore_for_file: type=lint
 import 'dart:ffi' as ffi;
 
-/// FFI bindings for Silero VAD using ONNX Runtime
+/// FFI bindings for Silero VAD on whisper.cpp's ggml runtime
 class VadBindings {
   /// Holds the symbol lookup function.
   final ffi.Pointer<T> Function<T extends ffi.NativeType>(String symbolName)
@@ -71,6 +71,80 @@ class VadBindings {
         double Function(ffi.Pointer<vad_context>, ffi.Pointer<ffi.Float>, int)
       >();
 
+  int vad_process_batch(
+    ffi.Pointer<vad_context> ctx,
+    ffi.Pointer<ffi.Float> samples,
+    int n_frames,
+    ffi.Pointer<ffi.Float> out_probs,
+  ) {
+    return _vad_process_batch(ctx, samples, n_frames, out_probs);
+  }
+
+  late final _vad_process_batchPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<vad_context>, ffi.Pointer<ffi.Float>, ffi.Int, ffi.Pointer<ffi.Float>)>>(
+        'vad_process_batch',
+      );
+  late final _vad_process_batch = _vad_process_batchPtr
+      .asFunction<int Function(ffi.Pointer<vad_context>, ffi.Pointer<ffi.Float>, int, ffi.Pointer<ffi.Float>)>();
+
+  int vad_feed(
+    ffi.Pointer<vad_context> ctx,
+    ffi.Pointer<ffi.Float> samples,
+    int n_samples,
+    ffi.Pointer<vad_event> events,
+    int max_events,
+  ) {
+    return _vad_feed(ctx, samples, n_samples, events, max_events);
+  }
+
+  late final _vad_feedPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<vad_context>, ffi.Pointer<ffi.Float>, ffi.Int, ffi.Pointer<vad_event>, ffi.Int)>>(
+        'vad_feed',
+      );
+  late final _vad_feed = _vad_feedPtr
+      .asFunction<int Function(ffi.Pointer<vad_context>, ffi.Pointer<ffi.Float>, int, ffi.Pointer<vad_event>, int)>();
+
+  int vad_copy_preroll(
+    ffi.Pointer<vad_context> ctx,
+    int offset,
+    ffi.Pointer<ffi.Float> out,
+    int max_samples,
+  ) {
+    return _vad_copy_preroll(ctx, offset, out, max_samples);
+  }
+
+  late final _vad_copy_prerollPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<vad_context>, ffi.Int64, ffi.Pointer<ffi.Float>, ffi.Int)>>(
+        'vad_copy_preroll',
+      );
+  late final _vad_copy_preroll = _vad_copy_prerollPtr
+      .asFunction<int Function(ffi.Pointer<vad_context>, int, ffi.Pointer<ffi.Float>, int)>();
+
+  bool vad_is_speaking(ffi.Pointer<vad_context> ctx) {
+    return _vad_is_speaking(ctx);
+  }
+
+  late final _vad_is_speakingPtr =
+      _lookup<ffi.NativeFunction<ffi.Bool Function(ffi.Pointer<vad_context>)>>(
+        'vad_is_speaking',
+      );
+  late final _vad_is_speaking = _vad_is_speakingPtr
+      .asFunction<bool Function(ffi.Pointer<vad_context>)>();
+
+  void vad_set_threshold(
+    ffi.Pointer<vad_context> ctx,
+    double threshold,
+  ) {
+    return _vad_set_threshold(ctx, threshold);
+  }
+
+  late final _vad_set_thresholdPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<vad_context>, ffi.Float)>>(
+        'vad_set_threshold',
+      );
+  late final _vad_set_threshold = _vad_set_thresholdPtr
+      .asFunction<void Function(ffi.Pointer<vad_context>, double)>();
+
   void vad_reset(ffi.Pointer<vad_context> ctx) {
     return _vad_reset(ctx);
   }
@@ -102,6 +176,19 @@ final class vad_config extends ffi.Struct {
   external int speech_pad_ms;
 }
 
+abstract class vad_event_type {
+  static const int VAD_EVENT_SPEECH_START = 1;
+  static const int VAD_EVENT_SPEECH_END = 2;
+}
+
+final class vad_event extends ffi.Struct {
+  @ffi.Int()
+  external int type;
+
+  @ffi.Int64()
+  external int offset;
+}
+
 const int _STDINT_H = 1;
 
 const int _FEATURES_H = 1;
@@ -30,6 +30,17 @@ class WhisperBindings {
   late final _version = _versionPtr
       .asFunction<ffi.Pointer<ffi.Char> Function()>();
 
+  void dartInit(ffi.Pointer<ffi.Void> post_cobject) {
+    return _dartInit(post_cobject);
+  }
+
+  late final _dartInitPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+        'whisper_dart_init',
+      );
+  late final _dartInit = _dartInitPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
   ffi.Pointer<Context> initFromFileWithParams(
     ffi.Pointer<ffi.Char> path_model,
     ContextParams params,
@@ -69,6 +80,17 @@ class WhisperBindings {
       );
   late final _free = _freePtr.asFunction<void Function(ffi.Pointer<Context>)>();
 
+  LoadStats getLoadStats(ffi.Pointer<Context> ctx) {
+    return _getLoadStats(ctx);
+  }
+
+  late final _getLoadStatsPtr =
+      _lookup<ffi.NativeFunction<LoadStats Function(ffi.Pointer<Context>)>>(
+        'whisper_get_load_stats',
+      );
+  late final _getLoadStats = _getLoadStatsPtr
+      .asFunction<LoadStats Function(ffi.Pointer<Context>)>();
+
   FullParams fullDefaultParams(int strategy) {
     return _fullDefaultParams(strategy);
   }
@@ -211,6 +233,412 @@ class WhisperBindings {
   late final _fullLangId = _fullLangIdPtr
       .asFunction<int Function(ffi.Pointer<Context>)>();
 
+  ffi.Pointer<WhisperState> initState(ffi.Pointer<Context> ctx) {
+    return _initState(ctx);
+  }
+
+  late final _initStatePtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<WhisperState> Function(ffi.Pointer<Context>)>>(
+        'whisper_init_state',
+      );
+  late final _initState = _initStatePtr
+      .asFunction<ffi.Pointer<WhisperState> Function(ffi.Pointer<Context>)>();
+
+  void freeState(ffi.Pointer<WhisperState> state) {
+    return _freeState(state);
+  }
+
+  late final _freeStatePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<WhisperState>)>>(
+        'whisper_free_state',
+      );
+  late final _freeState = _freeStatePtr
+      .asFunction<void Function(ffi.Pointer<WhisperState>)>();
+
+  void stateAbort(ffi.Pointer<WhisperState> state) {
+    return _stateAbort(state);
+  }
+
+  late final _stateAbortPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<WhisperState>)>>(
+        'whisper_state_abort',
+      );
+  late final _stateAbort = _stateAbortPtr
+      .asFunction<void Function(ffi.Pointer<WhisperState>)>();
+
+  ThreadpoolParams threadpoolDefaultParams() {
+    return _threadpoolDefaultParams();
+  }
+
+  late final _threadpoolDefaultParamsPtr =
+      _lookup<ffi.NativeFunction<ThreadpoolParams Function()>>(
+        'whisper_threadpool_default_params',
+      );
+  late final _threadpoolDefaultParams = _threadpoolDefaultParamsPtr
+      .asFunction<ThreadpoolParams Function()>();
+
+  int stateSetThreadpool(
+    ffi.Pointer<WhisperState> state,
+    ThreadpoolParams params,
+  ) {
+    return _stateSetThreadpool(state, params);
+  }
+
+  late final _stateSetThreadpoolPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<WhisperState>, ThreadpoolParams)>>(
+        'whisper_state_set_threadpool',
+      );
+  late final _stateSetThreadpool = _stateSetThreadpoolPtr
+      .asFunction<int Function(ffi.Pointer<WhisperState>, ThreadpoolParams)>();
+
+  void stateSetActive(
+    ffi.Pointer<WhisperState> state,
+    bool active,
+  ) {
+    return _stateSetActive(state, active);
+  }
+
+  late final _stateSetActivePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<WhisperState>, ffi.Bool)>>(
+        'whisper_state_set_active',
+      );
+  late final _stateSetActive = _stateSetActivePtr
+      .asFunction<void Function(ffi.Pointer<WhisperState>, bool)>();
+
+  ffi.Pointer<ModelSlot> modelSlotInit(
+    ffi.Pointer<ffi.Char> path_model,
+    ContextParams params,
+  ) {
+    return _modelSlotInit(path_model, params);
+  }
+
+  late final _modelSlotInitPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<ModelSlot> Function(ffi.Pointer<ffi.Char>, ContextParams)>>(
+        'whisper_model_slot_init',
+      );
+  late final _modelSlotInit = _modelSlotInitPtr
+      .asFunction<ffi.Pointer<ModelSlot> Function(ffi.Pointer<ffi.Char>, ContextParams)>();
+
+  void modelSlotFree(ffi.Pointer<ModelSlot> slot) {
+    return _modelSlotFree(slot);
+  }
+
+  late final _modelSlotFreePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ModelSlot>)>>(
+        'whisper_model_slot_free',
+      );
+  late final _modelSlotFree = _modelSlotFreePtr
+      .asFunction<void Function(ffi.Pointer<ModelSlot>)>();
+
+  int modelSlotSwap(
+    ffi.Pointer<ModelSlot> slot,
+    ffi.Pointer<ffi.Char> path_model,
+    ContextParams params,
+    int max_bytes,
+  ) {
+    return _modelSlotSwap(slot, path_model, params, max_bytes);
+  }
+
+  late final _modelSlotSwapPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<ModelSlot>, ffi.Pointer<ffi.Char>, ContextParams, ffi.Size)>>(
+        'whisper_model_slot_swap',
+      );
+  late final _modelSlotSwap = _modelSlotSwapPtr
+      .asFunction<int Function(ffi.Pointer<ModelSlot>, ffi.Pointer<ffi.Char>, ContextParams, int)>();
+
+  ffi.Pointer<WhisperModel> modelSlotAcquire(ffi.Pointer<ModelSlot> slot) {
+    return _modelSlotAcquire(slot);
+  }
+
+  late final _modelSlotAcquirePtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<WhisperModel> Function(ffi.Pointer<ModelSlot>)>>(
+        'whisper_model_slot_acquire',
+      );
+  late final _modelSlotAcquire = _modelSlotAcquirePtr
+      .asFunction<ffi.Pointer<WhisperModel> Function(ffi.Pointer<ModelSlot>)>();
+
+  void modelRelease(ffi.Pointer<WhisperModel> model) {
+    return _modelRelease(model);
+  }
+
+  late final _modelReleasePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<WhisperModel>)>>(
+        'whisper_model_release',
+      );
+  late final _modelRelease = _modelReleasePtr
+      .asFunction<void Function(ffi.Pointer<WhisperModel>)>();
+
+  ffi.Pointer<Context> modelContext(ffi.Pointer<WhisperModel> model) {
+    return _modelContext(model);
+  }
+
+  late final _modelContextPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<Context> Function(ffi.Pointer<WhisperModel>)>>(
+        'whisper_model_context',
+      );
+  late final _modelContext = _modelContextPtr
+      .asFunction<ffi.Pointer<Context> Function(ffi.Pointer<WhisperModel>)>();
+
+  ffi.Pointer<WhisperState> modelState(
+    ffi.Pointer<WhisperModel> model,
+    int purpose,
+  ) {
+    return _modelState(model, purpose);
+  }
+
+  late final _modelStatePtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<WhisperState> Function(ffi.Pointer<WhisperModel>, ffi.Int)>>(
+        'whisper_model_state',
+      );
+  late final _modelState = _modelStatePtr
+      .asFunction<ffi.Pointer<WhisperState> Function(ffi.Pointer<WhisperModel>, int)>();
+
+  int modelSlotSetThreadpool(
+    ffi.Pointer<ModelSlot> slot,
+    int purpose,
+    ThreadpoolParams params,
+  ) {
+    return _modelSlotSetThreadpool(slot, purpose, params);
+  }
+
+  late final _modelSlotSetThreadpoolPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<ModelSlot>, ffi.Int, ThreadpoolParams)>>(
+        'whisper_model_slot_set_threadpool',
+      );
+  late final _modelSlotSetThreadpool = _modelSlotSetThreadpoolPtr
+      .asFunction<int Function(ffi.Pointer<ModelSlot>, int, ThreadpoolParams)>();
+
+  void modelSlotSetActive(
+    ffi.Pointer<ModelSlot> slot,
+    int purpose,
+    bool active,
+  ) {
+    return _modelSlotSetActive(slot, purpose, active);
+  }
+
+  late final _modelSlotSetActivePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ModelSlot>, ffi.Int, ffi.Bool)>>(
+        'whisper_model_slot_set_active',
+      );
+  late final _modelSlotSetActive = _modelSlotSetActivePtr
+      .asFunction<void Function(ffi.Pointer<ModelSlot>, int, bool)>();
+
+  void modelSlotAbort(
+    ffi.Pointer<ModelSlot> slot,
+    int purpose,
+  ) {
+    return _modelSlotAbort(slot, purpose);
+  }
+
+  late final _modelSlotAbortPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ModelSlot>, ffi.Int)>>(
+        'whisper_model_slot_abort',
+      );
+  late final _modelSlotAbort = _modelSlotAbortPtr
+      .asFunction<void Function(ffi.Pointer<ModelSlot>, int)>();
+
+  ModelSlotMemory modelSlotGetMemory(ffi.Pointer<ModelSlot> slot) {
+    return _modelSlotGetMemory(slot);
+  }
+
+  late final _modelSlotGetMemoryPtr =
+      _lookup<ffi.NativeFunction<ModelSlotMemory Function(ffi.Pointer<ModelSlot>)>>(
+        'whisper_model_slot_get_memory',
+      );
+  late final _modelSlotGetMemory = _modelSlotGetMemoryPtr
+      .asFunction<ModelSlotMemory Function(ffi.Pointer<ModelSlot>)>();
+
+  int modelSlotWarmup(
+    ffi.Pointer<ModelSlot> slot,
+    int purpose,
+    int flags,
+  ) {
+    return _modelSlotWarmup(slot, purpose, flags);
+  }
+
+  late final _modelSlotWarmupPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<ModelSlot>, ffi.Int, ffi.Int)>>(
+        'whisper_model_slot_warmup',
+      );
+  late final _modelSlotWarmup = _modelSlotWarmupPtr
+      .asFunction<int Function(ffi.Pointer<ModelSlot>, int, int)>();
+
+  int fullWithState(
+    ffi.Pointer<Context> ctx,
+    ffi.Pointer<WhisperState> state,
+    FullParams params,
+    ffi.Pointer<ffi.Float> samples,
+    int n_samples,
+  ) {
+    return _fullWithState(ctx, state, params, samples, n_samples);
+  }
+
+  late final _fullWithStatePtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<Context>, ffi.Pointer<WhisperState>, FullParams, ffi.Pointer<ffi.Float>, ffi.Int)>>(
+        'whisper_full_with_state',
+      );
+  late final _fullWithState = _fullWithStatePtr
+      .asFunction<int Function(ffi.Pointer<Context>, ffi.Pointer<WhisperState>, FullParams, ffi.Pointer<ffi.Float>, int)>();
+
+  int warmup(
+    ffi.Pointer<Context> ctx,
+    int flags,
+  ) {
+    return _warmup(ctx, flags);
+  }
+
+  late final _warmupPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<Context>, ffi.Int)>>(
+        'whisper_warmup',
+      );
+  late final _warmup = _warmupPtr
+      .asFunction<int Function(ffi.Pointer<Context>, int)>();
+
+  int warmupWithState(
+    ffi.Pointer<Context> ctx,
+    ffi.Pointer<WhisperState> state,
+    int flags,
+  ) {
+    return _warmupWithState(ctx, state, flags);
+  }
+
+  late final _warmupWithStatePtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<Context>, ffi.Pointer<WhisperState>, ffi.Int)>>(
+        'whisper_warmup_with_state',
+      );
+  late final _warmupWithState = _warmupWithStatePtr
+      .asFunction<int Function(ffi.Pointer<Context>, ffi.Pointer<WhisperState>, int)>();
+
+  SpeculativeStats getSpeculativeStats(ffi.Pointer<WhisperState> state) {
+    return _getSpeculativeStats(state);
+  }
+
+  late final _getSpeculativeStatsPtr =
+      _lookup<ffi.NativeFunction<SpeculativeStats Function(ffi.Pointer<WhisperState>)>>(
+        'whisper_get_speculative_stats',
+      );
+  late final _getSpeculativeStats = _getSpeculativeStatsPtr
+      .asFunction<SpeculativeStats Function(ffi.Pointer<WhisperState>)>();
+
+  int fullNSegmentsFromState(ffi.Pointer<WhisperState> state) {
+    return _fullNSegmentsFromState(state);
+  }
+
+  late final _fullNSegmentsFromStatePtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<WhisperState>)>>(
+        'whisper_full_n_segments_from_state',
+      );
+  late final _fullNSegmentsFromState = _fullNSegmentsFromStatePtr
+      .asFunction<int Function(ffi.Pointer<WhisperState>)>();
+
+  ffi.Pointer<ffi.Char> fullGetSegmentTextFromState(
+    ffi.Pointer<WhisperState> state,
+    int i_segment,
+  ) {
+    return _fullGetSegmentTextFromState(state, i_segment);
+  }
+
+  late final _fullGetSegmentTextFromStatePtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<ffi.Char> Function(ffi.Pointer<WhisperState>, ffi.Int)>>(
+        'whisper_full_get_segment_text_from_state',
+      );
+  late final _fullGetSegmentTextFromState = _fullGetSegmentTextFromStatePtr
+      .asFunction<ffi.Pointer<ffi.Char> Function(ffi.Pointer<WhisperState>, int)>();
+
+  int fullGetSegmentT0FromState(
+    ffi.Pointer<WhisperState> state,
+    int i_segment,
+  ) {
+    return _fullGetSegmentT0FromState(state, i_segment);
+  }
+
+  late final _fullGetSegmentT0FromStatePtr =
+      _lookup<ffi.NativeFunction<ffi.Int64 Function(ffi.Pointer<WhisperState>, ffi.Int)>>(
+        'whisper_full_get_segment_t0_from_state',
+      );
+  late final _fullGetSegmentT0FromState = _fullGetSegmentT0FromStatePtr
+      .asFunction<int Function(ffi.Pointer<WhisperState>, int)>();
+
+  int fullGetSegmentT1FromState(
+    ffi.Pointer<WhisperState> state,
+    int i_segment,
+  ) {
+    return _fullGetSegmentT1FromState(state, i_segment);
+  }
+
+  late final _fullGetSegmentT1FromStatePtr =
+      _lookup<ffi.NativeFunction<ffi.Int64 Function(ffi.Pointer<WhisperState>, ffi.Int)>>(
+        'whisper_full_get_segment_t1_from_state',
+      );
+  late final _fullGetSegmentT1FromState = _fullGetSegmentT1FromStatePtr
+      .asFunction<int Function(ffi.Pointer<WhisperState>, int)>();
+
+  ffi.Pointer<StatePool> statePoolInit(ffi.Pointer<Context> ctx) {
+    return _statePoolInit(ctx);
+  }
+
+  late final _statePoolInitPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<StatePool> Function(ffi.Pointer<Context>)>>(
+        'whisper_state_pool_init',
+      );
+  late final _statePoolInit = _statePoolInitPtr
+      .asFunction<ffi.Pointer<StatePool> Function(ffi.Pointer<Context>)>();
+
+  void statePoolFree(ffi.Pointer<StatePool> pool) {
+    return _statePoolFree(pool);
+  }
+
+  late final _statePoolFreePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<StatePool>)>>(
+        'whisper_state_pool_free',
+      );
+  late final _statePoolFree = _statePoolFreePtr
+      .asFunction<void Function(ffi.Pointer<StatePool>)>();
+
+  ffi.Pointer<WhisperState> statePoolGet(
+    ffi.Pointer<StatePool> pool,
+    int purpose,
+  ) {
+    return _statePoolGet(pool, purpose);
+  }
+
+  late final _statePoolGetPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<WhisperState> Function(ffi.Pointer<StatePool>, ffi.Int)>>(
+        'whisper_state_pool_get',
+      );
+  late final _statePoolGet = _statePoolGetPtr
+      .asFunction<ffi.Pointer<WhisperState> Function(ffi.Pointer<StatePool>, int)>();
+
+  int tokenize(
+    ffi.Pointer<Context> ctx,
+    ffi.Pointer<ffi.Char> text,
+    ffi.Pointer<ffi.Int> tokens,
+    int n_max_tokens,
+  ) {
+    return _tokenize(ctx, text, tokens, n_max_tokens);
+  }
+
+  late final _tokenizePtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<Context>, ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Int>, ffi.Int)>>(
+        'whisper_tokenize',
+      );
+  late final _tokenize = _tokenizePtr
+      .asFunction<int Function(ffi.Pointer<Context>, ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Int>, int)>();
+
+  int tokenCount(
+    ffi.Pointer<Context> ctx,
+    ffi.Pointer<ffi.Char> text,
+  ) {
+    return _tokenCount(ctx, text);
+  }
+
+  late final _tokenCountPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<Context>, ffi.Pointer<ffi.Char>)>>(
+        'whisper_token_count',
+      );
+  late final _tokenCount = _tokenCountPtr
+      .asFunction<int Function(ffi.Pointer<Context>, ffi.Pointer<ffi.Char>)>();
+
   int nVocab(ffi.Pointer<Context> ctx) {
     return _nVocab(ctx);
   }
@@ -254,10 +682,232 @@ class WhisperBindings {
       );
   late final _isMultilingual = _isMultilingualPtr
       .asFunction<int Function(ffi.Pointer<Context>)>();
+
+  ffi.Pointer<AudioBuffer> audioBufferCreate(int capacity) {
+    return _audioBufferCreate(capacity);
+  }
+
+  late final _audioBufferCreatePtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<AudioBuffer> Function(ffi.Int64)>>(
+        'whisper_audio_buffer_create',
+      );
+  late final _audioBufferCreate = _audioBufferCreatePtr
+      .asFunction<ffi.Pointer<AudioBuffer> Function(int)>();
+
+  void audioBufferFree(ffi.Pointer<AudioBuffer> buffer) {
+    return _audioBufferFree(buffer);
+  }
+
+  late final _audioBufferFreePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<AudioBuffer>)>>(
+        'whisper_audio_buffer_free',
+      );
+  late final _audioBufferFree = _audioBufferFreePtr
+      .asFunction<void Function(ffi.Pointer<AudioBuffer>)>();
+
+  int audioBufferAppend(
+    ffi.Pointer<AudioBuffer> buffer,
+    ffi.Pointer<ffi.Float> samples,
+    int n_samples,
+  ) {
+    return _audioBufferAppend(buffer, samples, n_samples);
+  }
+
+  late final _audioBufferAppendPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<AudioBuffer>, ffi.Pointer<ffi.Float>, ffi.Int)>>(
+        'whisper_audio_buffer_append',
+      );
+  late final _audioBufferAppend = _audioBufferAppendPtr
+      .asFunction<int Function(ffi.Pointer<AudioBuffer>, ffi.Pointer<ffi.Float>, int)>();
+
+  int audioBufferAppendPcm16(
+    ffi.Pointer<AudioBuffer> buffer,
+    ffi.Pointer<ffi.Void> pcm,
+    int n_samples,
+  ) {
+    return _audioBufferAppendPcm16(buffer, pcm, n_samples);
+  }
+
+  late final _audioBufferAppendPcm16Ptr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<AudioBuffer>, ffi.Pointer<ffi.Void>, ffi.Int)>>(
+        'whisper_audio_buffer_append_pcm16',
+      );
+  late final _audioBufferAppendPcm16 = _audioBufferAppendPcm16Ptr
+      .asFunction<int Function(ffi.Pointer<AudioBuffer>, ffi.Pointer<ffi.Void>, int)>(isLeaf: true);
+
+  int audioBufferSize(ffi.Pointer<AudioBuffer> buffer) {
+    return _audioBufferSize(buffer);
+  }
+
+  late final _audioBufferSizePtr =
+      _lookup<ffi.NativeFunction<ffi.Int64 Function(ffi.Pointer<AudioBuffer>)>>(
+        'whisper_audio_buffer_size',
+      );
+  late final _audioBufferSize = _audioBufferSizePtr
+      .asFunction<int Function(ffi.Pointer<AudioBuffer>)>();
+
+  ffi.Pointer<ffi.Float> audioBufferView(
+    ffi.Pointer<AudioBuffer> buffer,
+    int offset,
+    int n_samples,
+  ) {
+    return _audioBufferView(buffer, offset, n_samples);
+  }
+
+  late final _audioBufferViewPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<ffi.Float> Function(ffi.Pointer<AudioBuffer>, ffi.Int64, ffi.Int)>>(
+        'whisper_audio_buffer_view',
+      );
+  late final _audioBufferView = _audioBufferViewPtr
+      .asFunction<ffi.Pointer<ffi.Float> Function(ffi.Pointer<AudioBuffer>, int, int)>();
+
+  void audioBufferDiscard(
+    ffi.Pointer<AudioBuffer> buffer,
+    int n_samples,
+  ) {
+    return _audioBufferDiscard(buffer, n_samples);
+  }
+
+  late final _audioBufferDiscardPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<AudioBuffer>, ffi.Int64)>>(
+        'whisper_audio_buffer_discard',
+      );
+  late final _audioBufferDiscard = _audioBufferDiscardPtr
+      .asFunction<void Function(ffi.Pointer<AudioBuffer>, int)>();
+
+  void audioBufferClear(ffi.Pointer<AudioBuffer> buffer) {
+    return _audioBufferClear(buffer);
+  }
+
+  late final _audioBufferClearPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<AudioBuffer>)>>(
+        'whisper_audio_buffer_clear',
+      );
+  late final _audioBufferClear = _audioBufferClearPtr
+      .asFunction<void Function(ffi.Pointer<AudioBuffer>)>();
+
+  ffi.Pointer<WhisperStream> streamBegin(
+    ffi.Pointer<Context> ctx,
+    FullParams params,
+  ) {
+    return _streamBegin(ctx, params);
+  }
+
+  late final _streamBeginPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Pointer<WhisperStream> Function(ffi.Pointer<Context>, FullParams)
+        >
+      >('whisper_stream_begin');
+  late final _streamBegin = _streamBeginPtr
+      .asFunction<
+        ffi.Pointer<WhisperStream> Function(ffi.Pointer<Context>, FullParams)
+      >();
+
+  ffi.Pointer<WhisperStream> streamBeginWithState(
+    ffi.Pointer<Context> ctx,
+    ffi.Pointer<WhisperState> state,
+    FullParams params,
+  ) {
+    return _streamBeginWithState(ctx, state, params);
+  }
+
+  late final _streamBeginWithStatePtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<WhisperStream> Function(ffi.Pointer<Context>, ffi.Pointer<WhisperState>, FullParams)>>(
+        'whisper_stream_begin_with_state',
+      );
+  late final _streamBeginWithState = _streamBeginWithStatePtr
+      .asFunction<ffi.Pointer<WhisperStream> Function(ffi.Pointer<Context>, ffi.Pointer<WhisperState>, FullParams)>();
+
+  int streamPush(
+    ffi.Pointer<WhisperStream> stream,
+    ffi.Pointer<ffi.Float> samples,
+    int n_samples,
+  ) {
+    return _streamPush(stream, samples, n_samples);
+  }
+
+  late final _streamPushPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Pointer<WhisperStream>,
+            ffi.Pointer<ffi.Float>,
+            ffi.Int,
+          )
+        >
+      >('whisper_stream_push');
+  late final _streamPush = _streamPushPtr
+      .asFunction<
+        int Function(ffi.Pointer<WhisperStream>, ffi.Pointer<ffi.Float>, int)
+      >();
+
+  int streamPoll(
+    ffi.Pointer<WhisperStream> stream,
+    ffi.Pointer<ffi.Pointer<ffi.Char>> partial,
+    ffi.Pointer<ffi.Pointer<ffi.Char>> committed,
+  ) {
+    return _streamPoll(stream, partial, committed);
+  }
+
+  late final _streamPollPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Pointer<WhisperStream>,
+            ffi.Pointer<ffi.Pointer<ffi.Char>>,
+            ffi.Pointer<ffi.Pointer<ffi.Char>>,
+          )
+        >
+      >('whisper_stream_poll');
+  late final _streamPoll = _streamPollPtr
+      .asFunction<
+        int Function(
+          ffi.Pointer<WhisperStream>,
+          ffi.Pointer<ffi.Pointer<ffi.Char>>,
+          ffi.Pointer<ffi.Pointer<ffi.Char>>,
+        )
+      >();
+
+  ffi.Pointer<ffi.Char> streamEnd(ffi.Pointer<WhisperStream> stream) {
+    return _streamEnd(stream);
+  }
+
+  late final _streamEndPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Pointer<ffi.Char> Function(ffi.Pointer<WhisperStream>)
+        >
+      >('whisper_stream_end');
+  late final _streamEnd = _streamEndPtr
+      .asFunction<ffi.Pointer<ffi.Char> Function(ffi.Pointer<WhisperStream>)>();
+
+  void streamFree(ffi.Pointer<WhisperStream> stream) {
+    return _streamFree(stream);
+  }
+
+  late final _streamFreePtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Void Function(ffi.Pointer<WhisperStream>)>
+      >('whisper_stream_free');
+  late final _streamFree = _streamFreePtr
+      .asFunction<void Function(ffi.Pointer<WhisperStream>)>();
 }
 
 final class Context extends ffi.Opaque {}
 
+final class WhisperStream extends ffi.Opaque {}
+
+final class AudioBuffer extends ffi.Opaque {}
+
+final class WhisperState extends ffi.Opaque {}
+
+final class StatePool extends ffi.Opaque {}
+
+final class WhisperModel extends ffi.Opaque {}
+
+final class ModelSlot extends ffi.Opaque {}
+
 final class FullParams extends ffi.Struct {
   @ffi.Int()
   external int strategy;
@@ -410,6 +1060,36 @@ final class FullParams extends ffi.Struct {
   external ffi.Pointer<ffi.Char> vad_model_path;
 
   external UnnamedStruct3 vad_params;
+
+  @ffi.Int64()
+  external int new_segment_port;
+
+  @ffi.Int64()
+  external int progress_port;
+
+  external ffi.Pointer<Context> draft_ctx;
+
+  external ffi.Pointer<WhisperState> draft_state;
+
+  @ffi.Int()
+  external int n_draft;
+}
+
+final class ThreadpoolParams extends ffi.Struct {
+  @ffi.Int()
+  external int n_threads;
+
+  @ffi.Int()
+  external int affinity;
+
+  @ffi.Uint64()
+  external int cpu_mask;
+
+  @ffi.Int()
+  external int prio;
+
+  @ffi.Uint32()
+  external int poll;
 }
 
 final class UnnamedStruct1 extends ffi.Struct {
@@ -468,6 +1148,96 @@ final class ContextParams extends ffi.Struct {
 
   @ffi.Size()
   external int dtw_mem_size;
+
+  @ffi.Bool()
+  external bool use_mmap;
+
+  @ffi.Bool()
+  external bool use_mlock;
+
+  external ffi.Pointer<ffi.Char> repack_cache_path;
+}
+
+final class LoadStats extends ffi.Struct {
+  @ffi.Int64()
+  external int t_load_us;
+
+  @ffi.Size()
+  external int n_bytes_mapped;
+
+  @ffi.Size()
+  external int n_bytes_copied;
+
+  @ffi.Size()
+  external int n_bytes_repacked;
+
+  @ffi.Size()
+  external int n_bytes_repack_cached;
+
+  @ffi.Float()
+  external double page_cache_hit;
+
+  @ffi.Bool()
+  external bool use_mmap;
+
+  @ffi.Bool()
+  external bool use_mlock;
+}
+
+final class SpeculativeStats extends ffi.Struct {
+  @ffi.Int()
+  external int n_verify;
+
+  @ffi.Int()
+  external int n_drafted;
+
+  @ffi.Int()
+  external int n_accepted;
+
+  @ffi.Int64()
+  external int t_draft_us;
+}
+
+abstract class whisper_threadpool_affinity {
+  static const int WHISPER_THREADPOOL_AFFINITY_ANY = 0;
+  static const int WHISPER_THREADPOOL_AFFINITY_PERFORMANCE = 1;
+  static const int WHISPER_THREADPOOL_AFFINITY_MASK = 2;
+}
+
+abstract class whisper_state_purpose {
+  static const int WHISPER_STATE_INTERIM = 0;
+  static const int WHISPER_STATE_FINAL = 1;
+  static const int WHISPER_STATE_PURPOSE_COUNT = 2;
+}
+
+abstract class whisper_warmup_flags {
+  static const int WHISPER_WARMUP_PREFAULT = 1;
+  static const int WHISPER_WARMUP_ENCODE = 2;
+  static const int WHISPER_WARMUP_ALL_BUCKETS = 4;
+  static const int WHISPER_WARMUP_BEAM_SEARCH = 8;
+  static const int WHISPER_WARMUP_DEFAULT = 3;
+}
+
+abstract class whisper_swap_status {
+  static const int WHISPER_SWAP_OK = 0;
+  static const int WHISPER_SWAP_ERR_LOAD = -1;
+  static const int WHISPER_SWAP_ERR_MEMORY = -2;
+  static const int WHISPER_SWAP_ERR_WARMUP = -3;
+  static const int WHISPER_SWAP_ERR_BUSY = -4;
+}
+
+final class ModelSlotMemory extends ffi.Struct {
+  @ffi.Size()
+  external int live_bytes;
+
+  @ffi.Size()
+  external int peak_bytes;
+
+  @ffi.Size()
+  external int last_estimate;
+
+  @ffi.Int()
+  external int n_live;
 }
 
 abstract class whisper_sampling_strategy {
@@ -483,6 +1253,23 @@ final class whisper_aheads extends ffi.Struct {
 }
 
 typedef whisper_ahead = ffi.Pointer<ffi.Void>;
+typedef whisper_new_segment_callback = ffi.Pointer<ffi.NativeFunction<whisper_new_segment_callbackFunction>>;
+typedef whisper_new_segment_callbackFunction = ffi.Void Function(ffi.Pointer<Context> ctx, ffi.Pointer<WhisperState> state, ffi.Int n_new, ffi.Pointer<ffi.Void> user_data);
+typedef Dartwhisper_new_segment_callbackFunction = void Function(ffi.Pointer<Context> ctx, ffi.Pointer<WhisperState> state, int n_new, ffi.Pointer<ffi.Void> user_data);
+typedef whisper_progress_callback = ffi.Pointer<ffi.NativeFunction<whisper_progress_callbackFunction>>;
+typedef whisper_progress_callbackFunction = ffi.Void Function(ffi.Pointer<Context> ctx, ffi.Pointer<WhisperState> state, ffi.Int progress, ffi.Pointer<ffi.Void> user_data);
+typedef Dartwhisper_progress_callbackFunction = void Function(ffi.Pointer<Context> ctx, ffi.Pointer<WhisperState> state, int progress, ffi.Pointer<ffi.Void> user_data);
+typedef whisper_encoder_begin_callback = ffi.Pointer<ffi.NativeFunction<whisper_encoder_begin_callbackFunction>>;
+typedef whisper_encoder_begin_callbackFunction = ffi.Bool Function(ffi.Pointer<Context> ctx, ffi.Pointer<WhisperState> state, ffi.Pointer<ffi.Void> user_data);
+typedef Dartwhisper_encoder_begin_callbackFunction = bool Function(ffi.Pointer<Context> ctx, ffi.Pointer<WhisperState> state, ffi.Pointer<ffi.Void> user_data);
+typedef whisper_logits_filter_callback = ffi.Pointer<ffi.NativeFunction<whisper_logits_filter_callbackFunction>>;
+typedef whisper_logits_filter_callbackFunction = ffi.Void Function(ffi.Pointer<Context> ctx, ffi.Pointer<WhisperState> state, ffi.Pointer<ffi.Void> tokens, ffi.Int n_tokens, ffi.Pointer<ffi.Float> logits, ffi.Pointer<ffi.Void> user_data);
+typedef Dartwhisper_logits_filter_callbackFunction = void Function(ffi.Pointer<Context> ctx, ffi.Pointer<WhisperState> state, ffi.Pointer<ffi.Void> tokens, int n_tokens, ffi.Pointer<ffi.Float> logits, ffi.Pointer<ffi.Void> user_data);
+typedef whisper_abort_callback = ffi.Pointer<ffi.NativeFunction<whisper_abort_callbackFunction>>;
+typedef whisper_abort_callbackFunction = ffi.Bool Function(ffi.Pointer<ffi.Void> user_data);
+typedef Dartwhisper_abort_callbackFunction = bool Function(ffi.Pointer<ffi.Void> user_data);
+
+const int WHISPER_AUDIO_CTX_AUTO = -1;
 
 const int _STDINT_H = 1;
 
@@ -0,0 +1,495 @@
+#include "capture_wrapper.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#ifdef CAPTURE_HAVE_PULSE
+#include <pulse/simple.h>
+#include <pulse/error.h>
+#endif
+
+#ifdef CAPTURE_HAVE_ALSA
+#include <alsa/asoundlib.h>
+#endif
+
+// Single-producer single-consumer ring of float samples. The capture thread
+// is the only writer and the Dart side (through capture_read) the only reader.
+struct capture_ring {
+    std::vector<float> data;
+    size_t mask = 0;
+    std::atomic<size_t> head{0}; // written by the producer
+    std::atomic<size_t> tail{0}; // written by the consumer
+
+    void init(size_t min_capacity) {
+        size_t capacity = 1;
+        while (capacity < min_capacity) capacity <<= 1;
+        data.assign(capacity, 0.0f);
+        mask = capacity - 1;
+        head.store(0);
+        tail.store(0);
+    }
+
+    size_t available() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+    }
+
+    // Returns the number of samples written, the rest is dropped.
+    size_t write(const float * src, size_t n) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        const size_t t = tail.load(std::memory_order_acquire);
+        n = std::min(n, data.size() - (h - t));
+
+        const size_t pos = h & mask;
+        const size_t first = std::min(n, data.size() - pos);
+        std::memcpy(data.data() + pos, src, first * sizeof(float));
+        std::memcpy(data.data(), src + first, (n - first) * sizeof(float));
+
+        head.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    size_t read(float * dst, size_t n) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        const size_t h = head.load(std::memory_order_acquire);
+        n = std::min(n, h - t);
+
+        const size_t pos = t & mask;
+        const size_t first = std::min(n, data.size() - pos);
+        std::memcpy(dst, data.data() + pos, first * sizeof(float));
+        std::memcpy(dst + first, data.data(), (n - first) * sizeof(float));
+
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+};
+
+// A blocking PCM16 mono source. read() returns the number of samples read,
+// 0 at end of stream and a negative value on error.
+struct capture_source {
+    virtual ~capture_source() {}
+    virtual int read(int16_t * dst, int n_samples) = 0;
+};
+
+struct capture_source_null : capture_source {
+    int sample_rate;
+    explicit capture_source_null(int sample_rate) : sample_rate(sample_rate) {}
+
+    int read(int16_t * dst, int n_samples) override {
+        std::this_thread::sleep_for(std::chrono::microseconds((int64_t) n_samples * 1000000 / sample_rate));
+        std::memset(dst, 0, n_samples * sizeof(int16_t));
+        return n_samples;
+    }
+};
+
+struct capture_source_file : capture_source {
+    FILE * file = nullptr;
+    int sample_rate;
+    bool realtime;
+    // Bytes of PCM left: to the end of the data chunk, or of a raw file
+    uint64_t remaining = UINT64_MAX;
+
+    capture_source_file(int sample_rate, bool realtime) : sample_rate(sample_rate), realtime(realtime) {}
+    ~capture_source_file() override {
+        if (file) fclose(file);
+    }
+
+    bool open(const char * path) {
+        file = fopen(path, "rb");
+        if (!file) return false;
+
+        // A RIFF file is read from its data chunk, anything else is taken as raw PCM16
+        char riff[12];
+        if (fread(riff, 1, 12, file) == 12 && std::memcmp(riff, "RIFF", 4) == 0) {
+            return std::memcmp(riff + 8, "WAVE", 4) == 0 && open_wav(path);
+        }
+        fseek(file, 0, SEEK_SET);
+        return true;
+    }
+
+    // Walks the chunks after the RIFF header up to "data", checking the format on the way
+    bool open_wav(const char * path) {
+        bool has_fmt = false;
+        uint8_t header[8];
+        while (fread(header, 1, 8, file) == 8) {
+            const uint32_t size = header[4] | header[5] << 8 | header[6] << 16 | (uint32_t) header[7] << 24;
+            if (std::memcmp(header, "fmt ", 4) == 0) {
+                uint8_t fmt[16];
+                if (size < 16 || fread(fmt, 1, 16, file) != 16) break;
+                const int format = fmt[0] | fmt[1] << 8;
+                const int channels = fmt[2] | fmt[3] << 8;
+                const int rate = fmt[4] | fmt[5] << 8 | fmt[6] << 16 | fmt[7] << 24;
+                const int bits = fmt[14] | fmt[15] << 8;
+                if (format != 1 || channels != 1 || rate != sample_rate || bits != 16) {
+                    std::cerr << "Capture: " << path << " is not PCM16 mono " << sample_rate << " Hz (format " << format
+                              << ", " << channels << " channels, " << rate << " Hz, " << bits << " bits)" << std::endl;
+                    return false;
+                }
+                has_fmt = true;
+                fseek(file, (long) (size - 16 + (size & 1)), SEEK_CUR);
+            } else if (std::memcmp(header, "data", 4) == 0) {
+                if (!has_fmt) break;
+                remaining = size;
+                return true;
+            } else {
+                // Chunks are padded to an even size
+                fseek(file, (long) size + (size & 1), SEEK_CUR);
+            }
+        }
+        std::cerr << "Capture: " << path << " has no fmt chunk before its data chunk" << std::endl;
+        return false;
+    }
+
+    int read(int16_t * dst, int n_samples) override {
+        if (realtime) {
+            std::this_thread::sleep_for(std::chrono::microseconds((int64_t) n_samples * 1000000 / sample_rate));
+        }
+        n_samples = (int) std::min<uint64_t>(n_samples, remaining / sizeof(int16_t));
+        const int n = (int) fread(dst, sizeof(int16_t), n_samples, file);
+        remaining -= n * sizeof(int16_t);
+        return n;
+    }
+};
+
+#ifdef CAPTURE_HAVE_PULSE
+struct capture_source_pulse : capture_source {
+    pa_simple * stream = nullptr;
+
+    ~capture_source_pulse() override {
+        if (stream) pa_simple_free(stream);
+    }
+
+    bool open(const char * device, int sample_rate, int period_samples) {
+        pa_sample_spec spec;
+        spec.format = PA_SAMPLE_S16LE;
+        spec.rate = sample_rate;
+        spec.channels = 1;
+
+        pa_buffer_attr attr;
+        attr.maxlength = (uint32_t) -1;
+        attr.tlength = (uint32_t) -1;
+        attr.prebuf = (uint32_t) -1;
+        attr.minreq = (uint32_t) -1;
+        attr.fragsize = period_samples * sizeof(int16_t);
+
+        int error = 0;
+        stream = pa_simple_new(nullptr, "LocalVoiceSync", PA_STREAM_RECORD, device, "Dictation",
+                               &spec, nullptr, &attr, &error);
+        if (!stream) {
+            std::cerr << "Capture: PulseAudio open failed: " << pa_strerror(error) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    int read(int16_t * dst, int n_samples) override {
+        int error = 0;
+        if (pa_simple_read(stream, dst, n_samples * sizeof(int16_t), &error) < 0) {
+            std::cerr << "Capture: PulseAudio read failed: " << pa_strerror(error) << std::endl;
+            return -1;
+        }
+        return n_samples;
+    }
+};
+#endif
+
+#ifdef CAPTURE_HAVE_ALSA
+struct capture_source_alsa : capture_source {
+    snd_pcm_t * pcm = nullptr;
+
+    ~capture_source_alsa() override {
+        if (pcm) snd_pcm_close(pcm);
+    }
+
+    bool open(const char * device, int sample_rate, int period_ms) {
+        int err = snd_pcm_open(&pcm, device ? device : "default", SND_PCM_STREAM_CAPTURE, 0);
+        if (err < 0) {
+            std::cerr << "Capture: ALSA open failed: " << snd_strerror(err) << std::endl;
+            pcm = nullptr;
+            return false;
+        }
+        err = snd_pcm_set_params(pcm, SND_PCM_FORMAT_S16_LE, SND_PCM_ACCESS_RW_INTERLEAVED,
+                                 1, sample_rate, 1, (unsigned int) period_ms * 2 * 1000);
+        if (err < 0) {
+            std::cerr << "Capture: ALSA set params failed: " << snd_strerror(err) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    int read(int16_t * dst, int n_samples) override {
+        int done = 0;
+        while (done < n_samples) {
+            snd_pcm_sframes_t n = snd_pcm_readi(pcm, dst + done, n_samples - done);
+            if (n < 0) {
+                n = snd_pcm_recover(pcm, (int) n, 1);
+                if (n < 0) {
+                    std::cerr << "Capture: ALSA read failed: " << snd_strerror((int) n) << std::endl;
+                    return -1;
+                }
+                continue;
+            }
+            done += (int) n;
+        }
+        return done;
+    }
+};
+#endif
+
+struct capture_context {
+    capture_config config;
+    std::string device;
+
+    capture_ring ring;
+    std::unique_ptr<capture_source> source;
+    int active_backend = CAPTURE_BACKEND_AUTO;
+
+    std::thread thread;
+    std::atomic<bool> running{false};
+
+    std::atomic<float> peak{0.0f};
+    std::atomic<float> rms{0.0f};
+    std::atomic<uint64_t> n_captured{0};
+    std::atomic<uint64_t> n_dropped{0};
+};
+
+static std::unique_ptr<capture_source> capture_open_source(capture_context * ctx, int backend) {
+    const char * device = ctx->device.empty() ? nullptr : ctx->device.c_str();
+
+    switch (backend) {
+        case CAPTURE_BACKEND_PULSE: {
+#ifdef CAPTURE_HAVE_PULSE
+            std::unique_ptr<capture_source_pulse> source(new capture_source_pulse());
+            if (source->open(device, ctx->config.sample_rate, ctx->config.sample_rate * ctx->config.period_ms / 1000)) return source;
+#endif
+            return nullptr;
+        }
+        case CAPTURE_BACKEND_ALSA: {
+#ifdef CAPTURE_HAVE_ALSA
+            std::unique_ptr<capture_source_alsa> source(new capture_source_alsa());
+            if (source->open(device, ctx->config.sample_rate, ctx->config.period_ms)) return source;
+#endif
+            return nullptr;
+        }
+        case CAPTURE_BACKEND_FILE: {
+            std::unique_ptr<capture_source_file> source(new capture_source_file(ctx->config.sample_rate, ctx->config.realtime));
+            if (device && source->open(device)) return source;
+            std::cerr << "Capture: cannot open input file " << (device ? device : "(null)") << std::endl;
+            return nullptr;
+        }
+        case CAPTURE_BACKEND_NULL:
+            return std::unique_ptr<capture_source>(new capture_source_null(ctx->config.sample_rate));
+        default:
+            return nullptr;
+    }
+}
+
+static void capture_thread_main(capture_context * ctx) {
+    const int period_samples = ctx->config.sample_rate * ctx->config.period_ms / 1000;
+    std::vector<int16_t> pcm(period_samples);
+    std::vector<float> samples(period_samples);
+
+    while (ctx->running.load(std::memory_order_relaxed)) {
+        const int n = ctx->source->read(pcm.data(), period_samples);
+        if (n <= 0) {
+            if (n < 0) std::cerr << "Capture: source failed, stopping" << std::endl;
+            break;
+        }
+
+        float peak = 0.0f;
+        float rms = 0.0f;
+        capture_convert_pcm16(pcm.data(), samples.data(), n, &peak, &rms);
+
+        const size_t written = ctx->ring.write(samples.data(), n);
+        ctx->n_captured.fetch_add(written, std::memory_order_relaxed);
+        ctx->n_dropped.fetch_add(n - written, std::memory_order_relaxed);
+        ctx->peak.store(peak, std::memory_order_relaxed);
+        ctx->rms.store(rms, std::memory_order_relaxed);
+    }
+
+    ctx->running.store(false);
+}
+
+extern "C" {
+
+capture_config capture_default_config(void) {
+    capture_config config;
+    config.backend = CAPTURE_BACKEND_AUTO;
+    config.sample_rate = 16000;
+    config.period_ms = 32;
+    config.ring_ms = 10000;
+    config.device = nullptr;
+    config.realtime = true;
+    return config;
+}
+
+capture_context * capture_init(capture_config config) {
+    if (config.sample_rate != 16000 || config.period_ms <= 0 || config.ring_ms < config.period_ms) {
+        std::cerr << "Capture: unsupported config (sample_rate=" << config.sample_rate
+                  << ", period_ms=" << config.period_ms << ", ring_ms=" << config.ring_ms << ")" << std::endl;
+        return nullptr;
+    }
+
+    capture_context * ctx = new capture_context();
+    ctx->config = config;
+    ctx->device = config.device ? config.device : "";
+    ctx->config.device = nullptr;
+    ctx->ring.init((size_t) config.sample_rate * config.ring_ms / 1000);
+    return ctx;
+}
+
+void capture_free(capture_context * ctx) {
+    if (!ctx) return;
+    capture_stop(ctx);
+    delete ctx;
+}
+
+int capture_start(capture_context * ctx) {
+    if (!ctx) return -1;
+    if (ctx->running.load()) return 0;
+    if (ctx->thread.joinable()) ctx->thread.join();
+
+    ctx->source.reset();
+    if (ctx->config.backend == CAPTURE_BACKEND_AUTO) {
+        // Never the null backend: recording silence would look like a working microphone
+        const int order[] = { CAPTURE_BACKEND_PULSE, CAPTURE_BACKEND_ALSA };
+        for (int backend : order) {
+            ctx->source = capture_open_source(ctx, backend);
+            if (ctx->source) {
+                ctx->active_backend = backend;
+                break;
+            }
+        }
+    } else {
+        ctx->source = capture_open_source(ctx, ctx->config.backend);
+        ctx->active_backend = ctx->config.backend;
+    }
+
+    if (!ctx->source) {
+        std::cerr << "Capture: no usable backend" << std::endl;
+        return -2;
+    }
+
+    ctx->ring.init(ctx->ring.data.size());
+    ctx->peak.store(0.0f);
+    ctx->rms.store(0.0f);
+    ctx->n_captured.store(0);
+    ctx->n_dropped.store(0);
+
+    ctx->running.store(true);
+    ctx->thread = std::thread(capture_thread_main, ctx);
+    return 0;
+}
+
+void capture_stop(capture_context * ctx) {
+    if (!ctx) return;
+    ctx->running.store(false);
+    if (ctx->thread.joinable()) ctx->thread.join();
+    ctx->source.reset();
+}
+
+bool capture_is_running(capture_context * ctx) {
+    return ctx && ctx->running.load();
+}
+
+int capture_active_backend(capture_context * ctx) {
+    return ctx ? ctx->active_backend : CAPTURE_BACKEND_AUTO;
+}
+
+int capture_available(capture_context * ctx) {
+    if (!ctx) return 0;
+    return (int) ctx->ring.available();
+}
+
+int capture_read(capture_context * ctx, float * dst, int max_samples) {
+    if (!ctx || !dst || max_samples <= 0) return 0;
+    return (int) ctx->ring.read(dst, max_samples);
+}
+
+capture_levels capture_get_levels(capture_context * ctx) {
+    capture_levels levels;
+    std::memset(&levels, 0, sizeof(levels));
+    if (!ctx) return levels;
+
+    levels.peak = ctx->peak.load(std::memory_order_relaxed);
+    levels.rms = ctx->rms.load(std::memory_order_relaxed);
+    levels.n_captured = ctx->n_captured.load(std::memory_order_relaxed);
+    levels.n_dropped = ctx->n_dropped.load(std::memory_order_relaxed);
+    return levels;
+}
+
+void capture_convert_pcm16(const int16_t * src, float * dst, int n_samples, float * peak, float * rms) {
+    const float scale = 1.0f / 32768.0f;
+    float max_abs = 0.0f;
+    float sum_sq = 0.0f;
+    int i = 0;
+
+#if defined(__AVX2__)
+    const __m256 vscale = _mm256_set1_ps(scale);
+    const __m256 vsign = _mm256_set1_ps(-0.0f);
+    __m256 vmax = _mm256_setzero_ps();
+    __m256 vsum = _mm256_setzero_ps();
+    for (; i + 8 <= n_samples; i += 8) {
+        const __m128i s16 = _mm_loadu_si128((const __m128i *) (src + i));
+        const __m256 f = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(s16)), vscale);
+        _mm256_storeu_ps(dst + i, f);
+        vmax = _mm256_max_ps(vmax, _mm256_andnot_ps(vsign, f));
+        vsum = _mm256_add_ps(vsum, _mm256_mul_ps(f, f));
+    }
+    float lanes_max[8];
+    float lanes_sum[8];
+    _mm256_storeu_ps(lanes_max, vmax);
+    _mm256_storeu_ps(lanes_sum, vsum);
+    for (int k = 0; k < 8; k++) {
+        max_abs = std::max(max_abs, lanes_max[k]);
+        sum_sq += lanes_sum[k];
+    }
+#elif defined(__ARM_NEON)
+    const float32x4_t vscale = vdupq_n_f32(scale);
+    float32x4_t vmax = vdupq_n_f32(0.0f);
+    float32x4_t vsum = vdupq_n_f32(0.0f);
+    for (; i + 8 <= n_samples; i += 8) {
+        const int16x8_t s16 = vld1q_s16(src + i);
+        const float32x4_t lo = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(s16))), vscale);
+        const float32x4_t hi = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(s16))), vscale);
+        vst1q_f32(dst + i, lo);
+        vst1q_f32(dst + i + 4, hi);
+        vmax = vmaxq_f32(vmax, vmaxq_f32(vabsq_f32(lo), vabsq_f32(hi)));
+        vsum = vmlaq_f32(vmlaq_f32(vsum, lo, lo), hi, hi);
+    }
+    float lanes_max[4];
+    float lanes_sum[4];
+    vst1q_f32(lanes_max, vmax);
+    vst1q_f32(lanes_sum, vsum);
+    for (int k = 0; k < 4; k++) {
+        max_abs = std::max(max_abs, lanes_max[k]);
+        sum_sq += lanes_sum[k];
+    }
+#endif
+
+    for (; i < n_samples; i++) {
+        const float f = src[i] * scale;
+        dst[i] = f;
+        max_abs = std::max(max_abs, std::fabs(f));
+        sum_sq += f * f;
+    }
+
+    if (peak) *peak = max_abs;
+    if (rms) *rms = n_samples > 0 ? std::sqrt(sum_sq / n_samples) : 0.0f;
+}
+
+}
@@ -0,0 +1,66 @@
+#ifndef CAPTURE_WRAPPER_H
+#define CAPTURE_WRAPPER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct capture_context capture_context;
+
+// PipeWire sessions are served by the PulseAudio or ALSA backend through
+// pipewire-pulse / pipewire-alsa.
+typedef enum {
+    CAPTURE_BACKEND_AUTO  = 0, // PulseAudio, then ALSA; capture_start fails if neither opens
+    CAPTURE_BACKEND_PULSE = 1,
+    CAPTURE_BACKEND_ALSA  = 2,
+    CAPTURE_BACKEND_FILE  = 3, // PCM16 mono 16 kHz WAV or raw file, for tests
+    CAPTURE_BACKEND_NULL  = 4, // silence, for tests
+} capture_backend;
+
+typedef struct {
+    int backend;
+    int sample_rate;      // only 16000 is supported
+    int period_ms;        // device read size and metering window
+    int ring_ms;          // ring capacity, older audio is dropped if the reader falls behind
+    const char * device;  // backend device name or file path, NULL for the default device
+    bool realtime;        // file backend: pace reads like a live device
+} capture_config;
+
+typedef struct {
+    float peak;           // of the last period, 0.0 to 1.0
+    float rms;            // of the last period, 0.0 to 1.0
+    uint64_t n_captured;  // samples written to the ring since start
+    uint64_t n_dropped;   // samples dropped because the ring was full
+} capture_levels;
+
+capture_config capture_default_config(void);
+
+capture_context * capture_init(capture_config config);
+void capture_free(capture_context * ctx);
+
+// Starts/stops the capture thread. The ring is cleared on start. Returns -2
+// when the backend, or for CAPTURE_BACKEND_AUTO every device backend, fails to open.
+int capture_start(capture_context * ctx);
+void capture_stop(capture_context * ctx);
+bool capture_is_running(capture_context * ctx);
+
+// Backend actually opened by the last capture_start (never CAPTURE_BACKEND_AUTO once started).
+int capture_active_backend(capture_context * ctx);
+
+// Single consumer side of the ring. Returns the number of samples copied to dst.
+int capture_available(capture_context * ctx);
+int capture_read(capture_context * ctx, float * dst, int max_samples);
+
+capture_levels capture_get_levels(capture_context * ctx);
+
+// Converts PCM16 to float in [-1, 1) and meters peak/RMS in the same pass.
+void capture_convert_pcm16(const int16_t * src, float * dst, int n_samples, float * peak, float * rms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,175 @@
+// Feeds WAV and raw files through the file backend and checks the samples
+// read from the ring and the levels of the last period. The WAV has a
+// WAVE_FORMAT_EX fmt chunk, a LIST chunk of odd size before the data and a
+// chunk after it, so a fixed 44-byte header or reading to the end of the
+// file shows up as wrong samples.
+
+#include "capture_wrapper.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+static int n_failed = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        std::fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+        std::fprintf(stderr, __VA_ARGS__); \
+        std::fprintf(stderr, "\n"); \
+        n_failed++; \
+    } \
+} while (0)
+
+// A ramp from -0.5 to 0.5 every 64 samples; 32 ms periods hold whole ramps
+static int16_t sample_at(int i) {
+    return (int16_t) ((i % 64 - 32) * 512);
+}
+
+static void put_u32(std::vector<uint8_t> & out, uint32_t v) {
+    for (int k = 0; k < 4; k++) out.push_back((uint8_t) (v >> (8 * k)));
+}
+
+static void put_u16(std::vector<uint8_t> & out, uint16_t v) {
+    out.push_back((uint8_t) v);
+    out.push_back((uint8_t) (v >> 8));
+}
+
+static void put_chunk(std::vector<uint8_t> & out, const char * id, const std::vector<uint8_t> & body) {
+    out.insert(out.end(), id, id + 4);
+    put_u32(out, (uint32_t) body.size());
+    out.insert(out.end(), body.begin(), body.end());
+    if (body.size() & 1) out.push_back(0);
+}
+
+static std::vector<uint8_t> make_wav(int n_samples, uint32_t rate) {
+    std::vector<uint8_t> fmt;
+    put_u16(fmt, 1);            // PCM
+    put_u16(fmt, 1);            // mono
+    put_u32(fmt, rate);
+    put_u32(fmt, rate * 2);     // byte rate
+    put_u16(fmt, 2);            // block align
+    put_u16(fmt, 16);           // bits
+    put_u16(fmt, 0);            // cbSize of WAVE_FORMAT_EX
+
+    const char info[] = "INFOISFT\x05\0\0\0test";
+    std::vector<uint8_t> list(info, info + sizeof(info) - 1);
+
+    std::vector<uint8_t> data;
+    for (int i = 0; i < n_samples; i++) put_u16(data, (uint16_t) sample_at(i));
+
+    // Not samples, must not be read as such
+    std::vector<uint8_t> trailer(64, 0x7f);
+
+    std::vector<uint8_t> body;
+    body.insert(body.end(), { 'W', 'A', 'V', 'E' });
+    put_chunk(body, "fmt ", fmt);
+    put_chunk(body, "LIST", list);
+    put_chunk(body, "data", data);
+    put_chunk(body, "id3 ", trailer);
+
+    std::vector<uint8_t> wav;
+    put_chunk(wav, "RIFF", body);
+    return wav;
+}
+
+static std::string write_temp(const std::vector<uint8_t> & bytes) {
+    char path[] = "/tmp/capture_file_test_XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0) return "";
+    const bool ok = write(fd, bytes.data(), bytes.size()) == (ssize_t) bytes.size();
+    close(fd);
+    return ok ? path : "";
+}
+
+// Captures the whole file, or returns the capture_start error
+static int capture_file(const std::string & path, std::vector<float> & samples, capture_levels & levels) {
+    capture_config config = capture_default_config();
+    config.backend = CAPTURE_BACKEND_FILE;
+    config.device = path.c_str();
+    config.realtime = false;
+    capture_context * ctx = capture_init(config);
+    if (!ctx) return -1;
+
+    const int ret = capture_start(ctx);
+    if (ret == 0) {
+        CHECK(capture_active_backend(ctx) == CAPTURE_BACKEND_FILE, "backend %d", capture_active_backend(ctx));
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (capture_is_running(ctx) && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        CHECK(!capture_is_running(ctx), "the capture did not stop at the end of %s", path.c_str());
+        samples.resize(capture_available(ctx));
+        samples.resize(capture_read(ctx, samples.data(), (int) samples.size()));
+        levels = capture_get_levels(ctx);
+    }
+    capture_free(ctx);
+    return ret;
+}
+
+static void check_samples(const char * what, const std::vector<float> & samples, const capture_levels & levels, int n_expected) {
+    CHECK((int) samples.size() == n_expected, "%s: %d samples, expected %d", what, (int) samples.size(), n_expected);
+    CHECK(levels.n_captured == (uint64_t) n_expected && levels.n_dropped == 0, "%s: %llu captured, %llu dropped", what,
+          (unsigned long long) levels.n_captured, (unsigned long long) levels.n_dropped);
+    for (int i = 0; i < (int) samples.size() && i < n_expected; i++) {
+        if (samples[i] != sample_at(i) / 32768.0f) {
+            CHECK(false, "%s: sample %d is %f, expected %f", what, i, samples[i], sample_at(i) / 32768.0f);
+            break;
+        }
+    }
+
+    double sum_sq = 0.0;
+    for (int i = 0; i < 64; i++) sum_sq += (sample_at(i) / 32768.0) * (sample_at(i) / 32768.0);
+    const float rms = (float) std::sqrt(sum_sq / 64);
+    CHECK(levels.peak == 0.5f, "%s: peak %f, expected 0.5", what, levels.peak);
+    CHECK(std::fabs(levels.rms - rms) < 1e-4f, "%s: rms %f, expected %f", what, levels.rms, rms);
+}
+
+int main() {
+    // Half a second: 15 periods of 512 samples and one of 320
+    const int n_samples = 8000;
+
+    const std::string wav = write_temp(make_wav(n_samples, 16000));
+    const std::string wav_44k = write_temp(make_wav(n_samples, 44100));
+    std::vector<uint8_t> pcm;
+    for (int i = 0; i < n_samples; i++) put_u16(pcm, (uint16_t) sample_at(i));
+    const std::string raw = write_temp(pcm);
+    if (wav.empty() || wav_44k.empty() || raw.empty()) {
+        std::fprintf(stderr, "cannot write the test files\n");
+        return 1;
+    }
+
+    std::vector<float> samples;
+    capture_levels levels;
+    CHECK(capture_file(wav, samples, levels) == 0, "capture_start failed on the WAV");
+    check_samples("WAV", samples, levels, n_samples);
+
+    samples.clear();
+    CHECK(capture_file(raw, samples, levels) == 0, "capture_start failed on the raw file");
+    check_samples("raw", samples, levels, n_samples);
+
+    samples.clear();
+    CHECK(capture_file(wav_44k, samples, levels) == -2, "a 44.1 kHz WAV was accepted");
+
+    unlink(wav.c_str());
+    unlink(wav_44k.c_str());
+    unlink(raw.c_str());
+
+    // Either a real device or an error, never silence from the null backend
+    capture_context * ctx = capture_init(capture_default_config());
+    if (capture_start(ctx) == 0) {
+        CHECK(capture_active_backend(ctx) != CAPTURE_BACKEND_NULL, "AUTO opened the null backend");
+    }
+    capture_free(ctx);
+
+    std::printf("%s\n", n_failed == 0 ? "OK" : "FAILED");
+    return n_failed == 0 ? 0 : 1;
+}
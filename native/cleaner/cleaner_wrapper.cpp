@@ -0,0 +1,545 @@
+#include "cleaner_wrapper.h"
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Removed outright. Single words only, so they never swallow real content.
+static const char* CLEANER_FILLERS[] = {
+    "um", "umm", "uhm", "uh", "uhh", "erm", "er", "hmm", "hm", "mm", "mmm",
+};
+
+// Kept, but a sign that the speaker rambled and an LLM pass is worth it
+static const char* CLEANER_HEDGES[] = {
+    "you know", "i mean", "sort of", "kind of", "basically", "literally",
+};
+
+// "like" is only a hedge when set off by a comma ("it was, like, huge")
+static const char* CLEANER_COMMA_HEDGES[] = {
+    "like",
+};
+
+// A sentence opening with one of these is a question ("how do we ...")
+static const char* CLEANER_QUESTION_WORDS[] = {
+    "what", "who", "whom", "whose", "where", "why", "how", "which",
+};
+
+// These only open a question when a subject follows ("can you ...", "is it
+// ...") and not in an imperative ("do the dishes", "do your best"). "when"
+// needs one of them next ("when is ...", not "when we ...").
+static const char* CLEANER_QUESTION_VERBS[] = {
+    "am", "is", "are", "was", "were", "do", "does", "did", "have", "has", "can", "could",
+    "will", "would", "shall", "should", "may", "might", "isn't", "aren't", "wasn't",
+    "weren't", "don't", "doesn't", "didn't", "haven't", "hasn't", "can't", "couldn't",
+    "won't", "wouldn't", "shouldn't",
+};
+
+static const char* CLEANER_QUESTION_SUBJECTS[] = {
+    "i", "you", "we", "he", "she", "it", "they", "this", "that", "these", "those", "there",
+    "anyone", "anybody", "someone", "somebody", "everyone", "anything", "something",
+};
+
+static const char* CLEANER_QUESTION_DETERMINERS[] = {
+    "the", "a", "an", "my", "your", "our", "his", "her", "their",
+};
+
+// Skipped before the words above ("so what ...", "and can you ...")
+static const char* CLEANER_QUESTION_OPENERS[] = {
+    "so", "and", "but", "well", "ok", "okay", "oh", "then",
+};
+
+// Doubled on purpose often enough that the repeat is left alone
+static const char* CLEANER_VALID_REPEATS[] = {
+    "had", "that", "no", "very", "really", "bye", "so", "is",
+};
+
+enum cleaner_action_kind {
+    CLEANER_ACTION_FILLER,
+    CLEANER_ACTION_HEDGE,
+    CLEANER_ACTION_REPLACE,
+};
+
+struct cleaner_action {
+    int kind;
+    bool needs_comma;          // Hedges: only counted next to a comma
+    std::string replacement;   // Replacements: written as is
+};
+
+// Patterns are word sequences, so each trie edge is one word id. The edges
+// of a node are sorted by word id when the trie is compiled.
+struct cleaner_node {
+    std::vector<std::pair<int, int>> next;
+    int action;  // Index into actions, -1 when no pattern ends here
+};
+
+// One whitespace-separated token of the input, as views into it
+struct cleaner_token {
+    std::string_view lead;   // Punctuation before the word: quotes, brackets
+    std::string_view core;   // From the first to the last word character
+    std::string_view trail;  // Punctuation after the word
+    int word;                // Id of the lowercased core, -1 if no pattern uses it
+};
+
+struct cleaner_out {
+    std::string_view lead;
+    std::string_view core;
+    std::string trail;       // Edited: punctuation moves here from dropped words
+    bool verbatim;           // Replacement text, never recapitalized
+};
+
+struct cleaner_context {
+    cleaner_config config;
+
+    // User dictionary, pattern words lowercased and joined by single spaces
+    std::vector<std::pair<std::string, std::string>> replacements;
+    bool dirty;
+
+    // Compiled patterns: the built-in lists and the user dictionary
+    std::deque<std::string> word_storage;
+    std::unordered_map<std::string_view, int> word_ids;
+    std::vector<cleaner_node> nodes;
+    std::vector<cleaner_action> actions;
+    std::unordered_map<std::string_view, bool> valid_repeats;
+
+    // Scratch reused between calls
+    std::vector<cleaner_token> tokens;
+    std::vector<cleaner_out> out;
+    std::string lower;
+    std::string result;
+
+    cleaner_context() : dirty(true) {}
+};
+
+static bool cleaner_is_space(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Letters, digits, apostrophes and anything non-ASCII
+static bool cleaner_is_word_byte(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '\'' || c >= 0x80;
+}
+
+static bool cleaner_is_sentence_end(char c) {
+    return c == '.' || c == '!' || c == '?';
+}
+
+static bool cleaner_has_sentence_end(std::string_view s) {
+    return std::any_of(s.begin(), s.end(), cleaner_is_sentence_end);
+}
+
+static bool cleaner_ends_sentence(std::string_view trail) {
+    // A trailing "..." is the speaker trailing off, the next word goes on
+    return cleaner_has_sentence_end(trail) && trail.find("..") == std::string_view::npos;
+}
+
+static char cleaner_to_lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+static char cleaner_to_upper(char c) {
+    return (c >= 'a' && c <= 'z') ? (char)(c - 'a' + 'A') : c;
+}
+
+static bool cleaner_iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (cleaner_to_lower(a[i]) != cleaner_to_lower(b[i])) return false;
+    }
+    return true;
+}
+
+static bool cleaner_in_list(std::string_view word, const char* const* list, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (cleaner_iequals(word, list[i])) return true;
+    }
+    return false;
+}
+
+#define CLEANER_IN_LIST(word, list) cleaner_in_list(word, list, sizeof(list) / sizeof(list[0]))
+
+static bool cleaner_istarts_with(std::string_view s, std::string_view prefix) {
+    return s.size() >= prefix.size() && cleaner_iequals(s.substr(0, prefix.size()), prefix);
+}
+
+static void cleaner_tokenize(std::string_view text, std::vector<cleaner_token>& tokens) {
+    tokens.clear();
+    size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && cleaner_is_space(text[i])) i++;
+        const size_t begin = i;
+        while (i < text.size() && !cleaner_is_space(text[i])) i++;
+        if (i == begin) break;
+
+        std::string_view span = text.substr(begin, i - begin);
+        size_t first = 0;
+        while (first < span.size() && !cleaner_is_word_byte(span[first])) first++;
+
+        cleaner_token token;
+        token.word = -1;
+        if (first == span.size()) {
+            // Punctuation on its own
+            token.lead = span;
+        } else {
+            size_t last = span.size() - 1;
+            while (!cleaner_is_word_byte(span[last])) last--;
+            token.lead = span.substr(0, first);
+            token.core = span.substr(first, last + 1 - first);
+            token.trail = span.substr(last + 1);
+        }
+        tokens.push_back(token);
+    }
+}
+
+static std::string_view cleaner_lowercase(cleaner_context* ctx, std::string_view s) {
+    ctx->lower.resize(s.size());
+    for (size_t i = 0; i < s.size(); i++) ctx->lower[i] = cleaner_to_lower(s[i]);
+    return ctx->lower;
+}
+
+static int cleaner_intern(cleaner_context* ctx, std::string_view word) {
+    auto it = ctx->word_ids.find(word);
+    if (it != ctx->word_ids.end()) return it->second;
+    ctx->word_storage.emplace_back(word);
+    const int id = (int) ctx->word_ids.size();
+    ctx->word_ids.emplace(ctx->word_storage.back(), id);
+    return id;
+}
+
+static int cleaner_child(const cleaner_context* ctx, int node, int word) {
+    const auto& next = ctx->nodes[node].next;
+    auto it = std::lower_bound(next.begin(), next.end(), std::make_pair(word, -1));
+    return (it != next.end() && it->first == word) ? it->second : -1;
+}
+
+static void cleaner_insert(cleaner_context* ctx, std::string_view pattern, const cleaner_action& action) {
+    std::vector<cleaner_token> words;
+    cleaner_tokenize(pattern, words);
+
+    int node = 0;
+    for (const cleaner_token& w : words) {
+        if (w.core.empty()) continue;
+        const int word = cleaner_intern(ctx, cleaner_lowercase(ctx, w.core));
+        int child = -1;
+        for (const auto& edge : ctx->nodes[node].next) {
+            if (edge.first == word) child = edge.second;
+        }
+        if (child < 0) {
+            child = (int) ctx->nodes.size();
+            ctx->nodes[node].next.emplace_back(word, child);
+            ctx->nodes.push_back({ {}, -1 });
+        }
+        node = child;
+    }
+    if (node == 0) return;
+
+    // A later pattern for the same words wins
+    ctx->actions.push_back(action);
+    ctx->nodes[node].action = (int) ctx->actions.size() - 1;
+}
+
+static void cleaner_compile(cleaner_context* ctx) {
+    ctx->word_storage.clear();
+    ctx->word_ids.clear();
+    ctx->nodes.assign(1, { {}, -1 });
+    ctx->actions.clear();
+
+    for (const char* w : CLEANER_FILLERS) {
+        cleaner_insert(ctx, w, { CLEANER_ACTION_FILLER, false, {} });
+    }
+    for (const char* w : CLEANER_HEDGES) {
+        cleaner_insert(ctx, w, { CLEANER_ACTION_HEDGE, false, {} });
+    }
+    for (const char* w : CLEANER_COMMA_HEDGES) {
+        cleaner_insert(ctx, w, { CLEANER_ACTION_HEDGE, true, {} });
+    }
+    for (const auto& r : ctx->replacements) {
+        cleaner_insert(ctx, r.first, { CLEANER_ACTION_REPLACE, false, r.second });
+    }
+
+    for (cleaner_node& node : ctx->nodes) {
+        std::sort(node.next.begin(), node.next.end());
+    }
+
+    ctx->valid_repeats.clear();
+    for (const char* w : CLEANER_VALID_REPEATS) {
+        ctx->valid_repeats.emplace(w, true);
+    }
+    ctx->dirty = false;
+}
+
+// Collapses doubled punctuation (",," and "..", but not "...") and drops
+// commas and colons next to a sentence end
+static void cleaner_normalize_trail(std::string& trail) {
+    if (trail.size() < 2) return;
+    const bool has_end = cleaner_has_sentence_end(trail);
+    std::string out;
+    for (size_t i = 0; i < trail.size(); i++) {
+        const char c = trail[i];
+        if (has_end && (c == ',' || c == ';' || c == ':')) continue;
+        if (c == '.') {
+            size_t run = 1;
+            while (i + run < trail.size() && trail[i + run] == '.') run++;
+            out.append(run >= 3 ? "..." : ".");
+            i += run - 1;
+            continue;
+        }
+        if (!out.empty() && out.back() == c) continue;
+        out.push_back(c);
+    }
+    trail.swap(out);
+}
+
+// Appends a word to the output, dropping it if it repeats the previous one
+static void cleaner_push_word(cleaner_context* ctx, const cleaner_token& token, cleaner_result& result) {
+    std::vector<cleaner_out>& out = ctx->out;
+
+    if (token.core.empty()) {
+        // Stray punctuation belongs to the word before it
+        if (!out.empty()) out.back().trail.append(token.lead);
+        return;
+    }
+
+    if (ctx->config.remove_stutters && !out.empty() && !out.back().verbatim && token.lead.empty()) {
+        cleaner_out& prev = out.back();
+
+        // "the the": the repeat goes, its punctuation stays
+        if (prev.trail.empty() && cleaner_iequals(prev.core, token.core) &&
+            ctx->valid_repeats.find(cleaner_lowercase(ctx, token.core)) == ctx->valid_repeats.end()) {
+            prev.trail.assign(token.trail);
+            result.n_stutters++;
+            return;
+        }
+
+        // "th- the": the false start goes
+        if (prev.trail == "-" && prev.core.size() < token.core.size() && cleaner_istarts_with(token.core, prev.core)) {
+            out.pop_back();
+            result.n_stutters++;
+        }
+    }
+
+    out.push_back({ token.lead, token.core, std::string(token.trail), false });
+}
+
+// Moves the punctuation of dropped words (fillers, empty replacements) that
+// still matters onto the word before them
+static void cleaner_drop_words(cleaner_context* ctx, const cleaner_token& last) {
+    if (ctx->out.empty()) return;
+    std::string& trail = ctx->out.back().trail;
+    if (cleaner_has_sentence_end(last.trail)) {
+        // "so um. Then" keeps its full stop on the word before the filler
+        if (!cleaner_has_sentence_end(trail)) {
+            trail.erase(std::remove_if(trail.begin(), trail.end(), [](char c) { return c == ',' || c == ';' || c == ':'; }), trail.end());
+            for (char c : last.trail) {
+                if (cleaner_is_sentence_end(c)) trail.push_back(c);
+            }
+        }
+    } else if (last.trail.find(',') != std::string_view::npos && !trail.empty() && trail.back() == ',') {
+        // "I think, um, it's fine": the commas only set the filler off
+        trail.pop_back();
+    }
+}
+
+// Whether the words from out[begin] on read as a question
+static bool cleaner_is_question(const cleaner_context* ctx, size_t begin) {
+    const std::vector<cleaner_out>& out = ctx->out;
+    while (begin + 1 < out.size() && !out[begin].verbatim && CLEANER_IN_LIST(out[begin].core, CLEANER_QUESTION_OPENERS)) {
+        begin++;
+    }
+    if (begin >= out.size() || out[begin].verbatim) return false;
+    if (CLEANER_IN_LIST(out[begin].core, CLEANER_QUESTION_WORDS)) return true;
+    if (begin + 1 >= out.size() || !out[begin].trail.empty()) return false;
+    const std::string_view first = out[begin].core;
+    const std::string_view second = out[begin + 1].core;
+    if (cleaner_iequals(first, "when")) return CLEANER_IN_LIST(second, CLEANER_QUESTION_VERBS);
+    if (!CLEANER_IN_LIST(first, CLEANER_QUESTION_VERBS)) return false;
+    return CLEANER_IN_LIST(second, CLEANER_QUESTION_SUBJECTS) ||
+           (!cleaner_iequals(first, "do") && CLEANER_IN_LIST(second, CLEANER_QUESTION_DETERMINERS));
+}
+
+static float cleaner_confidence(const cleaner_result& result, bool internal_punctuation, bool annotation) {
+    float confidence = 1.0f;
+    confidence -= 0.25f * result.n_hedges;
+    confidence -= 0.03f * (result.n_fillers + result.n_stutters);
+    // Long dictations are more likely to hold recognition errors worth a rewrite
+    if (result.n_words > 15) {
+        confidence -= std::min(0.4f, 0.02f * (result.n_words - 15));
+    }
+    // A run-on sentence needs punctuation only a language model can place
+    if (result.n_words >= 10 && !internal_punctuation) {
+        confidence -= 0.25f;
+    }
+    // Whisper annotations such as [BLANK_AUDIO] or (music)
+    if (annotation) {
+        confidence -= 0.5f;
+    }
+    return std::max(0.0f, std::min(1.0f, confidence));
+}
+
+extern "C" {
+
+cleaner_config cleaner_default_config(void) {
+    cleaner_config config;
+    config.remove_fillers = true;
+    config.remove_stutters = true;
+    config.capitalize = true;
+    config.terminal_punctuation = true;
+    return config;
+}
+
+cleaner_context* cleaner_init(cleaner_config config) {
+    cleaner_context* ctx = new cleaner_context();
+    ctx->config = config;
+    cleaner_compile(ctx);
+    return ctx;
+}
+
+void cleaner_free(cleaner_context* ctx) {
+    delete ctx;
+}
+
+int cleaner_add_replacement(cleaner_context* ctx, const char* from, const char* to) {
+    if (!ctx || !from || !to) return -1;
+
+    std::vector<cleaner_token> words;
+    cleaner_tokenize(from, words);
+    std::string pattern;
+    for (const cleaner_token& w : words) {
+        if (w.core.empty()) continue;
+        if (!pattern.empty()) pattern.push_back(' ');
+        pattern.append(cleaner_lowercase(ctx, w.core));
+    }
+    if (pattern.empty()) return -1;
+
+    // Written between single spaces, so its own spacing is collapsed
+    std::string replacement;
+    for (const char* c = to; *c; c++) {
+        if (!cleaner_is_space((unsigned char) *c)) {
+            replacement.push_back(*c);
+        } else if (!replacement.empty() && replacement.back() != ' ') {
+            replacement.push_back(' ');
+        }
+    }
+    if (!replacement.empty() && replacement.back() == ' ') replacement.pop_back();
+
+    ctx->replacements.emplace_back(pattern, replacement);
+    ctx->dirty = true;
+    return 0;
+}
+
+void cleaner_clear_replacements(cleaner_context* ctx) {
+    if (!ctx) return;
+    ctx->replacements.clear();
+    ctx->dirty = true;
+}
+
+cleaner_result cleaner_clean(cleaner_context* ctx, const char* text) {
+    cleaner_result result = {};
+    if (!ctx || !text) return result;
+    if (ctx->dirty) cleaner_compile(ctx);
+
+    std::vector<cleaner_token>& tokens = ctx->tokens;
+    cleaner_tokenize(text, tokens);
+    bool annotation = false;
+    for (cleaner_token& token : tokens) {
+        if (token.core.empty()) continue;
+        auto it = ctx->word_ids.find(cleaner_lowercase(ctx, token.core));
+        token.word = it != ctx->word_ids.end() ? it->second : -1;
+        annotation = annotation || token.lead.find_first_of("[(*") != std::string_view::npos;
+    }
+
+    ctx->out.clear();
+    const size_t n = tokens.size();
+    for (size_t i = 0; i < n;) {
+        // Longest pattern starting here; patterns never span punctuation
+        int action = -1;
+        size_t end = i;
+        int node = 0;
+        for (size_t j = i; j < n && tokens[j].word >= 0; j++) {
+            if (j > i && (!tokens[j - 1].trail.empty() || !tokens[j].lead.empty())) break;
+            node = cleaner_child(ctx, node, tokens[j].word);
+            if (node < 0) break;
+            if (ctx->nodes[node].action >= 0) {
+                action = ctx->nodes[node].action;
+                end = j + 1;
+            }
+        }
+
+        if (action < 0) {
+            cleaner_push_word(ctx, tokens[i], result);
+            i++;
+            continue;
+        }
+
+        const cleaner_action& a = ctx->actions[action];
+        if (a.kind == CLEANER_ACTION_REPLACE) {
+            if (a.replacement.empty()) {
+                cleaner_drop_words(ctx, tokens[end - 1]);
+            } else {
+                ctx->out.push_back({ tokens[i].lead, a.replacement, std::string(tokens[end - 1].trail), true });
+            }
+            result.n_replacements++;
+        } else if (a.kind == CLEANER_ACTION_FILLER && ctx->config.remove_fillers) {
+            cleaner_drop_words(ctx, tokens[end - 1]);
+            result.n_fillers++;
+        } else {
+            if (a.kind == CLEANER_ACTION_HEDGE) {
+                const bool comma = tokens[end - 1].trail.find(',') != std::string_view::npos ||
+                                   (!ctx->out.empty() && ctx->out.back().trail.find(',') != std::string::npos);
+                if (!a.needs_comma || comma) result.n_hedges++;
+            }
+            for (size_t j = i; j < end; j++) {
+                cleaner_push_word(ctx, tokens[j], result);
+            }
+        }
+        i = end;
+    }
+
+    // Write out with single spaces, fixing punctuation and capitals
+    std::string& s = ctx->result;
+    s.clear();
+    bool sentence_start = true;
+    size_t sentence_begin = 0;
+    bool internal_punctuation = false;
+    for (size_t k = 0; k < ctx->out.size(); k++) {
+        cleaner_out& o = ctx->out[k];
+        cleaner_normalize_trail(o.trail);
+        if (sentence_start) sentence_begin = k;
+
+        if (k + 1 == ctx->out.size() && ctx->config.terminal_punctuation &&
+            !cleaner_has_sentence_end(o.trail) && o.trail.find_first_of("\"')]") == std::string::npos) {
+            while (!o.trail.empty() && (o.trail.back() == ',' || o.trail.back() == ';' ||
+                                        o.trail.back() == ':' || o.trail.back() == '-')) {
+                o.trail.pop_back();
+            }
+            o.trail.push_back(cleaner_is_question(ctx, sentence_begin) ? '?' : '.');
+        }
+
+        if (!s.empty()) s.push_back(' ');
+        s.append(o.lead);
+        const size_t core_at = s.size();
+        s.append(o.core);
+        if (ctx->config.capitalize && !o.verbatim) {
+            // The pronoun "I", alone or in a contraction
+            if ((o.core.size() == 1 || o.core[1] == '\'') && o.core[0] == 'i') {
+                s[core_at] = 'I';
+            }
+            if (sentence_start) {
+                s[core_at] = cleaner_to_upper(s[core_at]);
+            }
+        }
+        s.append(o.trail);
+
+        if (k + 1 < ctx->out.size() && !o.trail.empty()) internal_punctuation = true;
+        sentence_start = cleaner_ends_sentence(o.trail);
+        result.n_words++;
+    }
+
+    result.text = s.c_str();
+    result.confidence = cleaner_confidence(result, internal_punctuation, annotation);
+    return result;
+}
+
+}
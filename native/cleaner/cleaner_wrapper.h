@@ -0,0 +1,50 @@
+#ifndef CLEANER_WRAPPER_H
+#define CLEANER_WRAPPER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct cleaner_context cleaner_context;
+
+typedef struct {
+    bool remove_fillers;        // "um", "uh", "erm", ...
+    bool remove_stutters;       // "the the", "th- the"
+    bool capitalize;            // Sentence starts and the pronoun "I"
+    bool terminal_punctuation;  // End the text with a period, or "?" after a question, if it has no closing punctuation
+} cleaner_config;
+
+typedef struct {
+    const char* text;     // Owned by the context, valid until the next cleaner_clean
+    float confidence;     // 0 to 1: how sure the fast path is that an LLM pass would not change much
+    int n_words;          // In the cleaned text
+    int n_fillers;        // Removed
+    int n_hedges;         // Left in place ("you know", "I mean", "like,"); lowers confidence
+    int n_stutters;       // Removed
+    int n_replacements;   // From the user dictionary
+} cleaner_result;
+
+cleaner_config cleaner_default_config(void);
+
+cleaner_context* cleaner_init(cleaner_config config);
+void cleaner_free(cleaner_context* ctx);
+
+// User dictionary. from is matched case-insensitively on whole words and may
+// span several words; the match is replaced by to as written, with runs of
+// whitespace collapsed. An empty to deletes the words. Later entries for the
+// same words replace earlier ones. Returns 0, or -1 if from has no words.
+int cleaner_add_replacement(cleaner_context* ctx, const char* from, const char* to);
+void cleaner_clear_replacements(cleaner_context* ctx);
+
+// Deterministic cleanup of one transcript: filler and stutter removal,
+// replacements, spacing and punctuation normalization, capitalization.
+cleaner_result cleaner_clean(cleaner_context* ctx, const char* text);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
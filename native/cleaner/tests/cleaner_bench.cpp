@@ -0,0 +1,76 @@
+// Times cleaner_clean over the raw texts of a corpus file. With a budget in
+// microseconds, fails if the mean time per call is over it.
+
+#include "cleaner_wrapper.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <corpus.tsv> [iterations] [max_us_per_call]" << std::endl;
+        return 2;
+    }
+    const int n_iter = argc > 2 ? std::atoi(argv[2]) : 20000;
+    const double max_us = argc > 3 ? std::atof(argv[3]) : 0.0;
+
+    std::ifstream corpus(argv[1]);
+    if (!corpus) {
+        std::cerr << "Cleaner bench: cannot open " << argv[1] << std::endl;
+        return 2;
+    }
+
+    std::vector<std::string> texts;
+    std::string line;
+    while (std::getline(corpus, line)) {
+        if (line.empty() || line[0] == '#' || line[0] == '!') continue;
+        texts.push_back(line.substr(0, line.find('\t')));
+    }
+    if (texts.empty() || n_iter <= 0) {
+        std::cerr << "Cleaner bench: nothing to run" << std::endl;
+        return 2;
+    }
+
+    cleaner_context* ctx = cleaner_init(cleaner_default_config());
+    if (!ctx) {
+        std::cerr << "Cleaner bench: cleaner_init failed" << std::endl;
+        return 2;
+    }
+    cleaner_add_replacement(ctx, "chat gpt", "ChatGPT");
+    cleaner_add_replacement(ctx, "kubernetes", "k8s");
+
+    // The first pass builds the trie and grows the buffers
+    size_t bytes = 0;
+    for (const std::string& text : texts) {
+        cleaner_clean(ctx, text.c_str());
+        bytes += text.size();
+    }
+
+    double sink = 0.0;
+    const auto t_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n_iter; i++) {
+        for (const std::string& text : texts) {
+            sink += cleaner_clean(ctx, text.c_str()).confidence;
+        }
+    }
+    const auto t_end = std::chrono::steady_clock::now();
+
+    cleaner_free(ctx);
+
+    const double n_calls = (double) n_iter * texts.size();
+    const double us = std::chrono::duration<double, std::micro>(t_end - t_start).count();
+    const double us_per_call = us / n_calls;
+    std::printf("%zu texts x %d iterations: %.3f us per call, %.1f MB/s (checksum %.0f)\n",
+                texts.size(), n_iter, us_per_call, bytes * n_iter / us, sink);
+
+    if (max_us > 0.0 && us_per_call > max_us) {
+        std::fprintf(stderr, "Cleaner bench: %.3f us per call is over the %.3f us budget\n", us_per_call, max_us);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Runs every case of a corpus file through cleaner_clean and checks the
+// cleaned text and the confidence range. See cleaner_corpus.tsv for the format.
+
+#include "cleaner_wrapper.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static std::vector<std::string> split_tabs(const std::string& line) {
+    std::vector<std::string> fields;
+    std::string field;
+    std::istringstream in(line);
+    while (std::getline(in, field, '\t')) {
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <corpus.tsv>" << std::endl;
+        return 2;
+    }
+
+    std::ifstream corpus(argv[1]);
+    if (!corpus) {
+        std::cerr << "Cleaner test: cannot open " << argv[1] << std::endl;
+        return 2;
+    }
+
+    cleaner_context* ctx = cleaner_init(cleaner_default_config());
+    if (!ctx) {
+        std::cerr << "Cleaner test: cleaner_init failed" << std::endl;
+        return 2;
+    }
+
+    int n_cases = 0;
+    int n_failed = 0;
+    int line_no = 0;
+    std::string line;
+    while (std::getline(corpus, line)) {
+        line_no++;
+        if (line.empty() || line[0] == '#') continue;
+
+        const std::vector<std::string> fields = split_tabs(line);
+        if (fields[0] == "!replace") {
+            // getline drops an empty last field, so a missing to is an empty one
+            const std::string to = fields.size() > 2 ? fields[2] : "";
+            if (fields.size() < 2 || fields.size() > 3 || cleaner_add_replacement(ctx, fields[1].c_str(), to.c_str()) != 0) {
+                std::cerr << argv[1] << ":" << line_no << ": bad replacement" << std::endl;
+                n_failed++;
+            }
+            continue;
+        }
+        if (fields.size() != 4) {
+            std::cerr << argv[1] << ":" << line_no << ": expected 4 tab-separated fields" << std::endl;
+            n_failed++;
+            continue;
+        }
+
+        const std::string& raw = fields[0];
+        const std::string& expected = fields[1];
+        const float min_confidence = std::strtof(fields[2].c_str(), nullptr);
+        const float max_confidence = std::strtof(fields[3].c_str(), nullptr);
+
+        const cleaner_result result = cleaner_clean(ctx, raw.c_str());
+        const std::string text = result.text ? result.text : "";
+        n_cases++;
+
+        bool ok = true;
+        if (expected != "*" && text != expected) {
+            std::cerr << argv[1] << ":" << line_no << ": \"" << raw << "\"\n"
+                      << "    expected \"" << expected << "\"\n"
+                      << "    got      \"" << text << "\"" << std::endl;
+            ok = false;
+        }
+        // Confidences are sums of a few hundredths, so compare with some slack
+        if (result.confidence < min_confidence - 1e-4f || result.confidence > max_confidence + 1e-4f) {
+            std::fprintf(stderr, "%s:%d: \"%s\": confidence %.2f outside [%.2f, %.2f]\n",
+                         argv[1], line_no, raw.c_str(), result.confidence, min_confidence, max_confidence);
+            ok = false;
+        }
+        if (!ok) n_failed++;
+    }
+
+    cleaner_free(ctx);
+
+    std::printf("%d cases, %d failed\n", n_cases, n_failed);
+    return n_failed == 0 && n_cases > 0 ? 0 : 1;
+}
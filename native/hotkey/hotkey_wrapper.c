@@ -1,41 +1,104 @@
 #include "hotkey_wrapper.h"
 #include <X11/Xlib.h>
 #include <X11/keysym.h>
+#ifdef HOTKEY_HAVE_XI2
+#include <X11/extensions/XInput2.h>
+#endif
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+// X11 KeyCodes are evdev codes shifted by 8 on every evdev-based server
+#define HOTKEY_EVDEV_OFFSET 8
+
+// Resolves hotkeys without an X display, in both directions
+static const struct {
+    const char* name;
+    uint16_t code;
+} HOTKEY_EVDEV_KEYS[] = {
+    { "F1", KEY_F1 }, { "F2", KEY_F2 }, { "F3", KEY_F3 }, { "F4", KEY_F4 },
+    { "F5", KEY_F5 }, { "F6", KEY_F6 }, { "F7", KEY_F7 }, { "F8", KEY_F8 },
+    { "F9", KEY_F9 }, { "F10", KEY_F10 }, { "F11", KEY_F11 }, { "F12", KEY_F12 },
+    { "Pause", KEY_PAUSE }, { "Scroll_Lock", KEY_SCROLLLOCK }, { "Print", KEY_SYSRQ },
+    { "Insert", KEY_INSERT }, { "Menu", KEY_COMPOSE }, { "Escape", KEY_ESC },
+    { "space", KEY_SPACE }, { "Caps_Lock", KEY_CAPSLOCK },
+    { "Control_L", KEY_LEFTCTRL }, { "Control_R", KEY_RIGHTCTRL },
+    { "Alt_L", KEY_LEFTALT }, { "Alt_R", KEY_RIGHTALT },
+    { "Shift_L", KEY_LEFTSHIFT }, { "Shift_R", KEY_RIGHTSHIFT },
+    { "Super_L", KEY_LEFTMETA }, { "Super_R", KEY_RIGHTMETA },
+};
+
+#define HOTKEY_N_EVDEV_KEYS (sizeof(HOTKEY_EVDEV_KEYS) / sizeof(HOTKEY_EVDEV_KEYS[0]))
+
+// One connection for the query functions, opened on first use. The listener
+// thread has its own.
+static pthread_mutex_t g_display_lock = PTHREAD_MUTEX_INITIALIZER;
+static Display* g_display = NULL;
+
+static Display* hotkey_display_lock(void) {
+    pthread_mutex_lock(&g_display_lock);
+    if (!g_display) g_display = XOpenDisplay(NULL);
+    if (!g_display) pthread_mutex_unlock(&g_display_lock);
+    return g_display;
+}
+
+static void hotkey_display_unlock(void) {
+    pthread_mutex_unlock(&g_display_lock);
+}
 
 bool x11_is_key_pressed(uint32_t key_code) {
-    Display *d = XOpenDisplay(NULL);
+    Display *d = hotkey_display_lock();
     if (!d) return false;
 
     char keys[32];
     XQueryKeymap(d, keys);
-    XCloseDisplay(d);
+    hotkey_display_unlock();
 
     return (keys[key_code / 8] & (1 << (key_code % 8))) != 0;
 }
 
 uint32_t x11_get_keycode(const char* keysym_name) {
-    Display *d = XOpenDisplay(NULL);
-    if (!d) return 0;
+    Display *d = hotkey_display_lock();
+    if (!d) {
+        for (size_t i = 0; i < HOTKEY_N_EVDEV_KEYS; i++) {
+            if (strcmp(HOTKEY_EVDEV_KEYS[i].name, keysym_name) == 0) {
+                return HOTKEY_EVDEV_KEYS[i].code + HOTKEY_EVDEV_OFFSET;
+            }
+        }
+        return 0;
+    }
 
     KeySym sym = XStringToKeysym(keysym_name);
     if (sym == NoSymbol) {
-        XCloseDisplay(d);
+        hotkey_display_unlock();
         return 0;
     }
 
     KeyCode code = XKeysymToKeycode(d, sym);
-    XCloseDisplay(d);
+    hotkey_display_unlock();
     return (uint32_t)code;
 }
 
 uint32_t x11_get_pressed_keycode() {
-    Display *d = XOpenDisplay(NULL);
+    Display *d = hotkey_display_lock();
     if (!d) return 0;
 
     char keys[32];
     XQueryKeymap(d, keys);
-    XCloseDisplay(d);
+    hotkey_display_unlock();
 
     for (int i = 0; i < 256; i++) {
         if (keys[i / 8] & (1 << (i % 8))) {
@@ -47,16 +110,487 @@ uint32_t x11_get_pressed_keycode() {
 }
 
 const char* x11_get_keysym_name(uint32_t key_code) {
-    Display *d = XOpenDisplay(NULL);
-    if (!d) return NULL;
+    Display *d = hotkey_display_lock();
+    if (!d) {
+        for (size_t i = 0; i < HOTKEY_N_EVDEV_KEYS; i++) {
+            if ((uint32_t)(HOTKEY_EVDEV_KEYS[i].code + HOTKEY_EVDEV_OFFSET) == key_code) {
+                return HOTKEY_EVDEV_KEYS[i].name;
+            }
+        }
+        return NULL;
+    }
 
     KeySym sym = XKeycodeToKeysym(d, (KeyCode)key_code, 0);
+    hotkey_display_unlock();
     if (sym == NoSymbol) {
-        XCloseDisplay(d);
         return NULL;
     }
 
-    const char* name = XKeysymToString(sym);
-    XCloseDisplay(d);
-    return name;
+    return XKeysymToString(sym);
+}
+
+// Mirror of Dart_CObject from dart_api.h (a stable ABI), only the kinds posted here
+enum {
+    HOTKEY_DART_BOOL  = 1,
+    HOTKEY_DART_INT64 = 3,
+    HOTKEY_DART_ARRAY = 6,
+};
+
+typedef struct hotkey_dart_cobject {
+    int32_t type;
+    union {
+        bool as_bool;
+        int64_t as_int64;
+        struct {
+            intptr_t length;
+            struct hotkey_dart_cobject** values;
+        } as_array;
+        void* reserved[5]; // size of the full union in dart_api.h
+    } value;
+} hotkey_dart_cobject;
+
+typedef bool (*hotkey_dart_post_cobject_fn)(int64_t port, hotkey_dart_cobject* message);
+
+static _Atomic(hotkey_dart_post_cobject_fn) g_dart_post_cobject = NULL;
+
+#define HOTKEY_MAX_DEVICES 64
+
+typedef struct {
+    pthread_t thread;
+    bool running;
+    hotkey_backend backend;
+    int64_t port;
+    int stop_fd;            // eventfd, written to stop the thread
+
+    // XI2 and keymap backends
+    Display* display;
+    int xi_opcode;
+
+    // evdev backend
+    int epoll_fd;
+    int inotify_fd;
+    int n_devices;
+    int device_fds[HOTKEY_MAX_DEVICES];
+    char device_names[HOTKEY_MAX_DEVICES][16];
+
+    // A key is down while any device holds it, so only its first press and
+    // last release are posted. Each source is an evdev device slot or an XI2
+    // source id; the keymap backend only has source 0.
+    uint8_t source_pressed[HOTKEY_MAX_DEVICES][32];
+    uint8_t press_count[256];
+    uint8_t pressed[32];    // Keys held on any source
+} hotkey_listener;
+
+static pthread_mutex_t g_listener_lock = PTHREAD_MUTEX_INITIALIZER;
+static hotkey_listener g_listener;
+
+static int64_t hotkey_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void hotkey_emit(hotkey_listener* l, int source, uint32_t key_code, bool pressed, int64_t timestamp_us) {
+    if (key_code > 255 || source < 0 || source >= HOTKEY_MAX_DEVICES) return;
+    const uint8_t bit = (uint8_t)(1 << (key_code % 8));
+    uint8_t* held = &l->source_pressed[source][key_code / 8];
+    if (((*held & bit) != 0) == pressed) return;
+    *held ^= bit;
+
+    if (pressed ? l->press_count[key_code]++ > 0 : --l->press_count[key_code] > 0) return;
+    l->pressed[key_code / 8] ^= bit;
+
+    hotkey_dart_post_cobject_fn post = atomic_load(&g_dart_post_cobject);
+    if (!post) return;
+
+    hotkey_dart_cobject code, state, time;
+    code.type = HOTKEY_DART_INT64;
+    code.value.as_int64 = key_code;
+    state.type = HOTKEY_DART_BOOL;
+    state.value.as_bool = pressed;
+    time.type = HOTKEY_DART_INT64;
+    time.value.as_int64 = timestamp_us;
+
+    hotkey_dart_cobject* values[3] = { &code, &state, &time };
+    hotkey_dart_cobject message;
+    message.type = HOTKEY_DART_ARRAY;
+    message.value.as_array.length = 3;
+    message.value.as_array.values = values;
+    post(l->port, &message);
+}
+
+// --- XInput2 ---------------------------------------------------------------
+
+static bool hotkey_xi2_open(hotkey_listener* l) {
+#ifdef HOTKEY_HAVE_XI2
+    Display* d = XOpenDisplay(NULL);
+    if (!d) return false;
+
+    int event, error;
+    int major = 2, minor = 1;
+    if (!XQueryExtension(d, "XInputExtension", &l->xi_opcode, &event, &error) ||
+        XIQueryVersion(d, &major, &minor) != Success) {
+        XCloseDisplay(d);
+        return false;
+    }
+
+    // Raw events reach us whichever window has focus, and even during grabs
+    unsigned char mask[XIMaskLen(XI_LASTEVENT)] = { 0 };
+    XISetMask(mask, XI_RawKeyPress);
+    XISetMask(mask, XI_RawKeyRelease);
+    XIEventMask event_mask;
+    event_mask.deviceid = XIAllMasterDevices;
+    event_mask.mask_len = sizeof(mask);
+    event_mask.mask = mask;
+    XISelectEvents(d, DefaultRootWindow(d), &event_mask, 1);
+    XFlush(d);
+
+    l->display = d;
+    return true;
+#else
+    (void)l;
+    return false;
+#endif
+}
+
+static void hotkey_xi2_run(hotkey_listener* l) {
+#ifdef HOTKEY_HAVE_XI2
+    Display* d = l->display;
+    struct pollfd fds[2] = {
+        { ConnectionNumber(d), POLLIN, 0 },
+        { l->stop_fd, POLLIN, 0 },
+    };
+
+    for (;;) {
+        // Events already read into Xlib's queue do not wake poll
+        while (XPending(d)) {
+            XEvent e;
+            XNextEvent(d, &e);
+            XGenericEventCookie* cookie = &e.xcookie;
+            if (cookie->type != GenericEvent || cookie->extension != l->xi_opcode || !XGetEventData(d, cookie)) {
+                continue;
+            }
+            const XIRawEvent* raw = (const XIRawEvent*)cookie->data;
+            if (!(raw->flags & XIKeyRepeat)) {
+                hotkey_emit(l, raw->sourceid % HOTKEY_MAX_DEVICES, (uint32_t)raw->detail,
+                            cookie->evtype == XI_RawKeyPress, hotkey_now_us());
+            }
+            XFreeEventData(d, cookie);
+        }
+
+        if (poll(fds, 2, -1) < 0 && errno != EINTR) break;
+        if (fds[1].revents) break;
+        if (fds[0].revents & (POLLERR | POLLHUP)) {
+            fprintf(stderr, "hotkey: X connection lost\n");
+            break;
+        }
+    }
+#else
+    (void)l;
+#endif
+}
+
+// --- evdev -----------------------------------------------------------------
+
+#define HOTKEY_BITS_PER_LONG (sizeof(unsigned long) * 8)
+#define HOTKEY_NLONGS(n) (((n) + HOTKEY_BITS_PER_LONG - 1) / HOTKEY_BITS_PER_LONG)
+
+static bool hotkey_test_bit(const unsigned long* bits, int bit) {
+    return (bits[bit / HOTKEY_BITS_PER_LONG] >> (bit % HOTKEY_BITS_PER_LONG)) & 1;
+}
+
+// Anything with keys below the button range, so mice are left out but
+// pedals and macro pads that only have function keys are not
+static bool hotkey_evdev_is_keyboard(int fd) {
+    unsigned long ev_bits[HOTKEY_NLONGS(EV_MAX + 1)] = { 0 };
+    if (ioctl(fd, EVIOCGBIT(0, sizeof(ev_bits)), ev_bits) < 0 || !hotkey_test_bit(ev_bits, EV_KEY)) {
+        return false;
+    }
+
+    unsigned long key_bits[HOTKEY_NLONGS(KEY_MAX + 1)] = { 0 };
+    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(key_bits)), key_bits) < 0) {
+        return false;
+    }
+    for (int code = KEY_ESC; code < BTN_MISC; code++) {
+        if (hotkey_test_bit(key_bits, code)) return true;
+    }
+    return false;
+}
+
+static void hotkey_evdev_add(hotkey_listener* l, const char* name) {
+    if (strncmp(name, "event", 5) != 0 || l->n_devices == HOTKEY_MAX_DEVICES) return;
+    for (int i = 0; i < l->n_devices; i++) {
+        if (strcmp(l->device_names[i], name) == 0) return;
+    }
+
+    char path[64];
+    snprintf(path, sizeof(path), "/dev/input/%s", name);
+    int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return;
+    if (!hotkey_evdev_is_keyboard(fd)) {
+        close(fd);
+        return;
+    }
+
+    // Event times on the same clock as the other backends
+    int clock = CLOCK_MONOTONIC;
+    ioctl(fd, EVIOCSCLOCKID, &clock);
+
+    struct epoll_event ev = { 0 };
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(l->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        close(fd);
+        return;
+    }
+
+    l->device_fds[l->n_devices] = fd;
+    snprintf(l->device_names[l->n_devices], sizeof(l->device_names[0]), "%s", name);
+    l->n_devices++;
+}
+
+static void hotkey_evdev_remove(hotkey_listener* l, int fd) {
+    for (int i = 0; i < l->n_devices; i++) {
+        if (l->device_fds[i] != fd) continue;
+        epoll_ctl(l->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+        close(fd);
+
+        // Keys held on an unplugged keyboard are released
+        const int64_t now = hotkey_now_us();
+        for (uint32_t key_code = 0; key_code < 256; key_code++) {
+            if (l->source_pressed[i][key_code / 8] & (1 << (key_code % 8))) {
+                hotkey_emit(l, i, key_code, false, now);
+            }
+        }
+
+        l->n_devices--;
+        l->device_fds[i] = l->device_fds[l->n_devices];
+        memcpy(l->device_names[i], l->device_names[l->n_devices], sizeof(l->device_names[0]));
+        memcpy(l->source_pressed[i], l->source_pressed[l->n_devices], sizeof(l->source_pressed[0]));
+        memset(l->source_pressed[l->n_devices], 0, sizeof(l->source_pressed[0]));
+        return;
+    }
+}
+
+static void hotkey_evdev_close(hotkey_listener* l) {
+    for (int i = 0; i < l->n_devices; i++) close(l->device_fds[i]);
+    l->n_devices = 0;
+    if (l->inotify_fd >= 0) close(l->inotify_fd);
+    if (l->epoll_fd >= 0) close(l->epoll_fd);
+    l->inotify_fd = -1;
+    l->epoll_fd = -1;
+}
+
+static bool hotkey_evdev_open(hotkey_listener* l) {
+    l->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (l->epoll_fd < 0) return false;
+
+    DIR* dir = opendir("/dev/input");
+    if (dir) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL) {
+            hotkey_evdev_add(l, entry->d_name);
+        }
+        closedir(dir);
+    }
+
+    // No readable keyboard usually means the user is not in the input group
+    if (l->n_devices == 0) {
+        hotkey_evdev_close(l);
+        return false;
+    }
+
+    // Keyboards plugged in later. udev fixes permissions after creating the
+    // node, hence IN_ATTRIB.
+    l->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (l->inotify_fd >= 0 && inotify_add_watch(l->inotify_fd, "/dev/input", IN_CREATE | IN_ATTRIB) >= 0) {
+        struct epoll_event ev = { 0 };
+        ev.events = EPOLLIN;
+        ev.data.fd = l->inotify_fd;
+        epoll_ctl(l->epoll_fd, EPOLL_CTL_ADD, l->inotify_fd, &ev);
+    }
+    return true;
+}
+
+static void hotkey_evdev_read(hotkey_listener* l, int fd) {
+    int device = 0;
+    while (device < l->n_devices && l->device_fds[device] != fd) device++;
+
+    struct input_event events[64];
+    for (;;) {
+        const ssize_t n = read(fd, events, sizeof(events));
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) return;
+        if (n <= 0) {
+            // Unplugged
+            hotkey_evdev_remove(l, fd);
+            return;
+        }
+
+        for (size_t i = 0; i < (size_t)n / sizeof(events[0]); i++) {
+            const struct input_event* ev = &events[i];
+            // value 2 is auto-repeat
+            if (ev->type != EV_KEY || ev->value > 1) continue;
+            const int64_t timestamp_us = (int64_t)ev->input_event_sec * 1000000 + ev->input_event_usec;
+            hotkey_emit(l, device, ev->code + HOTKEY_EVDEV_OFFSET, ev->value == 1, timestamp_us);
+        }
+    }
+}
+
+static void hotkey_evdev_hotplug(hotkey_listener* l) {
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t n;
+    while ((n = read(l->inotify_fd, buffer, sizeof(buffer))) > 0) {
+        for (char* p = buffer; p < buffer + n;) {
+            const struct inotify_event* ev = (const struct inotify_event*)p;
+            if (ev->len > 0) hotkey_evdev_add(l, ev->name);
+            p += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+}
+
+static void hotkey_evdev_run(hotkey_listener* l) {
+    struct epoll_event ev = { 0 };
+    ev.events = EPOLLIN;
+    ev.data.fd = l->stop_fd;
+    epoll_ctl(l->epoll_fd, EPOLL_CTL_ADD, l->stop_fd, &ev);
+
+    for (;;) {
+        struct epoll_event ready[16];
+        const int n = epoll_wait(l->epoll_fd, ready, 16, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            const int fd = ready[i].data.fd;
+            if (fd == l->stop_fd) return;
+            if (fd == l->inotify_fd) {
+                hotkey_evdev_hotplug(l);
+            } else {
+                hotkey_evdev_read(l, fd);
+            }
+        }
+    }
+}
+
+// --- XQueryKeymap ----------------------------------------------------------
+
+static bool hotkey_keymap_open(hotkey_listener* l) {
+    l->display = XOpenDisplay(NULL);
+    return l->display != NULL;
+}
+
+static void hotkey_keymap_run(hotkey_listener* l) {
+    struct pollfd stop = { l->stop_fd, POLLIN, 0 };
+    for (;;) {
+        const int r = poll(&stop, 1, 10);
+        if (r > 0 || (r < 0 && errno != EINTR)) break;
+
+        char keys[32];
+        XQueryKeymap(l->display, keys);
+        const int64_t now = hotkey_now_us();
+        for (int i = 0; i < 32; i++) {
+            uint8_t changed = (uint8_t)keys[i] ^ l->pressed[i];
+            while (changed) {
+                const int bit = __builtin_ctz(changed);
+                changed &= (uint8_t)(changed - 1);
+                hotkey_emit(l, 0, (uint32_t)(i * 8 + bit), (keys[i] >> bit) & 1, now);
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+static void* hotkey_listener_thread(void* arg) {
+    hotkey_listener* l = (hotkey_listener*)arg;
+    switch (l->backend) {
+        case HOTKEY_BACKEND_XI2: hotkey_xi2_run(l); break;
+        case HOTKEY_BACKEND_EVDEV: hotkey_evdev_run(l); break;
+        case HOTKEY_BACKEND_X11_KEYMAP: hotkey_keymap_run(l); break;
+        default: break;
+    }
+    return NULL;
+}
+
+static bool hotkey_backend_open(hotkey_listener* l, hotkey_backend backend) {
+    switch (backend) {
+        case HOTKEY_BACKEND_XI2: return hotkey_xi2_open(l);
+        case HOTKEY_BACKEND_EVDEV: return hotkey_evdev_open(l);
+        case HOTKEY_BACKEND_X11_KEYMAP: return hotkey_keymap_open(l);
+        default: return false;
+    }
+}
+
+static void hotkey_listener_close(hotkey_listener* l) {
+    if (l->display) XCloseDisplay(l->display);
+    l->display = NULL;
+    hotkey_evdev_close(l);
+    if (l->stop_fd >= 0) close(l->stop_fd);
+    l->stop_fd = -1;
+}
+
+void hotkey_dart_init(void* post_cobject) {
+    atomic_store(&g_dart_post_cobject, (hotkey_dart_post_cobject_fn)post_cobject);
+}
+
+hotkey_backend hotkey_listener_start(int64_t port) {
+    hotkey_listener_stop();
+
+    pthread_mutex_lock(&g_listener_lock);
+    hotkey_listener* l = &g_listener;
+    memset(l, 0, sizeof(*l));
+    l->port = port;
+    l->epoll_fd = -1;
+    l->inotify_fd = -1;
+    l->backend = HOTKEY_BACKEND_NONE;
+    l->stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (l->stop_fd < 0) {
+        pthread_mutex_unlock(&g_listener_lock);
+        return HOTKEY_BACKEND_NONE;
+    }
+
+    // X11 queries only see X clients under Wayland, so evdev goes first there
+    const char* session = getenv("XDG_SESSION_TYPE");
+    const bool wayland = (session && strcmp(session, "wayland") == 0) || getenv("WAYLAND_DISPLAY");
+    const hotkey_backend order_x11[] = { HOTKEY_BACKEND_XI2, HOTKEY_BACKEND_EVDEV, HOTKEY_BACKEND_X11_KEYMAP };
+    const hotkey_backend order_wayland[] = { HOTKEY_BACKEND_EVDEV, HOTKEY_BACKEND_XI2, HOTKEY_BACKEND_X11_KEYMAP };
+    const hotkey_backend* order = wayland ? order_wayland : order_x11;
+
+    for (int i = 0; i < 3; i++) {
+        if (hotkey_backend_open(l, order[i])) {
+            l->backend = order[i];
+            break;
+        }
+    }
+
+    if (l->backend == HOTKEY_BACKEND_NONE) {
+        fprintf(stderr, "hotkey: no input backend available\n");
+        hotkey_listener_close(l);
+    } else if (pthread_create(&l->thread, NULL, hotkey_listener_thread, l) != 0) {
+        fprintf(stderr, "hotkey: failed to start the listener thread\n");
+        hotkey_listener_close(l);
+        l->backend = HOTKEY_BACKEND_NONE;
+    } else {
+        l->running = true;
+    }
+
+    const hotkey_backend backend = l->backend;
+    pthread_mutex_unlock(&g_listener_lock);
+    return backend;
+}
+
+void hotkey_listener_stop(void) {
+    pthread_mutex_lock(&g_listener_lock);
+    hotkey_listener* l = &g_listener;
+    if (l->running) {
+        const uint64_t one = 1;
+        if (write(l->stop_fd, &one, sizeof(one)) < 0) {
+            fprintf(stderr, "hotkey: failed to signal the listener thread\n");
+        }
+        pthread_join(l->thread, NULL);
+        hotkey_listener_close(l);
+        l->running = false;
+    }
+    pthread_mutex_unlock(&g_listener_lock);
 }
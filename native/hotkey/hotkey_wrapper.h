@@ -13,6 +13,8 @@ extern "C" {
 bool x11_is_key_pressed(uint32_t key_code);
 
 // Returns the X11 KeyCode for a given KeySym string (e.g., "F12").
+// Without an X display, common hotkeys still resolve to the KeyCode X would
+// use for them (evdev code + 8), so the listener works on bare Wayland.
 uint32_t x11_get_keycode(const char* keysym_name);
 
 // Returns the KeyCode of the first pressed key found, or 0 if none.
@@ -21,6 +23,26 @@ uint32_t x11_get_pressed_keycode();
 // Returns the name of the keysym for a given keycode.
 const char* x11_get_keysym_name(uint32_t key_code);
 
+typedef enum {
+    HOTKEY_BACKEND_NONE = -1,
+    HOTKEY_BACKEND_XI2 = 0,         // XInput2 raw key events on one X connection
+    HOTKEY_BACKEND_EVDEV = 1,       // /dev/input/event* keyboards through epoll
+    HOTKEY_BACKEND_X11_KEYMAP = 2,  // XQueryKeymap every 10 ms on one X connection
+} hotkey_backend;
+
+// Passes NativeApi.postCObject from Dart, needed before hotkey_listener_start.
+void hotkey_dart_init(void* post_cobject);
+
+// Starts a thread that posts [key_code, pressed, timestamp_us] to port for
+// every key press and release. key_code is the X11 KeyCode, auto-repeats
+// are not posted, and timestamp_us is CLOCK_MONOTONIC. A key held on
+// several keyboards is posted pressed by the first and released by the last. On Wayland, evdev is
+// tried first (it needs read access to /dev/input, e.g. the input group);
+// on X11, XInput2 is. Returns the backend in use, or HOTKEY_BACKEND_NONE if
+// none could be opened. Restarts the listener if it is already running.
+hotkey_backend hotkey_listener_start(int64_t port);
+void hotkey_listener_stop(void);
+
 #ifdef __cplusplus
 }
 #endif
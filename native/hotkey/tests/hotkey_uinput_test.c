@@ -0,0 +1,259 @@
+// Creates two uinput keyboards, starts the evdev listener on them and checks
+// the [key_code, pressed, timestamp_us] messages it posts: one press and one
+// release per key, auto-repeats and repeated presses dropped, and a key held
+// on both keyboards released only by the last of them. The keys used are
+// F20 and F21, which nothing binds by default.
+// Exits with 77 (skipped) when /dev/uinput or the evdev nodes are not usable.
+
+#include "hotkey_wrapper.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <linux/uinput.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SKIP 77
+
+static int n_failed = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+        fprintf(stderr, __VA_ARGS__); \
+        fprintf(stderr, "\n"); \
+        n_failed++; \
+    } \
+} while (0)
+
+// Dart_CObject, as far as the listener posts it
+typedef struct test_cobject {
+    int32_t type;
+    union {
+        bool as_bool;
+        int64_t as_int64;
+        struct {
+            intptr_t length;
+            struct test_cobject** values;
+        } as_array;
+        void* reserved[5];
+    } value;
+} test_cobject;
+
+typedef struct {
+    int64_t key_code;
+    bool pressed;
+    int64_t timestamp_us;
+} test_edge;
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static test_edge g_edges[64];
+static int g_n_edges = 0;
+
+#define TEST_PORT 42
+
+static bool test_post(int64_t port, test_cobject* message) {
+    if (port != TEST_PORT || message->type != 6 || message->value.as_array.length != 3) return false;
+    test_cobject** values = message->value.as_array.values;
+    const int64_t key_code = values[0]->value.as_int64;
+    // Keys of real keyboards are left out
+    if (key_code != KEY_F20 + 8 && key_code != KEY_F21 + 8) return true;
+    pthread_mutex_lock(&g_lock);
+    if (g_n_edges < 64) {
+        g_edges[g_n_edges].key_code = key_code;
+        g_edges[g_n_edges].pressed = values[1]->value.as_bool;
+        g_edges[g_n_edges].timestamp_us = values[2]->value.as_int64;
+        g_n_edges++;
+    }
+    pthread_mutex_unlock(&g_lock);
+    return true;
+}
+
+static int64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int create_keyboard(const char* name) {
+    const int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return -1;
+    ioctl(fd, UI_SET_EVBIT, EV_KEY);
+    ioctl(fd, UI_SET_EVBIT, EV_REP);
+    ioctl(fd, UI_SET_KEYBIT, KEY_F20);
+    ioctl(fd, UI_SET_KEYBIT, KEY_F21);
+
+    struct uinput_setup setup;
+    memset(&setup, 0, sizeof(setup));
+    setup.id.bustype = BUS_VIRTUAL;
+    snprintf(setup.name, sizeof(setup.name), "%s", name);
+    if (ioctl(fd, UI_DEV_SETUP, &setup) < 0 || ioctl(fd, UI_DEV_CREATE) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void send_key(int fd, int code, int value) {
+    struct input_event ev[2];
+    memset(ev, 0, sizeof(ev));
+    ev[0].type = EV_KEY;
+    ev[0].code = code;
+    ev[0].value = value;
+    ev[1].type = EV_SYN;
+    ev[1].code = SYN_REPORT;
+    if (write(fd, ev, sizeof(ev)) != (ssize_t)sizeof(ev)) {
+        fprintf(stderr, "uinput write failed: %s\n", strerror(errno));
+    }
+}
+
+// Whether an evdev node named name can be read, waiting up to timeout_ms for udev
+static bool event_node_readable(const char* name, int timeout_ms) {
+    for (int waited = 0; waited <= timeout_ms; waited += 20) {
+        DIR* dir = opendir("/dev/input");
+        if (dir) {
+            struct dirent* entry;
+            while ((entry = readdir(dir)) != NULL) {
+                if (strncmp(entry->d_name, "event", 5) != 0) continue;
+                char path[300];
+                snprintf(path, sizeof(path), "/dev/input/%s", entry->d_name);
+                const int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+                if (fd < 0) continue;
+                char device_name[256] = { 0 };
+                const bool match = ioctl(fd, EVIOCGNAME(sizeof(device_name) - 1), device_name) >= 0 &&
+                                   strcmp(device_name, name) == 0;
+                close(fd);
+                if (match) {
+                    closedir(dir);
+                    return true;
+                }
+            }
+            closedir(dir);
+        }
+        usleep(20 * 1000);
+    }
+    return false;
+}
+
+// The edges posted since the last call, once none arrived for 100 ms
+static int take_edges(test_edge* out) {
+    int n = -1;
+    for (;;) {
+        usleep(100 * 1000);
+        pthread_mutex_lock(&g_lock);
+        const bool settled = g_n_edges == n;
+        n = g_n_edges;
+        if (settled) {
+            memcpy(out, g_edges, n * sizeof(test_edge));
+            g_n_edges = 0;
+        }
+        pthread_mutex_unlock(&g_lock);
+        if (settled) return n;
+    }
+}
+
+static void check_edges(const char* what, const test_edge* edges, int n, const int64_t* key_codes,
+                        const bool* pressed, int n_expected, int64_t t0) {
+    CHECK(n == n_expected, "%s: %d edges posted, expected %d", what, n, n_expected);
+    for (int i = 0; i < n && i < n_expected; i++) {
+        CHECK(edges[i].key_code == key_codes[i] && edges[i].pressed == pressed[i],
+              "%s: edge %d is key %lld pressed %d, expected key %lld pressed %d", what, i,
+              (long long)edges[i].key_code, edges[i].pressed, (long long)key_codes[i], pressed[i]);
+        CHECK(edges[i].timestamp_us >= t0 && edges[i].timestamp_us <= now_us(),
+              "%s: edge %d has timestamp %lld, outside the test", what, i, (long long)edges[i].timestamp_us);
+        CHECK(i == 0 || edges[i].timestamp_us >= edges[i - 1].timestamp_us, "%s: edge %d goes back in time", what, i);
+    }
+}
+
+int main(void) {
+    if (access("/dev/uinput", W_OK) != 0) {
+        printf("/dev/uinput is not writable, skipping\n");
+        return SKIP;
+    }
+
+    char name_a[64], name_b[64];
+    snprintf(name_a, sizeof(name_a), "hotkey test a %d", (int)getpid());
+    snprintf(name_b, sizeof(name_b), "hotkey test b %d", (int)getpid());
+    const int kbd_a = create_keyboard(name_a);
+    const int kbd_b = create_keyboard(name_b);
+    if (kbd_a < 0 || kbd_b < 0) {
+        fprintf(stderr, "creating the uinput keyboards failed with /dev/uinput writable\n");
+        return 1;
+    }
+    if (!event_node_readable(name_a, 2000) || !event_node_readable(name_b, 2000)) {
+        printf("no readable evdev nodes (no udev, or not in the input group), skipping\n");
+        close(kbd_a);
+        close(kbd_b);
+        return SKIP;
+    }
+
+    // evdev is tried first on Wayland
+    setenv("XDG_SESSION_TYPE", "wayland", 1);
+    hotkey_dart_init((void*)test_post);
+    const hotkey_backend backend = hotkey_listener_start(TEST_PORT);
+    if (backend != HOTKEY_BACKEND_EVDEV) {
+        printf("the evdev backend did not open (got %d), skipping\n", backend);
+        hotkey_listener_stop();
+        close(kbd_a);
+        close(kbd_b);
+        return SKIP;
+    }
+
+    const int64_t f20 = KEY_F20 + 8;
+    const int64_t f21 = KEY_F21 + 8;
+    test_edge edges[64];
+
+    // Auto-repeat and a repeated press on one keyboard
+    int64_t t0 = now_us();
+    send_key(kbd_a, KEY_F20, 1);
+    send_key(kbd_a, KEY_F20, 2);
+    send_key(kbd_a, KEY_F20, 2);
+    send_key(kbd_a, KEY_F20, 1);
+    send_key(kbd_a, KEY_F20, 0);
+    send_key(kbd_a, KEY_F20, 0);
+    int n = take_edges(edges);
+    {
+        const int64_t keys[] = { f20, f20 };
+        const bool pressed[] = { true, false };
+        check_edges("one keyboard", edges, n, keys, pressed, 2, t0);
+    }
+
+    // The same key on both keyboards: released by the last one only
+    t0 = now_us();
+    send_key(kbd_a, KEY_F20, 1);
+    send_key(kbd_b, KEY_F20, 1);
+    send_key(kbd_b, KEY_F21, 1);
+    send_key(kbd_a, KEY_F20, 0);
+    send_key(kbd_b, KEY_F21, 0);
+    n = take_edges(edges);
+    {
+        const int64_t keys[] = { f20, f21, f21 };
+        const bool pressed[] = { true, true, false };
+        check_edges("two keyboards", edges, n, keys, pressed, 3, t0);
+    }
+
+    // Unplugging the keyboard that still holds the key releases it
+    t0 = now_us();
+    ioctl(kbd_b, UI_DEV_DESTROY);
+    close(kbd_b);
+    n = take_edges(edges);
+    {
+        const int64_t keys[] = { f20 };
+        const bool pressed[] = { false };
+        check_edges("unplugged", edges, n, keys, pressed, 1, t0);
+    }
+
+    hotkey_listener_stop();
+    ioctl(kbd_a, UI_DEV_DESTROY);
+    close(kbd_a);
+
+    printf("%s\n", n_failed == 0 ? "OK" : "FAILED");
+    return n_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,635 @@
+#include "inject_wrapper.h"
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#ifdef INJECT_HAVE_XTEST
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/keysym.h>
+#include <X11/extensions/XTest.h>
+#endif
+
+struct inject_key {
+    uint16_t code;  // 0 when the character has no key
+    bool shift;
+};
+
+// What a compositor types for each ASCII character when the keyboard has
+// the US layout. uinput only sends keycodes, so this is the one layout the
+// uinput backend can assume.
+static const std::array<inject_key, 128>& inject_us_keymap() {
+    static const std::array<inject_key, 128> keymap = [] {
+        std::array<inject_key, 128> map{};
+        struct row {
+            const char* plain;
+            const char* shifted;
+            std::array<uint16_t, 13> codes;
+        };
+        static const row rows[] = {
+            { "1234567890-=", "!@#$%^&*()_+",
+              { KEY_1, KEY_2, KEY_3, KEY_4, KEY_5, KEY_6, KEY_7, KEY_8, KEY_9, KEY_0, KEY_MINUS, KEY_EQUAL } },
+            { "qwertyuiop[]\\", "QWERTYUIOP{}|",
+              { KEY_Q, KEY_W, KEY_E, KEY_R, KEY_T, KEY_Y, KEY_U, KEY_I, KEY_O, KEY_P, KEY_LEFTBRACE, KEY_RIGHTBRACE, KEY_BACKSLASH } },
+            { "asdfghjkl;'", "ASDFGHJKL:\"",
+              { KEY_A, KEY_S, KEY_D, KEY_F, KEY_G, KEY_H, KEY_J, KEY_K, KEY_L, KEY_SEMICOLON, KEY_APOSTROPHE } },
+            { "zxcvbnm,./", "ZXCVBNM<>?",
+              { KEY_Z, KEY_X, KEY_C, KEY_V, KEY_B, KEY_N, KEY_M, KEY_COMMA, KEY_DOT, KEY_SLASH } },
+            { "`", "~", { KEY_GRAVE } },
+        };
+        for (const row& r : rows) {
+            for (size_t i = 0; r.plain[i]; i++) {
+                map[(unsigned char) r.plain[i]] = { r.codes[i], false };
+                map[(unsigned char) r.shifted[i]] = { r.codes[i], true };
+            }
+        }
+        map[' '] = { KEY_SPACE, false };
+        map['\n'] = { KEY_ENTER, false };
+        map['\t'] = { KEY_TAB, false };
+        return map;
+    }();
+    return keymap;
+}
+
+// Decodes one code point and advances p. Invalid bytes decode as U+FFFD.
+static bool inject_next_codepoint(const char*& p, uint32_t& cp) {
+    const unsigned char* s = (const unsigned char*) p;
+    if (!s[0]) return false;
+
+    int len = 1;
+    cp = s[0];
+    if (s[0] >= 0xf0 && s[0] < 0xf8) { len = 4; cp = s[0] & 0x07; }
+    else if (s[0] >= 0xe0) { len = 3; cp = s[0] & 0x0f; }
+    else if (s[0] >= 0xc0) { len = 2; cp = s[0] & 0x1f; }
+    else if (s[0] >= 0x80) { p += 1; cp = 0xfffd; return true; }
+
+    for (int i = 1; i < len; i++) {
+        if ((s[i] & 0xc0) != 0x80) {
+            p += i;
+            cp = 0xfffd;
+            return true;
+        }
+        cp = (cp << 6) | (s[i] & 0x3f);
+    }
+    p += len;
+    return true;
+}
+
+// Mirror of Dart_CObject from dart_api.h (a stable ABI), only the kinds posted here
+enum {
+    INJECT_DART_INT64 = 3,
+};
+
+struct inject_dart_cobject {
+    int32_t type;
+    union {
+        int64_t as_int64;
+        void* reserved[5]; // size of the full union in dart_api.h
+    } value;
+};
+
+typedef bool (*inject_dart_post_cobject_fn)(int64_t port, inject_dart_cobject* message);
+
+static std::atomic<inject_dart_post_cobject_fn> g_dart_post_cobject{nullptr};
+
+struct inject_context {
+    inject_config config;
+    inject_backend backend = INJECT_BACKEND_NONE;
+    std::string device_name;
+
+    // One injection at a time on the device
+    std::mutex device_mutex;
+
+    // uinput
+    int fd = -1;
+    std::chrono::steady_clock::time_point created;
+    bool settled = false;
+    std::vector<input_event> events;
+
+#ifdef INJECT_HAVE_XTEST
+    // XTest
+    Display* display = nullptr;
+    std::unordered_map<KeySym, inject_key> keysyms;  // Keysym to keycode and shift level
+    KeyCode shift_keycode = 0;
+    KeyCode control_keycode = 0;
+    KeyCode scratch_keycode = 0;  // Unused keycode, remapped for keysyms no key has
+#endif
+
+    // Writer thread for inject_type_port, started on first use
+    std::thread writer;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<std::pair<std::string, int64_t>> queue;
+    bool stopping = false;
+};
+
+static void inject_pause(int us) {
+    if (us > 0) std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+// --- uinput ----------------------------------------------------------------
+
+static bool inject_uinput_open(inject_context* ctx) {
+    const int fd = open("/dev/uinput", O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Inject: cannot open /dev/uinput: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Every key a keyboard has, so the device is taken for one
+    bool ok = ioctl(fd, UI_SET_EVBIT, EV_KEY) == 0 && ioctl(fd, UI_SET_EVBIT, EV_SYN) == 0;
+    for (int code = KEY_ESC; ok && code <= KEY_MICMUTE; code++) {
+        ok = ioctl(fd, UI_SET_KEYBIT, code) == 0;
+    }
+
+    uinput_setup setup;
+    memset(&setup, 0, sizeof(setup));
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x0001;
+    setup.id.product = 0x0001;
+    snprintf(setup.name, UINPUT_MAX_NAME_SIZE, "%s", ctx->device_name.c_str());
+
+    if (!ok || ioctl(fd, UI_DEV_SETUP, &setup) < 0 || ioctl(fd, UI_DEV_CREATE) < 0) {
+        std::cerr << "Inject: cannot create the uinput device: " << strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+
+    ctx->fd = fd;
+    ctx->created = std::chrono::steady_clock::now();
+    return true;
+}
+
+static void inject_uinput_push(inject_context* ctx, uint16_t type, uint16_t code, int32_t value) {
+    input_event ev;
+    memset(&ev, 0, sizeof(ev));  // The kernel stamps the time
+    ev.type = type;
+    ev.code = code;
+    ev.value = value;
+    ctx->events.push_back(ev);
+}
+
+static void inject_uinput_key(inject_context* ctx, inject_key key) {
+    if (key.shift) {
+        inject_uinput_push(ctx, EV_KEY, KEY_LEFTSHIFT, 1);
+        inject_uinput_push(ctx, EV_SYN, SYN_REPORT, 0);
+    }
+    inject_uinput_push(ctx, EV_KEY, key.code, 1);
+    inject_uinput_push(ctx, EV_SYN, SYN_REPORT, 0);
+    inject_uinput_push(ctx, EV_KEY, key.code, 0);
+    inject_uinput_push(ctx, EV_SYN, SYN_REPORT, 0);
+    if (key.shift) {
+        inject_uinput_push(ctx, EV_KEY, KEY_LEFTSHIFT, 0);
+        inject_uinput_push(ctx, EV_SYN, SYN_REPORT, 0);
+    }
+}
+
+// Writes the pending events in one call and clears them
+static bool inject_uinput_flush(inject_context* ctx) {
+    const char* data = (const char*) ctx->events.data();
+    size_t left = ctx->events.size() * sizeof(input_event);
+    while (left > 0) {
+        const ssize_t n = write(ctx->fd, data, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Inject: uinput write failed: " << strerror(errno) << std::endl;
+            ctx->events.clear();
+            return false;
+        }
+        data += n;
+        left -= (size_t) n;
+    }
+    ctx->events.clear();
+    return true;
+}
+
+// The compositor needs a moment to pick up a new device; events written
+// before that are lost. Only the first injection after inject_init waits.
+static void inject_uinput_settle(inject_context* ctx) {
+    if (ctx->settled) return;
+    const auto ready = ctx->created + std::chrono::milliseconds(200);
+    std::this_thread::sleep_until(ready);
+    ctx->settled = true;
+}
+
+static int inject_uinput_type(inject_context* ctx, const char* text) {
+    inject_uinput_settle(ctx);
+    const auto& keymap = inject_us_keymap();
+
+    int n = 0;
+    int in_batch = 0;
+    uint32_t cp;
+    for (const char* p = text; inject_next_codepoint(p, cp);) {
+        inject_uinput_key(ctx, keymap[cp]);
+        n++;
+        if (++in_batch == ctx->config.chars_per_batch) {
+            if (!inject_uinput_flush(ctx)) return -1;
+            in_batch = 0;
+            inject_pause(ctx->config.batch_delay_us);
+        }
+    }
+    return inject_uinput_flush(ctx) ? n : -1;
+}
+
+static int inject_uinput_paste(inject_context* ctx) {
+    inject_uinput_settle(ctx);
+    inject_uinput_push(ctx, EV_KEY, KEY_LEFTCTRL, 1);
+    inject_uinput_push(ctx, EV_SYN, SYN_REPORT, 0);
+    inject_uinput_key(ctx, { KEY_V, false });
+    inject_uinput_push(ctx, EV_KEY, KEY_LEFTCTRL, 0);
+    inject_uinput_push(ctx, EV_SYN, SYN_REPORT, 0);
+    return inject_uinput_flush(ctx) ? 0 : -1;
+}
+
+// --- XTest -----------------------------------------------------------------
+
+#ifdef INJECT_HAVE_XTEST
+
+static KeySym inject_keysym(uint32_t cp) {
+    if (cp == '\n') return XK_Return;
+    if (cp == '\t') return XK_Tab;
+    // Latin-1 keysyms are the code points, everything else has a Unicode keysym
+    if ((cp >= 0x20 && cp < 0x7f) || (cp >= 0xa0 && cp <= 0xff)) return cp;
+    return 0x01000000 | cp;
+}
+
+// Keysyms reachable without AltGr, each on the lowest keycode that has it
+static void inject_xtest_load_keymap(inject_context* ctx) {
+    Display* d = ctx->display;
+    int min_keycode, max_keycode, per_keycode;
+    XDisplayKeycodes(d, &min_keycode, &max_keycode);
+    KeySym* syms = XGetKeyboardMapping(d, (KeyCode) min_keycode, max_keycode - min_keycode + 1, &per_keycode);
+
+    ctx->keysyms.clear();
+    ctx->scratch_keycode = 0;
+    for (int keycode = min_keycode; keycode <= max_keycode; keycode++) {
+        const KeySym* row = syms + (keycode - min_keycode) * per_keycode;
+        bool empty = true;
+        for (int level = 0; level < per_keycode; level++) {
+            if (row[level] == NoSymbol) continue;
+            empty = false;
+            if (level < 2) ctx->keysyms.emplace(row[level], inject_key{ (uint16_t) keycode, level == 1 });
+        }
+        // A lone letter keysym implies its capital on the shift level
+        if (per_keycode > 0 && row[0] != NoSymbol && (per_keycode < 2 || row[1] == NoSymbol)) {
+            KeySym lower, upper;
+            XConvertCase(row[0], &lower, &upper);
+            if (lower != upper) ctx->keysyms.emplace(upper, inject_key{ (uint16_t) keycode, true });
+        }
+        if (empty) ctx->scratch_keycode = (KeyCode) keycode;
+    }
+    XFree(syms);
+
+    ctx->shift_keycode = XKeysymToKeycode(d, XK_Shift_L);
+    ctx->control_keycode = XKeysymToKeycode(d, XK_Control_L);
+}
+
+static bool inject_xtest_open(inject_context* ctx) {
+    Display* d = XOpenDisplay(NULL);
+    if (!d) return false;
+
+    int event_base, error_base, major, minor;
+    if (!XTestQueryExtension(d, &event_base, &error_base, &major, &minor)) {
+        std::cerr << "Inject: the X server has no XTest extension" << std::endl;
+        XCloseDisplay(d);
+        return false;
+    }
+
+    ctx->display = d;
+    inject_xtest_load_keymap(ctx);
+    return true;
+}
+
+static bool inject_xtest_can_type(inject_context* ctx, uint32_t cp) {
+    if (cp < 0x20 && cp != '\n' && cp != '\t') return false;
+    return ctx->keysyms.count(inject_keysym(cp)) > 0 || ctx->scratch_keycode != 0;
+}
+
+static void inject_xtest_key(inject_context* ctx, inject_key key) {
+    Display* d = ctx->display;
+    if (key.shift) XTestFakeKeyEvent(d, ctx->shift_keycode, True, CurrentTime);
+    XTestFakeKeyEvent(d, key.code, True, CurrentTime);
+    XTestFakeKeyEvent(d, key.code, False, CurrentTime);
+    if (key.shift) XTestFakeKeyEvent(d, ctx->shift_keycode, False, CurrentTime);
+}
+
+static int inject_xtest_type(inject_context* ctx, const char* text) {
+    Display* d = ctx->display;
+    KeySym remapped = NoSymbol;
+
+    int n = 0;
+    int in_batch = 0;
+    uint32_t cp;
+    for (const char* p = text; inject_next_codepoint(p, cp);) {
+        const KeySym sym = inject_keysym(cp);
+        inject_key key;
+        auto it = ctx->keysyms.find(sym);
+        if (it != ctx->keysyms.end()) {
+            key = it->second;
+        } else {
+            // Borrow the scratch keycode, as xdotool does. Syncing first
+            // keeps the keys already sent on the old mapping.
+            if (remapped != sym) {
+                KeySym pair[2] = { sym, sym };
+                XSync(d, False);
+                XChangeKeyboardMapping(d, ctx->scratch_keycode, 2, pair, 1);
+                XSync(d, False);
+                remapped = sym;
+            }
+            key = { ctx->scratch_keycode, false };
+        }
+
+        inject_xtest_key(ctx, key);
+        n++;
+        if (++in_batch == ctx->config.chars_per_batch) {
+            XFlush(d);
+            in_batch = 0;
+            inject_pause(ctx->config.batch_delay_us);
+        }
+    }
+
+    XSync(d, False);
+    if (remapped != NoSymbol) {
+        KeySym none[2] = { NoSymbol, NoSymbol };
+        XChangeKeyboardMapping(d, ctx->scratch_keycode, 2, none, 1);
+        XSync(d, False);
+    }
+    return n;
+}
+
+static int inject_xtest_paste(inject_context* ctx) {
+    Display* d = ctx->display;
+    const KeyCode v = XKeysymToKeycode(d, XK_v);
+    if (!v || !ctx->control_keycode) return -1;
+    XTestFakeKeyEvent(d, ctx->control_keycode, True, CurrentTime);
+    XTestFakeKeyEvent(d, v, True, CurrentTime);
+    XTestFakeKeyEvent(d, v, False, CurrentTime);
+    XTestFakeKeyEvent(d, ctx->control_keycode, False, CurrentTime);
+    XSync(d, False);
+    return 0;
+}
+
+#endif
+
+// --- Layout ----------------------------------------------------------------
+
+static std::string inject_trim(const std::string& s, const char* chars = " \t\r\n\"'") {
+    const size_t begin = s.find_first_not_of(chars);
+    if (begin == std::string::npos) return "";
+    return s.substr(begin, s.find_last_not_of(chars) - begin + 1);
+}
+
+// Value of a KEY=value line in a shell-style file such as /etc/default/keyboard
+static bool inject_read_assignment(const char* path, const char* key, std::string& value) {
+    std::ifstream in(path);
+    const std::string prefix = std::string(key) + "=";
+    std::string line;
+    while (std::getline(in, line)) {
+        line = inject_trim(line, " \t");
+        if (line.compare(0, prefix.size(), prefix) == 0) {
+            value = inject_trim(line.substr(prefix.size()));
+            return true;
+        }
+    }
+    return false;
+}
+
+// Value of an Option "name" "value" line in an xorg.conf snippet
+static bool inject_read_xorg_option(const char* path, const char* option, std::string& value) {
+    std::ifstream in(path);
+    const std::string quoted = std::string("\"") + option + "\"";
+    std::string line;
+    while (std::getline(in, line)) {
+        line = inject_trim(line, " \t");
+        if (line.compare(0, 6, "Option") != 0) continue;
+        const size_t at = line.find(quoted);
+        if (at == std::string::npos) continue;
+        value = inject_trim(line.substr(at + quoted.size()));
+        return true;
+    }
+    return false;
+}
+
+// Only the plain US layout, alone: with a second layout the user can switch to it
+static inject_layout inject_classify_layout(const std::string& layout, const std::string& variant) {
+    if (layout.empty()) return INJECT_LAYOUT_UNKNOWN;
+    return layout == "us" && (variant.empty() || variant == "basic") ? INJECT_LAYOUT_US : INJECT_LAYOUT_OTHER;
+}
+
+// ---------------------------------------------------------------------------
+
+static bool inject_can_type_text(inject_context* ctx, const char* text) {
+    const auto& keymap = inject_us_keymap();
+    uint32_t cp;
+    for (const char* p = text; inject_next_codepoint(p, cp);) {
+        if (ctx->backend == INJECT_BACKEND_UINPUT) {
+            if (cp >= 128 || keymap[cp].code == 0) return false;
+        }
+#ifdef INJECT_HAVE_XTEST
+        if (ctx->backend == INJECT_BACKEND_XTEST && !inject_xtest_can_type(ctx, cp)) {
+            return false;
+        }
+#endif
+    }
+    return true;
+}
+
+static void inject_writer_loop(inject_context* ctx) {
+    for (;;) {
+        std::pair<std::string, int64_t> job;
+        {
+            std::unique_lock<std::mutex> lock(ctx->queue_mutex);
+            ctx->queue_cv.wait(lock, [ctx] { return ctx->stopping || !ctx->queue.empty(); });
+            if (ctx->stopping) return;
+            job = std::move(ctx->queue.front());
+            ctx->queue.pop_front();
+        }
+
+        const int n = inject_type(ctx, job.first.c_str());
+        inject_dart_post_cobject_fn post = g_dart_post_cobject.load(std::memory_order_acquire);
+        if (post) {
+            inject_dart_cobject message;
+            message.type = INJECT_DART_INT64;
+            message.value.as_int64 = n;
+            post(job.second, &message);
+        }
+    }
+}
+
+extern "C" {
+
+inject_config inject_default_config(void) {
+    inject_config config;
+    // 6 characters are at most 48 events, well inside evdev's 64
+    config.chars_per_batch = 6;
+    config.batch_delay_us = 2000;
+    config.prefer_xtest = true;
+    config.device_name = nullptr;
+    return config;
+}
+
+inject_context* inject_init(inject_config config) {
+    inject_context* ctx = new inject_context();
+    ctx->config = config;
+    if (ctx->config.chars_per_batch < 1) ctx->config.chars_per_batch = 1;
+    ctx->device_name = config.device_name ? config.device_name : "localvoicesync virtual keyboard";
+    ctx->config.device_name = nullptr;
+
+    // XTest only reaches X clients on a Wayland session
+    const char* session = getenv("XDG_SESSION_TYPE");
+    const bool wayland = (session && strcmp(session, "wayland") == 0) || getenv("WAYLAND_DISPLAY");
+    (void) wayland;
+
+#ifdef INJECT_HAVE_XTEST
+    if (!wayland && config.prefer_xtest && inject_xtest_open(ctx)) {
+        ctx->backend = INJECT_BACKEND_XTEST;
+        return ctx;
+    }
+#endif
+    if (inject_uinput_open(ctx)) {
+        ctx->backend = INJECT_BACKEND_UINPUT;
+        return ctx;
+    }
+#ifdef INJECT_HAVE_XTEST
+    if (!wayland && !config.prefer_xtest && inject_xtest_open(ctx)) {
+        ctx->backend = INJECT_BACKEND_XTEST;
+        return ctx;
+    }
+#endif
+
+    std::cerr << "Inject: no usable backend" << std::endl;
+    delete ctx;
+    return nullptr;
+}
+
+void inject_free(inject_context* ctx) {
+    if (!ctx) return;
+
+    if (ctx->writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(ctx->queue_mutex);
+            ctx->stopping = true;
+        }
+        ctx->queue_cv.notify_all();
+        ctx->writer.join();
+    }
+
+    // Whatever was still queued is reported as not typed
+    inject_dart_post_cobject_fn post = g_dart_post_cobject.load(std::memory_order_acquire);
+    for (const auto& job : ctx->queue) {
+        if (!post) break;
+        inject_dart_cobject message;
+        message.type = INJECT_DART_INT64;
+        message.value.as_int64 = -1;
+        post(job.second, &message);
+    }
+
+    if (ctx->fd >= 0) {
+        ioctl(ctx->fd, UI_DEV_DESTROY);
+        close(ctx->fd);
+    }
+#ifdef INJECT_HAVE_XTEST
+    if (ctx->display) XCloseDisplay(ctx->display);
+#endif
+    delete ctx;
+}
+
+inject_backend inject_get_backend(inject_context* ctx) {
+    return ctx ? ctx->backend : INJECT_BACKEND_NONE;
+}
+
+bool inject_can_type(inject_context* ctx, const char* text) {
+    if (!ctx || !text) return false;
+    std::lock_guard<std::mutex> lock(ctx->device_mutex);
+    return inject_can_type_text(ctx, text);
+}
+
+int inject_type(inject_context* ctx, const char* text) {
+    if (!ctx || !text) return -1;
+    std::lock_guard<std::mutex> lock(ctx->device_mutex);
+    if (!inject_can_type_text(ctx, text)) return -1;
+
+    switch (ctx->backend) {
+        case INJECT_BACKEND_UINPUT: return inject_uinput_type(ctx, text);
+#ifdef INJECT_HAVE_XTEST
+        case INJECT_BACKEND_XTEST: return inject_xtest_type(ctx, text);
+#endif
+        default: return -1;
+    }
+}
+
+int inject_paste(inject_context* ctx) {
+    if (!ctx) return -1;
+    std::lock_guard<std::mutex> lock(ctx->device_mutex);
+
+    switch (ctx->backend) {
+        case INJECT_BACKEND_UINPUT: return inject_uinput_paste(ctx);
+#ifdef INJECT_HAVE_XTEST
+        case INJECT_BACKEND_XTEST: return inject_xtest_paste(ctx);
+#endif
+        default: return -1;
+    }
+}
+
+inject_layout inject_detect_layout(void) {
+    // What wlroots compositors and other libxkbcommon users default to
+    const char* env_layout = getenv("XKB_DEFAULT_LAYOUT");
+    if (env_layout && *env_layout) {
+        const char* env_variant = getenv("XKB_DEFAULT_VARIANT");
+        return inject_classify_layout(env_layout, env_variant ? env_variant : "");
+    }
+
+    std::string layout, variant;
+    if (inject_read_xorg_option("/etc/X11/xorg.conf.d/00-keyboard.conf", "XkbLayout", layout)) {
+        inject_read_xorg_option("/etc/X11/xorg.conf.d/00-keyboard.conf", "XkbVariant", variant);
+        return inject_classify_layout(layout, variant);
+    }
+    if (inject_read_assignment("/etc/default/keyboard", "XKBLAYOUT", layout)) {
+        inject_read_assignment("/etc/default/keyboard", "XKBVARIANT", variant);
+        return inject_classify_layout(layout, variant);
+    }
+    // The console keymap, which the X11 layout follows when it is not set
+    if (inject_read_assignment("/etc/vconsole.conf", "KEYMAP", layout)) {
+        return inject_classify_layout(layout, "");
+    }
+    return INJECT_LAYOUT_UNKNOWN;
+}
+
+void inject_dart_init(void* post_cobject) {
+    g_dart_post_cobject.store((inject_dart_post_cobject_fn) post_cobject, std::memory_order_release);
+}
+
+bool inject_type_port(inject_context* ctx, const char* text, int64_t port) {
+    if (!ctx || !text || !inject_can_type(ctx, text)) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(ctx->queue_mutex);
+        ctx->queue.emplace_back(text, port);
+        if (!ctx->writer.joinable()) {
+            ctx->writer = std::thread(inject_writer_loop, ctx);
+        }
+    }
+    ctx->queue_cv.notify_one();
+    return true;
+}
+
+}
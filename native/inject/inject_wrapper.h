@@ -0,0 +1,78 @@
+#ifndef INJECT_WRAPPER_H
+#define INJECT_WRAPPER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct inject_context inject_context;
+
+typedef enum {
+    INJECT_BACKEND_NONE = -1,
+    INJECT_BACKEND_UINPUT = 0,  // Virtual keyboard on /dev/uinput, US layout keycodes
+    INJECT_BACKEND_XTEST = 1,   // XTest on one X connection, any keysym
+} inject_backend;
+
+typedef enum {
+    INJECT_LAYOUT_UNKNOWN = -1,
+    INJECT_LAYOUT_OTHER = 0,    // Any layout or variant but plain US
+    INJECT_LAYOUT_US = 1,
+} inject_layout;
+
+typedef struct {
+    // Characters written to the device in one batch, and the pause after
+    // each batch. A batch must fit the reader's event buffer (64 events on
+    // evdev, up to 8 events per character), or keys get dropped.
+    int chars_per_batch;
+    int batch_delay_us;
+    bool prefer_xtest;        // Use XTest when an X display is reachable (ignored on Wayland)
+    const char* device_name;  // Name of the uinput device, NULL for the default
+} inject_config;
+
+inject_config inject_default_config(void);
+
+// Opens the backend, which then stays open: the uinput device is created
+// once, not per injection. Returns NULL if neither backend can be opened
+// (no access to /dev/uinput and no X display with XTest).
+inject_context* inject_init(inject_config config);
+void inject_free(inject_context* ctx);
+
+inject_backend inject_get_backend(inject_context* ctx);
+
+// Returns true if every character of the UTF-8 text can be typed with the
+// current backend. uinput only covers printable ASCII, newline and tab.
+bool inject_can_type(inject_context* ctx, const char* text);
+
+// Types UTF-8 text into the focused window and returns the number of
+// characters typed, or -1 if the text cannot be typed (nothing is typed
+// then) or the device failed.
+int inject_type(inject_context* ctx, const char* text);
+
+// Presses Ctrl+V. Returns 0, or -1 on failure.
+int inject_paste(inject_context* ctx);
+
+// The session's keyboard layout, which the uinput backend depends on: its
+// keycodes only type the intended characters on the plain US layout. Read
+// from XKB_DEFAULT_LAYOUT/XKB_DEFAULT_VARIANT, then the system layout that
+// localectl reports (/etc/X11/xorg.conf.d/00-keyboard.conf,
+// /etc/default/keyboard, /etc/vconsole.conf). Per-user layouts set in a
+// desktop environment's own settings are not visible here.
+inject_layout inject_detect_layout(void);
+
+// Passes NativeApi.postCObject from Dart, needed before inject_type_port.
+void inject_dart_init(void* post_cobject);
+
+// Queues the text on the context's writer thread and returns immediately,
+// so pacing never blocks the caller. The result of inject_type is posted to
+// port when the text is typed. Returns false, with nothing queued, if the
+// text cannot be typed with the current backend.
+bool inject_type_port(inject_context* ctx, const char* text, int64_t port);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
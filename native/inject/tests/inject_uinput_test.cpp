@@ -0,0 +1,193 @@
+// Types through the uinput backend and reads the keys back from the virtual
+// keyboard's evdev node, so the injector is tested without a display. The
+// node is grabbed first, so nothing reaches the session the test runs in.
+// Exits with 77 (skipped) when /dev/uinput or the evdev node is not usable.
+
+#include "inject_wrapper.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+static const int SKIP = 77;
+
+static int n_failed = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        std::fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+        std::fprintf(stderr, __VA_ARGS__); \
+        std::fprintf(stderr, "\n"); \
+        n_failed++; \
+    } \
+} while (0)
+
+static void check_layout(const char* layout, const char* variant, inject_layout expected) {
+    setenv("XKB_DEFAULT_LAYOUT", layout, 1);
+    if (variant) {
+        setenv("XKB_DEFAULT_VARIANT", variant, 1);
+    } else {
+        unsetenv("XKB_DEFAULT_VARIANT");
+    }
+    const inject_layout got = inject_detect_layout();
+    CHECK(got == expected, "layout \"%s\" variant \"%s\": got %d, expected %d", layout, variant ? variant : "", got,
+          expected);
+}
+
+// The evdev node of the device named name, or -1 once timeout_ms have passed
+static int open_event_node(const std::string& name, int timeout_ms) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    do {
+        DIR* dir = opendir("/dev/input");
+        if (dir) {
+            while (dirent* entry = readdir(dir)) {
+                if (strncmp(entry->d_name, "event", 5) != 0) continue;
+                const std::string path = std::string("/dev/input/") + entry->d_name;
+                const int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+                if (fd < 0) continue;
+                char device_name[256] = {};
+                if (ioctl(fd, EVIOCGNAME(sizeof(device_name) - 1), device_name) >= 0 && name == device_name) {
+                    closedir(dir);
+                    return fd;
+                }
+                close(fd);
+            }
+            closedir(dir);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    } while (std::chrono::steady_clock::now() < deadline);
+    return -1;
+}
+
+// Key events read until none arrive for idle_ms
+static std::vector<input_event> read_keys(int fd, int idle_ms) {
+    std::vector<input_event> keys;
+    auto last = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - last < std::chrono::milliseconds(idle_ms)) {
+        input_event ev[64];
+        const ssize_t n = read(fd, ev, sizeof(ev));
+        if (n <= 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        for (size_t i = 0; i < (size_t) n / sizeof(input_event); i++) {
+            if (ev[i].type == EV_KEY) keys.push_back(ev[i]);
+        }
+        last = std::chrono::steady_clock::now();
+    }
+    return keys;
+}
+
+// What the keys type on the US layout
+static std::string us_text(const std::vector<input_event>& keys) {
+    static const struct { uint16_t code; char plain, shifted; } map[] = {
+        { KEY_H, 'h', 'H' }, { KEY_I, 'i', 'I' }, { KEY_O, 'o', 'O' }, { KEY_K, 'k', 'K' },
+        { KEY_1, '1', '!' }, { KEY_COMMA, ',', '<' }, { KEY_SPACE, ' ', ' ' }, { KEY_ENTER, '\n', '\n' },
+        { KEY_APOSTROPHE, '\'', '"' }, { KEY_TAB, '\t', '\t' },
+    };
+    std::string text;
+    bool shift = false;
+    for (const input_event& ev : keys) {
+        if (ev.code == KEY_LEFTSHIFT) {
+            shift = ev.value != 0;
+            continue;
+        }
+        if (ev.value != 1) continue;
+        char c = '?';
+        for (const auto& m : map) {
+            if (m.code == ev.code) c = shift ? m.shifted : m.plain;
+        }
+        text += c;
+    }
+    return text;
+}
+
+int main() {
+    // Layout detection, which needs no device
+    check_layout("us", nullptr, INJECT_LAYOUT_US);
+    check_layout("us", "basic", INJECT_LAYOUT_US);
+    check_layout("us", "dvorak", INJECT_LAYOUT_OTHER);
+    check_layout("fr", nullptr, INJECT_LAYOUT_OTHER);
+    check_layout("de", "nodeadkeys", INJECT_LAYOUT_OTHER);
+    check_layout("us,de", nullptr, INJECT_LAYOUT_OTHER);
+    unsetenv("XKB_DEFAULT_LAYOUT");
+    unsetenv("XKB_DEFAULT_VARIANT");
+
+    if (access("/dev/uinput", W_OK) != 0) {
+        std::printf("layout checks %s; /dev/uinput is not writable, skipping the device test\n",
+                    n_failed == 0 ? "passed" : "FAILED");
+        return n_failed == 0 ? SKIP : 1;
+    }
+
+    const std::string name = "inject test " + std::to_string(getpid());
+    inject_config config = inject_default_config();
+    config.prefer_xtest = false;
+    config.device_name = name.c_str();
+    inject_context* ctx = inject_init(config);
+    if (!ctx) {
+        std::fprintf(stderr, "inject_init failed with /dev/uinput writable\n");
+        return 1;
+    }
+    if (inject_get_backend(ctx) != INJECT_BACKEND_UINPUT) {
+        std::printf("another backend was chosen, skipping the device test\n");
+        inject_free(ctx);
+        return n_failed == 0 ? SKIP : 1;
+    }
+
+    const int fd = open_event_node(name, 2000);
+    if (fd < 0) {
+        std::printf("no readable evdev node for \"%s\" (no udev, or not in the input group), skipping\n",
+                    name.c_str());
+        inject_free(ctx);
+        return n_failed == 0 ? SKIP : 1;
+    }
+    // Keeps the keys away from the focused window
+    CHECK(ioctl(fd, EVIOCGRAB, 1) == 0, "EVIOCGRAB failed: %s", strerror(errno));
+
+    // More characters than one batch, both shift levels
+    const char* text = "Hi, ok! 'OK'\tHI\n";
+    const int typed = inject_type(ctx, text);
+    CHECK(typed == (int) strlen(text), "inject_type returned %d, expected %zu", typed, strlen(text));
+    std::vector<input_event> keys = read_keys(fd, 200);
+    const std::string read_back = us_text(keys);
+    CHECK(read_back == text, "read back \"%s\", expected \"%s\"", read_back.c_str(), text);
+
+    // Every press has its release, and shift is up at the end
+    int down = 0;
+    for (const input_event& ev : keys) down += ev.value == 1 ? 1 : ev.value == 0 ? -1 : 0;
+    CHECK(down == 0, "%d keys left pressed", down);
+
+    // Characters without a US key are refused whole, nothing is typed
+    CHECK(!inject_can_type(ctx, "caf\xc3\xa9"), "inject_can_type accepted a non-ASCII character");
+    CHECK(inject_type(ctx, "caf\xc3\xa9") == -1, "inject_type typed a non-ASCII character");
+    CHECK(read_keys(fd, 100).empty(), "keys were sent for refused text");
+
+    // Ctrl+V
+    CHECK(inject_paste(ctx) == 0, "inject_paste failed");
+    keys = read_keys(fd, 100);
+    const uint16_t paste[] = { KEY_LEFTCTRL, KEY_V, KEY_V, KEY_LEFTCTRL };
+    const int32_t paste_values[] = { 1, 1, 0, 0 };
+    CHECK(keys.size() == 4, "paste sent %zu key events, expected 4", keys.size());
+    for (size_t i = 0; i < keys.size() && i < 4; i++) {
+        CHECK(keys[i].code == paste[i] && keys[i].value == paste_values[i], "paste event %zu is key %d value %d", i,
+              keys[i].code, keys[i].value);
+    }
+
+    ioctl(fd, EVIOCGRAB, 0);
+    close(fd);
+    inject_free(ctx);
+
+    std::printf("%s\n", n_failed == 0 ? "OK" : "FAILED");
+    return n_failed == 0 ? 0 : 1;
+}
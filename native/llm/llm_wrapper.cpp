@@ -0,0 +1,488 @@
+#include "llm_wrapper.h"
+#include "llama.h"
+#include <vector>
+#include <string>
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <sys/stat.h>
+
+// Stands in for the transcript while the chat template is rendered, so the
+// prompt can be split into the fixed prefix and the closing suffix
+static const char* LLM_TRANSCRIPT_MARKER = "\x01\x02transcript\x02\x01";
+
+static const char* LLM_DEFAULT_SYSTEM_PROMPT =
+    "You are a helpful assistant that cleans up speech-to-text transcriptions.";
+static const char* LLM_DEFAULT_INSTRUCTIONS =
+    "Clean up the following speech-to-text transcription.\n"
+    "Fix capitalization, punctuation, and obvious speech recognition errors.\n"
+    "Return only the cleaned text, no additional commentary.\n"
+    "\n"
+    "Original text:";
+
+struct llm_context {
+    llama_model* model;
+    llama_context* lctx;
+    const llama_vocab* vocab;
+    llama_sampler* smpl;
+
+    llm_config config;
+    std::string system_prompt;
+    std::string instructions;
+    std::string session_path;
+
+    // Fixed prompt up to the transcript. Its KV cells stay in sequence 0
+    // between requests; snapshot is the same state serialized, for models
+    // whose memory cannot be trimmed back to a position.
+    std::vector<llama_token> prefix;
+    std::vector<uint8_t> snapshot;
+    std::string suffix;  // Template text after the transcript
+
+    std::vector<llama_token> prompt;  // Transcript and suffix of the current request
+    std::string result;
+    std::atomic<bool> abort;
+    llm_stats stats;
+
+    llm_context() : model(nullptr), lctx(nullptr), vocab(nullptr), smpl(nullptr),
+                    abort(false), stats() {}
+};
+
+static double llm_ms_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static std::vector<llama_token> llm_tokenize(const llama_vocab* vocab, const std::string& text, bool add_special, bool parse_special) {
+    const int n = -llama_tokenize(vocab, text.data(), (int32_t) text.size(), nullptr, 0, add_special, parse_special);
+    std::vector<llama_token> tokens(std::max(n, 0));
+    if (n > 0) {
+        llama_tokenize(vocab, text.data(), (int32_t) text.size(), tokens.data(), n, add_special, parse_special);
+    }
+    return tokens;
+}
+
+// Renders the chat template with the marker as the transcript and splits the
+// result around it. Falls back to chatml when the model's template is unknown.
+static bool llm_render_prompt(llm_context* ctx, std::string& prefix, std::string& suffix) {
+    const std::string user = ctx->instructions + LLM_TRANSCRIPT_MARKER;
+
+    std::vector<llama_chat_message> messages;
+    if (!ctx->system_prompt.empty()) {
+        messages.push_back({ "system", ctx->system_prompt.c_str() });
+    }
+    messages.push_back({ "user", user.c_str() });
+
+    const char* tmpl = llama_model_chat_template(ctx->model, nullptr);
+    int n = llama_chat_apply_template(tmpl, messages.data(), messages.size(), true, nullptr, 0);
+    if (n < 0 && tmpl) {
+        std::cerr << "LLM: unsupported chat template, using chatml" << std::endl;
+        tmpl = nullptr;
+        n = llama_chat_apply_template(tmpl, messages.data(), messages.size(), true, nullptr, 0);
+    }
+    if (n < 0) {
+        return false;
+    }
+
+    std::vector<char> buf(n + 1, 0);
+    llama_chat_apply_template(tmpl, messages.data(), messages.size(), true, buf.data(), n + 1);
+    const std::string formatted(buf.data(), n);
+
+    const size_t pos = formatted.find(LLM_TRANSCRIPT_MARKER);
+    if (pos == std::string::npos) {
+        return false;
+    }
+    prefix = formatted.substr(0, pos);
+    suffix = formatted.substr(pos + strlen(LLM_TRANSCRIPT_MARKER));
+    return true;
+}
+
+// Decodes tokens on sequence 0 in n_batch chunks. Positions continue from
+// whatever the sequence already holds.
+static bool llm_decode(llm_context* ctx, llama_token* tokens, int n_tokens) {
+    const int n_batch = (int) llama_n_batch(ctx->lctx);
+    for (int i = 0; i < n_tokens; i += n_batch) {
+        const int n_eval = std::min(n_tokens - i, n_batch);
+        const int ret = llama_decode(ctx->lctx, llama_batch_get_one(tokens + i, n_eval));
+        if (ret != 0) {
+            // 2 means the abort callback fired
+            if (ret != 2) {
+                std::cerr << "LLM: decode failed (" << ret << ")" << std::endl;
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+// A snapshot written before the model file was last replaced cannot be
+// trusted even if the prompt tokens still match
+static bool llm_session_is_fresh(const std::string& session_path, const char* model_path) {
+    struct stat session_st, model_st;
+    if (stat(session_path.c_str(), &session_st) != 0) return false;
+    if (stat(model_path, &model_st) != 0) return false;
+    return session_st.st_mtime >= model_st.st_mtime;
+}
+
+static bool llm_load_session(llm_context* ctx, const char* model_path) {
+    if (ctx->session_path.empty() || !llm_session_is_fresh(ctx->session_path, model_path)) {
+        return false;
+    }
+
+    std::vector<llama_token> saved(ctx->prefix.size());
+    size_t n_saved = 0;
+    const size_t n_read = llama_state_seq_load_file(ctx->lctx, ctx->session_path.c_str(), 0,
+                                                    saved.data(), saved.size(), &n_saved);
+    if (n_read > 0 && n_saved == ctx->prefix.size() &&
+        std::equal(saved.begin(), saved.end(), ctx->prefix.begin())) {
+        return true;
+    }
+
+    // Stale prompt or a partial load, start the sequence over
+    llama_memory_seq_rm(llama_get_memory(ctx->lctx), 0, -1, -1);
+    return false;
+}
+
+static void llm_save_session(llm_context* ctx) {
+    if (ctx->session_path.empty()) return;
+
+    // Written aside and renamed so a crash never leaves a torn snapshot
+    const std::string tmp_path = ctx->session_path + ".tmp";
+    if (llama_state_seq_save_file(ctx->lctx, tmp_path.c_str(), 0, ctx->prefix.data(), ctx->prefix.size()) == 0 ||
+        std::rename(tmp_path.c_str(), ctx->session_path.c_str()) != 0) {
+        std::cerr << "LLM: failed to write session " << ctx->session_path << std::endl;
+        std::remove(tmp_path.c_str());
+    }
+}
+
+static bool llm_prepare_prefix(llm_context* ctx, const char* model_path) {
+    std::string prefix_text;
+    if (!llm_render_prompt(ctx, prefix_text, ctx->suffix)) {
+        std::cerr << "LLM: failed to render the chat template" << std::endl;
+        return false;
+    }
+
+    ctx->prefix = llm_tokenize(ctx->vocab, prefix_text, true, true);
+
+    // Templates that spell out BOS themselves would otherwise get it twice
+    const llama_token bos = llama_vocab_bos(ctx->vocab);
+    if (ctx->prefix.size() >= 2 && ctx->prefix[0] == bos && ctx->prefix[1] == bos) {
+        ctx->prefix.erase(ctx->prefix.begin());
+    }
+
+    if ((int) ctx->prefix.size() >= ctx->config.n_ctx) {
+        std::cerr << "LLM: prompt does not fit in n_ctx " << ctx->config.n_ctx << std::endl;
+        return false;
+    }
+
+    if (llm_load_session(ctx, model_path)) {
+        std::cout << "LLM: restored " << ctx->prefix.size() << " prompt tokens from " << ctx->session_path << std::endl;
+    } else {
+        const auto t0 = std::chrono::steady_clock::now();
+        if (!llm_decode(ctx, ctx->prefix.data(), (int) ctx->prefix.size())) {
+            return false;
+        }
+        std::cout << "LLM: decoded " << ctx->prefix.size() << " prompt tokens in " << llm_ms_since(t0) << " ms" << std::endl;
+        llm_save_session(ctx);
+    }
+
+    ctx->snapshot.resize(llama_state_seq_get_size(ctx->lctx, 0));
+    ctx->snapshot.resize(llama_state_seq_get_data(ctx->lctx, ctx->snapshot.data(), ctx->snapshot.size(), 0));
+    return true;
+}
+
+// Drops everything after the fixed prompt from sequence 0
+static bool llm_restore_prefix(llm_context* ctx) {
+    llama_memory_t mem = llama_get_memory(ctx->lctx);
+    if (llama_memory_seq_rm(mem, 0, (llama_pos) ctx->prefix.size(), -1)) {
+        return true;
+    }
+
+    // Recurrent state cannot be cut at a position, load the whole sequence back
+    llama_memory_seq_rm(mem, 0, -1, -1);
+    return llama_state_seq_set_data(ctx->lctx, ctx->snapshot.data(), ctx->snapshot.size(), 0) > 0;
+}
+
+// Length of the longest prefix of s that does not end inside a UTF-8 sequence
+static size_t llm_utf8_complete_len(const std::string& s) {
+    size_t n = s.size();
+    for (size_t back = 1; back <= 4 && back <= n; back++) {
+        const unsigned char c = (unsigned char) s[n - back];
+        if ((c & 0xC0) == 0x80) continue;  // Continuation byte
+        size_t len = 1;
+        if ((c & 0xE0) == 0xC0) len = 2;
+        else if ((c & 0xF0) == 0xE0) len = 3;
+        else if ((c & 0xF8) == 0xF0) len = 4;
+        return back < len ? n - back : n;
+    }
+    return n;
+}
+
+// Mirror of Dart_CObject from dart_api.h (a stable ABI), only the kinds posted here
+enum {
+    LLM_DART_STRING = 5,
+};
+
+struct llm_dart_cobject {
+    int32_t type;
+    union {
+        const char* as_string;
+        void* reserved[5]; // size of the full union in dart_api.h
+    } value;
+};
+
+typedef bool (*llm_dart_post_cobject_fn)(int64_t port, llm_dart_cobject* message);
+
+static std::atomic<llm_dart_post_cobject_fn> g_dart_post_cobject{nullptr};
+
+struct llm_port_sink {
+    llm_dart_post_cobject_fn post;
+    int64_t port;
+    std::string piece;  // NUL-terminated copy, Dart copies it again on post
+};
+
+static bool llm_post_piece(const char* piece, int n_bytes, void* user_data) {
+    llm_port_sink* sink = static_cast<llm_port_sink*>(user_data);
+    sink->piece.assign(piece, n_bytes);
+
+    llm_dart_cobject message;
+    message.type = LLM_DART_STRING;
+    message.value.as_string = sink->piece.c_str();
+    // Fails once the receiving port is closed: nobody is listening any more
+    return sink->post(sink->port, &message);
+}
+
+static bool llm_abort_callback(void* data) {
+    return static_cast<llm_context*>(data)->abort.load(std::memory_order_relaxed);
+}
+
+// llama logs every tensor it loads at debug level. This also becomes the
+// ggml logger, which is shared with whisper and logs the same way by default.
+static void llm_log_callback(ggml_log_level level, const char* text, void* /*user_data*/) {
+    static ggml_log_level last_level = GGML_LOG_LEVEL_INFO;
+    if (level == GGML_LOG_LEVEL_CONT) {
+        level = last_level;
+    } else {
+        last_level = level;
+    }
+    if (level == GGML_LOG_LEVEL_DEBUG) return;
+    fputs(text, stderr);
+}
+
+static void llm_backend_init() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        llama_log_set(llm_log_callback, nullptr);
+        llama_backend_init();
+    });
+}
+
+extern "C" {
+
+llm_config llm_default_config(void) {
+    llm_config config;
+    config.n_ctx = 2048;
+    config.n_threads = 0;
+    config.n_gpu_layers = -1;
+    config.n_predict = 512;
+    config.temperature = 0.0f;
+    config.seed = 0;
+    config.system_prompt = LLM_DEFAULT_SYSTEM_PROMPT;
+    config.instructions = LLM_DEFAULT_INSTRUCTIONS;
+    config.session_path = nullptr;
+    return config;
+}
+
+llm_context* llm_init(const char* model_path, llm_config config) {
+    if (!model_path) return nullptr;
+    llm_backend_init();
+
+    if (config.n_threads <= 0) {
+        config.n_threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+    }
+    if (config.n_ctx <= 0) config.n_ctx = 2048;
+    if (config.n_predict <= 0) config.n_predict = 512;
+
+    llama_model_params mparams = llama_model_default_params();
+    mparams.n_gpu_layers = config.n_gpu_layers;
+
+    llama_model* model = llama_model_load_from_file(model_path, mparams);
+    if (!model) {
+        std::cerr << "Failed to load LLM model: " << model_path << std::endl;
+        return nullptr;
+    }
+
+    // One sequence, and a batch large enough to take the whole prompt at once
+    llama_context_params cparams = llama_context_default_params();
+    cparams.n_ctx = config.n_ctx;
+    cparams.n_batch = config.n_ctx;
+    cparams.n_seq_max = 1;
+    cparams.n_threads = config.n_threads;
+    cparams.n_threads_batch = config.n_threads;
+
+    llama_context* lctx = llama_init_from_model(model, cparams);
+    if (!lctx) {
+        std::cerr << "Failed to create LLM context" << std::endl;
+        llama_model_free(model);
+        return nullptr;
+    }
+
+    llm_context* ctx = new llm_context();
+    ctx->model = model;
+    ctx->lctx = lctx;
+    ctx->vocab = llama_model_get_vocab(model);
+    ctx->config = config;
+    ctx->system_prompt = config.system_prompt ? config.system_prompt : "";
+    ctx->instructions = config.instructions ? config.instructions : "";
+    ctx->session_path = config.session_path ? config.session_path : "";
+    // The caller's strings are not kept past init
+    ctx->config.system_prompt = nullptr;
+    ctx->config.instructions = nullptr;
+    ctx->config.session_path = nullptr;
+
+    llama_set_abort_callback(lctx, llm_abort_callback, ctx);
+
+    ctx->smpl = llama_sampler_chain_init(llama_sampler_chain_default_params());
+    if (config.temperature > 0.0f) {
+        llama_sampler_chain_add(ctx->smpl, llama_sampler_init_temp(config.temperature));
+        llama_sampler_chain_add(ctx->smpl, llama_sampler_init_dist(config.seed));
+    } else {
+        llama_sampler_chain_add(ctx->smpl, llama_sampler_init_greedy());
+    }
+
+    if (!llm_prepare_prefix(ctx, model_path)) {
+        llm_free(ctx);
+        return nullptr;
+    }
+
+    return ctx;
+}
+
+void llm_free(llm_context* ctx) {
+    if (!ctx) return;
+    llama_sampler_free(ctx->smpl);
+    llama_free(ctx->lctx);
+    llama_model_free(ctx->model);
+    delete ctx;
+}
+
+const char* llm_cleanup(llm_context* ctx, const char* text, llm_piece_callback cb, void* user_data) {
+    if (!ctx || !text) return nullptr;
+
+    ctx->abort.store(false);
+    ctx->stats = llm_stats();
+    ctx->stats.n_prefix = (int) ctx->prefix.size();
+    ctx->result.clear();
+
+    if (!llm_restore_prefix(ctx)) {
+        std::cerr << "LLM: failed to restore the prompt snapshot" << std::endl;
+        return nullptr;
+    }
+
+    // The instructions end right before the transcript; the separating space
+    // goes with the transcript so it tokenizes as it would in one string
+    std::string transcript(text);
+    transcript.erase(0, transcript.find_first_not_of(" \t\n\r"));
+    ctx->prompt = llm_tokenize(ctx->vocab, " " + transcript, false, false);
+    const std::vector<llama_token> suffix = llm_tokenize(ctx->vocab, ctx->suffix, false, true);
+    ctx->prompt.insert(ctx->prompt.end(), suffix.begin(), suffix.end());
+    ctx->stats.n_prompt = (int) ctx->prompt.size();
+
+    const int n_ctx = (int) llama_n_ctx(ctx->lctx);
+    int n_past = ctx->stats.n_prefix + ctx->stats.n_prompt;
+    if (n_past >= n_ctx) {
+        std::cerr << "LLM: transcript of " << ctx->stats.n_prompt << " tokens does not fit in n_ctx " << n_ctx << std::endl;
+        return nullptr;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    if (!llm_decode(ctx, ctx->prompt.data(), (int) ctx->prompt.size())) {
+        return nullptr;
+    }
+    ctx->stats.t_prompt_ms = llm_ms_since(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    llama_sampler_reset(ctx->smpl);
+    size_t n_emitted = 0;
+    bool stopped = false;
+    std::vector<char> piece(64);
+    for (int i = 0; i < ctx->config.n_predict && n_past < n_ctx; i++) {
+        llama_token token = llama_sampler_sample(ctx->smpl, ctx->lctx, -1);
+        if (llama_vocab_is_eog(ctx->vocab, token)) {
+            break;
+        }
+
+        int n = llama_token_to_piece(ctx->vocab, token, piece.data(), (int32_t) piece.size(), 0, false);
+        if (n < 0) {
+            piece.resize(-n);
+            n = llama_token_to_piece(ctx->vocab, token, piece.data(), (int32_t) piece.size(), 0, false);
+        }
+        ctx->result.append(piece.data(), std::max(n, 0));
+        ctx->stats.n_generated++;
+
+        // Leading whitespace is never streamed, the result is trimmed anyway
+        if (n_emitted == 0) {
+            const size_t start = ctx->result.find_first_not_of(" \t\n\r");
+            if (start == std::string::npos) {
+                ctx->result.clear();
+            } else if (start > 0) {
+                ctx->result.erase(0, start);
+            }
+        }
+
+        if (cb) {
+            const size_t end = llm_utf8_complete_len(ctx->result);
+            if (end > n_emitted) {
+                stopped = !cb(ctx->result.data() + n_emitted, (int)(end - n_emitted), user_data);
+                n_emitted = end;
+                if (stopped) break;
+            }
+        }
+
+        if (ctx->abort.load() || !llm_decode(ctx, &token, 1)) {
+            return nullptr;
+        }
+        n_past++;
+    }
+    ctx->stats.t_generate_ms = llm_ms_since(t0);
+
+    // A reply cut off by n_predict can end inside a character
+    if (cb && !stopped && ctx->result.size() > n_emitted) {
+        cb(ctx->result.data() + n_emitted, (int)(ctx->result.size() - n_emitted), user_data);
+    }
+
+    const size_t end = ctx->result.find_last_not_of(" \t\n\r");
+    ctx->result.erase(end == std::string::npos ? 0 : end + 1);
+    return ctx->result.c_str();
+}
+
+void llm_dart_init(void* post_cobject) {
+    g_dart_post_cobject.store((llm_dart_post_cobject_fn) post_cobject, std::memory_order_release);
+}
+
+const char* llm_cleanup_port(llm_context* ctx, const char* text, int64_t piece_port) {
+    llm_dart_post_cobject_fn post = g_dart_post_cobject.load(std::memory_order_acquire);
+    if (!post || piece_port == 0) {
+        return llm_cleanup(ctx, text, nullptr, nullptr);
+    }
+
+    llm_port_sink sink;
+    sink.post = post;
+    sink.port = piece_port;
+    return llm_cleanup(ctx, text, llm_post_piece, &sink);
+}
+
+void llm_abort(llm_context* ctx) {
+    if (!ctx) return;
+    ctx->abort.store(true);
+}
+
+llm_stats llm_get_stats(llm_context* ctx) {
+    if (!ctx) return llm_stats();
+    return ctx->stats;
+}
+
+}
@@ -0,0 +1,74 @@
+#ifndef LLM_WRAPPER_H
+#define LLM_WRAPPER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct llm_context llm_context;
+
+typedef struct {
+    int n_ctx;             // Context size in tokens, prompt and reply together
+    int n_threads;         // 0 = half the hardware threads
+    int n_gpu_layers;      // Layers to offload, -1 = all
+    int n_predict;         // Maximum reply length in tokens
+    float temperature;     // 0 = greedy
+    uint32_t seed;
+    const char* system_prompt;
+    const char* instructions;  // Fixed text placed before the transcript in the user turn
+    const char* session_path;  // KV snapshot of the fixed prompt, NULL to keep it in memory only
+} llm_config;
+
+typedef struct {
+    int n_prefix;          // Tokens restored from the snapshot instead of decoded
+    int n_prompt;          // Tokens decoded for the transcript and the end of the prompt
+    int n_generated;
+    double t_prompt_ms;
+    double t_generate_ms;
+} llm_stats;
+
+// Called with each piece of the reply as it is generated. Pieces are not
+// NUL-terminated and end on a UTF-8 character boundary, unless the reply was
+// cut off by n_predict mid-character. Return false to stop generating. Leading whitespace is not streamed; trailing whitespace
+// may be, although the returned reply is trimmed.
+typedef bool (*llm_piece_callback)(const char* piece, int n_bytes, void* user_data);
+
+llm_config llm_default_config(void);
+
+// Loads the model and prepares the fixed part of the prompt: the chat template
+// is rendered around config.system_prompt and config.instructions, decoded
+// once, and saved to config.session_path. A later init with the same model
+// and prompt loads the snapshot instead of decoding it again.
+llm_context* llm_init(const char* model_path, llm_config config);
+void llm_free(llm_context* ctx);
+
+// Clean up a transcription. Only the transcript and the closing template
+// tokens are decoded, on top of the restored prompt snapshot. cb may be NULL.
+// Returns the trimmed reply, owned by ctx and valid until the next call, or
+// NULL on error or abort.
+const char* llm_cleanup(llm_context* ctx, const char* text, llm_piece_callback cb, void* user_data);
+
+// Hands the library Dart's NativeApi.postCObject so llm_cleanup_port can post
+// to native ports.
+void llm_dart_init(void* post_cobject);
+
+// llm_cleanup with each piece of the reply posted to the Dart native port
+// piece_port as a string. Generation stops if the port has been closed.
+// llm_dart_init must be called first.
+const char* llm_cleanup_port(llm_context* ctx, const char* text, int64_t piece_port);
+
+// Stop a running llm_cleanup from another thread. The flag is cleared when
+// the next llm_cleanup starts.
+void llm_abort(llm_context* ctx);
+
+// Timings of the last llm_cleanup
+llm_stats llm_get_stats(llm_context* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,130 @@
+// Checks when llm_init trusts the prompt snapshot at session_path. It is
+// restored only while it is newer than the model and holds exactly the
+// prompt tokens; otherwise, and when the file is damaged, the prompt is
+// decoded again and the snapshot rewritten. Every reply must match the one
+// from a context that never used a snapshot. A restore leaves the file
+// alone, while a rewrite replaces it through a rename, so the inode tells
+// which path init took.
+//
+// usage: llm_session_test <model.gguf>
+
+#include "llm_wrapper.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static int n_failed = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        std::fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+        std::fprintf(stderr, __VA_ARGS__); \
+        std::fprintf(stderr, "\n"); \
+        n_failed++; \
+    } \
+} while (0)
+
+static const char* TRANSCRIPT = "so um the meeting is moved to thursday i think";
+
+static llm_config test_config(const char* session_path, const char* instructions) {
+    llm_config config = llm_default_config();
+    config.n_ctx = 512;
+    config.n_threads = 1;
+    config.n_gpu_layers = 0;
+    config.n_predict = 16;
+    config.temperature = 0.0f;
+    config.instructions = instructions;
+    config.session_path = session_path;
+    return config;
+}
+
+// Reply to TRANSCRIPT, or "" when init or the cleanup failed
+static std::string reply(const char* model_path, const char* session_path, const char* instructions) {
+    llm_context* ctx = llm_init(model_path, test_config(session_path, instructions));
+    if (!ctx) return "";
+    const char* text = llm_cleanup(ctx, TRANSCRIPT, nullptr, nullptr);
+    const std::string result = text ? text : "";
+    llm_free(ctx);
+    return result;
+}
+
+static ino_t inode_of(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? st.st_ino : 0;
+}
+
+// Moves the file's mtime relative to the model's
+static void set_mtime(const std::string& path, const char* model_path, int seconds_after_model) {
+    struct stat st;
+    stat(model_path, &st);
+    struct timespec times[2];
+    times[0].tv_sec = st.st_mtime + seconds_after_model;
+    times[0].tv_nsec = 0;
+    times[1] = times[0];
+    utimensat(AT_FDCWD, path.c_str(), times, 0);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <model.gguf>" << std::endl;
+        return 2;
+    }
+    const char* model = argv[1];
+
+    char dir[] = "/tmp/llm_session_test_XXXXXX";
+    if (!mkdtemp(dir)) {
+        std::cerr << "LLM session test: cannot create a temporary directory" << std::endl;
+        return 2;
+    }
+    const std::string session = std::string(dir) + "/model.session";
+    const char* instructions = "Fix the punctuation.";
+    const char* other_instructions = "Fix the punctuation and the capitalization.";
+
+    const std::string expected = reply(model, nullptr, instructions);
+    const std::string other_expected = reply(model, nullptr, other_instructions);
+    CHECK(!expected.empty() || !other_expected.empty(), "the model produced no reply");
+
+    // Written by the first init
+    CHECK(reply(model, session.c_str(), instructions) == expected, "the reply changed when the snapshot was written");
+    ino_t inode = inode_of(session);
+    CHECK(inode != 0, "no snapshot was written");
+
+    // Fresh and the same prompt: restored
+    set_mtime(session, model, 10);
+    CHECK(reply(model, session.c_str(), instructions) == expected, "the reply changed after a restore");
+    CHECK(inode_of(session) == inode, "a fresh snapshot of the same prompt was not restored");
+
+    // Older than the model: decoded again
+    set_mtime(session, model, -10);
+    CHECK(reply(model, session.c_str(), instructions) == expected, "the reply changed after a stale snapshot");
+    CHECK(inode_of(session) != inode, "a snapshot older than the model was restored");
+    inode = inode_of(session);
+
+    // Fresh but for another prompt: decoded again
+    set_mtime(session, model, 10);
+    CHECK(reply(model, session.c_str(), other_instructions) == other_expected,
+          "the reply changed after a snapshot of another prompt");
+    CHECK(inode_of(session) != inode, "a snapshot of another prompt was restored");
+    inode = inode_of(session);
+
+    // Cut short: the partial load is dropped and the prompt decoded again
+    struct stat st;
+    stat(session.c_str(), &st);
+    CHECK(truncate(session.c_str(), st.st_size / 2) == 0, "cannot truncate the snapshot");
+    set_mtime(session, model, 10);
+    CHECK(reply(model, session.c_str(), other_instructions) == other_expected,
+          "the reply changed after a damaged snapshot");
+    CHECK(inode_of(session) != inode, "a damaged snapshot was kept");
+
+    unlink(session.c_str());
+    rmdir(dir);
+
+    std::printf("%s\n", n_failed == 0 ? "OK" : "FAILED");
+    return n_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+// Runs a fixture through the streaming Silero model and checks the segment
+// offsets vad_feed reports. The fixture is silence with two bursts of audio:
+// a recording when one is given, otherwise noise. The expected events are
+// derived independently from the per-frame probabilities of
+// vad_process_batch, so the offsets and the carry-over of partial frames are
+// checked with any model. With a recording and a real model, the segments
+// must also start where the bursts were placed.
+//
+// usage: vad_stream_test <ggml-silero.bin> [speech.wav]
+
+#include "vad_wrapper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static int n_failed = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        std::fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+        std::fprintf(stderr, __VA_ARGS__); \
+        std::fprintf(stderr, "\n"); \
+        n_failed++; \
+    } \
+} while (0)
+
+static const int SAMPLE_RATE = 16000;
+
+// Samples of the data chunk, for the 16 kHz mono 16-bit PCM the app records
+static bool read_wav(const char* path, std::vector<float>& samples) {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.size() < 12 || std::memcmp(data.data(), "RIFF", 4) != 0 || std::memcmp(data.data() + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    for (size_t pos = 12; pos + 8 <= data.size();) {
+        uint32_t size;
+        std::memcpy(&size, data.data() + pos + 4, 4);
+        if (pos + 8 + size > data.size()) size = (uint32_t) (data.size() - pos - 8);
+        if (std::memcmp(data.data() + pos, "data", 4) == 0) {
+            samples.resize(size / 2);
+            for (size_t i = 0; i < samples.size(); i++) {
+                int16_t s;
+                std::memcpy(&s, data.data() + pos + 8 + 2 * i, 2);
+                samples[i] = s / 32768.0f;
+            }
+            return true;
+        }
+        pos += 8 + size + (size & 1);
+    }
+    return false;
+}
+
+// Silero's VADIterator over per-frame probabilities, written out separately
+// from the wrapper's segmenter
+static std::vector<vad_event> expected_events(const std::vector<float>& probs, int frame_size, const vad_config& config) {
+    const int64_t pad = (int64_t) config.speech_pad_ms * SAMPLE_RATE / 1000;
+    const int64_t min_silence = (int64_t) config.min_silence_duration_ms * SAMPLE_RATE / 1000;
+    std::vector<vad_event> events;
+    bool speaking = false;
+    int64_t silence_start = -1;
+    for (size_t i = 0; i < probs.size(); i++) {
+        const int64_t frame_start = (int64_t) i * frame_size;
+        const int64_t frame_end = frame_start + frame_size;
+        if (probs[i] >= config.threshold) {
+            silence_start = -1;
+            if (!speaking) {
+                speaking = true;
+                events.push_back({ VAD_EVENT_SPEECH_START, std::max<int64_t>(0, frame_start - pad) });
+            }
+        } else if (speaking && probs[i] < config.threshold - 0.15f) {
+            if (silence_start < 0) silence_start = frame_start;
+            if (frame_end - (silence_start + frame_size) >= min_silence) {
+                events.push_back({ VAD_EVENT_SPEECH_END, silence_start + pad });
+                speaking = false;
+                silence_start = -1;
+            }
+        }
+    }
+    return events;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <ggml-silero.bin> [speech.wav]" << std::endl;
+        return 2;
+    }
+
+    std::vector<float> burst;
+    const bool has_speech = argc > 2;
+    if (has_speech) {
+        if (!read_wav(argv[2], burst)) {
+            std::cerr << "VAD stream test: cannot read " << argv[2] << std::endl;
+            return 2;
+        }
+    } else {
+        std::mt19937 rng(7);
+        std::normal_distribution<float> noise(0.0f, 0.2f);
+        burst.resize(2 * SAMPLE_RATE);
+        for (float& s : burst) s = noise(rng);
+    }
+
+    // 1 s silence, burst, 1.5 s silence, burst, 1 s silence
+    const int64_t burst_at[2] = { SAMPLE_RATE, SAMPLE_RATE + (int64_t) burst.size() + 3 * SAMPLE_RATE / 2 };
+    std::vector<float> fixture(burst_at[1] + burst.size() + SAMPLE_RATE, 0.0f);
+    for (int64_t at : burst_at) std::copy(burst.begin(), burst.end(), fixture.begin() + at);
+
+    vad_config config;
+    config.sample_rate = SAMPLE_RATE;
+    config.frame_size = 0;
+    config.threshold = 0.5f;
+    config.min_silence_duration_ms = 300;
+    config.speech_pad_ms = 100;
+    vad_context* ctx = vad_init(argv[1], config);
+    if (!ctx) {
+        std::cerr << "VAD stream test: failed to load " << argv[1] << std::endl;
+        return 2;
+    }
+
+    // Silero's window at 16 kHz
+    const int frame_size = 512;
+    const int n_frames = (int) (fixture.size() / frame_size);
+    std::vector<float> probs(n_frames);
+    CHECK(vad_process_batch(ctx, fixture.data(), n_frames, probs.data()) == n_frames, "vad_process_batch failed");
+
+    // The LSTM state carries over the same way frame by frame
+    vad_reset(ctx);
+    for (int i = 0; i < n_frames; i++) {
+        const float prob = vad_process(ctx, fixture.data() + (size_t) i * frame_size, frame_size);
+        if (std::fabs(prob - probs[i]) > 1e-5f) {
+            CHECK(false, "frame %d: %f one at a time, %f batched", i, prob, probs[i]);
+            break;
+        }
+    }
+
+    if (!has_speech) {
+        // A random model may sit on either side of 0.5; centre the
+        // hysteresis band on the range the fixture covers
+        const auto range = std::minmax_element(probs.begin(), probs.end());
+        config.threshold = (*range.first + *range.second + 0.15f) / 2;
+        std::printf("probabilities %f to %f, threshold %f\n", *range.first, *range.second, config.threshold);
+        vad_set_threshold(ctx, config.threshold);
+    }
+    const std::vector<vad_event> expected = expected_events(probs, frame_size, config);
+
+    // Chunks that never line up with the frames
+    std::vector<vad_event> events;
+    vad_reset(ctx);
+    const int chunk_sizes[] = { 100, 777, 1, 512, 4000, 333 };
+    for (size_t offset = 0, k = 0; offset < fixture.size(); k++) {
+        const int n = (int) std::min<size_t>(chunk_sizes[k % 6], fixture.size() - offset);
+        vad_event chunk_events[8];
+        const int n_events = vad_feed(ctx, fixture.data() + offset, n, chunk_events, 8);
+        CHECK(n_events >= 0, "vad_feed failed at %zu", offset);
+        events.insert(events.end(), chunk_events, chunk_events + std::max(n_events, 0));
+        offset += n;
+    }
+
+    CHECK(events.size() == expected.size(), "%zu events, expected %zu", events.size(), expected.size());
+    for (size_t i = 0; i < events.size() && i < expected.size(); i++) {
+        std::printf("event %zu: type %d at %lld\n", i, events[i].type, (long long) events[i].offset);
+        CHECK(events[i].type == expected[i].type && events[i].offset == expected[i].offset,
+              "event %zu: type %d at %lld, expected type %d at %lld", i, events[i].type, (long long) events[i].offset,
+              expected[i].type, (long long) expected[i].offset);
+    }
+
+    if (has_speech) {
+        // Each burst opens a segment no earlier than its padding allows and
+        // within half a second of its start
+        const int64_t pad = (int64_t) config.speech_pad_ms * SAMPLE_RATE / 1000;
+        std::vector<int64_t> starts;
+        for (const vad_event& e : events) {
+            if (e.type == VAD_EVENT_SPEECH_START) starts.push_back(e.offset);
+        }
+        CHECK(starts.size() >= 2, "%zu segments for two bursts of speech", starts.size());
+        for (int b = 0; b < 2; b++) {
+            const bool found = std::any_of(starts.begin(), starts.end(), [&](int64_t s) {
+                return s >= burst_at[b] - pad - frame_size && s <= burst_at[b] + SAMPLE_RATE / 2;
+            });
+            CHECK(found, "no segment starts at burst %d (sample %lld)", b, (long long) burst_at[b]);
+        }
+        CHECK(starts.empty() || starts.front() >= burst_at[0] - pad - frame_size, "speech detected in the leading silence");
+    }
+
+    vad_free(ctx);
+
+    std::printf("%s\n", n_failed == 0 ? "OK" : "FAILED");
+    return n_failed == 0 ? 0 : 1;
+}
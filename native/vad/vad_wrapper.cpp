@@ -1,5 +1,5 @@
 #include "vad_wrapper.h"
-#include <onnxruntime/onnxruntime_c_api.h>
+#include "whisper.h"
 #include <vector>
 #include <string>
 #include <iostream>
@@ -7,168 +7,271 @@
 #include <algorithm>
 #include <cstring>
 
-const OrtApi* g_ort = OrtGetApiBase()->GetApi(ORT_API_VERSION);
-
 struct vad_context {
-    OrtEnv* env;
-    OrtSession* session;
-    OrtMemoryInfo* mem_info;
-    
+    // ggml Silero model from whisper.cpp, run in streaming mode: the LSTM
+    // state persists between frames and the graph is allocated once
+    whisper_vad_context* vctx;
+
     vad_config config;
-    std::vector<float> state;
-    std::vector<float> context;  // Context buffer (64 samples for 16kHz, 32 for 8kHz)
-    
-    vad_context() : env(nullptr), session(nullptr), mem_info(nullptr) {}
+    int frame_size;    // Samples per model window, fixed by the model (512 at 16 kHz)
+
+    // Segmenter state for vad_feed. Offsets count samples since init/reset.
+    std::vector<float> pending;  // Partial frame carried between feeds
+    std::vector<float> window;   // Zero-padded short frame for vad_process
+    int n_pending;
+    int64_t current_sample;      // End of the last frame run through the model
+    int64_t temp_end;            // Start of the current silence run, 0 if none
+    bool triggered;
+
+    // Pre-roll ring holding the most recent samples fed
+    std::vector<float> ring;
+    int64_t n_fed;
+
+    vad_context() : vctx(nullptr), frame_size(0),
+                    n_pending(0), current_sample(0), temp_end(0), triggered(false), n_fed(0) {}
 };
 
+static int debug_counter = 0;
+
+// Runs n_frames whole windows through the model. No allocation happens here.
+static bool vad_run_frames(vad_context* ctx, const float* samples, int n_frames, float* probs) {
+    // Debug: check sample statistics every 50 calls
+    debug_counter++;
+    if (debug_counter % 50 == 0) {
+        float maxAbs = 0.0f;
+        float sum = 0.0f;
+        for (int i = 0; i < ctx->frame_size; i++) {
+            float abs = samples[i] < 0 ? -samples[i] : samples[i];
+            if (abs > maxAbs) maxAbs = abs;
+            sum += samples[i];
+        }
+        std::cout << "DEBUG: [VAD Native] n=" << ctx->frame_size << " x " << n_frames << " maxAbs=" << maxAbs << " mean=" << (sum/ctx->frame_size) << " sr=" << ctx->config.sample_rate << std::endl;
+    }
+
+    if (!whisper_vad_stream_process(ctx->vctx, samples, n_frames, probs)) {
+        std::cerr << "VAD frame processing failed" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool vad_run_frame(vad_context* ctx, const float* samples, float* prob) {
+    return vad_run_frames(ctx, samples, 1, prob);
+}
+
+static int vad_ms_to_samples(const vad_context* ctx, int ms) {
+    return ms > 0 ? (int)((int64_t) ms * ctx->config.sample_rate / 1000) : 0;
+}
+
+static void vad_ring_write(vad_context* ctx, const float* samples, int n_samples) {
+    // Keep enough for the padded start of a frame that completes in this chunk
+    const size_t needed = (size_t) vad_ms_to_samples(ctx, ctx->config.speech_pad_ms) + 2 * ctx->frame_size + n_samples;
+    if (ctx->ring.size() < needed) {
+        // Grow while preserving the chronological tail
+        std::vector<float> grown(needed, 0.0f);
+        const int64_t keep = std::min<int64_t>(ctx->n_fed, (int64_t) ctx->ring.size());
+        for (int64_t i = 0; i < keep; i++) {
+            const int64_t pos = ctx->n_fed - keep + i;
+            grown[pos % needed] = ctx->ring[pos % ctx->ring.size()];
+        }
+        ctx->ring.swap(grown);
+    }
+
+    const size_t cap = ctx->ring.size();
+    size_t head = (size_t)(ctx->n_fed % cap);
+    int done = 0;
+    while (done < n_samples) {
+        const size_t chunk = std::min(cap - head, (size_t)(n_samples - done));
+        std::memcpy(ctx->ring.data() + head, samples + done, chunk * sizeof(float));
+        done += (int) chunk;
+        head = 0;
+    }
+    ctx->n_fed += n_samples;
+}
+
+// Silero VADIterator semantics: hysteresis between threshold and
+// threshold - 0.15, and a hangover of min_silence_duration_ms before ending
+static void vad_segment(vad_context* ctx, float prob, vad_event* events, int max_events, int* n_events) {
+    const int64_t pad = vad_ms_to_samples(ctx, ctx->config.speech_pad_ms);
+    const int64_t min_silence = vad_ms_to_samples(ctx, ctx->config.min_silence_duration_ms);
+    const float threshold = ctx->config.threshold;
+
+    ctx->current_sample += ctx->frame_size;
+
+    if (prob >= threshold && ctx->temp_end) {
+        ctx->temp_end = 0;
+    }
+
+    if (prob >= threshold && !ctx->triggered) {
+        ctx->triggered = true;
+        if (*n_events < max_events) {
+            events[*n_events].type = VAD_EVENT_SPEECH_START;
+            events[*n_events].offset = std::max<int64_t>(0, ctx->current_sample - pad - ctx->frame_size);
+            (*n_events)++;
+        }
+        return;
+    }
+
+    if (prob < threshold - 0.15f && ctx->triggered) {
+        if (!ctx->temp_end) {
+            ctx->temp_end = ctx->current_sample;
+        }
+        if (ctx->current_sample - ctx->temp_end < min_silence) {
+            return;
+        }
+        if (*n_events < max_events) {
+            events[*n_events].type = VAD_EVENT_SPEECH_END;
+            events[*n_events].offset = ctx->temp_end + pad - ctx->frame_size;
+            (*n_events)++;
+        }
+        ctx->temp_end = 0;
+        ctx->triggered = false;
+    }
+}
+
 extern "C" {
 
 vad_context* vad_init(const char* model_path, vad_config config) {
-    vad_context* ctx = new vad_context();
-    ctx->config = config;
-    
-    OrtStatus* status = g_ort->CreateEnv(ORT_LOGGING_LEVEL_WARNING, "VAD", &ctx->env);
-    if (status != nullptr) {
-        delete ctx;
+    if (config.sample_rate != 16000) {
+        std::cerr << "VAD: only 16 kHz audio is supported, got " << config.sample_rate << std::endl;
         return nullptr;
     }
-    
-    OrtSessionOptions* session_options;
-    g_ort->CreateSessionOptions(&session_options);
-    g_ort->SetIntraOpNumThreads(session_options, 1);
-    g_ort->SetSessionGraphOptimizationLevel(session_options, ORT_ENABLE_ALL);
-    
-    status = g_ort->CreateSession(ctx->env, model_path, session_options, &ctx->session);
-    g_ort->ReleaseSessionOptions(session_options);
-    
-    if (status != nullptr) {
-        const char* msg = g_ort->GetErrorMessage(status);
-        std::cerr << "Failed to create ORT session: " << msg << std::endl;
-        g_ort->ReleaseStatus(status);
-        g_ort->ReleaseEnv(ctx->env);
-        delete ctx;
+
+    // One frame is far too small to be worth spreading over threads
+    whisper_vad_context_params params = whisper_vad_default_context_params();
+    params.n_threads = 1;
+    params.use_gpu = false;
+
+    whisper_vad_context* vctx = whisper_vad_init_from_file_with_params(model_path, params);
+    if (!vctx) {
+        std::cerr << "Failed to load VAD model: " << model_path << std::endl;
         return nullptr;
     }
-    
-    g_ort->CreateMemoryInfo("Cpu", OrtDeviceAllocator, 0, OrtMemTypeDefault, &ctx->mem_info);
-    
-    // Initialize state (2 x 1 x 128 for Silero VAD)
-    ctx->state.assign(2 * 1 * 128, 0.0f);
-    
-    // Initialize context buffer (64 samples for 16kHz, 32 for 8kHz)
-    int context_size = (config.sample_rate == 16000) ? 64 : 32;
-    ctx->context.assign(context_size, 0.0f);
-    
+
+    // The LSTM state buffer is not zeroed on allocation
+    whisper_vad_stream_reset(vctx);
+
+    vad_context* ctx = new vad_context();
+    ctx->vctx = vctx;
+    ctx->config = config;
+
+    ctx->frame_size = whisper_vad_n_window(vctx);
+    if (config.frame_size > 0 && config.frame_size != ctx->frame_size) {
+        std::cerr << "VAD: model window is " << ctx->frame_size << " samples, ignoring frame_size " << config.frame_size << std::endl;
+    }
+    ctx->config.frame_size = ctx->frame_size;
+    ctx->pending.assign(ctx->frame_size, 0.0f);
+    ctx->window.assign(ctx->frame_size, 0.0f);
+
     return ctx;
 }
 
 void vad_free(vad_context* ctx) {
     if (!ctx) return;
-    if (ctx->session) g_ort->ReleaseSession(ctx->session);
-    if (ctx->mem_info) g_ort->ReleaseMemoryInfo(ctx->mem_info);
-    if (ctx->env) g_ort->ReleaseEnv(ctx->env);
+    whisper_vad_free(ctx->vctx);
     delete ctx;
 }
 
 void vad_reset(vad_context* ctx) {
     if (!ctx) return;
-    std::fill(ctx->state.begin(), ctx->state.end(), 0.0f);
-    std::fill(ctx->context.begin(), ctx->context.end(), 0.0f);
+    whisper_vad_stream_reset(ctx->vctx);
+    ctx->n_pending = 0;
+    ctx->current_sample = 0;
+    ctx->temp_end = 0;
+    ctx->triggered = false;
+    ctx->n_fed = 0;
 }
 
-static int debug_counter = 0;
+int vad_feed(vad_context* ctx, const float* samples, int n_samples, vad_event* events, int max_events) {
+    if (!ctx || (!samples && n_samples > 0) || n_samples < 0) return -1;
+    if (!events) max_events = 0;
 
-float vad_process(vad_context* ctx, const float* samples, int n_samples) {
-    if (!ctx || !ctx->session) return 0.0f;
-    
-    int context_size = (int)ctx->context.size();
-    
-    // Build input: [context (64 samples) + new samples (512 samples)] = 576 samples total
-    std::vector<float> input_with_context(context_size + n_samples);
-    std::copy(ctx->context.begin(), ctx->context.end(), input_with_context.begin());
-    std::copy(samples, samples + n_samples, input_with_context.begin() + context_size);
-    
-    int total_samples = (int)input_with_context.size();
-    
-    // Debug: check sample statistics every 50 calls
-    debug_counter++;
-    if (debug_counter % 50 == 0) {
-        float maxAbs = 0.0f;
-        float sum = 0.0f;
-        for (int i = 0; i < total_samples; i++) {
-            float abs = input_with_context[i] < 0 ? -input_with_context[i] : input_with_context[i];
-            if (abs > maxAbs) maxAbs = abs;
-            sum += input_with_context[i];
-        }
-        std::cout << "DEBUG: [VAD Native] n=" << total_samples << " (ctx=" << context_size << " + samples=" << n_samples << ") maxAbs=" << maxAbs << " mean=" << (sum/total_samples) << " sr=" << ctx->config.sample_rate << std::endl;
-    }
-
-    const char* input_names[] = {"input", "state", "sr"};
-    const char* output_names[] = {"output", "stateN"};
-    
-    int64_t input_shape[] = {1, (int64_t)total_samples};
-    int64_t state_shape[] = {2, 1, 128};
-    int64_t sr_val = (int64_t) ctx->config.sample_rate;
-    
-    OrtValue* input_tensor = nullptr;
-    g_ort->CreateTensorWithDataAsOrtValue(ctx->mem_info, (void*)input_with_context.data(), total_samples * sizeof(float), input_shape, 2, ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, &input_tensor);
-    
-    OrtValue* state_tensor = nullptr;
-    g_ort->CreateTensorWithDataAsOrtValue(ctx->mem_info, (void*)ctx->state.data(), ctx->state.size() * sizeof(float), state_shape, 3, ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, &state_tensor);
-
-    OrtValue* sr_tensor = nullptr;
-    g_ort->CreateTensorWithDataAsOrtValue(ctx->mem_info, (void*)&sr_val, sizeof(int64_t), nullptr, 0, ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64, &sr_tensor);
-    
-    OrtValue* inputs[] = {input_tensor, state_tensor, sr_tensor};
-    OrtValue* outputs[] = {nullptr, nullptr};
-    
-    OrtStatus* status = g_ort->Run(ctx->session, nullptr, input_names, (const OrtValue* const*)inputs, 3, output_names, 2, outputs);
-    
+    vad_ring_write(ctx, samples, n_samples);
+
+    const int frame_size = ctx->frame_size;
+    if ((int) ctx->pending.size() < frame_size) ctx->pending.resize(frame_size);
+    int n_events = 0;
+    int offset = 0;
     float prob = 0.0f;
-    if (status == nullptr) {
-        float* output_data;
-        g_ort->GetTensorMutableData(outputs[0], (void**)&output_data);
-        
-        // Debug: print output tensor info
-        if (debug_counter % 50 == 0) {
-            OrtTensorTypeAndShapeInfo* type_info;
-            g_ort->GetTensorTypeAndShape(outputs[0], &type_info);
-            size_t num_dims;
-            g_ort->GetDimensionsCount(type_info, &num_dims);
-            std::vector<int64_t> dims(num_dims);
-            g_ort->GetDimensions(type_info, dims.data(), num_dims);
-            std::cout << "DEBUG: [VAD Native] output dims=" << num_dims << " [";
-            for (size_t i = 0; i < num_dims; i++) std::cout << dims[i] << (i < num_dims-1 ? ", " : "");
-            std::cout << "] values=[" << output_data[0] << "]" << std::endl;
-            g_ort->ReleaseTensorTypeAndShapeInfo(type_info);
-        }
-        
-        prob = output_data[0];
-        
-        // Update hidden state
-        float* next_state_data;
-        g_ort->GetTensorMutableData(outputs[1], (void**)&next_state_data);
-        if (next_state_data) {
-            std::memcpy(ctx->state.data(), next_state_data, ctx->state.size() * sizeof(float));
+
+    // Complete the frame left over from the previous feed
+    if (ctx->n_pending > 0) {
+        const int n = std::min(n_samples, frame_size - ctx->n_pending);
+        std::memcpy(ctx->pending.data() + ctx->n_pending, samples, n * sizeof(float));
+        ctx->n_pending += n;
+        offset = n;
+        if (ctx->n_pending < frame_size) {
+            return 0;
         }
-        
-        g_ort->ReleaseValue(outputs[0]);
-        g_ort->ReleaseValue(outputs[1]);
-    } else {
-        const char* msg = g_ort->GetErrorMessage(status);
-        std::cerr << "VAD ORT Run failed: " << msg << std::endl;
-        g_ort->ReleaseStatus(status);
-    }
-    
-    // Update context with the last 64 samples of the full input (context + new audio)
-    // This matches the Python implementation: self._context = x[..., -context_size:]
-    std::copy(input_with_context.end() - context_size, input_with_context.end(), ctx->context.begin());
-    
-    g_ort->ReleaseValue(input_tensor);
-    g_ort->ReleaseValue(state_tensor);
-    g_ort->ReleaseValue(sr_tensor);
-    
+        ctx->n_pending = 0;
+        if (!vad_run_frame(ctx, ctx->pending.data(), &prob)) return -1;
+        vad_segment(ctx, prob, events, max_events, &n_events);
+    }
+
+    // Whole frames straight from the caller's buffer
+    for (; n_samples - offset >= frame_size; offset += frame_size) {
+        if (!vad_run_frame(ctx, samples + offset, &prob)) return -1;
+        vad_segment(ctx, prob, events, max_events, &n_events);
+    }
+
+    if (offset < n_samples) {
+        ctx->n_pending = n_samples - offset;
+        std::memcpy(ctx->pending.data(), samples + offset, ctx->n_pending * sizeof(float));
+    }
+
+    return n_events;
+}
+
+int vad_copy_preroll(vad_context* ctx, int64_t offset, float* out, int max_samples) {
+    if (!ctx || !out || max_samples < 0 || offset < 0 || offset > ctx->n_fed) return -1;
+
+    const size_t cap = ctx->ring.size();
+    if (cap == 0) return 0;
+    if (ctx->n_fed - offset > (int64_t) cap) return -1;
+
+    const int n = (int) std::min<int64_t>(ctx->n_fed - offset, max_samples);
+    for (int i = 0; i < n; i++) {
+        out[i] = ctx->ring[(size_t)((offset + i) % cap)];
+    }
+    return n;
+}
+
+bool vad_is_speaking(vad_context* ctx) {
+    return ctx && ctx->triggered;
+}
+
+void vad_set_threshold(vad_context* ctx, float threshold) {
+    if (!ctx) return;
+    ctx->config.threshold = threshold;
+}
+
+float vad_process(vad_context* ctx, const float* samples, int n_samples) {
+    if (!ctx || !samples || n_samples <= 0) return 0.0f;
+
+    // The model takes whole windows: a short frame is zero-padded, a long one
+    // is run window by window and the last probability is returned
+    const int frame_size = ctx->frame_size;
+    float prob = 0.0f;
+    int offset = 0;
+    for (; n_samples - offset >= frame_size; offset += frame_size) {
+        if (!vad_run_frame(ctx, samples + offset, &prob)) return 0.0f;
+    }
+    if (offset < n_samples) {
+        std::fill(ctx->window.begin(), ctx->window.end(), 0.0f);
+        std::memcpy(ctx->window.data(), samples + offset, (n_samples - offset) * sizeof(float));
+        if (!vad_run_frame(ctx, ctx->window.data(), &prob)) return 0.0f;
+    }
     return prob;
 }
 
+int vad_process_batch(vad_context* ctx, const float* samples, int n_frames, float* out_probs) {
+    if (!ctx || !samples || !out_probs || n_frames < 0) return -1;
+    if (n_frames == 0) return 0;
+
+    // Silero is stateful across frames, so the windows run back to back on
+    // the one allocated graph rather than as one batched tensor
+    if (!vad_run_frames(ctx, samples, n_frames, out_probs)) return -1;
+    return n_frames;
+}
+
 }
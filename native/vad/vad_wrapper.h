@@ -18,13 +18,44 @@ typedef struct {
     int speech_pad_ms;
 } vad_config;
 
+typedef enum {
+    VAD_EVENT_SPEECH_START = 1,
+    VAD_EVENT_SPEECH_END = 2,
+} vad_event_type;
+
+typedef struct {
+    int type;        // vad_event_type
+    int64_t offset;  // Absolute sample offset since init/reset, padded by speech_pad_ms
+} vad_event;
+
 vad_context* vad_init(const char* model_path, vad_config config);
 void vad_free(vad_context* ctx);
 
 // Process a frame of audio. Returns probability of speech (0.0 to 1.0).
 float vad_process(vad_context* ctx, const float* samples, int n_samples);
 
-// Reset the VAD state (RNN hidden states)
+// Process n_frames consecutive frames of config.frame_size samples in one call,
+// writing one speech probability per frame to out_probs. Returns the number of
+// frames processed, or -1 on error.
+int vad_process_batch(vad_context* ctx, const float* samples, int n_frames, float* out_probs);
+
+// Feed an arbitrary chunk of audio through the segmenter. Partial frames are
+// carried over to the next call. Speech starts once a frame crosses threshold;
+// it ends after min_silence_duration_ms below (threshold - 0.15). Writes up to
+// max_events events and returns how many were written, or -1 on error.
+int vad_feed(vad_context* ctx, const float* samples, int n_samples, vad_event* events, int max_events);
+
+// Copy the retained audio from offset up to the last sample fed, e.g. the
+// pre-roll of a speech start event. Returns the number of samples copied, or
+// -1 if offset is no longer held by the pre-roll ring.
+int vad_copy_preroll(vad_context* ctx, int64_t offset, float* out, int max_samples);
+
+// Whether the segmenter is currently inside a speech segment
+bool vad_is_speaking(vad_context* ctx);
+
+void vad_set_threshold(vad_context* ctx, float threshold);
+
+// Reset the VAD state (RNN hidden states, segmenter and pre-roll ring)
 void vad_reset(vad_context* ctx);
 
 #ifdef __cplusplus
@@ -5,6 +5,8 @@
 #define whisper_state real_whisper_state
 #define whisper_full_params real_whisper_full_params
 #define whisper_context_params real_whisper_context_params
+#define whisper_load_stats real_whisper_load_stats
+#define whisper_speculative_stats real_whisper_speculative_stats
 #define whisper_token_data real_whisper_token_data
 #define whisper_model_loader real_whisper_model_loader
 #define whisper_grammar_element real_whisper_grammar_element
@@ -29,12 +31,26 @@
 #define whisper_ctx_init_openvino_encoder real_whisper_ctx_init_openvino_encoder
 #define whisper_free real_whisper_free
 #define whisper_free_state real_whisper_free_state
+#define whisper_set_threadpool_with_state real_whisper_set_threadpool_with_state
+#define whisper_get_load_stats real_whisper_get_load_stats
+#define whisper_get_model_memory real_whisper_get_model_memory
+#define whisper_get_state_memory real_whisper_get_state_memory
+#define whisper_prefault_model real_whisper_prefault_model
+#define whisper_get_speculative_stats real_whisper_get_speculative_stats
 #define whisper_free_params real_whisper_free_params
 #define whisper_free_context_params real_whisper_free_context_params
 #define whisper_pcm_to_mel real_whisper_pcm_to_mel
 #define whisper_pcm_to_mel_with_state real_whisper_pcm_to_mel_with_state
 #define whisper_pcm_to_mel_phase_vocoder real_whisper_pcm_to_mel_phase_vocoder
 #define whisper_pcm_to_mel_phase_vocoder_with_state real_whisper_pcm_to_mel_phase_vocoder_with_state
+#define whisper_mel_stream_reset real_whisper_mel_stream_reset
+#define whisper_mel_stream_reset_with_state real_whisper_mel_stream_reset_with_state
+#define whisper_mel_stream_append real_whisper_mel_stream_append
+#define whisper_mel_stream_append_with_state real_whisper_mel_stream_append_with_state
+#define whisper_mel_stream_discard real_whisper_mel_stream_discard
+#define whisper_mel_stream_discard_with_state real_whisper_mel_stream_discard_with_state
+#define whisper_mel_stream_apply real_whisper_mel_stream_apply
+#define whisper_mel_stream_apply_with_state real_whisper_mel_stream_apply_with_state
 #define whisper_set_mel real_whisper_set_mel
 #define whisper_set_mel_with_state real_whisper_set_mel_with_state
 #define whisper_encode real_whisper_encode
@@ -42,6 +58,7 @@
 #define whisper_decode real_whisper_decode
 #define whisper_decode_with_state real_whisper_decode_with_state
 #define whisper_tokenize real_whisper_tokenize
+#define whisper_token_count real_whisper_token_count
 #define whisper_lang_max_id real_whisper_lang_max_id
 #define whisper_lang_id real_whisper_lang_id
 #define whisper_lang_str real_whisper_lang_str
@@ -73,6 +90,7 @@
 #define whisper_full_get_segment_t1_from_state real_whisper_full_get_segment_t1_from_state
 #define whisper_full_get_segment_text real_whisper_full_get_segment_text
 #define whisper_full_get_segment_text_from_state real_whisper_full_get_segment_text_from_state
+#define whisper_full_get_segment_no_speech_prob_from_state real_whisper_full_get_segment_no_speech_prob_from_state
 #define whisper_full_n_tokens real_whisper_full_n_tokens
 #define whisper_full_n_tokens_from_state real_whisper_full_n_tokens_from_state
 #define whisper_full_get_token_text real_whisper_full_get_token_text
@@ -0,0 +1,239 @@
+// Transcribes a set of recordings with the full 30 s encoder context and with
+// WHISPER_AUDIO_CTX_AUTO, and reports the word error rate and the decode time
+// of both, so the latency win of the adaptive context is measured against
+// what it costs in accuracy.
+//
+// usage: bench_audio_ctx <model.bin> <manifest.tsv> [n_threads] [repeats] [max_wer_increase]
+//
+// Each manifest line is "<wav path><TAB><reference text>", with the path
+// relative to the manifest. The WAVs are 16 kHz mono 16-bit PCM. With
+// max_wer_increase, fails if the adaptive context raises the WER by more.
+
+#include "whisper_wrapper.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static bool read_wav(const std::string& path, std::vector<float>& samples) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Bench: cannot open " << path << std::endl;
+        return false;
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.size() < 12 || std::memcmp(data.data(), "RIFF", 4) != 0 || std::memcmp(data.data() + 8, "WAVE", 4) != 0) {
+        std::cerr << "Bench: " << path << " is not a WAV file" << std::endl;
+        return false;
+    }
+
+    bool format_ok = false;
+    for (size_t pos = 12; pos + 8 <= data.size();) {
+        uint32_t size;
+        std::memcpy(&size, data.data() + pos + 4, 4);
+        const char* chunk = data.data() + pos + 8;
+        if (pos + 8 + size > data.size()) size = (uint32_t) (data.size() - pos - 8);
+
+        if (std::memcmp(data.data() + pos, "fmt ", 4) == 0 && size >= 16) {
+            uint16_t format, channels, bits;
+            uint32_t rate;
+            std::memcpy(&format, chunk, 2);
+            std::memcpy(&channels, chunk + 2, 2);
+            std::memcpy(&rate, chunk + 4, 4);
+            std::memcpy(&bits, chunk + 14, 2);
+            format_ok = format == 1 && channels == 1 && rate == 16000 && bits == 16;
+        } else if (std::memcmp(data.data() + pos, "data", 4) == 0) {
+            if (!format_ok) break;
+            samples.resize(size / 2);
+            for (size_t i = 0; i < samples.size(); i++) {
+                int16_t s;
+                std::memcpy(&s, chunk + 2 * i, 2);
+                samples[i] = s / 32768.0f;
+            }
+            return true;
+        }
+        pos += 8 + size + (size & 1);
+    }
+
+    std::cerr << "Bench: " << path << " is not 16 kHz mono 16-bit PCM" << std::endl;
+    return false;
+}
+
+// Lowercase words without punctuation, apostrophes kept
+static std::vector<std::string> normalize(const std::string& text) {
+    std::vector<std::string> words;
+    std::string word;
+    for (const char c : text) {
+        const unsigned char u = (unsigned char) c;
+        if (std::isalnum(u) || c == '\'' || u >= 0x80) {
+            word += (char) std::tolower(u);
+        } else if (!word.empty()) {
+            words.push_back(word);
+            word.clear();
+        }
+    }
+    if (!word.empty()) words.push_back(word);
+    return words;
+}
+
+// Word-level edit distance
+static int word_errors(const std::vector<std::string>& ref, const std::vector<std::string>& hyp) {
+    std::vector<int> prev(hyp.size() + 1), cur(hyp.size() + 1);
+    for (size_t j = 0; j <= hyp.size(); j++) prev[j] = (int) j;
+    for (size_t i = 1; i <= ref.size(); i++) {
+        cur[0] = (int) i;
+        for (size_t j = 1; j <= hyp.size(); j++) {
+            const int sub = prev[j - 1] + (ref[i - 1] == hyp[j - 1] ? 0 : 1);
+            cur[j] = std::min({sub, prev[j] + 1, cur[j - 1] + 1});
+        }
+        std::swap(prev, cur);
+    }
+    return prev[hyp.size()];
+}
+
+struct mode_result {
+    int errors = 0;
+    double ms = 0.0;
+};
+
+// Best of repeats, with the text of the last run
+static bool transcribe(whisper_context* ctx, const std::vector<float>& samples, int audio_ctx, int n_threads,
+                       int repeats, std::string& text, double& ms) {
+    whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    params.n_threads = n_threads;
+    params.language = "en";
+    params.audio_ctx = audio_ctx;
+    params.print_progress = false;
+    params.print_realtime = false;
+    params.print_timestamps = false;
+
+    ms = 0.0;
+    for (int r = 0; r < repeats; r++) {
+        const auto t_start = std::chrono::steady_clock::now();
+        if (whisper_full(ctx, params, samples.data(), (int) samples.size()) != 0) {
+            return false;
+        }
+        const double t = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_start).count();
+        ms = r == 0 ? t : std::min(ms, t);
+    }
+
+    text.clear();
+    for (int i = 0; i < whisper_full_n_segments(ctx); i++) {
+        text += whisper_full_get_segment_text(ctx, i);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <model.bin> <manifest.tsv> [n_threads] [repeats] [max_wer_increase]"
+                  << std::endl;
+        return 2;
+    }
+    const int n_threads = argc > 3 ? std::atoi(argv[3]) : 4;
+    const int repeats = argc > 4 ? std::max(1, std::atoi(argv[4])) : 3;
+    const double max_wer_increase = argc > 5 ? std::atof(argv[5]) : -1.0;
+
+    const std::string manifest_path = argv[2];
+    const size_t slash = manifest_path.find_last_of('/');
+    const std::string base = slash == std::string::npos ? "" : manifest_path.substr(0, slash + 1);
+
+    std::ifstream manifest(manifest_path);
+    if (!manifest) {
+        std::cerr << "Bench: cannot open " << manifest_path << std::endl;
+        return 2;
+    }
+
+    whisper_context_params cparams = whisper_context_default_params();
+    cparams.use_gpu = false;
+    whisper_context* ctx = whisper_init_from_file_with_params(argv[1], cparams);
+    if (!ctx) {
+        std::cerr << "Bench: failed to load " << argv[1] << std::endl;
+        return 2;
+    }
+    // Neither mode pays for first-use graph allocation inside the timings
+    whisper_warmup(ctx, WHISPER_WARMUP_DEFAULT | WHISPER_WARMUP_ALL_BUCKETS);
+
+    mode_result full, adaptive;
+    int n_ref_words = 0;
+    int n_files = 0;
+    double audio_s = 0.0;
+
+    std::printf("%-32s %6s %10s %10s %8s %8s\n", "file", "sec", "full ms", "auto ms", "full err", "auto err");
+
+    std::string line;
+    while (std::getline(manifest, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        const size_t tab = line.find('\t');
+        if (tab == std::string::npos) {
+            std::cerr << "Bench: expected \"<wav><TAB><reference>\": " << line << std::endl;
+            whisper_free(ctx);
+            return 2;
+        }
+        std::string wav = line.substr(0, tab);
+        if (wav[0] != '/') wav = base + wav;
+        const std::vector<std::string> ref = normalize(line.substr(tab + 1));
+
+        std::vector<float> samples;
+        if (!read_wav(wav, samples)) {
+            whisper_free(ctx);
+            return 2;
+        }
+
+        std::string text_full, text_auto;
+        double ms_full, ms_auto;
+        if (!transcribe(ctx, samples, 0, n_threads, repeats, text_full, ms_full) ||
+            !transcribe(ctx, samples, WHISPER_AUDIO_CTX_AUTO, n_threads, repeats, text_auto, ms_auto)) {
+            std::cerr << "Bench: whisper_full failed on " << wav << std::endl;
+            whisper_free(ctx);
+            return 2;
+        }
+
+        const int err_full = word_errors(ref, normalize(text_full));
+        const int err_auto = word_errors(ref, normalize(text_auto));
+        full.errors += err_full;
+        full.ms += ms_full;
+        adaptive.errors += err_auto;
+        adaptive.ms += ms_auto;
+        n_ref_words += (int) ref.size();
+        n_files++;
+        audio_s += samples.size() / 16000.0;
+
+        const std::string name = wav.substr(wav.find_last_of('/') + 1);
+        std::printf("%-32.32s %6.1f %10.1f %10.1f %8d %8d\n", name.c_str(), samples.size() / 16000.0, ms_full,
+                    ms_auto, err_full, err_auto);
+        if (err_auto != err_full) {
+            std::printf("    full: %s\n    auto: %s\n", text_full.c_str(), text_auto.c_str());
+        }
+    }
+
+    whisper_free(ctx);
+
+    if (n_files == 0 || n_ref_words == 0) {
+        std::cerr << "Bench: no recordings in " << manifest_path << std::endl;
+        return 2;
+    }
+
+    const double wer_full = 100.0 * full.errors / n_ref_words;
+    const double wer_auto = 100.0 * adaptive.errors / n_ref_words;
+    std::printf("\n%d files, %.1f s of audio, %d reference words, %d threads, best of %d\n", n_files, audio_s,
+                n_ref_words, n_threads, repeats);
+    std::printf("full context: WER %.2f%%, %.1f ms\n", wer_full, full.ms);
+    std::printf("adaptive:     WER %.2f%%, %.1f ms (%.2fx)\n", wer_auto, adaptive.ms, full.ms / adaptive.ms);
+
+    if (max_wer_increase >= 0.0 && wer_auto - wer_full > max_wer_increase) {
+        std::fprintf(stderr, "Bench: the adaptive context raises the WER by %.2f points, over %.2f\n",
+                     wer_auto - wer_full, max_wer_increase);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+// Appends past the initial capacity of a whisper_audio_buffer and checks that
+// views taken before the grow still read the same samples, that the samples
+// were carried over, and that discard and clear keep the contents consistent.
+
+#include "whisper_wrapper.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+static int n_failed = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        std::fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+        std::fprintf(stderr, __VA_ARGS__); \
+        std::fprintf(stderr, "\n"); \
+        n_failed++; \
+    } \
+} while (0)
+
+static bool holds(const float * view, int64_t first, int n) {
+    for (int i = 0; i < n; i++) {
+        if (view[i] != (float) (first + i)) return false;
+    }
+    return true;
+}
+
+int main() {
+    // Smaller than one append, so the first grows right away
+    whisper_audio_buffer * buffer = whisper_audio_buffer_create(1000);
+    CHECK(buffer != nullptr, "whisper_audio_buffer_create failed");
+
+    std::vector<float> chunk(1600);
+    int64_t written = 0;
+    const float * first_view = nullptr;
+    std::vector<const float *> views;
+    // 100 chunks of 0.1 s grow it several times
+    for (int c = 0; c < 100; c++) {
+        for (size_t i = 0; i < chunk.size(); i++) chunk[i] = (float) (written + i);
+        CHECK(whisper_audio_buffer_append(buffer, chunk.data(), (int) chunk.size()) == 0, "append %d failed", c);
+        const float * view = whisper_audio_buffer_view(buffer, written, (int) chunk.size());
+        CHECK(view && holds(view, written, (int) chunk.size()), "chunk %d reads back wrong", c);
+        views.push_back(view);
+        if (c == 0) first_view = view;
+        written += chunk.size();
+    }
+    CHECK(whisper_audio_buffer_size(buffer) == written, "size %lld, expected %lld",
+          (long long) whisper_audio_buffer_size(buffer), (long long) written);
+
+    // Views from before each grow still hold their samples
+    for (size_t c = 0; c < views.size(); c++) {
+        CHECK(holds(views[c], (int64_t) c * 1600, 1600), "view of chunk %zu changed after a grow", c);
+    }
+    CHECK(holds(first_view, 0, 1600), "the first view changed");
+
+    const float * all = whisper_audio_buffer_view(buffer, 0, (int) written);
+    CHECK(all && holds(all, 0, (int) written), "the samples were not carried over");
+    CHECK(whisper_audio_buffer_view(buffer, written - 10, 11) == nullptr, "a view past the end was returned");
+
+    // PCM16 appends grow the same way
+    std::vector<uint8_t> pcm(2 * 50000);
+    for (size_t i = 0; i < pcm.size() / 2; i++) {
+        const int16_t s = (int16_t) (i % 2 ? -16384 : 16384);
+        pcm[2 * i] = (uint8_t) (s & 0xff);
+        pcm[2 * i + 1] = (uint8_t) ((uint16_t) s >> 8);
+    }
+    CHECK(whisper_audio_buffer_append_pcm16(buffer, pcm.data(), 50000) == 0, "append_pcm16 failed");
+    const float * pcm_view = whisper_audio_buffer_view(buffer, written, 50000);
+    CHECK(pcm_view && pcm_view[0] == 0.5f && pcm_view[1] == -0.5f && pcm_view[49999] == -0.5f,
+          "PCM16 samples read back wrong");
+    CHECK(holds(whisper_audio_buffer_view(buffer, 0, 1600), 0, 1600), "append_pcm16 moved the float samples");
+    written += 50000;
+
+    // Discard shifts the rest to the front
+    whisper_audio_buffer_discard(buffer, 1600);
+    CHECK(whisper_audio_buffer_size(buffer) == written - 1600, "discard left %lld samples",
+          (long long) whisper_audio_buffer_size(buffer));
+    const float * shifted = whisper_audio_buffer_view(buffer, 0, 1600);
+    CHECK(shifted && holds(shifted, 1600, 1600), "discard did not shift the samples");
+
+    // Cleared, it fills again from the start
+    whisper_audio_buffer_clear(buffer);
+    CHECK(whisper_audio_buffer_size(buffer) == 0, "clear left samples");
+    for (size_t i = 0; i < chunk.size(); i++) chunk[i] = (float) i;
+    CHECK(whisper_audio_buffer_append(buffer, chunk.data(), (int) chunk.size()) == 0, "append after clear failed");
+    CHECK(holds(whisper_audio_buffer_view(buffer, 0, 1600), 0, 1600), "append after clear reads back wrong");
+
+    whisper_audio_buffer_free(buffer);
+
+    std::printf("%s\n", n_failed == 0 ? "OK" : "FAILED");
+    return n_failed == 0 ? 0 : 1;
+}
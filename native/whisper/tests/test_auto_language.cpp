@@ -0,0 +1,137 @@
+// Transcribes with language "auto", the way the app's "Auto Detect" setting
+// does, and checks that a language was detected and text came back. With
+// detect_language set instead, whisper_full stops after the detection.
+//
+// usage: test_auto_language <model.bin> [speech.wav]
+//
+// Without a WAV, a second of noise is transcribed with the decoder limited to
+// ordinary text tokens, so any model, even one with random weights, produces
+// text once it decodes at all. The WAV is 16 kHz mono 16-bit PCM.
+
+#include "whisper_wrapper.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static int n_failed = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        std::fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+        std::fprintf(stderr, __VA_ARGS__); \
+        std::fprintf(stderr, "\n"); \
+        n_failed++; \
+    } \
+} while (0)
+
+// Samples of the data chunk, for the 16 kHz mono 16-bit PCM the app records
+static bool read_wav(const char * path, std::vector<float> & samples) {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.size() < 12 || std::memcmp(data.data(), "RIFF", 4) != 0 || std::memcmp(data.data() + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    for (size_t pos = 12; pos + 8 <= data.size();) {
+        uint32_t size;
+        std::memcpy(&size, data.data() + pos + 4, 4);
+        if (pos + 8 + size > data.size()) size = (uint32_t) (data.size() - pos - 8);
+        if (std::memcmp(data.data() + pos, "data", 4) == 0) {
+            samples.resize(size / 2);
+            for (size_t i = 0; i < samples.size(); i++) {
+                int16_t s;
+                std::memcpy(&s, data.data() + pos + 8 + 2 * i, 2);
+                samples[i] = s / 32768.0f;
+            }
+            return true;
+        }
+        pos += 8 + size + (size & 1);
+    }
+    return false;
+}
+
+// Leaves only the first text tokens, below every special token in any vocabulary
+static void text_tokens_only(whisper_context *, whisper_state *, const void *, int, float * logits, void * user_data) {
+    const int n_vocab = *(const int *) user_data;
+    for (int i = 0; i < n_vocab; i++) {
+        if (i < 10 || i >= 1000) logits[i] = -INFINITY;
+    }
+}
+
+static std::string full_text(whisper_context * ctx) {
+    std::string text;
+    for (int i = 0; i < whisper_full_n_segments(ctx); i++) {
+        text += whisper_full_get_segment_text(ctx, i);
+    }
+    return text;
+}
+
+int main(int argc, char ** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <model.bin> [speech.wav]" << std::endl;
+        return 2;
+    }
+
+    std::vector<float> samples;
+    if (argc > 2) {
+        if (!read_wav(argv[2], samples)) {
+            std::cerr << "Auto language test: cannot read " << argv[2] << std::endl;
+            return 2;
+        }
+    } else {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> noise(-0.3f, 0.3f);
+        samples.resize(16000);
+        for (float & s : samples) s = noise(rng);
+    }
+
+    whisper_context_params cparams = whisper_context_default_params();
+    cparams.use_gpu = false;
+    whisper_context * ctx = whisper_init_from_file_with_params(argv[1], cparams);
+    if (!ctx) {
+        std::cerr << "Auto language test: failed to load " << argv[1] << std::endl;
+        return 2;
+    }
+    if (!whisper_is_multilingual(ctx)) {
+        std::printf("%s is English-only, nothing to detect\n", argv[1]);
+        whisper_free(ctx);
+        return 77;
+    }
+
+    whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    params.n_threads = 2;
+    params.language = "auto";
+    params.detect_language = false;
+    params.max_tokens = 16;
+    params.print_progress = false;
+    int n_vocab = whisper_n_vocab(ctx);
+    if (argc <= 2) {
+        params.no_timestamps = true;
+        params.single_segment = true;
+        params.logits_filter_callback = (void *) text_tokens_only;
+        params.logits_filter_callback_user_data = &n_vocab;
+    }
+
+    CHECK(whisper_full(ctx, params, samples.data(), (int) samples.size()) == 0, "whisper_full failed");
+    const int lang_id = whisper_full_lang_id(ctx);
+    CHECK(lang_id >= 0, "no language was detected");
+    const std::string text = full_text(ctx);
+    CHECK(whisper_full_n_segments(ctx) > 0 && !text.empty(), "language \"auto\" returned no text");
+    std::printf("detected language %d: \"%s\"\n", lang_id, text.c_str());
+
+    // What the app used to pass: detection only
+    params.detect_language = true;
+    CHECK(whisper_full(ctx, params, samples.data(), (int) samples.size()) == 0, "whisper_full failed");
+    CHECK(whisper_full_n_segments(ctx) == 0, "detect_language returned %d segments", whisper_full_n_segments(ctx));
+
+    whisper_free(ctx);
+
+    std::printf("%s\n", n_failed == 0 ? "OK" : "FAILED");
+    return n_failed == 0 ? 0 : 1;
+}
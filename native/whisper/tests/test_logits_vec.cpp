@@ -0,0 +1,161 @@
+// Checks the vector kernels of the logits passes (whisper-vec.h) against
+// scalar references, at every tail length and on a full vocab, and times
+// them against the scalar loops they replaced.
+
+#include "whisper-vec.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static int n_failed = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        std::fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+        std::fprintf(stderr, __VA_ARGS__); \
+        std::fprintf(stderr, "\n"); \
+        n_failed++; \
+    } \
+} while (0)
+
+static float ref_max(const float * x, int n) {
+    float max = -INFINITY;
+    for (int i = 0; i < n; i++) {
+        max = std::max(max, x[i]);
+    }
+    return max;
+}
+
+static int ref_argmax(const float * x, int n) {
+    int best = 0;
+    for (int i = 1; i < n; i++) {
+        if (x[i] > x[best]) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+static double ref_exp_sum(const float * x, int n, float max) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        sum += std::exp((double) (x[i] - max));
+    }
+    return sum;
+}
+
+static void check_vector(const std::vector<float> & x, const char * what) {
+    const int n = (int) x.size();
+
+    const float max = whisper_vec_max(x.data(), n);
+    CHECK(max == ref_max(x.data(), n), "%s n=%d: max %g, expected %g", what, n, max, ref_max(x.data(), n));
+
+    if (n > 0) {
+        const int argmax = whisper_vec_argmax(x.data(), n);
+        CHECK(argmax == ref_argmax(x.data(), n), "%s n=%d: argmax %d, expected %d", what, n, argmax, ref_argmax(x.data(), n));
+    }
+
+    if (n == 0 || max == -INFINITY) {
+        return;
+    }
+
+    std::vector<float> y(n, -1.0f);
+    const float sum = whisper_vec_exp_sum(x.data(), n, max, y.data());
+    const double sum_ref = ref_exp_sum(x.data(), n, max);
+    // Summed in float, in lanes or in order
+    CHECK(std::fabs(sum - sum_ref) <= 1e-4*sum_ref, "%s n=%d: exp sum %.9g, expected %.9g", what, n, sum, sum_ref);
+
+    // Without y, the same sum is returned
+    CHECK(whisper_vec_exp_sum(x.data(), n, max, nullptr) == sum, "%s n=%d: exp sum differs without y", what, n);
+
+    for (int i = 0; i < n; i++) {
+        // The argument is rounded to float as in the kernels
+        const double ref = std::exp((double) (x[i] - max));
+        // Within 2 ulps, and exact zeros for -inf
+        const bool ok = x[i] == -INFINITY ? y[i] == 0.0f : std::fabs(y[i] - ref) <= 2.5e-7*ref + 1e-38;
+        if (!ok) {
+            CHECK(false, "%s n=%d: exp(x[%d] - max) = %.9g, expected %.9g", what, n, i, y[i], ref);
+            break;
+        }
+    }
+
+    const float lse = whisper_logsumexp(x.data(), n);
+    const double lse_ref = std::log(sum_ref) + max;
+    CHECK(std::fabs(lse - lse_ref) <= 1e-4*std::max(1.0, std::fabs(lse_ref)), "%s n=%d: logsumexp %.9g, expected %.9g",
+          what, n, lse, lse_ref);
+}
+
+int main() {
+    std::mt19937 rng(42);
+    std::normal_distribution<float> logit(0.0f, 4.0f);
+
+    // Every tail length the 8- and 4-wide loops leave
+    for (int n = 0; n <= 40; n++) {
+        std::vector<float> x(n);
+        for (float & v : x) v = logit(rng);
+        check_vector(x, "random");
+    }
+
+    // A full multilingual vocab with suppressed tokens, as whisper_process_logits sees it
+    const int n_vocab = 51866;
+    std::vector<float> logits(n_vocab);
+    for (float & v : logits) v = logit(rng);
+    for (int i = 0; i < n_vocab; i += 7) logits[i] = -INFINITY;
+    check_vector(logits, "vocab");
+
+    // Ties go to the first occurrence, in the vector body and in the tail
+    {
+        std::vector<float> x(37, 1.0f);
+        x[5] = x[20] = x[36] = 3.0f;
+        check_vector(x, "tie");
+        x[5] = x[20] = 1.0f;
+        check_vector(x, "tie in tail");
+    }
+
+    // Fully suppressed: no max, argmax 0, logsumexp -inf
+    {
+        std::vector<float> x(19, -INFINITY);
+        check_vector(x, "suppressed");
+        CHECK(whisper_logsumexp(x.data(), (int) x.size()) == -INFINITY, "suppressed: logsumexp is not -inf");
+    }
+
+    // Logits far below the max flush to zero rather than underflowing to garbage
+    {
+        std::vector<float> x(24, -200.0f);
+        x[3] = 0.0f;
+        check_vector(x, "underflow");
+    }
+
+    // Timing on the full vocab, against the scalar loops
+    const int n_iter = 2000;
+    std::vector<float> probs(n_vocab);
+    double sink = 0.0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int it = 0; it < n_iter; it++) {
+        const float max = ref_max(logits.data(), n_vocab);
+        float sum = 0.0f;
+        for (int i = 0; i < n_vocab; i++) {
+            probs[i] = expf(logits[i] - max);
+            sum += probs[i];
+        }
+        sink += sum + ref_argmax(probs.data(), n_vocab);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int it = 0; it < n_iter; it++) {
+        const float max = whisper_vec_max(logits.data(), n_vocab);
+        const float sum = whisper_vec_exp_sum(logits.data(), n_vocab, max, probs.data());
+        sink += sum + whisper_vec_argmax(probs.data(), n_vocab);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    const double us_scalar = std::chrono::duration<double, std::micro>(t1 - t0).count()/n_iter;
+    const double us_vec = std::chrono::duration<double, std::micro>(t2 - t1).count()/n_iter;
+    std::printf("max + exp sum + argmax over %d logits: scalar %.1f us, vector %.1f us (checksum %.0f)\n",
+                n_vocab, us_scalar, us_vec, sink);
+
+    std::printf("%s\n", n_failed == 0 ? "OK" : "FAILED");
+    return n_failed == 0 ? 0 : 1;
+}
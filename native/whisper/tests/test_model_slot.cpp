@@ -0,0 +1,59 @@
+// Frees a model slot while a decode still holds its model and checks that the
+// free waits for the release.
+//
+// usage: test_model_slot <model.bin>
+
+#include "whisper_wrapper.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+static int n_failed = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        std::fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+        std::fprintf(stderr, __VA_ARGS__); \
+        std::fprintf(stderr, "\n"); \
+        n_failed++; \
+    } \
+} while (0)
+
+int main(int argc, char ** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <model.bin>" << std::endl;
+        return 2;
+    }
+
+    whisper_context_params cparams = whisper_context_default_params();
+    cparams.use_gpu = false;
+    whisper_model_slot * slot = whisper_model_slot_init(argv[1], cparams);
+    if (!slot) {
+        std::cerr << "Model slot test: failed to load " << argv[1] << std::endl;
+        return 2;
+    }
+
+    whisper_model * model = whisper_model_slot_acquire(slot);
+    CHECK(whisper_model_context(model) != nullptr, "the acquired model has no context");
+
+    std::atomic<bool> freed{false};
+    std::thread free_thread([&] {
+        whisper_model_slot_free(slot);
+        freed.store(true);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    CHECK(!freed.load(), "the slot was freed under an acquired model");
+    // Still usable until released
+    CHECK(whisper_model_state(model, WHISPER_STATE_FINAL) != nullptr, "the acquired model lost its state");
+
+    whisper_model_release(model);
+    free_thread.join();
+    CHECK(freed.load(), "the slot was not freed after the release");
+
+    std::printf("%s\n", n_failed == 0 ? "OK" : "FAILED");
+    return n_failed == 0 ? 0 : 1;
+}
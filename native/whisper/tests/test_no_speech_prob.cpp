@@ -0,0 +1,98 @@
+// Checks that a segment's no_speech_prob depends only on its own window: the
+// same audio gives the same value on a fresh state and on one that decoded
+// something else first. It is read at the sot row of the first decode, which
+// only holds fresh logits because that row is asked for explicitly.
+//
+// usage: test_no_speech_prob <model.bin>
+
+#include "whisper_wrapper.h"
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static int n_failed = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        std::fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+        std::fprintf(stderr, __VA_ARGS__); \
+        std::fprintf(stderr, "\n"); \
+        n_failed++; \
+    } \
+} while (0)
+
+// Leaves only the first text tokens, so even a model with random weights
+// produces a segment
+static void text_tokens_only(whisper_context *, whisper_state *, const void *, int, float * logits, void * user_data) {
+    const int n_vocab = *(const int *) user_data;
+    for (int i = 0; i < n_vocab; i++) {
+        if (i < 10 || i >= 1000) logits[i] = -INFINITY;
+    }
+}
+
+static std::vector<float> noise(unsigned seed, float amplitude) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-amplitude, amplitude);
+    std::vector<float> samples(2 * 16000);
+    for (float & s : samples) s = dist(rng);
+    return samples;
+}
+
+int main(int argc, char ** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <model.bin>" << std::endl;
+        return 2;
+    }
+
+    whisper_context_params cparams = whisper_context_default_params();
+    cparams.use_gpu = false;
+    whisper_context * ctx = whisper_init_from_file_with_params(argv[1], cparams);
+    if (!ctx) {
+        std::cerr << "No-speech test: failed to load " << argv[1] << std::endl;
+        return 2;
+    }
+    whisper_state * used = whisper_init_state(ctx);
+    whisper_state * fresh = whisper_init_state(ctx);
+
+    int n_vocab = whisper_n_vocab(ctx);
+    whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    params.n_threads = 2;
+    params.language = "en";
+    params.no_context = true;
+    params.no_timestamps = true;
+    params.single_segment = true;
+    params.max_tokens = 8;
+    params.temperature_inc = 0.0f;
+    params.print_progress = false;
+    params.logits_filter_callback = (void *) text_tokens_only;
+    params.logits_filter_callback_user_data = &n_vocab;
+
+    const std::vector<float> first = noise(1, 0.5f);
+    const std::vector<float> second = noise(2, 0.05f);
+
+    CHECK(whisper_full_with_state(ctx, used, params, first.data(), (int) first.size()) == 0, "decode failed");
+    CHECK(whisper_full_with_state(ctx, used, params, second.data(), (int) second.size()) == 0, "decode failed");
+    CHECK(whisper_full_with_state(ctx, fresh, params, second.data(), (int) second.size()) == 0, "decode failed");
+
+    const int n_segments = whisper_full_n_segments_from_state(fresh);
+    CHECK(n_segments > 0, "no segments");
+    CHECK(whisper_full_n_segments_from_state(used) == n_segments, "the states returned %d and %d segments",
+          whisper_full_n_segments_from_state(used), n_segments);
+    for (int i = 0; i < n_segments && i < whisper_full_n_segments_from_state(used); i++) {
+        const float p_used = whisper_full_get_segment_no_speech_prob_from_state(used, i);
+        const float p_fresh = whisper_full_get_segment_no_speech_prob_from_state(fresh, i);
+        std::printf("segment %d: no_speech_prob %.6f after another decode, %.6f fresh\n", i, p_used, p_fresh);
+        CHECK(p_fresh > 0.0f && p_fresh <= 1.0f, "segment %d: no_speech_prob %f is not a probability", i, p_fresh);
+        CHECK(std::fabs(p_used - p_fresh) <= 1e-5f, "segment %d: no_speech_prob depends on the previous decode", i);
+    }
+
+    whisper_free_state(fresh);
+    whisper_free_state(used);
+    whisper_free(ctx);
+
+    std::printf("%s\n", n_failed == 0 ? "OK" : "FAILED");
+    return n_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+// Transcribes greedily with and without a draft model and checks that the
+// text is the same, then replaces the threadpool the draft state borrowed
+// during the call and decodes on the draft state alone.
+//
+// usage: test_speculative <model.bin> <draft.bin> [speech.wav]
+//
+// Meant for a real model pair such as ggml-base.en.bin with ggml-tiny.en.bin;
+// without a recording, the first 32 tokens of three seconds of noise are
+// compared.
+
+#include "whisper_wrapper.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static int n_failed = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        std::fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+        std::fprintf(stderr, __VA_ARGS__); \
+        std::fprintf(stderr, "\n"); \
+        n_failed++; \
+    } \
+} while (0)
+
+// Samples of the data chunk, for the 16 kHz mono 16-bit PCM the app records
+static bool read_wav(const char * path, std::vector<float> & samples) {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.size() < 12 || std::memcmp(data.data(), "RIFF", 4) != 0 || std::memcmp(data.data() + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    for (size_t pos = 12; pos + 8 <= data.size();) {
+        uint32_t size;
+        std::memcpy(&size, data.data() + pos + 4, 4);
+        if (pos + 8 + size > data.size()) size = (uint32_t) (data.size() - pos - 8);
+        if (std::memcmp(data.data() + pos, "data", 4) == 0) {
+            samples.resize(size / 2);
+            for (size_t i = 0; i < samples.size(); i++) {
+                int16_t s;
+                std::memcpy(&s, data.data() + pos + 8 + 2 * i, 2);
+                samples[i] = s / 32768.0f;
+            }
+            return true;
+        }
+        pos += 8 + size + (size & 1);
+    }
+    return false;
+}
+
+static std::string state_text(whisper_state * state) {
+    std::string text;
+    for (int i = 0; i < whisper_full_n_segments_from_state(state); i++) {
+        text += whisper_full_get_segment_text_from_state(state, i);
+    }
+    return text;
+}
+
+int main(int argc, char ** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <model.bin> <draft.bin> [speech.wav]" << std::endl;
+        return 2;
+    }
+
+    std::vector<float> samples;
+    if (argc > 3) {
+        if (!read_wav(argv[3], samples)) {
+            std::cerr << "Speculative test: cannot read " << argv[3] << std::endl;
+            return 2;
+        }
+    } else {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> noise(-0.25f, 0.25f);
+        samples.resize(3 * 16000);
+        for (float & s : samples) s = noise(rng);
+    }
+
+    whisper_context_params cparams = whisper_context_default_params();
+    cparams.use_gpu = false;
+    whisper_context * ctx = whisper_init_from_file_with_params(argv[1], cparams);
+    whisper_context * dctx = whisper_init_from_file_with_params(argv[2], cparams);
+    if (!ctx || !dctx) {
+        std::cerr << "Speculative test: failed to load the models" << std::endl;
+        return 2;
+    }
+    whisper_state * state = whisper_init_state(ctx);
+    whisper_state * dstate = whisper_init_state(dctx);
+
+    whisper_threadpool_params tpp = whisper_threadpool_default_params();
+    tpp.n_threads = 2;
+    CHECK(whisper_state_set_threadpool(state, tpp) == 0, "whisper_state_set_threadpool failed");
+
+    whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    params.language = "en";
+    params.temperature_inc = 0.0f;
+    params.print_progress = false;
+    if (argc <= 3) {
+        // Noise can run to the end of the text context
+        params.max_tokens = 32;
+    }
+
+    CHECK(whisper_full_with_state(ctx, state, params, samples.data(), (int) samples.size()) == 0,
+          "the decode without a draft failed");
+    const std::string reference = state_text(state);
+
+    for (int n_draft : { 2, 4, 8 }) {
+        params.draft_ctx = dctx;
+        params.draft_state = dstate;
+        params.n_draft = n_draft;
+        CHECK(whisper_full_with_state(ctx, state, params, samples.data(), (int) samples.size()) == 0,
+              "the decode with n_draft %d failed", n_draft);
+        const std::string text = state_text(state);
+        const whisper_speculative_stats stats = whisper_get_speculative_stats(state);
+        std::printf("n_draft %d: %d of %d drafted tokens accepted\n", n_draft, stats.n_accepted, stats.n_drafted);
+        CHECK(stats.n_drafted > 0 || reference.empty(), "n_draft %d: the draft model proposed nothing", n_draft);
+        CHECK(text == reference, "n_draft %d: the text differs\n    without: \"%s\"\n    with:    \"%s\"", n_draft,
+              reference.c_str(), text.c_str());
+    }
+
+    // The pool the draft state borrowed is freed here. A decode on the draft
+    // state alone must not run on it.
+    CHECK(whisper_state_set_threadpool(state, tpp) == 0, "replacing the threadpool failed");
+    whisper_full_params draft_params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    draft_params.language = "en";
+    draft_params.max_tokens = 4;
+    draft_params.print_progress = false;
+    CHECK(whisper_full_with_state(dctx, dstate, draft_params, samples.data(), 16000) == 0,
+          "the decode on the draft state failed");
+
+    whisper_free_state(dstate);
+    whisper_free_state(state);
+    whisper_free(dctx);
+    whisper_free(ctx);
+
+    std::printf("%s\n", n_failed == 0 ? "OK" : "FAILED");
+    return n_failed == 0 ? 0 : 1;
+}
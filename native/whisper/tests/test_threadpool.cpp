@@ -0,0 +1,126 @@
+// Decodes on a state with its own threadpool and checks that the calling
+// thread gets its CPU affinity and scheduling policy back, and that the pool
+// cannot be replaced while a decode runs.
+//
+// usage: test_threadpool <model.bin>
+
+#include "whisper_wrapper.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+static int n_failed = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        std::fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+        std::fprintf(stderr, __VA_ARGS__); \
+        std::fprintf(stderr, "\n"); \
+        n_failed++; \
+    } \
+} while (0)
+
+static int current_policy() {
+    int policy;
+    sched_param param;
+    pthread_getschedparam(pthread_self(), &policy, &param);
+    return policy;
+}
+
+// Lets the main thread act while the decode is between its start and the encoder
+struct encoder_gate {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool entered = false;
+    bool released = false;
+};
+
+static bool wait_at_encoder(whisper_context *, whisper_state *, void * user_data) {
+    encoder_gate * gate = (encoder_gate *) user_data;
+    std::unique_lock<std::mutex> lock(gate->mutex);
+    gate->entered = true;
+    gate->cv.notify_all();
+    gate->cv.wait(lock, [gate] { return gate->released; });
+    return true;
+}
+
+int main(int argc, char ** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <model.bin>" << std::endl;
+        return 2;
+    }
+
+    whisper_context_params cparams = whisper_context_default_params();
+    cparams.use_gpu = false;
+    whisper_context * ctx = whisper_init_from_file_with_params(argv[1], cparams);
+    if (!ctx) {
+        std::cerr << "Threadpool test: failed to load " << argv[1] << std::endl;
+        return 2;
+    }
+    whisper_state * state = whisper_init_state(ctx);
+
+    // SCHED_BATCH needs no privileges and tells whether the pool's priority stuck
+    whisper_threadpool_params tpp = whisper_threadpool_default_params();
+    tpp.n_threads = 2;
+    tpp.prio = -1;
+    tpp.affinity = WHISPER_THREADPOOL_AFFINITY_MASK;
+    tpp.cpu_mask = 1;
+    CHECK(whisper_state_set_threadpool(state, tpp) == 0, "whisper_state_set_threadpool failed");
+
+    cpu_set_t cpus_before;
+    pthread_getaffinity_np(pthread_self(), sizeof(cpus_before), &cpus_before);
+    const int policy_before = current_policy();
+
+    whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    params.language = "en";
+    params.max_tokens = 4;
+    params.print_progress = false;
+    std::vector<float> silence(16000, 0.0f);
+
+    // Every decode on the inactive pool wakes it from its pause
+    for (int i = 0; i < 2; i++) {
+        CHECK(whisper_full_with_state(ctx, state, params, silence.data(), (int) silence.size()) == 0,
+              "decode %d failed", i);
+        cpu_set_t cpus_after;
+        pthread_getaffinity_np(pthread_self(), sizeof(cpus_after), &cpus_after);
+        CHECK(CPU_EQUAL(&cpus_before, &cpus_after), "decode %d left the caller on the pool's CPUs", i);
+        CHECK(current_policy() == policy_before, "decode %d left the caller with policy %d, was %d", i,
+              current_policy(), policy_before);
+    }
+
+    // Refused while a decode runs, accepted once it is done
+    encoder_gate gate;
+    params.encoder_begin_callback = (void *) wait_at_encoder;
+    params.encoder_begin_callback_user_data = &gate;
+    int decode_ret = -1;
+    std::thread decode([&] {
+        decode_ret = whisper_full_with_state(ctx, state, params, silence.data(), (int) silence.size());
+    });
+    {
+        std::unique_lock<std::mutex> lock(gate.mutex);
+        gate.cv.wait(lock, [&gate] { return gate.entered; });
+    }
+    CHECK(whisper_state_set_threadpool(state, tpp) == -1, "the threadpool was replaced during a decode");
+    {
+        std::lock_guard<std::mutex> lock(gate.mutex);
+        gate.released = true;
+    }
+    gate.cv.notify_all();
+    decode.join();
+    CHECK(decode_ret == 0, "the gated decode failed");
+    CHECK(whisper_state_set_threadpool(state, tpp) == 0, "the threadpool was refused after the decode");
+
+    whisper_free_state(state);
+    whisper_free(ctx);
+
+    std::printf("%s\n", n_failed == 0 ? "OK" : "FAILED");
+    return n_failed == 0 ? 0 : 1;
+}
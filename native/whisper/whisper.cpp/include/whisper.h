@@ -126,8 +126,29 @@ extern "C" {
         struct whisper_aheads dtw_aheads;
 
         size_t dtw_mem_size; // TODO: remove
+
+        // Map the model file and use CPU weights in place instead of reading
+        // them into allocated buffers (POSIX only, ignored elsewhere)
+        bool use_mmap;
+        bool use_mlock; // keep the mapped model resident in RAM
+
+        // Sidecar file caching the weights the CPU backend repacks into
+        // interleaved layouts, so later loads map them instead of repacking.
+        // Rewritten when the model, CPU features or ggml build change. NULL to disable
+        const char * repack_cache_path;
     };
 
+    typedef struct whisper_load_stats {
+        int64_t t_load_us;      // time to map and load the model
+        size_t  n_bytes_mapped; // weights used in place from the file mapping
+        size_t  n_bytes_copied; // weights read into allocated buffers
+        size_t  n_bytes_repacked;      // weights repacked for the CPU backend while loading
+        size_t  n_bytes_repack_cached; // repacked weights mapped from the repack cache
+        float   page_cache_hit; // fraction of the file already in the page cache, -1 when not mapped
+        bool    use_mmap;
+        bool    use_mlock;      // true only if the mapping was actually locked
+    } whisper_load_stats;
+
     typedef struct whisper_token_data {
         whisper_token id;  // token id
         whisper_token tid; // forced timestamp token id
@@ -267,6 +288,22 @@ extern "C" {
     // Frees all allocated memory
     WHISPER_API void whisper_free      (struct whisper_context * ctx);
     WHISPER_API void whisper_free_state(struct whisper_state * state);
+
+    // Runs the CPU graphs of this state on a caller-owned ggml threadpool
+    // instead of spawning workers for every graph. Pass NULL to go back to
+    // the default. The pool must outlive its use by the state.
+    WHISPER_API void whisper_set_threadpool_with_state(struct whisper_state * state, struct ggml_threadpool * threadpool);
+
+    // How the model of ctx was loaded, to track cold and warm starts
+    WHISPER_API struct whisper_load_stats whisper_get_load_stats(struct whisper_context * ctx);
+
+    // Bytes held by the weights of ctx, and by the KV caches and compute buffers of state
+    WHISPER_API size_t whisper_get_model_memory(struct whisper_context * ctx);
+    WHISPER_API size_t whisper_get_state_memory(struct whisper_state * state);
+
+    // Faults in every page of a mapped model. Returns the bytes touched, 0 if
+    // the weights were read into memory at load.
+    WHISPER_API size_t whisper_prefault_model(struct whisper_context * ctx);
     WHISPER_API void whisper_free_params(struct whisper_full_params * params);
     WHISPER_API void whisper_free_context_params(struct whisper_context_params * params);
 
@@ -286,6 +323,33 @@ extern "C" {
                                int   n_samples,
                                int   n_threads);
 
+    // Incremental log mel spectrogram, for audio that arrives in chunks.
+    // whisper_mel_stream_append() computes STFT frames only for the newly appended samples.
+    // whisper_mel_stream_discard() drops the first n_frames frames (10 ms each) and the audio they cover.
+    // whisper_mel_stream_apply() stores the spectrogram of the retained audio inside the state,
+    // like whisper_set_mel(), so whisper_full() can then be called with n_samples == 0.
+    // whisper_pcm_to_mel() does not touch the incremental spectrogram.
+    // Returns 0 on success
+    WHISPER_API void whisper_mel_stream_reset(struct whisper_context * ctx);
+    WHISPER_API void whisper_mel_stream_reset_with_state(struct whisper_context * ctx, struct whisper_state * state);
+
+    WHISPER_API int whisper_mel_stream_append(
+            struct whisper_context * ctx,
+                       const float * samples,
+                               int   n_samples);
+
+    WHISPER_API int whisper_mel_stream_append_with_state(
+            struct whisper_context * ctx,
+              struct whisper_state * state,
+                       const float * samples,
+                               int   n_samples);
+
+    WHISPER_API int whisper_mel_stream_discard(struct whisper_context * ctx, int n_frames);
+    WHISPER_API int whisper_mel_stream_discard_with_state(struct whisper_context * ctx, struct whisper_state * state, int n_frames);
+
+    WHISPER_API int whisper_mel_stream_apply(struct whisper_context * ctx);
+    WHISPER_API int whisper_mel_stream_apply_with_state(struct whisper_context * ctx, struct whisper_state * state);
+
     // This can be used to set a custom log mel spectrogram inside the default state of the provided whisper context.
     // Use this instead of whisper_pcm_to_mel() if you want to provide your own log mel spectrogram.
     // n_mel must be 80
@@ -443,6 +507,15 @@ extern "C" {
         float prompt_ms;
     };
     WHISPER_API struct whisper_timings * whisper_get_timings(struct whisper_context * ctx);
+
+    // Speculative decoding counters of the last whisper_full_with_state() on the state.
+    struct whisper_speculative_stats {
+        int     n_verify;   // batched decodes that verified draft tokens
+        int     n_drafted;  // tokens proposed by the draft model
+        int     n_accepted; // proposed tokens that were also sampled from the model
+        int64_t t_draft_us; // time spent encoding and decoding with the draft model
+    };
+    WHISPER_API struct whisper_speculative_stats whisper_get_speculative_stats(struct whisper_state * state);
     WHISPER_API void whisper_print_timings(struct whisper_context * ctx);
     WHISPER_API void whisper_reset_timings(struct whisper_context * ctx);
 
@@ -588,6 +661,16 @@ extern "C" {
         const char * vad_model_path;              // Path to VAD model
 
         whisper_vad_params vad_params;
+
+        // Speculative decoding, used for greedy decoding at temperature 0 and
+        // producing the same tokens: the draft model, smaller but with the same
+        // text tokens, proposes up to n_draft tokens at a time that are then
+        // verified in one batched decode. Needs the PCM samples (n_samples > 0).
+        struct {
+            struct whisper_context * ctx;
+            struct whisper_state   * state;   // state of ctx, runs on the threadpool of the decode
+            int                      n_draft;
+        } speculative;
     };
 
     // NOTE: this function allocates memory, and it is the responsibility of the caller to free the pointer - see whisper_free_context_params & whisper_free_params()
@@ -695,6 +778,21 @@ extern "C" {
                            const float * samples,
                                    int   n_samples);
 
+    // Streaming detection: runs n_frames consecutive windows of
+    // whisper_vad_n_window() samples and writes one probability per window.
+    // Unlike whisper_vad_detect_speech, the LSTM state carries over between
+    // calls and the graph is built and allocated only once.
+    WHISPER_API bool whisper_vad_stream_process(
+            struct whisper_vad_context * vctx,
+                           const float * samples,
+                                   int   n_frames,
+                                 float * probs);
+
+    // Clears the LSTM state carried by whisper_vad_stream_process
+    WHISPER_API void whisper_vad_stream_reset(struct whisper_vad_context * vctx);
+
+    WHISPER_API int     whisper_vad_n_window(struct whisper_vad_context * vctx);
+
     WHISPER_API int     whisper_vad_n_probs(struct whisper_vad_context * vctx);
     WHISPER_API float * whisper_vad_probs  (struct whisper_vad_context * vctx);
 
@@ -0,0 +1,174 @@
+#pragma once
+
+// Vector kernels for the logits passes in whisper.cpp. These run over the
+// whole vocab for every decoder at every step, outside the graph
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(__AVX2__) && defined(__FMA__)
+// adapted from ggml_v_expf (arm limited optimized routine): the maximum error
+// is 1.45358 plus 0.5 ulps, numbers beneath -103.97 (and -inf) flush to zero
+static inline __m256 whisper_v_expf(__m256 x) {
+    const __m256 r = _mm256_set1_ps(0x1.8p23f);
+    const __m256 z = _mm256_fmadd_ps(x, _mm256_set1_ps(0x1.715476p+0f), r);
+    const __m256 n = _mm256_sub_ps(z, r);
+    const __m256 b = _mm256_fnmadd_ps(n, _mm256_set1_ps(0x1.7f7d1cp-20f),
+                                      _mm256_fnmadd_ps(n, _mm256_set1_ps(0x1.62e4p-1f), x));
+    const __m256i e = _mm256_slli_epi32(_mm256_castps_si256(z), 23);
+    const __m256 k = _mm256_castsi256_ps(_mm256_add_epi32(e, _mm256_castps_si256(_mm256_set1_ps(1))));
+    const __m256i c = _mm256_castps_si256(
+        _mm256_cmp_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.f), n), _mm256_set1_ps(126), _CMP_GT_OQ));
+    const __m256 u = _mm256_mul_ps(b, b);
+    const __m256 j = _mm256_fmadd_ps(
+        _mm256_fmadd_ps(_mm256_fmadd_ps(_mm256_set1_ps(0x1.0e4020p-7f), b, _mm256_set1_ps(0x1.573e2ep-5f)), u,
+                        _mm256_fmadd_ps(_mm256_set1_ps(0x1.555e66p-3f), b, _mm256_set1_ps(0x1.fffdb6p-2f))),
+        u, _mm256_mul_ps(_mm256_set1_ps(0x1.ffffecp-1f), b));
+    if (!_mm256_movemask_ps(_mm256_castsi256_ps(c))) {
+        return _mm256_fmadd_ps(j, k, k);
+    }
+    const __m256i g = _mm256_and_si256(
+        _mm256_castps_si256(_mm256_cmp_ps(n, _mm256_setzero_ps(), _CMP_LE_OQ)), _mm256_set1_epi32(0x82000000u));
+    const __m256 s1 = _mm256_castsi256_ps(_mm256_add_epi32(g, _mm256_set1_epi32(0x7f000000u)));
+    const __m256 s2 = _mm256_castsi256_ps(_mm256_sub_epi32(e, g));
+    const __m256i d = _mm256_castps_si256(
+        _mm256_cmp_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.f), n), _mm256_set1_ps(192), _CMP_GT_OQ));
+    return _mm256_or_ps(
+        _mm256_and_ps(_mm256_castsi256_ps(d), _mm256_mul_ps(s1, s1)),
+        _mm256_andnot_ps(_mm256_castsi256_ps(d),
+            _mm256_or_ps(_mm256_and_ps(_mm256_castsi256_ps(c), _mm256_mul_ps(_mm256_fmadd_ps(s2, j, s2), s1)),
+                         _mm256_andnot_ps(_mm256_castsi256_ps(c), _mm256_fmadd_ps(k, j, k)))));
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+// adapted from ggml_v_expf (arm limited optimized routine): the maximum error
+// is 1.45358 plus 0.5 ulps, numbers beneath -103.97 (and -inf) flush to zero
+static inline float32x4_t whisper_v_expf(float32x4_t x) {
+    const float32x4_t r = vdupq_n_f32(0x1.8p23f);
+    const float32x4_t z = vfmaq_f32(r, x, vdupq_n_f32(0x1.715476p+0f));
+    const float32x4_t n = vsubq_f32(z, r);
+    const float32x4_t b = vfmsq_f32(vfmsq_f32(x, n, vdupq_n_f32(0x1.62e4p-1f)), n, vdupq_n_f32(0x1.7f7d1cp-20f));
+    const uint32x4_t e = vshlq_n_u32(vreinterpretq_u32_f32(z), 23);
+    const float32x4_t k = vreinterpretq_f32_u32(vaddq_u32(e, vreinterpretq_u32_f32(vdupq_n_f32(1))));
+    const uint32x4_t c = vcagtq_f32(n, vdupq_n_f32(126));
+    const float32x4_t u = vmulq_f32(b, b);
+    const float32x4_t j = vfmaq_f32(
+        vmulq_f32(vdupq_n_f32(0x1.ffffecp-1f), b),
+        vfmaq_f32(vfmaq_f32(vdupq_n_f32(0x1.fffdb6p-2f), vdupq_n_f32(0x1.555e66p-3f), b),
+                  vfmaq_f32(vdupq_n_f32(0x1.573e2ep-5f), vdupq_n_f32(0x1.0e4020p-7f), b), u), u);
+    if (!vpaddd_u64(vreinterpretq_u64_u32(c))) {
+        return vfmaq_f32(k, j, k);
+    }
+    const uint32x4_t d = vandq_u32(vclezq_f32(n), vdupq_n_u32(0x82000000));
+    const float32x4_t s1 = vreinterpretq_f32_u32(vaddq_u32(d, vdupq_n_u32(0x7f000000)));
+    const float32x4_t s2 = vreinterpretq_f32_u32(vsubq_u32(e, d));
+    return vbslq_f32(vcagtq_f32(n, vdupq_n_f32(192)), vmulq_f32(s1, s1),
+                     vbslq_f32(c, vmulq_f32(vfmaq_f32(s2, s2, j), s1), vfmaq_f32(k, k, j)));
+}
+#endif
+
+static inline float whisper_vec_max(const float * x, int n) {
+    int i = 0;
+    float max = -INFINITY;
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256 acc = _mm256_set1_ps(-INFINITY);
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_max_ps(acc, _mm256_loadu_ps(x + i));
+    }
+    __m128 lo = _mm_max_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    lo = _mm_max_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_max_ss(lo, _mm_movehdup_ps(lo));
+    max = _mm_cvtss_f32(lo);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    float32x4_t acc = vdupq_n_f32(-INFINITY);
+    for (; i + 4 <= n; i += 4) {
+        acc = vmaxq_f32(acc, vld1q_f32(x + i));
+    }
+    max = vmaxvq_f32(acc);
+#endif
+    for (; i < n; i++) {
+        max = std::max(max, x[i]);
+    }
+    return max;
+}
+
+// index of the first occurrence of the largest value
+static inline int whisper_vec_argmax(const float * x, int n) {
+    const float max = whisper_vec_max(x, n);
+    int i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+    const __m256 vmax = _mm256_set1_ps(max);
+    for (; i + 8 <= n; i += 8) {
+        const int m = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(x + i), vmax, _CMP_EQ_OQ));
+        if (m != 0) {
+            return i + __builtin_ctz(m);
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const float32x4_t vmax = vdupq_n_f32(max);
+    for (; i + 4 <= n; i += 4) {
+        if (vmaxvq_u32(vceqq_f32(vld1q_f32(x + i), vmax)) != 0) {
+            break;
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        if (x[i] == max) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+// sum of exp(x[i] - max), also stored to y unless it is null
+static inline float whisper_vec_exp_sum(const float * x, int n, float max, float * y) {
+    int i = 0;
+    float sum = 0.0f;
+#if defined(__AVX2__) && defined(__FMA__)
+    const __m256 vmax = _mm256_set1_ps(max);
+    __m256 acc = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        const __m256 val = whisper_v_expf(_mm256_sub_ps(_mm256_loadu_ps(x + i), vmax));
+        if (y) {
+            _mm256_storeu_ps(y + i, val);
+        }
+        acc = _mm256_add_ps(acc, val);
+    }
+    __m128 lo = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_movehdup_ps(lo));
+    sum = _mm_cvtss_f32(lo);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const float32x4_t vmax = vdupq_n_f32(max);
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t val = whisper_v_expf(vsubq_f32(vld1q_f32(x + i), vmax));
+        if (y) {
+            vst1q_f32(y + i, val);
+        }
+        acc = vaddq_f32(acc, val);
+    }
+    sum = vaddvq_f32(acc);
+#endif
+    for (; i < n; i++) {
+        const float val = expf(x[i] - max);
+        if (y) {
+            y[i] = val;
+        }
+        sum += val;
+    }
+    return sum;
+}
+
+static inline float whisper_logsumexp(const float * logits, int n_logits) {
+    const float logit_max = whisper_vec_max(logits, n_logits);
+    if (logit_max == -INFINITY) {
+        return -INFINITY;
+    }
+    return logf(whisper_vec_exp_sum(logits, n_logits, logit_max, nullptr)) + logit_max;
+}
@@ -1,5 +1,6 @@
 #include "whisper.h"
 #include "whisper-arch.h"
+#include "whisper-vec.h"
 
 #include "ggml.h"
 #include "ggml-cpp.h"
@@ -26,18 +27,40 @@
 #include <cstring>
 #include <fstream>
 #include <functional>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <random>
 #include <regex>
 #include <set>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #ifdef _MSC_VER
 #include <codecvt>
 #endif
 
+// Mapped weights are used as they are in the file, so big-endian hosts keep
+// reading (and byte-swapping) them into allocated buffers
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(WHISPER_BIG_ENDIAN)
+#define WHISPER_USE_MMAP
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #if defined(WHISPER_BIG_ENDIAN)
 template<typename T>
 static T byteswap(T value) {
@@ -146,6 +169,12 @@ static constexpr float WHISPER_HISTORY_CONDITIONING_TEMP_CUTOFF = 0.5f;
 
 #define WHISPER_MAX_NODES 4096
 
+// whisper_tokenize() results kept per context
+#define WHISPER_TOKENIZE_CACHE_SIZE 8
+
+// suppress_regex matches kept per context
+#define WHISPER_SUPPRESS_REGEX_CACHE_SIZE 4
+
 static std::string format(const char * fmt, ...) {
     va_list ap;
     va_list ap2;
@@ -187,11 +216,36 @@ static bool ggml_graph_compute_helper(
     return ggml_backend_graph_compute(backend.get(), graph) == GGML_STATUS_SUCCESS;
 }
 
+// graph on a CPU backend the caller keeps, e.g. the last one of a state, and
+// on threadpool when set
+static bool ggml_graph_compute_helper(
+            ggml_backend_t   backend,
+        struct ggml_cgraph * graph,
+                       int   n_threads,
+         ggml_threadpool_t   threadpool) {
+    ggml_backend_reg_t reg = ggml_backend_dev_backend_reg(ggml_backend_get_device(backend));
+
+    auto * fn_set_n_threads = (ggml_backend_set_n_threads_t) ggml_backend_reg_get_proc_address(reg, "ggml_backend_set_n_threads");
+    if (fn_set_n_threads) {
+        fn_set_n_threads(backend, n_threads);
+    }
+
+    auto * fn_set_threadpool = (decltype(&ggml_backend_cpu_set_threadpool)) ggml_backend_reg_get_proc_address(reg, "ggml_backend_cpu_set_threadpool");
+    if (fn_set_threadpool) {
+        fn_set_threadpool(backend, threadpool);
+    }
+
+    return ggml_backend_graph_compute(backend, graph) == GGML_STATUS_SUCCESS;
+}
+
+// threadpool, when set, is a persistent pool the CPU backend runs the graph
+// on; otherwise the backend spawns and joins its workers for every graph
 static bool ggml_graph_compute_helper(
       ggml_backend_sched_t   sched,
         struct ggml_cgraph * graph,
                        int   n_threads,
-                      bool   sched_reset = true) {
+                      bool   sched_reset = true,
+         ggml_threadpool_t   threadpool  = nullptr) {
     for (int i = 0; i < ggml_backend_sched_get_n_backends(sched); ++i) {
         ggml_backend_t backend = ggml_backend_sched_get_backend(sched, i);
         ggml_backend_dev_t dev = ggml_backend_get_device(backend);
@@ -201,6 +255,11 @@ static bool ggml_graph_compute_helper(
         if (fn_set_n_threads) {
             fn_set_n_threads(backend, n_threads);
         }
+
+        auto * fn_set_threadpool = (decltype(&ggml_backend_cpu_set_threadpool)) ggml_backend_reg_get_proc_address(reg, "ggml_backend_cpu_set_threadpool");
+        if (fn_set_threadpool) {
+            fn_set_threadpool(backend, threadpool);
+        }
     }
 
     const bool t = (ggml_backend_sched_graph_compute(sched, graph) == GGML_STATUS_SUCCESS);
@@ -416,7 +475,41 @@ struct whisper_mel {
     int n_len_org;
     int n_mel;
 
-    std::vector<float> data;
+    // only frames [0, n_len_data) are stored, the rest of the 30 s padding
+    // tail is the constant tail_value
+    int   n_len_data = 0;
+    float tail_value = 0.0f;
+
+    // raw frames hold log10 power; the clamp to (mmax - 8) and the (x + 4)/4
+    // scaling are applied when frames are copied into the encoder input
+    bool  raw  = false;
+    float mmax = 0.0f;
+
+    std::vector<float> data; // [n_mel][n_len_data]
+};
+
+// per-frame scratch of the mel computation, one per thread
+struct whisper_mel_scratch {
+    std::vector<float> fft_in;
+    std::vector<float> fft_scratch; // complex, interleaved
+    std::vector<float> power;
+};
+
+// Incremental log mel spectrogram. Each STFT frame is computed once, as soon
+// as all the samples it covers have been appended. Frame and sample indices
+// are absolute since the last reset.
+struct whisper_mel_stream {
+    int64_t n_samples  = 0; // samples appended
+    int64_t frame_base = 0; // first retained frame, earlier ones were discarded
+    int64_t n_final    = 0; // frames [frame_base, n_final) are stored in frames
+
+    std::vector<float> frames; // raw log10 mel, [frame][n_mel]
+    std::vector<float> head;   // first samples, for the reflective pad of frames 0 and 1
+    std::vector<float> pcm;    // samples [pcm_begin, n_samples) still needed by later frames
+    int64_t pcm_begin = 0;
+
+    whisper_mel_scratch scratch;
+    std::vector<float> frame;
 };
 
 struct whisper_filters {
@@ -424,6 +517,11 @@ struct whisper_filters {
     int32_t n_fft;
 
     std::vector<float> data;
+
+    // [band_begin[j], band_end[j]) is the nonzero range of mel band j,
+    // filled once after the filters are loaded
+    std::vector<int32_t> band_begin;
+    std::vector<int32_t> band_end;
 };
 
 struct whisper_vocab {
@@ -435,6 +533,11 @@ struct whisper_vocab {
     std::map<token, id> token_to_id;
     std::map<id, token> id_to_token;
 
+    // token_to_id keyed by views of its own keys, so that substrings of the
+    // text are looked up without copying them
+    std::unordered_map<std::string_view, id> token_index;
+    int token_len_max = 0;
+
     // reference: https://github.com/openai/whisper/blob/248b6cb124225dd263bb9bd32d060b6517e067f8/whisper/tokenizer.py#L334-L349
     id token_eot        = 50256;
     id token_sot        = 50257;
@@ -832,6 +935,9 @@ struct vad_time_mapping {
 };
 
 struct whisper_state {
+    // CPU threadpool for the encoder/decoder graphs, not owned by the state
+    ggml_threadpool_t threadpool = nullptr;
+
     int64_t t_sample_us = 0;
     int64_t t_encode_us = 0;
     int64_t t_decode_us = 0;
@@ -861,6 +967,7 @@ struct whisper_state {
     whisper_kv_cache kv_pad;
 
     whisper_mel mel;
+    whisper_mel_stream mel_stream;
 
     whisper_batch batch;
 
@@ -878,6 +985,13 @@ struct whisper_state {
     struct ggml_tensor * embd_conv = nullptr;
     struct ggml_tensor * embd_enc  = nullptr;
 
+    // the encoder output and kv_cross hold the encoding of the current mel at
+    // this offset and audio_ctx; an encode asking for the same is skipped.
+    // Anything that changes the mel clears the flag
+    bool enc_valid      = false;
+    int  enc_mel_offset = 0;
+    int  enc_n_ctx      = 0;
+
     // helpers for GPU offloading
     std::vector<float> inp_mel;
     std::vector<float> inp_mask;
@@ -885,6 +999,13 @@ struct whisper_state {
     // decode output (2-dimensional array: [n_tokens][n_vocab])
     std::vector<float> logits;
 
+    // tokens suppressed at every step regardless of the decoded ones, one bit
+    // per vocab entry, compiled by whisper_suppress_init() for each
+    // whisper_full call. The second mask (suppress_regex and non-speech
+    // tokens) follows logits_filter_callback, so it stays empty without one
+    std::vector<uint32_t> suppress_mask;
+    std::vector<uint32_t> suppress_mask_post;
+
     std::vector<whisper_segment> result_all;
 
     // prompt history split into static prefix (prompt_past0) and dynamic rolling context (prompt_past1)
@@ -932,12 +1053,401 @@ struct whisper_state {
     bool has_vad_segments = false;
 
     std::vector<vad_time_mapping> vad_mapping_table;
+
+    // speculative decoding counters, reset by whisper_full_with_state()
+    int32_t n_spec_verify   = 0;
+    int32_t n_spec_drafted  = 0;
+    int32_t n_spec_accepted = 0;
+    int64_t t_spec_draft_us = 0;
+};
+
+// Read-only shared mapping of a model file. CPU weights point straight into
+// it, so every process loading the same file uses one copy in the page cache.
+struct whisper_mmap {
+    uint8_t * addr = nullptr;
+    size_t    size = 0;
+    size_t    pos  = 0; // loader cursor
+
+    int64_t t_map_us       = 0;
+    float   page_cache_hit = -1.0f; // fraction of the file resident before mapping
+    bool    locked         = false;
+
+    // wraps the whole mapping, owned by the model buffers
+    ggml_backend_buffer_t buffer = nullptr;
+
+    whisper_mmap() = default;
+    whisper_mmap(const whisper_mmap &) = delete;
+    whisper_mmap & operator=(const whisper_mmap &) = delete;
+
+#ifdef WHISPER_USE_MMAP
+    static std::unique_ptr<whisper_mmap> open(const char * path, bool use_mlock) {
+        const int64_t t_start_us = ggml_time_us();
+
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return nullptr;
+        }
+
+        // the mapping keeps the file referenced once the descriptor is closed
+        void * addr = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            WHISPER_LOG_WARN("%s: mmap failed: %s\n", __func__, strerror(errno));
+            return nullptr;
+        }
+
+        auto mapping = std::unique_ptr<whisper_mmap>(new whisper_mmap());
+        mapping->addr = (uint8_t *) addr;
+        mapping->size = (size_t) st.st_size;
+
+        // how much of the file another process (or an earlier run) left in the
+        // page cache, to tell cold starts from warm ones
+        {
+            const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+            const size_t n_pages = (mapping->size + page - 1)/page;
+#if defined(__APPLE__)
+            std::vector<char> vec(n_pages);
+#else
+            std::vector<unsigned char> vec(n_pages);
+#endif
+            if (mincore(addr, mapping->size, vec.data()) == 0) {
+                size_t n_resident = 0;
+                for (auto v : vec) {
+                    n_resident += v & 1;
+                }
+                mapping->page_cache_hit = (float) n_resident/n_pages;
+            }
+        }
+
+        // start readahead of the whole file while the header is parsed
+        if (madvise(addr, mapping->size, MADV_WILLNEED) != 0) {
+            WHISPER_LOG_WARN("%s: madvise(MADV_WILLNEED) failed: %s\n", __func__, strerror(errno));
+        }
+#ifdef MADV_HUGEPAGE
+        // only honoured where the kernel does huge pages for the page cache
+        madvise(addr, mapping->size, MADV_HUGEPAGE);
+#endif
+
+        if (use_mlock) {
+            if (mlock(addr, mapping->size) == 0) {
+                mapping->locked = true;
+            } else {
+                WHISPER_LOG_WARN("%s: mlock of %.2f MB failed: %s (check RLIMIT_MEMLOCK)\n",
+                        __func__, mapping->size/1e6, strerror(errno));
+            }
+        }
+
+        mapping->t_map_us = ggml_time_us() - t_start_us;
+
+        return mapping;
+    }
+
+    // reads one byte of every page so that no later graph stalls on a fault
+    // or on readahead that has not completed yet
+    size_t prefault() const {
+        const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+        uint8_t sum = 0;
+        for (size_t off = 0; off < size; off += page) {
+            sum += ((const volatile uint8_t *) addr)[off];
+        }
+        GGML_UNUSED(sum);
+        return size;
+    }
+
+    ~whisper_mmap() {
+        if (locked) {
+            munlock(addr, size);
+        }
+        if (addr) {
+            munmap(addr, size);
+        }
+    }
+#else
+    static std::unique_ptr<whisper_mmap> open(const char * /*path*/, bool /*use_mlock*/) {
+        return nullptr;
+    }
+
+    size_t prefault() const {
+        return 0;
+    }
+#endif
+};
+
+//
+// repack cache
+//
+// Sidecar file holding the weights the CPU backend re-lays out into
+// interleaved formats at load (CPU_REPACK buffer type), stored exactly as the
+// backend leaves them so later loads can map them instead of repacking:
+//
+//   header | entries[n_tensors] | padding | tensor data, each 64-byte aligned
+//
+// It is keyed by a fingerprint of the model file, the CPU features reported by
+// the backend (which select the repacked layout) and the ggml build, and is
+// rewritten whenever any of them changes.
+//
+
+#define WHISPER_REPACK_CACHE_MAGIC      0x6b707277 // "wrpk"
+#define WHISPER_REPACK_CACHE_VERSION    1
+#define WHISPER_REPACK_CACHE_ALIGN      64
+#define WHISPER_REPACK_CACHE_DATA_ALIGN 65536      // start of the data, a multiple of any page size
+
+struct whisper_repack_cache_header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t model_key;
+    uint64_t cpu_key;
+    uint64_t build_key;
+    uint32_t n_tensors;
+    uint32_t reserved;
+    uint64_t data_offset;
+    uint64_t data_size;
+};
+
+struct whisper_repack_cache_entry {
+    char     name[GGML_MAX_NAME];
+    int32_t  type;
+    int32_t  reserved;
+    int64_t  ne[4];
+    uint64_t offset; // from the start of the data
+    uint64_t nbytes;
+};
+
+struct whisper_repack_cache_key {
+    uint64_t model = 0;
+    uint64_t cpu   = 0;
+    uint64_t build = 0;
+};
+
+static const uint64_t WHISPER_FNV_OFFSET = 0xcbf29ce484222325ULL;
+
+static uint64_t whisper_fnv1a(uint64_t hash, const void * data, size_t size) {
+    const uint8_t * bytes = (const uint8_t *) data;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static uint64_t whisper_fnv1a(uint64_t hash, const char * str) {
+    // the terminator separates consecutive strings
+    return whisper_fnv1a(hash, str, strlen(str) + 1);
+}
+
+static bool whisper_repack_cache_key_init(whisper_repack_cache_key & key, const std::string & path_model, ggml_backend_reg_t cpu_reg) {
+    // hashing the whole file would cost as much as the repacking it saves, so
+    // the fingerprint is its identity (device, inode, mtime), which any
+    // rewrite or replacement changes, its size and three 1 MB samples, which
+    // also catch a copy with the same weights keeping its mtime
+    std::ifstream fin(path_model, std::ios::binary | std::ios::ate);
+    if (!fin) {
+        return false;
+    }
+
+    const uint64_t size = (uint64_t) fin.tellg();
+    std::vector<char> chunk(1 << 20);
+
+    key.model = whisper_fnv1a(WHISPER_FNV_OFFSET, &size, sizeof(size));
+#ifdef WHISPER_USE_MMAP
+    struct stat st;
+    if (stat(path_model.c_str(), &st) != 0) {
+        return false;
+    }
+#if defined(__APPLE__)
+    const int64_t mtime_ns = (int64_t) st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    const int64_t mtime_ns = (int64_t) st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    const uint64_t identity[3] = { (uint64_t) st.st_dev, (uint64_t) st.st_ino, (uint64_t) mtime_ns };
+    key.model = whisper_fnv1a(key.model, identity, sizeof(identity));
+#endif
+    for (uint64_t offset : { (uint64_t) 0, size/2, size > chunk.size() ? size - chunk.size() : 0 }) {
+        fin.clear();
+        fin.seekg((std::streamoff) offset);
+        fin.read(chunk.data(), chunk.size());
+        key.model = whisper_fnv1a(key.model, chunk.data(), (size_t) fin.gcount());
+    }
+
+    key.cpu = WHISPER_FNV_OFFSET;
+    auto get_features = (ggml_backend_get_features_t) ggml_backend_reg_get_proc_address(cpu_reg, "ggml_backend_get_features");
+    if (get_features) {
+        for (auto * feature = get_features(cpu_reg); feature && feature->name; ++feature) {
+            key.cpu = whisper_fnv1a(key.cpu, feature->name);
+            key.cpu = whisper_fnv1a(key.cpu, feature->value);
+        }
+    }
+
+    key.build = whisper_fnv1a(WHISPER_FNV_OFFSET, ggml_version());
+    key.build = whisper_fnv1a(key.build, ggml_commit());
+#ifdef WHISPER_REPACK_BUILD_ID
+    key.build = whisper_fnv1a(key.build, WHISPER_REPACK_BUILD_ID);
+#endif
+
+    return true;
+}
+
+struct whisper_repack_cache {
+    std::unique_ptr<whisper_mmap> mapping;
+
+    std::map<std::string, const whisper_repack_cache_entry *> entries;
+    uint8_t * data      = nullptr;
+    size_t    data_size = 0;
+
+    // the whole file is validated here, so entries can be trusted afterwards
+    static std::unique_ptr<whisper_repack_cache> open(const char * path, const whisper_repack_cache_key & key, bool use_mlock) {
+        auto mapping = whisper_mmap::open(path, use_mlock);
+        if (!mapping || mapping->size < sizeof(whisper_repack_cache_header)) {
+            return nullptr;
+        }
+
+        const auto * header = (const whisper_repack_cache_header *) mapping->addr;
+        if (header->magic     != WHISPER_REPACK_CACHE_MAGIC ||
+            header->version   != WHISPER_REPACK_CACHE_VERSION ||
+            header->model_key != key.model ||
+            header->cpu_key   != key.cpu ||
+            header->build_key != key.build) {
+            WHISPER_LOG_INFO("%s: repack cache '%s' is stale\n", __func__, path);
+            return nullptr;
+        }
+
+        const uint64_t entries_end = sizeof(whisper_repack_cache_header) + (uint64_t) header->n_tensors*sizeof(whisper_repack_cache_entry);
+        if (entries_end > header->data_offset ||
+            header->data_offset % WHISPER_REPACK_CACHE_DATA_ALIGN != 0 ||
+            header->data_offset + header->data_size > mapping->size) {
+            WHISPER_LOG_WARN("%s: repack cache '%s' is corrupted\n", __func__, path);
+            return nullptr;
+        }
+
+        auto cache = std::unique_ptr<whisper_repack_cache>(new whisper_repack_cache());
+        const auto * entries = (const whisper_repack_cache_entry *) (mapping->addr + sizeof(whisper_repack_cache_header));
+        for (uint32_t i = 0; i < header->n_tensors; ++i) {
+            const auto & entry = entries[i];
+            if (entry.offset % WHISPER_REPACK_CACHE_ALIGN != 0 || entry.offset + entry.nbytes > header->data_size) {
+                WHISPER_LOG_WARN("%s: repack cache '%s' is corrupted\n", __func__, path);
+                return nullptr;
+            }
+            cache->entries[std::string(entry.name, strnlen(entry.name, sizeof(entry.name)))] = &entry;
+        }
+
+        cache->data      = mapping->addr + header->data_offset;
+        cache->data_size = header->data_size;
+        cache->mapping   = std::move(mapping);
+
+        return cache;
+    }
+
+    // places every tensor of ctx on its repacked data, or returns NULL if the
+    // cache does not hold all of them as they are now
+    ggml_backend_buffer_t attach(ggml_context * ctx, ggml_backend_buffer_from_ptr_t buffer_from_ptr) const {
+        for (ggml_tensor * t = ggml_get_first_tensor(ctx); t; t = ggml_get_next_tensor(ctx, t)) {
+            auto it = entries.find(ggml_get_name(t));
+            if (it == entries.end()) {
+                return nullptr;
+            }
+            const auto * entry = it->second;
+            if (entry->type != t->type || entry->nbytes != ggml_nbytes(t) ||
+                entry->ne[0] != t->ne[0] || entry->ne[1] != t->ne[1] || entry->ne[2] != t->ne[2] || entry->ne[3] != t->ne[3]) {
+                return nullptr;
+            }
+        }
+
+        ggml_backend_buffer_t buf = buffer_from_ptr(data, data_size);
+        if (!buf) {
+            return nullptr;
+        }
+        for (ggml_tensor * t = ggml_get_first_tensor(ctx); t; t = ggml_get_next_tensor(ctx, t)) {
+            ggml_backend_tensor_alloc(buf, t, data + entries.at(ggml_get_name(t))->offset);
+        }
+        return buf;
+    }
+
+    // written next to the final path and renamed over it, so a reader never
+    // sees a partial file
+    static bool write(const std::string & path, const whisper_repack_cache_key & key, const std::vector<ggml_tensor *> & tensors) {
+        std::vector<whisper_repack_cache_entry> entries(tensors.size());
+        uint64_t data_size = 0;
+        for (size_t i = 0; i < tensors.size(); ++i) {
+            auto & entry = entries[i];
+            memset(&entry, 0, sizeof(entry));
+            strncpy(entry.name, ggml_get_name(tensors[i]), sizeof(entry.name) - 1);
+            entry.type   = tensors[i]->type;
+            for (int j = 0; j < 4; ++j) {
+                entry.ne[j] = tensors[i]->ne[j];
+            }
+            entry.offset = GGML_PAD(data_size, WHISPER_REPACK_CACHE_ALIGN);
+            entry.nbytes = ggml_nbytes(tensors[i]);
+            data_size = entry.offset + entry.nbytes;
+        }
+
+        whisper_repack_cache_header header;
+        memset(&header, 0, sizeof(header));
+        header.magic       = WHISPER_REPACK_CACHE_MAGIC;
+        header.version     = WHISPER_REPACK_CACHE_VERSION;
+        header.model_key   = key.model;
+        header.cpu_key     = key.cpu;
+        header.build_key   = key.build;
+        header.n_tensors   = (uint32_t) entries.size();
+        header.data_offset = GGML_PAD(sizeof(header) + entries.size()*sizeof(whisper_repack_cache_entry), WHISPER_REPACK_CACHE_DATA_ALIGN);
+        header.data_size   = data_size;
+
+        const std::string path_tmp = path + ".tmp";
+        {
+            std::ofstream fout(path_tmp, std::ios::binary | std::ios::trunc);
+            if (!fout) {
+                return false;
+            }
+
+            const std::vector<char> zeros(WHISPER_REPACK_CACHE_DATA_ALIGN, 0);
+            uint64_t pos = 0;
+            auto write_at = [&](uint64_t offset, const void * src, size_t size) {
+                fout.write(zeros.data(), (std::streamsize) (offset - pos));
+                fout.write((const char *) src, (std::streamsize) size);
+                pos = offset + size;
+            };
+
+            write_at(0, &header, sizeof(header));
+            write_at(pos, entries.data(), entries.size()*sizeof(whisper_repack_cache_entry));
+            for (size_t i = 0; i < tensors.size(); ++i) {
+                // repacked buffers live in host memory
+                write_at(header.data_offset + entries[i].offset, tensors[i]->data, entries[i].nbytes);
+            }
+
+            if (!fout.good()) {
+                fout.close();
+                std::remove(path_tmp.c_str());
+                return false;
+            }
+        }
+
+        if (std::rename(path_tmp.c_str(), path.c_str()) != 0) {
+            std::remove(path_tmp.c_str());
+            return false;
+        }
+        return true;
+    }
 };
 
 struct whisper_context {
     int64_t t_load_us  = 0;
     int64_t t_start_us = 0;
 
+    // set when the model was loaded through a file mapping
+    std::unique_ptr<whisper_mmap> mapping;
+    size_t n_bytes_mapped = 0; // weights used in place from the mapping
+    size_t n_bytes_copied = 0; // weights read into allocated buffers
+
+    // set when the repacked weights came from the repack cache
+    std::unique_ptr<whisper_repack_cache> repack_cache;
+    size_t n_bytes_repacked      = 0; // weights repacked while loading
+    size_t n_bytes_repack_cached = 0; // repacked weights mapped from the cache
+
     ggml_type wtype = ggml_type::GGML_TYPE_F16; // weight type (FP32 / FP16 / QX)
     ggml_type itype = ggml_type::GGML_TYPE_F16; // intermediate type (FP32 or FP16)
 
@@ -948,6 +1458,16 @@ struct whisper_context {
 
     whisper_state * state = nullptr;
 
+    // tokens matching the recent suppress_regex values, matched against the
+    // vocab once rather than at every step, most recently used first. States
+    // decoding in parallel share it
+    std::mutex suppress_regex_mutex;
+    std::list<std::pair<std::string, std::vector<whisper_token>>> suppress_regex_ids;
+
+    // recent whisper_tokenize() results, most recently used first
+    std::mutex tokenize_cache_mutex;
+    std::list<std::pair<std::string, std::vector<whisper_token>>> tokenize_cache;
+
     std::string path_model; // populated by whisper_init_from_file_with_params()
 };
 
@@ -1583,6 +2103,19 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
         filters.data.resize(filters.n_mel * filters.n_fft);
         loader->read(loader->context, filters.data.data(), filters.data.size() * sizeof(float));
         BYTESWAP_FILTERS(filters);
+
+        // each triangular band only touches a handful of FFT bins
+        filters.band_begin.assign(filters.n_mel, 0);
+        filters.band_end.assign(filters.n_mel, 0);
+        for (int j = 0; j < filters.n_mel; j++) {
+            const float * row = filters.data.data() + j * filters.n_fft;
+            int begin = 0;
+            int end   = filters.n_fft;
+            while (begin < end && row[begin]   == 0.0f) begin++;
+            while (end > begin && row[end - 1] == 0.0f) end--;
+            filters.band_begin[j] = begin;
+            filters.band_end[j]   = end;
+        }
     }
 
     // load vocab
@@ -1671,6 +2204,12 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
             }
         }
 
+        vocab.token_index.reserve(vocab.token_to_id.size());
+        for (const auto & token_id : vocab.token_to_id) {
+            vocab.token_index.emplace(token_id.first, token_id.second);
+            vocab.token_len_max = std::max(vocab.token_len_max, (int) token_id.first.size());
+        }
+
         WHISPER_LOG_INFO("%s: n_langs       = %d\n", __func__, vocab.num_languages());
     }
 
@@ -1721,7 +2260,9 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
         ggml_context * ctx = get_ctx(buft);
         ggml_tensor * tensor = ggml_dup_tensor(ctx, meta);
 
-        model.tensors[format(ASR_TENSOR_NAMES.at(system).at(type), layer)] = tensor;
+        const std::string name = format(ASR_TENSOR_NAMES.at(system).at(type), layer);
+        ggml_set_name(tensor, name.c_str()); // the repack cache is keyed by name
+        model.tensors[name] = tensor;
 
         return tensor;
     };
@@ -1845,10 +2386,56 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
         ggml_free(ctx);
     }
 
+    // weights the CPU backend repacks can be mapped from the repack cache
+    ggml_backend_buffer_type_t repack_buft = nullptr;
+    ggml_backend_reg_t repack_reg = nullptr;
+    for (const auto & p : buft_list) {
+        if (strcmp(ggml_backend_buft_name(p.second), "CPU_REPACK") == 0 && ctx_map.count(p.second)) {
+            repack_buft = p.second;
+            repack_reg  = ggml_backend_dev_backend_reg(p.first);
+        }
+    }
+
+    ggml_backend_buffer_from_ptr_t repack_buffer_from_ptr = nullptr;
+    whisper_repack_cache_key repack_key;
+    bool use_repack_cache = false;
+#ifdef WHISPER_USE_MMAP
+    if (repack_buft && wctx.params.repack_cache_path && !wctx.path_model.empty()) {
+        repack_buffer_from_ptr = (ggml_backend_buffer_from_ptr_t)
+            ggml_backend_reg_get_proc_address(repack_reg, "ggml_backend_cpu_repack_buffer_from_ptr");
+        use_repack_cache = repack_buffer_from_ptr && whisper_repack_cache_key_init(repack_key, wctx.path_model, repack_reg);
+    }
+#endif
+    GGML_UNUSED(repack_reg);
+    if (use_repack_cache) {
+        wctx.repack_cache = whisper_repack_cache::open(wctx.params.repack_cache_path, repack_key, wctx.params.use_mlock);
+    }
+
     // allocate tensors in the backend buffers
+    whisper_mmap * mapping = wctx.mapping.get();
     for (auto & p : ctx_map) {
         ggml_backend_buffer_type_t buft = p.first;
         ggml_context * ctx = p.second;
+        if (wctx.repack_cache && buft == repack_buft) {
+            ggml_backend_buffer_t buf = wctx.repack_cache->attach(ctx, repack_buffer_from_ptr);
+            if (buf) {
+                model.buffers.emplace_back(buf);
+                WHISPER_LOG_INFO("%s: %12s total size = %8.2f MB (repack cache)\n", __func__, ggml_backend_buffer_name(buf), ggml_backend_buffer_get_size(buf) / 1e6);
+                continue;
+            }
+            WHISPER_LOG_INFO("%s: repack cache does not match the model, repacking\n", __func__);
+            wctx.repack_cache.reset();
+        }
+        if (mapping && buft == ggml_backend_cpu_buffer_type()) {
+            // plain CPU weights are placed in the mapping while loading
+            mapping->buffer = ggml_backend_cpu_buffer_from_ptr(mapping->addr, mapping->size);
+            if (!mapping->buffer) {
+                WHISPER_LOG_ERROR("%s: failed to wrap the model mapping in a buffer\n", __func__);
+                return false;
+            }
+            model.buffers.emplace_back(mapping->buffer);
+            continue;
+        }
         ggml_backend_buffer_t buf = ggml_backend_alloc_ctx_tensors_from_buft(ctx, buft);
         if (buf) {
             model.buffers.emplace_back(buf);
@@ -1863,6 +2450,10 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
         size_t total_size = 0;
 
         model.n_loaded = 0;
+        wctx.n_bytes_mapped = 0;
+        wctx.n_bytes_copied = 0;
+        wctx.n_bytes_repacked = 0;
+        wctx.n_bytes_repack_cached = 0;
 
         std::vector<char> read_buf;
 
@@ -1919,10 +2510,49 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
                 return false;
             }
 
-            if (ggml_backend_buffer_is_host(tensor->buffer)) {
+            const bool repacked = repack_buft && tensor->buffer && ggml_backend_buffer_get_type(tensor->buffer) == repack_buft;
+
+            if (repacked && wctx.repack_cache) {
+                // already repacked in the cache, the copy in the model file is not needed
+                if (mapping) {
+                    if (mapping->pos + ggml_nbytes(tensor) > mapping->size) {
+                        WHISPER_LOG_ERROR("%s: tensor '%s' is truncated in model file\n", __func__, name.data());
+                        return false;
+                    }
+                    mapping->pos += ggml_nbytes(tensor);
+                } else {
+                    read_buf.resize(ggml_nbytes(tensor));
+                    loader->read(loader->context, read_buf.data(), read_buf.size());
+                }
+                wctx.n_bytes_repack_cached += ggml_nbytes(tensor);
+            } else if (tensor->buffer == nullptr) {
+                // tensor of the mapped CPU buffer: kernels index weights as their
+                // element type, so it is used in place only if the file keeps it aligned
+                const size_t align = tensor->type == GGML_TYPE_F16 || tensor->type == GGML_TYPE_BF16 ? 2 : 4;
+                if (mapping->pos + ggml_nbytes(tensor) > mapping->size) {
+                    WHISPER_LOG_ERROR("%s: tensor '%s' is truncated in model file\n", __func__, name.data());
+                    return false;
+                }
+                if (mapping->pos % align == 0) {
+                    ggml_backend_tensor_alloc(mapping->buffer, tensor, mapping->addr + mapping->pos);
+                    mapping->pos += ggml_nbytes(tensor);
+                    wctx.n_bytes_mapped += ggml_nbytes(tensor);
+                } else {
+                    ggml_backend_buffer_t buf = ggml_backend_buft_alloc_buffer(ggml_backend_cpu_buffer_type(), ggml_nbytes(tensor));
+                    if (!buf) {
+                        WHISPER_LOG_ERROR("%s: failed to allocate buffer for tensor '%s'\n", __func__, name.data());
+                        return false;
+                    }
+                    model.buffers.emplace_back(buf);
+                    ggml_backend_tensor_alloc(buf, tensor, ggml_backend_buffer_get_base(buf));
+                    loader->read(loader->context, tensor->data, ggml_nbytes(tensor));
+                    wctx.n_bytes_copied += ggml_nbytes(tensor);
+                }
+            } else if (ggml_backend_buffer_is_host(tensor->buffer)) {
                 // for the CPU and Metal backend, we can read directly into the tensor
                 loader->read(loader->context, tensor->data, ggml_nbytes(tensor));
                 BYTESWAP_TENSOR(tensor);
+                wctx.n_bytes_copied += ggml_nbytes(tensor);
             } else {
                 // read into a temporary buffer first, then copy to device memory
                 read_buf.resize(ggml_nbytes(tensor));
@@ -1930,6 +2560,10 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
                 loader->read(loader->context, read_buf.data(), read_buf.size());
 
                 ggml_backend_tensor_set(tensor, read_buf.data(), 0, ggml_nbytes(tensor));
+                wctx.n_bytes_copied += ggml_nbytes(tensor);
+                if (repacked) {
+                    wctx.n_bytes_repacked += ggml_nbytes(tensor);
+                }
             }
 
             total_size += ggml_nbytes(tensor);
@@ -1937,6 +2571,10 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
         }
 
         WHISPER_LOG_INFO("%s: model size    = %7.2f MB\n", __func__, total_size/1e6);
+        if (mapping) {
+            WHISPER_LOG_INFO("%s: mapped        = %7.2f MB, copied = %7.2f MB, %3.0f%% in page cache\n", __func__,
+                    wctx.n_bytes_mapped/1e6, wctx.n_bytes_copied/1e6, 100.0f*std::max(0.0f, mapping->page_cache_hit));
+        }
 
         if (model.n_loaded == 0) {
             WHISPER_LOG_WARN("%s: WARN no tensors loaded from model file - assuming empty model for testing\n", __func__);
@@ -1946,11 +2584,29 @@ static bool whisper_model_load(struct whisper_model_loader * loader, whisper_con
         }
     }
 
+    if (use_repack_cache && wctx.n_bytes_repacked > 0) {
+        std::vector<ggml_tensor *> tensors;
+        for (const auto & kv : model.tensors) {
+            ggml_tensor * tensor = kv.second;
+            if (ggml_backend_buffer_get_type(tensor->buffer) == repack_buft) {
+                tensors.push_back(tensor);
+            }
+        }
+        if (whisper_repack_cache::write(wctx.params.repack_cache_path, repack_key, tensors)) {
+            WHISPER_LOG_INFO("%s: saved %.2f MB of repacked weights to '%s'\n", __func__, wctx.n_bytes_repacked/1e6, wctx.params.repack_cache_path);
+        } else {
+            WHISPER_LOG_WARN("%s: failed to write repack cache '%s'\n", __func__, wctx.params.repack_cache_path);
+        }
+    }
+
     for (auto & buf : model.buffers) {
         ggml_backend_buffer_set_usage(buf, GGML_BACKEND_BUFFER_USAGE_WEIGHTS);
     }
 
     wctx.t_load_us = ggml_time_us() - t_start_us;
+    if (mapping) {
+        wctx.t_load_us += mapping->t_map_us;
+    }
 
     return true;
 }
@@ -2364,6 +3020,16 @@ static bool whisper_encode_internal(
                    void * abort_callback_data) {
     const int64_t t_start_us = ggml_time_us();
 
+    const int n_enc_ctx = wstate.exp_n_audio_ctx > 0 ? wstate.exp_n_audio_ctx : wctx.model.hparams.n_audio_ctx;
+
+    // e.g. language detection followed by the first window of the transcription
+    if (wstate.enc_valid && wstate.enc_mel_offset == mel_offset && wstate.enc_n_ctx == n_enc_ctx) {
+        WHISPER_LOG_DEBUG("%s: reusing the encoder output for offset %d, audio_ctx %d\n", __func__, mel_offset, n_enc_ctx);
+        return !(abort_callback && abort_callback(abort_callback_data));
+    }
+
+    wstate.enc_valid = false;
+
     // conv
     {
         auto & sched = wstate.sched_conv.sched;
@@ -2392,10 +3058,19 @@ static bool whisper_encode_internal(
 
             const int i0 = std::min(mel_offset,           mel_inp.n_len);
             const int i1 = std::min(mel_offset + 2*n_ctx, mel_inp.n_len);
+            const int id = std::max(i0, std::min(i1, mel_inp.n_len_data)); // first padding tail frame
+
+            const float floor = mel_inp.mmax - 8.0f;
+            auto norm = [&](float v) { return mel_inp.raw ? (std::max(v, floor) + 4.0f)/4.0f : v; };
+            const float tail = norm(mel_inp.tail_value);
 
             for (int j = 0; j < mel_inp.n_mel; ++j) {
-                for (int i = i0; i < i1; ++i) {
-                    dst[j*2*n_ctx + (i - i0)] = mel_inp.data[j*mel_inp.n_len + i];
+                const float * src = mel_inp.data.data() + (size_t) j*mel_inp.n_len_data;
+                for (int i = i0; i < id; ++i) {
+                    dst[j*2*n_ctx + (i - i0)] = norm(src[i]);
+                }
+                for (int i = id; i < i1; ++i) {
+                    dst[j*2*n_ctx + (i - i0)] = tail;
                 }
             }
 
@@ -2403,7 +3078,7 @@ static bool whisper_encode_internal(
         }
 
         if (!whisper_encode_external(wstate)) {
-            if (!ggml_graph_compute_helper(sched, gf, n_threads)) {
+            if (!ggml_graph_compute_helper(sched, gf, n_threads, true, wstate.threadpool)) {
                 return false;
             }
         } else {
@@ -2428,7 +3103,7 @@ static bool whisper_encode_internal(
             return false;
         }
 
-        if (!ggml_graph_compute_helper(sched, gf, n_threads)) {
+        if (!ggml_graph_compute_helper(sched, gf, n_threads, true, wstate.threadpool)) {
             return false;
         }
     }
@@ -2444,11 +3119,15 @@ static bool whisper_encode_internal(
             return false;
         }
 
-        if (!ggml_graph_compute_helper(sched, gf, n_threads)) {
+        if (!ggml_graph_compute_helper(sched, gf, n_threads, true, wstate.threadpool)) {
             return false;
         }
     }
 
+    wstate.enc_valid      = true;
+    wstate.enc_mel_offset = mel_offset;
+    wstate.enc_n_ctx      = n_enc_ctx;
+
     wstate.t_encode_us += ggml_time_us() - t_start_us;
     wstate.n_encode++;
 
@@ -2941,7 +3620,7 @@ static bool whisper_decode_internal(
 
         logits = ggml_graph_node(gf, -1);
 
-        if (!ggml_graph_compute_helper(sched, gf, n_threads)) {
+        if (!ggml_graph_compute_helper(sched, gf, n_threads, true, wstate.threadpool)) {
             return false;
         }
     }
@@ -2994,30 +3673,217 @@ static std::string to_timestamp(int64_t t, bool comma = false) {
     return std::string(buf);
 }
 
-#define SIN_COS_N_COUNT WHISPER_N_FFT
+#define WHISPER_FFT_MAX_FACTORS 16
+
 namespace {
-struct whisper_global_cache {
-    // In FFT, we frequently use sine and cosine operations with the same values.
-    // We can use precalculated values to speed up the process.
-    float sin_vals[SIN_COS_N_COUNT];
-    float cos_vals[SIN_COS_N_COUNT];
+struct whisper_cpx {
+    float r;
+    float i;
+};
 
+// Real-input FFT plan for frames of WHISPER_N_FFT samples. The real frame is
+// packed into a complex sequence of half the length, transformed with a
+// mixed-radix (4/2/3/5) decimation-in-time FFT, and then split back into the
+// spectrum of the real input. All twiddles are computed once.
+struct whisper_fft_plan {
+    int n_half = 0;
+    int factors[2 * WHISPER_FFT_MAX_FACTORS] = {}; // (radix, remaining length) pairs
+    std::vector<whisper_cpx> twiddles;              // exp(-2*pi*i*k/n_half)
+    std::vector<whisper_cpx> super_twiddles;        // exp(-2*pi*i*k/(2*n_half)), k in [0, n_half/2]
+
+    void init(int n) {
+        WHISPER_ASSERT(n % 2 == 0 && "real FFT needs an even frame size");
+        n_half = n / 2;
+
+        twiddles.resize(n_half);
+        for (int k = 0; k < n_half; k++) {
+            const double theta = -2.0 * M_PI * k / n_half;
+            twiddles[k] = { (float) cos(theta), (float) sin(theta) };
+        }
+
+        super_twiddles.resize(n_half / 2 + 1);
+        for (int k = 0; k <= n_half / 2; k++) {
+            const double theta = -M_PI * ((double) k / n_half + 0.5);
+            super_twiddles[k] = { (float) cos(theta), (float) sin(theta) };
+        }
+
+        // factor as 4s first, then 2, 3, 5 - the same ordering kissfft uses
+        int m = n_half;
+        int p = 4;
+        int nf = 0;
+        while (m > 1) {
+            while (m % p) {
+                switch (p) {
+                    case 4:  p = 2; break;
+                    case 2:  p = 3; break;
+                    case 3:  p = 5; break;
+                    default: p = m; break;
+                }
+            }
+            WHISPER_ASSERT(p <= 5 && "FFT size must factor into 2, 3 and 5");
+            WHISPER_ASSERT(nf < WHISPER_FFT_MAX_FACTORS);
+            m /= p;
+            factors[2 * nf + 0] = p;
+            factors[2 * nf + 1] = m;
+            nf++;
+        }
+    }
+};
+
+static inline whisper_cpx cpx_mul(whisper_cpx a, whisper_cpx b) {
+    return { a.r * b.r - a.i * b.i, a.r * b.i + a.i * b.r };
+}
+
+static inline whisper_cpx cpx_add(whisper_cpx a, whisper_cpx b) {
+    return { a.r + b.r, a.i + b.i };
+}
+
+static inline whisper_cpx cpx_sub(whisper_cpx a, whisper_cpx b) {
+    return { a.r - b.r, a.i - b.i };
+}
+
+static void fft_bfly2(whisper_cpx * out, const whisper_fft_plan & plan, int fstride, int m) {
+    whisper_cpx * out2 = out + m;
+    const whisper_cpx * tw = plan.twiddles.data();
+    for (int k = 0; k < m; k++) {
+        const whisper_cpx t = cpx_mul(out2[k], tw[k * fstride]);
+        out2[k] = cpx_sub(out[k], t);
+        out[k]  = cpx_add(out[k], t);
+    }
+}
+
+static void fft_bfly3(whisper_cpx * out, const whisper_fft_plan & plan, int fstride, int m) {
+    const whisper_cpx * tw = plan.twiddles.data();
+    const float epi3 = tw[fstride * m].i;
+    for (int k = 0; k < m; k++) {
+        const whisper_cpx s1 = cpx_mul(out[k + m],     tw[k * fstride]);
+        const whisper_cpx s2 = cpx_mul(out[k + 2 * m], tw[2 * k * fstride]);
+        const whisper_cpx s3 = cpx_add(s1, s2);
+        const whisper_cpx s0 = { (s1.r - s2.r) * epi3, (s1.i - s2.i) * epi3 };
+
+        const whisper_cpx mid = { out[k].r - 0.5f * s3.r, out[k].i - 0.5f * s3.i };
+        out[k] = cpx_add(out[k], s3);
+        out[k + 2 * m] = { mid.r + s0.i, mid.i - s0.r };
+        out[k + m]     = { mid.r - s0.i, mid.i + s0.r };
+    }
+}
+
+static void fft_bfly4(whisper_cpx * out, const whisper_fft_plan & plan, int fstride, int m) {
+    const whisper_cpx * tw = plan.twiddles.data();
+    for (int k = 0; k < m; k++) {
+        const whisper_cpx s0 = cpx_mul(out[k + m],     tw[k * fstride]);
+        const whisper_cpx s1 = cpx_mul(out[k + 2 * m], tw[2 * k * fstride]);
+        const whisper_cpx s2 = cpx_mul(out[k + 3 * m], tw[3 * k * fstride]);
+
+        const whisper_cpx s5 = cpx_sub(out[k], s1);
+        const whisper_cpx a  = cpx_add(out[k], s1);
+        const whisper_cpx s3 = cpx_add(s0, s2);
+        const whisper_cpx s4 = cpx_sub(s0, s2);
+
+        out[k + 2 * m] = cpx_sub(a, s3);
+        out[k]         = cpx_add(a, s3);
+        out[k + m]     = { s5.r + s4.i, s5.i - s4.r };
+        out[k + 3 * m] = { s5.r - s4.i, s5.i + s4.r };
+    }
+}
+
+static void fft_bfly5(whisper_cpx * out, const whisper_fft_plan & plan, int fstride, int m) {
+    const whisper_cpx * tw = plan.twiddles.data();
+    const whisper_cpx ya = tw[fstride * m];
+    const whisper_cpx yb = tw[fstride * 2 * m];
+    for (int k = 0; k < m; k++) {
+        const whisper_cpx s0 = out[k];
+        const whisper_cpx s1 = cpx_mul(out[k + m],     tw[k * fstride]);
+        const whisper_cpx s2 = cpx_mul(out[k + 2 * m], tw[2 * k * fstride]);
+        const whisper_cpx s3 = cpx_mul(out[k + 3 * m], tw[3 * k * fstride]);
+        const whisper_cpx s4 = cpx_mul(out[k + 4 * m], tw[4 * k * fstride]);
+
+        const whisper_cpx s7  = cpx_add(s1, s4);
+        const whisper_cpx s10 = cpx_sub(s1, s4);
+        const whisper_cpx s8  = cpx_add(s2, s3);
+        const whisper_cpx s9  = cpx_sub(s2, s3);
+
+        out[k] = { s0.r + s7.r + s8.r, s0.i + s7.i + s8.i };
+
+        const whisper_cpx s5 = { s0.r + s7.r * ya.r + s8.r * yb.r, s0.i + s7.i * ya.r + s8.i * yb.r };
+        const whisper_cpx s6 = { s10.i * ya.i + s9.i * yb.i, -s10.r * ya.i - s9.r * yb.i };
+        out[k + m]     = cpx_sub(s5, s6);
+        out[k + 4 * m] = cpx_add(s5, s6);
+
+        const whisper_cpx s11 = { s0.r + s7.r * yb.r + s8.r * ya.r, s0.i + s7.i * yb.r + s8.i * ya.r };
+        const whisper_cpx s12 = { -s10.i * yb.i + s9.i * ya.i, s10.r * yb.i - s9.r * ya.i };
+        out[k + 2 * m] = cpx_add(s11, s12);
+        out[k + 3 * m] = cpx_sub(s11, s12);
+    }
+}
+
+// out-of-place decimation in time: gather the strided inputs for each sub-FFT,
+// recurse, then combine with a radix-p butterfly
+static void fft_work(whisper_cpx * out, const whisper_cpx * in, int fstride, const int * factors, const whisper_fft_plan & plan) {
+    const int p = factors[0];
+    const int m = factors[1];
+    whisper_cpx * const out_end = out + p * m;
+
+    if (m == 1) {
+        for (whisper_cpx * o = out; o != out_end; o++, in += fstride) {
+            *o = *in;
+        }
+    } else {
+        for (whisper_cpx * o = out; o != out_end; o += m, in += fstride) {
+            fft_work(o, in, fstride * p, factors + 2, plan);
+        }
+    }
+
+    switch (p) {
+        case 2: fft_bfly2(out, plan, fstride, m); break;
+        case 3: fft_bfly3(out, plan, fstride, m); break;
+        case 4: fft_bfly4(out, plan, fstride, m); break;
+        case 5: fft_bfly5(out, plan, fstride, m); break;
+    }
+}
+
+// power spectrum |X[k]|^2 for k in [0, n/2] of a real frame of n = 2 * n_half samples
+// scratch must hold 2 * n_half complex values
+static void fft_power(const whisper_fft_plan & plan, const float * in, whisper_cpx * scratch, float * power) {
+    const int n_half = plan.n_half;
+    const whisper_cpx * packed = reinterpret_cast<const whisper_cpx *>(in);
+    whisper_cpx * z = scratch;
+
+    fft_work(z, packed, 1, plan.factors, plan);
+
+    // split the packed spectrum: X[k] = (Z[k] + conj(Z[-k]))/2 + w^k (Z[k] - conj(Z[-k]))/(2i)
+    power[0]      = (z[0].r + z[0].i) * (z[0].r + z[0].i);
+    power[n_half] = (z[0].r - z[0].i) * (z[0].r - z[0].i);
+
+    for (int k = 1; k <= n_half / 2; k++) {
+        const whisper_cpx a = z[k];
+        const whisper_cpx b = { z[n_half - k].r, -z[n_half - k].i };
+
+        const whisper_cpx even = { 0.5f * (a.r + b.r), 0.5f * (a.i + b.i) };
+        const whisper_cpx odd  = cpx_mul({ 0.5f * (a.r - b.r), 0.5f * (a.i - b.i) }, plan.super_twiddles[k]);
+
+        const whisper_cpx xk  = cpx_add(even, odd);
+        const whisper_cpx xnk = { even.r - odd.r, odd.i - even.i };
+
+        power[k]          = xk.r * xk.r + xk.i * xk.i;
+        power[n_half - k] = xnk.r * xnk.r + xnk.i * xnk.i;
+    }
+}
+}
+
+namespace {
+struct whisper_global_cache {
     // Hann window (Use cosf to eliminate difference)
     // ref: https://pytorch.org/docs/stable/generated/torch.hann_window.html
     // ref: https://github.com/openai/whisper/blob/main/whisper/audio.py#L147
     float hann_window[WHISPER_N_FFT];
 
+    // FFT plan for WHISPER_N_FFT-sample frames, built once
+    whisper_fft_plan fft_plan;
+
     whisper_global_cache() {
-        fill_sin_cos_table();
         fill_hann_window(sizeof(hann_window)/sizeof(hann_window[0]), true, hann_window);
-    }
-
-    void fill_sin_cos_table() {
-        for (int i = 0; i < SIN_COS_N_COUNT; i++) {
-            double theta = (2 * M_PI * i) / SIN_COS_N_COUNT;
-            sin_vals[i] = sinf(theta);
-            cos_vals[i] = cosf(theta);
-        }
+        fft_plan.init(WHISPER_N_FFT);
     }
 
     void fill_hann_window(int length, bool periodic, float * output) {
@@ -3032,276 +3898,360 @@ struct whisper_global_cache {
 } global_cache;
 }
 
-// naive Discrete Fourier Transform
-// input is real-valued
-// output is complex-valued
-static void dft(const float* in, int N, float* out) {
-    const int sin_cos_step = SIN_COS_N_COUNT / N;
+// dot product of the power spectrum with the nonzero part of one mel band
+//
+// Accumulated in float, 8 (AVX2) or 4 (NEON) lanes wide, where the reference
+// sums in double. Bands span at most 14 bins (80 mels, 9 with 128), and on
+// noise and tones from 0 to -100 dB the normalized mel stays within 2.5e-8 of
+// a double sum, well below the float rounding of the encoder input.
+static float mel_band_dot(const float * power, const float * weights, int n) {
+    int k = 0;
+    float sum = 0.0f;
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256 acc = _mm256_setzero_ps();
+    for (; k + 8 <= n; k += 8) {
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(power + k), _mm256_loadu_ps(weights + k), acc);
+    }
+    __m128 lo = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_movehdup_ps(lo));
+    sum = _mm_cvtss_f32(lo);
+#elif defined(__ARM_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; k + 4 <= n; k += 4) {
+        acc = vmlaq_f32(acc, vld1q_f32(power + k), vld1q_f32(weights + k));
+    }
+    sum = vgetq_lane_f32(acc, 0) + vgetq_lane_f32(acc, 1) + vgetq_lane_f32(acc, 2) + vgetq_lane_f32(acc, 3);
+#endif
+    for (; k < n; k++) {
+        sum += power[k] * weights[k];
+    }
+    return sum;
+}
 
-    for (int k = 0; k < N; k++) {
-        float re = 0;
-        float im = 0;
+// ref: https://github.com/openai/whisper/blob/main/whisper/audio.py#L110-L157
+//
+// Frame i covers samples [i*hop - n_fft/2, i*hop + n_fft/2). The first n_fft/2
+// samples before the audio are a reflection of it, everything after the end of
+// the appended audio is zero (the 30 s padding).
+#define WHISPER_MEL_TAIL_VALUE -10.0f // log10(1e-10), a frame of zeros
 
-        for (int n = 0; n < N; n++) {
-            int idx = (k * n * sin_cos_step) % (SIN_COS_N_COUNT); // t = 2*M_PI*k*n/N
-            re += in[n]*global_cache.cos_vals[idx]; // cos(t)
-            im -= in[n]*global_cache.sin_vals[idx]; // sin(t)
-        }
+static void mel_stream_reset(whisper_mel_stream & ms) {
+    ms.n_samples  = 0;
+    ms.frame_base = 0;
+    ms.n_final    = 0;
+    ms.pcm_begin  = 0;
+    ms.frames.clear();
+    ms.head.clear();
+    ms.pcm.clear();
+}
 
-        out[k*2 + 0] = re;
-        out[k*2 + 1] = im;
+static float mel_stream_sample(const whisper_mel_stream & ms, int64_t s) {
+    if (s < 0) {
+        return -s < (int64_t) ms.head.size() ? ms.head[-s] : 0.0f;
     }
+    if (s >= ms.n_samples) {
+        return 0.0f;
+    }
+    return ms.pcm[s - ms.pcm_begin];
 }
 
-// Cooley-Tukey FFT
-// poor man's implementation - use something better
-// input is real-valued
-// output is complex-valued
-static void fft(float* in, int N, float* out) {
-    if (N == 1) {
-        out[0] = in[0];
-        out[1] = 0;
-        return;
-    }
+// raw log10 mel of frame i into out[n_mel]
+static void mel_stream_frame(const whisper_mel_stream & ms, whisper_mel_scratch & scratch, int64_t i, const whisper_filters & filters, float * out) {
+    const int frame_size = WHISPER_N_FFT;
+    const int n_fft      = filters.n_fft;
+    const float * hann   = global_cache.hann_window;
 
-    const int half_N = N / 2;
-    if (N - half_N*2 == 1) {
-        dft(in, N, out);
-        return;
-    }
+    // make sure n_fft == 1 + (WHISPER_N_FFT / 2), bin_0 to bin_nyquist
+    assert(n_fft == 1 + (frame_size / 2));
 
-    float* even = in + N;
-    for (int i = 0; i < half_N; ++i) {
-        even[i]= in[2*i];
+    if (scratch.fft_in.empty()) {
+        scratch.fft_in.resize(frame_size);
+        scratch.fft_scratch.resize(frame_size * 2);
+        scratch.power.resize(n_fft);
     }
-    float* even_fft = out + 2 * N;
-    fft(even, half_N, even_fft);
 
-    float* odd = even;
-    for (int i = 0; i < half_N; ++i) {
-        odd[i] = in[2*i + 1];
+    const int64_t s0 = i*WHISPER_HOP_LENGTH - frame_size/2;
+    if (s0 >= ms.pcm_begin && s0 + frame_size <= ms.n_samples) {
+        const float * x = ms.pcm.data() + (s0 - ms.pcm_begin);
+        for (int j = 0; j < frame_size; j++) {
+            scratch.fft_in[j] = hann[j] * x[j];
+        }
+    } else {
+        for (int j = 0; j < frame_size; j++) {
+            scratch.fft_in[j] = hann[j] * mel_stream_sample(ms, s0 + j);
+        }
     }
-    float* odd_fft = even_fft + N;
-    fft(odd, half_N, odd_fft);
-
-    const int sin_cos_step = SIN_COS_N_COUNT / N;
-    for (int k = 0; k < half_N; k++) {
-        int idx = k * sin_cos_step; // t = 2*M_PI*k/N
-        float re = global_cache.cos_vals[idx]; // cos(t)
-        float im = -global_cache.sin_vals[idx]; // sin(t)
-
-        float re_odd = odd_fft[2*k + 0];
-        float im_odd = odd_fft[2*k + 1];
 
-        out[2*k + 0] = even_fft[2*k + 0] + re*re_odd - im*im_odd;
-        out[2*k + 1] = even_fft[2*k + 1] + re*im_odd + im*re_odd;
+    // FFT, modulus^2 of bin_0 to bin_nyquist
+    fft_power(global_cache.fft_plan, scratch.fft_in.data(), reinterpret_cast<whisper_cpx *>(scratch.fft_scratch.data()), scratch.power.data());
 
-        out[2*(k + half_N) + 0] = even_fft[2*k + 0] - re*re_odd + im*im_odd;
-        out[2*(k + half_N) + 1] = even_fft[2*k + 1] - re*im_odd - im*re_odd;
+    // mel spectrogram, over the nonzero bins of each band only
+    for (int j = 0; j < filters.n_mel; j++) {
+        const int begin = filters.band_begin[j];
+        const int end   = filters.band_end[j];
+        const double sum = mel_band_dot(scratch.power.data() + begin, filters.data.data() + j * n_fft + begin, end - begin);
+        out[j] = log10(std::max(sum, 1e-10));
     }
 }
 
-static void log_mel_spectrogram_worker_thread(int ith, const float * hann, const std::vector<float> & samples,
-                                              int n_samples, int frame_size, int frame_step, int n_threads,
-                                              const whisper_filters & filters, whisper_mel & mel) {
-    std::vector<float> fft_in(frame_size * 2, 0.0);
-    std::vector<float> fft_out(frame_size * 2 * 2 * 2);
+static void mel_stream_append(whisper_mel_stream & ms, const float * samples, int n_samples, const whisper_filters & filters) {
+    const int n_mel = filters.n_mel;
+    const int half  = WHISPER_N_FFT/2;
 
-    int n_fft = filters.n_fft;
-    int i = ith;
+    // feed in blocks so only a frame's worth of history is ever buffered
+    const int block = WHISPER_SAMPLE_RATE;
+    for (int offset = 0; offset < n_samples; offset += block) {
+        const int n = std::min(block, n_samples - offset);
+        const float * x = samples + offset;
 
-    // make sure n_fft == 1 + (WHISPER_N_FFT / 2), bin_0 to bin_nyquist
-    assert(n_fft == 1 + (frame_size / 2));
+        for (int k = 0; k < n && ms.head.size() <= (size_t) half; k++) {
+            ms.head.push_back(x[k]);
+        }
 
-    // calculate FFT only when fft_in are not all zero
-    for (; i < std::min(n_samples / frame_step + 1, mel.n_len); i += n_threads) {
-        const int offset = i * frame_step;
+        ms.pcm.insert(ms.pcm.end(), x, x + n);
+        ms.n_samples += n;
 
-        // apply Hann window (~10% faster)
-        for (int j = 0; j < std::min(frame_size, n_samples - offset); j++) {
-            fft_in[j] = hann[j] * samples[offset + j];
+        // frames whose window now lies entirely within the appended audio
+        while (ms.n_final*WHISPER_HOP_LENGTH + half < ms.n_samples) {
+            ms.frames.resize(ms.frames.size() + n_mel);
+            mel_stream_frame(ms, ms.scratch, ms.n_final, filters, ms.frames.data() + ms.frames.size() - n_mel);
+            ms.n_final++;
         }
 
-        // fill the rest with zeros
-        if (n_samples - offset < frame_size) {
-            std::fill(fft_in.begin() + (n_samples - offset), fft_in.end(), 0.0);
+        // drop the samples no later frame needs
+        const int64_t keep_from = std::max<int64_t>(0, ms.n_final*WHISPER_HOP_LENGTH - half);
+        if (keep_from > ms.pcm_begin) {
+            ms.pcm.erase(ms.pcm.begin(), ms.pcm.begin() + (keep_from - ms.pcm_begin));
+            ms.pcm_begin = keep_from;
         }
+    }
+}
 
-        // FFT
-        fft(fft_in.data(), frame_size, fft_out.data());
+// Appends a whole recording to an empty stream, its frames computed by up to
+// n_threads threads. Each frame is computed exactly as mel_stream_append
+// would, so the result does not depend on the number of threads.
+#define WHISPER_MEL_MIN_FRAMES_PER_THREAD 500 // 5 s, well above the cost of a thread
 
-        // Calculate modulus^2 of complex numbers
-        // Use pow(fft_out[2 * j + 0], 2) + pow(fft_out[2 * j + 1], 2) causes inference quality problem? Interesting.
-        for (int j = 0; j < n_fft; j++) {
-            fft_out[j] = (fft_out[2 * j + 0] * fft_out[2 * j + 0] + fft_out[2 * j + 1] * fft_out[2 * j + 1]);
-        }
+static void mel_stream_append_all(whisper_mel_stream & ms, const float * samples, int n_samples, int n_threads, const whisper_filters & filters) {
+    const int n_mel = filters.n_mel;
+    const int half  = WHISPER_N_FFT/2;
 
-        // mel spectrogram
-        for (int j = 0; j < mel.n_mel; j++) {
-            double sum = 0.0;
-            // unroll loop (suggested by GH user @lunixbochs)
-            int k = 0;
-            for (k = 0; k < n_fft - 3; k += 4) {
-                sum +=
-                        fft_out[k + 0] * filters.data[j * n_fft + k + 0] +
-                        fft_out[k + 1] * filters.data[j * n_fft + k + 1] +
-                        fft_out[k + 2] * filters.data[j * n_fft + k + 2] +
-                        fft_out[k + 3] * filters.data[j * n_fft + k + 3];
-            }
-            // handle n_fft remainder
-            for (; k < n_fft; k++) {
-                sum += fft_out[k] * filters.data[j * n_fft + k];
-            }
-            sum = log10(std::max(sum, 1e-10));
-            mel.data[j * mel.n_len + i] = sum;
+    const int64_t n_final = n_samples > half ? (n_samples - half - 1)/WHISPER_HOP_LENGTH + 1 : 0;
+    n_threads = (int) std::min<int64_t>(n_threads, n_final/WHISPER_MEL_MIN_FRAMES_PER_THREAD);
+    if (n_threads <= 1 || ms.n_samples > 0) {
+        mel_stream_append(ms, samples, n_samples, filters);
+        return;
+    }
+
+    ms.head.assign(samples, samples + std::min(n_samples, half + 1));
+    ms.pcm.assign(samples, samples + n_samples);
+    ms.n_samples = n_samples;
+    ms.n_final   = n_final;
+    ms.frames.resize((size_t) n_final*n_mel);
+
+    auto worker = [&](int ith) {
+        whisper_mel_scratch scratch;
+        const int64_t i0 = n_final*ith/n_threads;
+        const int64_t i1 = n_final*(ith + 1)/n_threads;
+        for (int64_t i = i0; i < i1; i++) {
+            mel_stream_frame(ms, scratch, i, filters, ms.frames.data() + (size_t) i*n_mel);
         }
+    };
+
+    std::vector<std::thread> workers;
+    for (int ith = 1; ith < n_threads; ith++) {
+        workers.emplace_back(worker, ith);
     }
+    worker(0);
+    for (auto & w : workers) {
+        w.join();
+    }
+}
 
-    // Otherwise fft_out are all zero
-    double sum = log10(1e-10);
-    for (; i < mel.n_len; i += n_threads) {
-        for (int j = 0; j < mel.n_mel; j++) {
-            mel.data[j * mel.n_len + i] = sum;
+static void mel_stream_discard(whisper_mel_stream & ms, int64_t n_frames, const whisper_filters & filters) {
+    // never move past the appended audio
+    n_frames = std::min(n_frames, ms.n_samples/WHISPER_HOP_LENGTH - ms.frame_base);
+    if (n_frames <= 0) {
+        return;
+    }
+
+    const int64_t n_stored = std::min(n_frames, ms.n_final - ms.frame_base);
+    ms.frames.erase(ms.frames.begin(), ms.frames.begin() + n_stored*filters.n_mel);
+    ms.frame_base += n_frames;
+    ms.n_final = std::max(ms.n_final, ms.frame_base);
+}
+
+// Lays the retained frames out as a spectrogram of the audio starting at
+// frame_base, computing the few frames that still overlap the end of the audio.
+static void mel_stream_to_mel(whisper_mel_stream & ms, const whisper_filters & filters, whisper_mel & mel) {
+    const int n_mel = filters.n_mel;
+    const int64_t n = ms.n_samples - ms.frame_base*WHISPER_HOP_LENGTH;
+
+    // Calculate number of frames + remove the last frame
+    // https://github.com/pytorch/pytorch/blob/main/aten/src/ATen/native/SpectralOps.cpp#L936
+    mel.n_mel     = n_mel;
+    mel.n_len     = (n + WHISPER_SAMPLE_RATE*WHISPER_CHUNK_SIZE) / WHISPER_HOP_LENGTH;
+    // Calculate semi-padded sample length to ensure compatibility
+    mel.n_len_org = 1 + (n + WHISPER_N_FFT/2 - WHISPER_N_FFT) / WHISPER_HOP_LENGTH;
+
+    // frames that see any audio at all, the rest is the constant tail
+    const int64_t i_end = (ms.n_samples + WHISPER_N_FFT/2 + WHISPER_HOP_LENGTH - 1) / WHISPER_HOP_LENGTH;
+    const int n_data = (int) std::min<int64_t>(std::max<int64_t>(i_end, ms.n_final) - ms.frame_base, mel.n_len);
+
+    mel.n_len_data = n_data;
+    mel.tail_value = WHISPER_MEL_TAIL_VALUE;
+    mel.raw        = true;
+    mel.data.resize((size_t) n_mel * n_data);
+
+    float mmax = n_data < mel.n_len ? WHISPER_MEL_TAIL_VALUE : -1e20f;
+
+    ms.frame.resize(n_mel);
+    for (int r = 0; r < n_data; r++) {
+        const int64_t i = ms.frame_base + r;
+        const float * src = ms.frames.data() + (size_t) r * n_mel;
+        if (i >= ms.n_final) {
+            mel_stream_frame(ms, ms.scratch, i, filters, ms.frame.data());
+            src = ms.frame.data();
+        }
+        for (int j = 0; j < n_mel; j++) {
+            mel.data[(size_t) j*n_data + r] = src[j];
+            mmax = std::max(mmax, src[j]);
         }
     }
+
+    mel.mmax = mmax;
 }
 
-// ref: https://github.com/openai/whisper/blob/main/whisper/audio.py#L110-L157
 static bool log_mel_spectrogram(
               whisper_state & wstate,
               const float * samples,
               const int   n_samples,
               const int   /*sample_rate*/,
               const int   frame_size,
-              const int   frame_step,
-              const int   n_mel,
+              const int   /*frame_step*/,
+              const int   /*n_mel*/,
               const int   n_threads,
               const whisper_filters & filters,
               const bool   debug,
               whisper_mel & mel) {
     const int64_t t_start_us = ggml_time_us();
 
-    // Hann window
     WHISPER_ASSERT(frame_size == WHISPER_N_FFT && "Unsupported frame_size");
-    const float * hann = global_cache.hann_window;
-
-    // Calculate the length of padding
-    int64_t stage_1_pad = WHISPER_SAMPLE_RATE * 30;
-    int64_t stage_2_pad = frame_size / 2;
-
-    // Initialize a vector and copy data from C array to it.
-    std::vector<float> samples_padded;
-    samples_padded.resize(n_samples + stage_1_pad + stage_2_pad * 2);
-    std::copy(samples, samples + n_samples, samples_padded.begin() + stage_2_pad);
-
-    // pad 30 seconds of zeros at the end of audio (480,000 samples) + reflective pad 200 samples at the end of audio
-    std::fill(samples_padded.begin() + n_samples + stage_2_pad, samples_padded.begin() + n_samples + stage_1_pad + 2 * stage_2_pad, 0);
-
-    // reflective pad 200 samples at the beginning of audio
-    std::reverse_copy(samples + 1, samples + 1 + stage_2_pad, samples_padded.begin());
-
-    mel.n_mel     = n_mel;
-    // https://github.com/pytorch/pytorch/blob/main/aten/src/ATen/native/SpectralOps.cpp#L936
-    // Calculate number of frames + remove the last frame
-    mel.n_len     = (samples_padded.size() - frame_size) / frame_step;
-    // Calculate semi-padded sample length to ensure compatibility
-    mel.n_len_org = 1 + (n_samples + stage_2_pad - frame_size) / frame_step;
-    mel.data.resize(mel.n_mel * mel.n_len);
 
-    {
-        std::vector<std::thread> workers(n_threads - 1);
-        for (int iw = 0; iw < n_threads - 1; ++iw) {
-            workers[iw] = std::thread(
-                    log_mel_spectrogram_worker_thread, iw + 1, hann, std::cref(samples_padded),
-                    n_samples + stage_2_pad, frame_size, frame_step, n_threads,
-                    std::cref(filters), std::ref(mel));
-        }
-
-        // main thread
-        log_mel_spectrogram_worker_thread(0, hann, samples_padded, n_samples + stage_2_pad, frame_size, frame_step, n_threads, filters, mel);
-
-        for (int iw = 0; iw < n_threads - 1; ++iw) {
-            workers[iw].join();
-        }
-    }
-
-    // clamping and normalization
-    double mmax = -1e20;
-    for (int i = 0; i < mel.n_mel*mel.n_len; i++) {
-        if (mel.data[i] > mmax) {
-            mmax = mel.data[i];
-        }
-    }
-
-    mmax -= 8.0;
-
-    for (int i = 0; i < mel.n_mel*mel.n_len; i++) {
-        if (mel.data[i] < mmax) {
-            mel.data[i] = mmax;
-        }
-
-        mel.data[i] = (mel.data[i] + 4.0)/4.0;
-    }
+    // a one-shot pass of the incremental path; the state's own stream is left untouched
+    whisper_mel_stream ms;
+    mel_stream_append_all(ms, samples, n_samples, n_threads, filters);
+    mel_stream_to_mel(ms, filters, mel);
 
     wstate.t_mel_us += ggml_time_us() - t_start_us;
 
-    // Dump log_mel_spectrogram
+    // Dump log_mel_spectrogram, normalized as the encoder sees it
     if (debug) {
         std::ofstream outFile("log_mel_spectrogram.json");
         outFile << "[";
-        for (uint64_t i = 0; i < mel.data.size() - 1; i++) {
-            outFile << mel.data[i] << ", ";
+        for (int j = 0; j < mel.n_mel; j++) {
+            for (int i = 0; i < mel.n_len; i++) {
+                const float v = i < mel.n_len_data ? mel.data[(size_t) j*mel.n_len_data + i] : mel.tail_value;
+                outFile << (std::max(v, mel.mmax - 8.0f) + 4.0f)/4.0f;
+                if (j + 1 < mel.n_mel || i + 1 < mel.n_len) {
+                    outFile << ", ";
+                }
+            }
         }
-        outFile << mel.data[mel.data.size() - 1] << "]";
+        outFile << "]";
         outFile.close();
     }
 
     return true;
 }
 
-// split text into tokens
+static bool whisper_is_space(unsigned char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+static bool whisper_is_alpha(unsigned char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+static bool whisper_is_digit(unsigned char c) { return c >= '0' && c <= '9'; }
+static bool whisper_is_other(unsigned char c) { return !whisper_is_space(c) && !whisper_is_alpha(c) && !whisper_is_digit(c); }
+
+// split text into words, as [begin, end) byte offsets
 //
 // ref: https://github.com/openai/gpt-2/blob/a74da5d99abaaba920de8131d64da2862a8f213b/src/encoder.py#L53
 //
 // Regex (Python):
 // r"""'s|'t|'re|'ve|'m|'ll|'d| ?\p{L}+| ?\p{N}+| ?[^\s\p{L}\p{N}]+|\s+(?!\S)|\s+"""
 //
-// Regex (C++):
+// A single scan matching what the C++ regex
 // R"('s|'t|'re|'ve|'m|'ll|'d| ?[[:alpha:]]+| ?[[:digit:]]+| ?[^\s[:alpha:][:digit:]]+|\s+(?!\S)|\s+)"
+// matches in the "C" locale: bytes outside ASCII are neither letters, digits
+// nor spaces, so multibyte characters go with the punctuation.
 //
-static std::vector<whisper_vocab::id> tokenize(const whisper_vocab & vocab, const std::string & text) {
-    std::vector<std::string> words;
-
-    // first split the text into words
-    {
-        std::string str = text;
-        std::string pat = R"('s|'t|'re|'ve|'m|'ll|'d| ?[[:alpha:]]+| ?[[:digit:]]+| ?[^\s[:alpha:][:digit:]]+|\s+(?!\S)|\s+)";
+static void whisper_pretokenize(const std::string & text, std::vector<std::pair<int, int>> & words) {
+    const int n = text.size();
+    const auto at = [&](int i) { return (unsigned char) text[i]; };
+
+    words.clear();
+
+    int i = 0;
+    while (i < n) {
+        const int begin = i;
+
+        // 's|'t|'re|'ve|'m|'ll|'d
+        if (at(i) == '\'' && i + 1 < n) {
+            const char c1 = text[i + 1];
+            const char c2 = i + 2 < n ? text[i + 2] : '\0';
+            if (c1 == 's' || c1 == 't' || c1 == 'm' || c1 == 'd') {
+                i += 2;
+            } else if ((c1 == 'r' && c2 == 'e') || (c1 == 'v' && c2 == 'e') || (c1 == 'l' && c2 == 'l')) {
+                i += 3;
+            }
+            if (i > begin) {
+                words.emplace_back(begin, i);
+                continue;
+            }
+        }
 
-        std::regex re(pat);
-        std::smatch m;
+        // ' ?' followed by a run of one class
+        const int j = at(i) == ' ' && i + 1 < n ? i + 1 : i;
+        bool (*is_class)(unsigned char) = nullptr;
+        if (whisper_is_alpha(at(j))) {
+            is_class = whisper_is_alpha;
+        } else if (whisper_is_digit(at(j))) {
+            is_class = whisper_is_digit;
+        } else if (whisper_is_other(at(j))) {
+            is_class = whisper_is_other;
+        }
+        if (is_class) {
+            for (i = j + 1; i < n && is_class(at(i)); ++i) {}
+            words.emplace_back(begin, i);
+            continue;
+        }
 
-        while (std::regex_search(str, m, re)) {
-            for (auto x : m) {
-                words.push_back(x);
-            }
-            str = m.suffix();
+        // \s+(?!\S)|\s+ : a run of spaces leaves its last one to the word after it
+        while (i < n && whisper_is_space(at(i))) {
+            ++i;
         }
+        if (i < n && i - begin > 1) {
+            --i;
+        }
+        words.emplace_back(begin, i);
     }
+}
+
+// find the longest tokens that form the words
+static std::vector<whisper_vocab::id> tokenize(const whisper_vocab & vocab, const std::string & text) {
+    std::vector<std::pair<int, int>> words;
+    whisper_pretokenize(text, words);
 
-    // find the longest tokens that form the words:
     std::vector<whisper_vocab::id> tokens;
     for (const auto & word : words) {
-        if (word.empty()) continue;
+        const char * str = text.data() + word.first;
+        const int    n   = word.second - word.first;
 
         int i = 0;
-        int n = word.size();
         while (i < n) {
-            int j = n;
+            int j = std::min(n, i + vocab.token_len_max);
             bool found = false;
             while (j > i) {
-                auto sub = word.substr(i, j-i);
-                auto it = vocab.token_to_id.find(sub);
-                if (it != vocab.token_to_id.end()) {
+                auto it = vocab.token_index.find(std::string_view(str + i, j - i));
+                if (it != vocab.token_index.end()) {
                     tokens.push_back(it->second);
                     i = j;
                     found = true;
@@ -3319,6 +4269,27 @@ static std::vector<whisper_vocab::id> tokenize(const whisper_vocab & vocab, cons
     return tokens;
 }
 
+// tokenize() through the context's cache of recent results. The same
+// initial prompt is tokenized again for every whisper_full call
+static std::vector<whisper_vocab::id> whisper_tokenize_cached(struct whisper_context * ctx, const char * text) {
+    std::lock_guard<std::mutex> lock(ctx->tokenize_cache_mutex);
+
+    auto & cache = ctx->tokenize_cache;
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+        if (it->first == text) {
+            cache.splice(cache.begin(), cache, it);
+            return it->second;
+        }
+    }
+
+    cache.emplace_front(text, tokenize(ctx->vocab, text));
+    if (cache.size() > WHISPER_TOKENIZE_CACHE_SIZE) {
+        cache.pop_back();
+    }
+
+    return cache.front().second;
+}
+
 //
 // interface implementation
 //
@@ -3617,12 +4588,52 @@ struct whisper_context_params whisper_context_default_params() {
             /*.heads            =*/ NULL,
         },
         /*.dtw_mem_size         =*/ 1024*1024*128,
+
+        /*.use_mmap             =*/ true,
+        /*.use_mlock            =*/ false,
+
+        /*.repack_cache_path    =*/ nullptr,
     };
     return result;
 }
 
+static struct whisper_context * whisper_init_with_params_no_state_impl(struct whisper_model_loader * loader, struct whisper_context_params params, std::unique_ptr<whisper_mmap> mapping, const char * path_model);
+
 struct whisper_context * whisper_init_from_file_with_params_no_state(const char * path_model, struct whisper_context_params params) {
     WHISPER_LOG_INFO("%s: loading model from '%s'\n", __func__, path_model);
+
+    if (params.use_mmap) {
+        auto mapping = whisper_mmap::open(path_model, params.use_mlock);
+        if (mapping) {
+            whisper_model_loader loader = {};
+
+            loader.context = mapping.get();
+
+            loader.read = [](void * ctx, void * output, size_t read_size) {
+                whisper_mmap * mapping = reinterpret_cast<whisper_mmap *>(ctx);
+
+                size_t size_to_copy = std::min(read_size, mapping->size - mapping->pos);
+
+                memcpy(output, mapping->addr + mapping->pos, size_to_copy);
+                mapping->pos += size_to_copy;
+
+                return size_to_copy;
+            };
+
+            loader.eof = [](void * ctx) {
+                whisper_mmap * mapping = reinterpret_cast<whisper_mmap *>(ctx);
+
+                return mapping->pos >= mapping->size;
+            };
+
+            loader.close = [](void * /*ctx*/) { };
+
+            return whisper_init_with_params_no_state_impl(&loader, params, std::move(mapping), path_model);
+        }
+
+        WHISPER_LOG_WARN("%s: failed to map '%s', reading it instead\n", __func__, path_model);
+    }
+
 #ifdef _MSC_VER
     // Convert UTF-8 path to wide string (UTF-16) for Windows, resolving character encoding issues.
     std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
@@ -3656,13 +4667,7 @@ struct whisper_context * whisper_init_from_file_with_params_no_state(const char
         fin->close();
     };
 
-    auto ctx = whisper_init_with_params_no_state(&loader, params);
-
-    if (ctx) {
-        ctx->path_model = path_model;
-    }
-
-    return ctx;
+    return whisper_init_with_params_no_state_impl(&loader, params, nullptr, path_model);
 }
 
 struct whisper_context * whisper_init_from_buffer_with_params_no_state(void * buffer, size_t buffer_size, struct whisper_context_params params) {
@@ -3703,6 +4708,10 @@ struct whisper_context * whisper_init_from_buffer_with_params_no_state(void * bu
 }
 
 struct whisper_context * whisper_init_with_params_no_state(struct whisper_model_loader * loader, struct whisper_context_params params) {
+    return whisper_init_with_params_no_state_impl(loader, params, nullptr, nullptr);
+}
+
+static struct whisper_context * whisper_init_with_params_no_state_impl(struct whisper_model_loader * loader, struct whisper_context_params params, std::unique_ptr<whisper_mmap> mapping, const char * path_model) {
     ggml_time_init();
 
     if (params.flash_attn && params.dtw_token_timestamps) {
@@ -3714,11 +4723,16 @@ struct whisper_context * whisper_init_with_params_no_state(struct whisper_model_
     WHISPER_LOG_INFO("%s: flash attn = %d\n", __func__, params.flash_attn);
     WHISPER_LOG_INFO("%s: gpu_device = %d\n", __func__, params.gpu_device);
     WHISPER_LOG_INFO("%s: dtw        = %d\n", __func__, params.dtw_token_timestamps);
+    WHISPER_LOG_INFO("%s: mmap       = %d\n", __func__, mapping != nullptr);
     WHISPER_LOG_INFO("%s: devices    = %zu\n", __func__, ggml_backend_dev_count());
     WHISPER_LOG_INFO("%s: backends   = %zu\n", __func__, ggml_backend_reg_count());
 
     whisper_context * ctx = new whisper_context;
     ctx->params = params;
+    ctx->mapping = std::move(mapping);
+    if (path_model) {
+        ctx->path_model = path_model;
+    }
 
     if (!whisper_model_load(loader, *ctx)) {
         loader->close(loader->context);
@@ -3801,6 +4815,10 @@ struct whisper_context * whisper_init_no_state(struct whisper_model_loader * loa
     return whisper_init_with_params_no_state(loader, whisper_context_default_params());
 }
 
+void whisper_set_threadpool_with_state(struct whisper_state * state, struct ggml_threadpool * threadpool) {
+    state->threadpool = threadpool;
+}
+
 void whisper_free_state(struct whisper_state * state) {
     if (state) {
         whisper_kv_cache_free(state->kv_self);
@@ -3860,6 +4878,52 @@ void whisper_free(struct whisper_context * ctx) {
     }
 }
 
+struct whisper_load_stats whisper_get_load_stats(struct whisper_context * ctx) {
+    struct whisper_load_stats stats = {
+        /*.t_load_us      =*/ ctx->t_load_us,
+        /*.n_bytes_mapped =*/ ctx->n_bytes_mapped,
+        /*.n_bytes_copied =*/ ctx->n_bytes_copied,
+        /*.n_bytes_repacked      =*/ ctx->n_bytes_repacked,
+        /*.n_bytes_repack_cached =*/ ctx->n_bytes_repack_cached,
+        /*.page_cache_hit =*/ ctx->mapping ? ctx->mapping->page_cache_hit : -1.0f,
+        /*.use_mmap       =*/ ctx->mapping != nullptr,
+        /*.use_mlock      =*/ ctx->mapping && ctx->mapping->locked,
+    };
+    return stats;
+}
+
+size_t whisper_get_model_memory(struct whisper_context * ctx) {
+    size_t size = 0;
+    for (ggml_backend_buffer_t buf : ctx->model.buffers) {
+        // the mapping spans the whole file, including what was copied out of it
+        if (ctx->mapping && buf == ctx->mapping->buffer) {
+            size += ctx->n_bytes_mapped;
+        } else {
+            size += ggml_backend_buffer_get_size(buf);
+        }
+    }
+    return size;
+}
+
+size_t whisper_prefault_model(struct whisper_context * ctx) {
+    return ctx->mapping ? ctx->mapping->prefault() : 0;
+}
+
+size_t whisper_get_state_memory(struct whisper_state * state) {
+    size_t size = 0;
+    for (const whisper_kv_cache * kv : { &state->kv_self, &state->kv_cross, &state->kv_pad }) {
+        if (kv->buffer) {
+            size += ggml_backend_buffer_get_size(kv->buffer);
+        }
+    }
+    for (whisper_sched * sched : { &state->sched_conv, &state->sched_encode, &state->sched_cross, &state->sched_decode }) {
+        if (sched->sched) {
+            size += whisper_sched_size(*sched);
+        }
+    }
+    return size;
+}
+
 void whisper_free_context_params(struct whisper_context_params * params) {
     if (params) {
         delete params;
@@ -3873,6 +4937,8 @@ void whisper_free_params(struct whisper_full_params * params) {
 }
 
 int whisper_pcm_to_mel_with_state(struct whisper_context * ctx, struct whisper_state * state, const float * samples, int n_samples, int n_threads) {
+    state->enc_valid = false;
+
     if (!log_mel_spectrogram(*state, samples, n_samples, WHISPER_SAMPLE_RATE, WHISPER_N_FFT, WHISPER_HOP_LENGTH, ctx->model.filters.n_mel, n_threads, ctx->model.filters, false, state->mel)) {
         WHISPER_LOG_ERROR("%s: failed to compute mel spectrogram\n", __func__);
         return -1;
@@ -3885,6 +4951,58 @@ int whisper_pcm_to_mel(struct whisper_context * ctx, const float * samples, int
     return whisper_pcm_to_mel_with_state(ctx, ctx->state, samples, n_samples, n_threads);
 }
 
+void whisper_mel_stream_reset_with_state(struct whisper_context * /*ctx*/, struct whisper_state * state) {
+    mel_stream_reset(state->mel_stream);
+}
+
+void whisper_mel_stream_reset(struct whisper_context * ctx) {
+    whisper_mel_stream_reset_with_state(ctx, ctx->state);
+}
+
+int whisper_mel_stream_append_with_state(struct whisper_context * ctx, struct whisper_state * state, const float * samples, int n_samples) {
+    if (n_samples < 0 || (n_samples > 0 && samples == nullptr)) {
+        WHISPER_LOG_ERROR("%s: invalid samples\n", __func__);
+        return -1;
+    }
+
+    const int64_t t_start_us = ggml_time_us();
+    mel_stream_append(state->mel_stream, samples, n_samples, ctx->model.filters);
+    state->t_mel_us += ggml_time_us() - t_start_us;
+
+    return 0;
+}
+
+int whisper_mel_stream_append(struct whisper_context * ctx, const float * samples, int n_samples) {
+    return whisper_mel_stream_append_with_state(ctx, ctx->state, samples, n_samples);
+}
+
+int whisper_mel_stream_discard_with_state(struct whisper_context * ctx, struct whisper_state * state, int n_frames) {
+    if (n_frames < 0) {
+        WHISPER_LOG_ERROR("%s: invalid number of frames: %d\n", __func__, n_frames);
+        return -1;
+    }
+
+    mel_stream_discard(state->mel_stream, n_frames, ctx->model.filters);
+    return 0;
+}
+
+int whisper_mel_stream_discard(struct whisper_context * ctx, int n_frames) {
+    return whisper_mel_stream_discard_with_state(ctx, ctx->state, n_frames);
+}
+
+int whisper_mel_stream_apply_with_state(struct whisper_context * ctx, struct whisper_state * state) {
+    const int64_t t_start_us = ggml_time_us();
+    state->enc_valid = false;
+    mel_stream_to_mel(state->mel_stream, ctx->model.filters, state->mel);
+    state->t_mel_us += ggml_time_us() - t_start_us;
+
+    return 0;
+}
+
+int whisper_mel_stream_apply(struct whisper_context * ctx) {
+    return whisper_mel_stream_apply_with_state(ctx, ctx->state);
+}
+
 int whisper_set_mel_with_state(
         struct whisper_context * ctx,
           struct whisper_state * state,
@@ -3896,9 +5014,13 @@ int whisper_set_mel_with_state(
         return -1;
     }
 
-    state->mel.n_len     = n_len;
-    state->mel.n_len_org = n_len;
-    state->mel.n_mel     = n_mel;
+    state->enc_valid = false;
+
+    state->mel.n_len      = n_len;
+    state->mel.n_len_org  = n_len;
+    state->mel.n_mel      = n_mel;
+    state->mel.n_len_data = n_len;
+    state->mel.raw        = false;
 
     state->mel.data.resize(n_len*n_mel);
     memcpy(state->mel.data.data(), data, n_len*n_mel*sizeof(float));
@@ -3955,7 +5077,7 @@ int whisper_decode(struct whisper_context * ctx, const whisper_token * tokens, i
 }
 
 int whisper_tokenize(struct whisper_context * ctx, const char * text, whisper_token * tokens, int n_max_tokens) {
-    const auto res = tokenize(ctx->vocab, text);
+    const auto res = whisper_tokenize_cached(ctx, text);
 
     if (n_max_tokens < (int) res.size()) {
         WHISPER_LOG_ERROR("%s: too many resulting tokens: %d (max %d)\n", __func__, (int) res.size(), n_max_tokens);
@@ -3970,7 +5092,7 @@ int whisper_tokenize(struct whisper_context * ctx, const char * text, whisper_to
 }
 
 int whisper_token_count(struct whisper_context * ctx, const char * text) {
-    return -whisper_tokenize(ctx, text, NULL, 0);
+    return whisper_tokenize_cached(ctx, text).size();
 }
 
 int whisper_lang_max_id(void) {
@@ -4255,6 +5377,15 @@ struct whisper_timings * whisper_get_timings(struct whisper_context * ctx) {
     return timings;
 }
 
+struct whisper_speculative_stats whisper_get_speculative_stats(struct whisper_state * state) {
+    return {
+        /*.n_verify   =*/ state->n_spec_verify,
+        /*.n_drafted  =*/ state->n_spec_drafted,
+        /*.n_accepted =*/ state->n_spec_accepted,
+        /*.t_draft_us =*/ state->t_spec_draft_us,
+    };
+}
+
 void whisper_print_timings(struct whisper_context * ctx) {
     const int64_t t_end_us = ggml_time_us();
 
@@ -4424,6 +5555,12 @@ struct whisper_vad_context {
     struct ggml_tensor * h_state;
     struct ggml_tensor * c_state;
     std::vector<float>   probs;
+
+    // Streaming: the graph stays allocated in sched between calls to
+    // whisper_vad_stream_process, until whisper_vad_detect_speech reuses sched
+    ggml_cgraph        * stream_graph = nullptr;
+    struct ggml_tensor * stream_frame = nullptr;
+    struct ggml_tensor * stream_prob  = nullptr;
 };
 
 struct whisper_vad_context_params whisper_vad_default_context_params(void) {
@@ -5095,6 +6232,9 @@ bool whisper_vad_detect_speech(
     WHISPER_LOG_INFO("%s: detecting speech in %d samples\n", __func__, n_samples);
     WHISPER_LOG_INFO("%s: n_chunks: %d\n", __func__, n_chunks);
 
+    // The batch graph below overwrites the streaming one
+    vctx->stream_graph = nullptr;
+
     // Reset LSTM hidden/cell states
     ggml_backend_buffer_clear(vctx->buffer, 0);
 
@@ -5165,6 +6305,53 @@ bool whisper_vad_detect_speech(
     return true;
 }
 
+bool whisper_vad_stream_process(
+        struct whisper_vad_context * vctx,
+                       const float * samples,
+                               int   n_frames,
+                             float * probs) {
+    auto & sched = vctx->sched.sched;
+
+    if (!vctx->stream_graph) {
+        ggml_cgraph * gf = whisper_vad_build_graph(*vctx);
+        if (!ggml_backend_sched_alloc_graph(sched, gf)) {
+            WHISPER_LOG_ERROR("%s: failed to allocate the compute buffer\n", __func__);
+            ggml_backend_sched_reset(sched);
+            return false;
+        }
+        vctx->stream_graph = gf;
+        vctx->stream_frame = ggml_graph_get_tensor(gf, "frame");
+        vctx->stream_prob  = ggml_graph_get_tensor(gf, "prob");
+    }
+
+    const int64_t t_start_vad_us = ggml_time_us();
+
+    for (int i = 0; i < n_frames; i++) {
+        ggml_backend_tensor_set(vctx->stream_frame, samples + (size_t) i * vctx->n_window, 0, vctx->n_window * sizeof(float));
+
+        if (!ggml_graph_compute_helper(sched, vctx->stream_graph, vctx->n_threads, false)) {
+            WHISPER_LOG_ERROR("%s: failed to compute VAD graph\n", __func__);
+            vctx->stream_graph = nullptr;
+            return false;
+        }
+
+        ggml_backend_tensor_get(vctx->stream_prob, &probs[i], 0, sizeof(float));
+    }
+
+    vctx->t_vad_us += ggml_time_us() - t_start_vad_us;
+
+    return true;
+}
+
+void whisper_vad_stream_reset(struct whisper_vad_context * vctx) {
+    // Only the LSTM hidden/cell states live in this buffer
+    ggml_backend_buffer_clear(vctx->buffer, 0);
+}
+
+int whisper_vad_n_window(struct whisper_vad_context * vctx) {
+    return vctx->n_window;
+}
+
 int whisper_vad_segments_n_segments(struct whisper_vad_segments * segments) {
     return segments->data.size();
 }
@@ -5989,6 +7176,12 @@ struct whisper_full_params whisper_full_default_params(enum whisper_sampling_str
         /*.vad_model_path              =*/ nullptr,
 
         /* vad_params =*/ whisper_vad_default_params(),
+
+        /*.speculative =*/ {
+            /*.ctx     =*/ nullptr,
+            /*.state   =*/ nullptr,
+            /*.n_draft =*/ 4,
+        },
     };
 
     switch (strategy) {
@@ -6099,38 +7292,150 @@ static const std::vector<std::string> non_speech_tokens = {
     "♪♪♪","♩", "♪", "♫", "♬", "♭", "♮", "♯"
 };
 
+// log_softmax and softmax of the logits in one exp pass
 static void whisper_compute_logprobs(
                 const std::vector<float> & logits,
                               const int    n_logits,
-                      std::vector<float> & logprobs) {
-    const float logit_max = *std::max_element(logits.begin(), logits.end());
-    float logsumexp = 0.0f;
-    for (int i = 0; i < n_logits; ++i) {
-        if (logits[i] > -INFINITY) {
-            logsumexp += expf(logits[i] - logit_max);
-        }
+                      std::vector<float> & logprobs,
+                      std::vector<float> & probs) {
+    const float logit_max = whisper_vec_max(logits.data(), n_logits);
+    if (logit_max == -INFINITY) {
+        std::fill(logprobs.begin(), logprobs.begin() + n_logits, -INFINITY);
+        std::fill(probs.begin(),    probs.begin()    + n_logits, 0.0f);
+        return;
     }
-    logsumexp = logf(logsumexp) + logit_max;
 
+    // probs holds exp(logit - logit_max) until the sum is known
+    const float sum       = whisper_vec_exp_sum(logits.data(), n_logits, logit_max, probs.data());
+    const float logsumexp = logf(sum) + logit_max;
+    const float scale     = 1.0f/sum;
+
+    // -INFINITY logits stay -INFINITY logprobs, their probs are already 0
     for (int i = 0; i < n_logits; ++i) {
-        if (logits[i] > -INFINITY) {
-            logprobs[i] = logits[i] - logsumexp;
-        } else {
-            logprobs[i] = -INFINITY;
+        logprobs[i] = logits[i] - logsumexp;
+        probs[i]   *= scale;
+    }
+}
+
+static void whisper_suppress_token(std::vector<uint32_t> & mask, whisper_token id) {
+    mask[id/32] |= 1u << (id%32);
+}
+
+static void whisper_suppress_apply(const std::vector<uint32_t> & mask, std::vector<float> & logits) {
+    for (size_t k = 0; k < mask.size(); ++k) {
+        // the masks are sparse apart from the timestamp range
+        for (uint32_t bits = mask[k], i = 32*k; bits != 0; bits >>= 1, ++i) {
+            if (bits & 1) {
+                logits[i] = -INFINITY;
+            }
         }
     }
 }
 
-static void whisper_compute_probs(
-    const std::vector<float> & logits,
-                  const int    n_logits,
-    const std::vector<float> & logprobs,
-          std::vector<float> & probs)     {
-    for (int i = 0; i < n_logits; ++i) {
-        if (logits[i] == -INFINITY) {
-            probs[i] = 0.0f;
+// Compiles the suppression rules that do not depend on the decoded tokens
+// into state.suppress_mask and state.suppress_mask_post
+static void whisper_suppress_init(
+              whisper_context & ctx,
+                whisper_state & state,
+    const whisper_full_params & params) {
+    const auto & vocab = ctx.vocab;
+
+    const int n_words = (vocab.n_vocab + 31)/32;
+
+    auto & mask = state.suppress_mask;
+    auto & post = state.suppress_mask_post;
+
+    mask.assign(n_words, 0);
+    post.clear();
+
+    // suppress <|notimestamps|> token
+    // ref: https://github.com/openai/whisper/blob/0b1ba3d46ebf7fe6f953acfd8cad62a4f851b49f/whisper/decoding.py#L410-L412
+    whisper_suppress_token(mask, vocab.token_not);
+    if (params.no_timestamps) {
+        for (int i = vocab.token_beg; i < vocab.n_vocab; ++i) {
+            whisper_suppress_token(mask, i);
+        }
+    }
+
+    // suppress sot and nosp tokens
+    whisper_suppress_token(mask, vocab.token_sot);
+    whisper_suppress_token(mask, vocab.token_nosp);
+
+    // [TDRZ] when tinydiarize is disabled, suppress solm token
+    if (params.tdrz_enable == false) {
+        whisper_suppress_token(mask, vocab.token_solm);
+    }
+
+    // suppress task tokens
+    whisper_suppress_token(mask, vocab.token_translate);
+    whisper_suppress_token(mask, vocab.token_transcribe);
+    whisper_suppress_token(mask, vocab.token_prev);
+
+    // suppress lang tokens
+    for (size_t i = 0; i < g_lang.size(); ++i) {
+        whisper_suppress_token(mask, whisper_token_lang(&ctx, i));
+    }
+
+    // the rest is applied after the logits filter callback
+    if (params.logits_filter_callback) {
+        post.assign(n_words, 0);
+    }
+    auto & after = params.logits_filter_callback ? post : mask;
+
+    // suppress any tokens matching a regular expression
+    // ref: https://github.com/openai/whisper/discussions/1041
+    if (params.suppress_regex != nullptr) {
+        std::lock_guard<std::mutex> lock(ctx.suppress_regex_mutex);
+
+        auto & cache = ctx.suppress_regex_ids;
+        auto it = cache.begin();
+        while (it != cache.end() && it->first != params.suppress_regex) {
+            ++it;
+        }
+        if (it != cache.end()) {
+            cache.splice(cache.begin(), cache, it);
         } else {
-            probs[i] = expf(logprobs[i]);
+            std::vector<whisper_token> ids;
+            try {
+                std::regex re(params.suppress_regex);
+                for (const auto & token_id : vocab.token_to_id) {
+                    if (std::regex_match(token_id.first, re)) {
+                        ids.push_back(token_id.second);
+                    }
+                }
+            } catch (const std::regex_error & e) {
+                WHISPER_LOG_ERROR("%s: invalid suppress_regex '%s': %s\n", __func__, params.suppress_regex, e.what());
+            }
+            cache.emplace_front(params.suppress_regex, std::move(ids));
+            if (cache.size() > WHISPER_SUPPRESS_REGEX_CACHE_SIZE) {
+                cache.pop_back();
+            }
+        }
+
+        for (const whisper_token id : cache.front().second) {
+            whisper_suppress_token(after, id);
+        }
+    }
+
+    // suppress non-speech tokens
+    // ref: https://github.com/openai/whisper/blob/7858aa9c08d98f75575035ecd6481f462d66ca27/whisper/tokenizer.py#L224-L253
+    if (params.suppress_nst) {
+        for (const std::string & token : non_speech_tokens) {
+            const std::string suppress_tokens[] = {token, " " + token};
+            for (const std::string & suppress_token : suppress_tokens) {
+                const auto it = vocab.token_to_id.find(suppress_token);
+                if (it != vocab.token_to_id.end()) {
+                    whisper_suppress_token(after, it->second);
+                }
+            }
+        }
+
+        // allow hyphens "-" and single quotes "'" between words, but not at the beginning of a word
+        for (const char * suppress_token : { " -", " '" }) {
+            const auto it = vocab.token_to_id.find(suppress_token);
+            if (it != vocab.token_to_id.end()) {
+                whisper_suppress_token(after, it->second);
+            }
         }
     }
 }
@@ -6138,7 +7443,6 @@ static void whisper_compute_probs(
 // process the logits for the selected decoder
 // - applies logit filters
 // - computes logprobs and probs
-// TODO: optimize
 static void whisper_process_logits(
               struct whisper_context & ctx,
                struct whisper_state  & state,
@@ -6160,12 +7464,14 @@ static void whisper_process_logits(
     auto & logprobs = decoder.logprobs;
     {
         logits.resize(n_logits);
-        memcpy(logits.data(), state.logits.data() + decoder.i_batch*n_logits, n_logits*sizeof(float));
 
+        const float * logits_cur = state.logits.data() + decoder.i_batch*n_logits;
         if (temperature > 0.0f) {
             for (int i = 0; i < n_logits; i++) {
-                logits[i] /= temperature;
+                logits[i] = logits_cur[i]/temperature;
             }
+        } else {
+            memcpy(logits.data(), logits_cur, n_logits*sizeof(float));
         }
 
         // will be populated a bit later
@@ -6185,71 +7491,14 @@ static void whisper_process_logits(
             }
         }
 
-        // suppress <|notimestamps|> token
-        // ref: https://github.com/openai/whisper/blob/0b1ba3d46ebf7fe6f953acfd8cad62a4f851b49f/whisper/decoding.py#L410-L412
-        logits[vocab.token_not] = -INFINITY;
-        if (params.no_timestamps) {
-            for (int i = vocab.token_beg; i < n_logits; ++i) {
-                logits[i] = -INFINITY;
-            }
-        }
-
-        // suppress sot and nosp tokens
-        logits[vocab.token_sot]  = -INFINITY;
-        logits[vocab.token_nosp] = -INFINITY;
-
-        // [TDRZ] when tinydiarize is disabled, suppress solm token
-        if (params.tdrz_enable == false) {
-            logits[vocab.token_solm] = -INFINITY;
-        }
-
-        // suppress task tokens
-        logits[vocab.token_translate]  = -INFINITY;
-        logits[vocab.token_transcribe] = -INFINITY;
-        logits[vocab.token_prev]       = -INFINITY;
-
-        // suppress lang tokens
-        for (size_t i = 0; i < g_lang.size(); ++i) {
-            logits[whisper_token_lang(&ctx, i)] = -INFINITY;
-        }
-
-        // suppress prev token
-        logits[vocab.token_prev] = -INFINITY;
+        // special, task and lang tokens, and the suppress_regex and non-speech
+        // tokens unless they have to follow the filter callback
+        whisper_suppress_apply(state.suppress_mask, logits);
 
         if (params.logits_filter_callback) {
             params.logits_filter_callback(&ctx, &state, tokens_cur.data(), tokens_cur.size(), logits.data(), params.logits_filter_callback_user_data);
-        }
-
-        // suppress any tokens matching a regular expression
-        // ref: https://github.com/openai/whisper/discussions/1041
-        if (params.suppress_regex != nullptr) {
-            std::regex re(params.suppress_regex);
-            for (std::pair<whisper_vocab::token, whisper_vocab::id> token_id : vocab.token_to_id) {
-                if (std::regex_match(token_id.first, re)) {
-                    logits[token_id.second] = -INFINITY;
-                }
-            }
-        }
-
-        // suppress non-speech tokens
-        // ref: https://github.com/openai/whisper/blob/7858aa9c08d98f75575035ecd6481f462d66ca27/whisper/tokenizer.py#L224-L253
-        if (params.suppress_nst) {
-            for (const std::string & token : non_speech_tokens) {
-                const std::string suppress_tokens[] = {token, " " + token};
-                for (const std::string & suppress_token : suppress_tokens) {
-                    if (vocab.token_to_id.find(suppress_token) != vocab.token_to_id.end()) {
-                        logits[vocab.token_to_id.at(suppress_token)] = -INFINITY;
-                    }
-                }
-            }
 
-            // allow hyphens "-" and single quotes "'" between words, but not at the beginning of a word
-            if (vocab.token_to_id.find(" -") != vocab.token_to_id.end()) {
-                logits[vocab.token_to_id.at(" -")] = -INFINITY;
-            }
-            if (vocab.token_to_id.find(" '") != vocab.token_to_id.end()) {
-                logits[vocab.token_to_id.at(" '")] = -INFINITY;
-            }
+            whisper_suppress_apply(state.suppress_mask_post, logits);
         }
 
         // timestamps have to appear in pairs, except directly before EOT; mask logits accordingly
@@ -6262,13 +7511,9 @@ static void whisper_process_logits(
 
             if (last_was_timestamp) {
                 if (penultimate_was_timestamp) {
-                    for (int i = vocab.token_beg; i < n_logits; ++i) {
-                        logits[i] = -INFINITY;
-                    }
+                    std::fill(logits.begin() + vocab.token_beg, logits.end(), -INFINITY);
                 } else {
-                    for (int i = 0; i < vocab.token_eot; ++i) {
-                        logits[i] = -INFINITY;
-                    }
+                    std::fill(logits.begin(), logits.begin() + vocab.token_eot, -INFINITY);
                 }
             }
         }
@@ -6294,67 +7539,43 @@ static void whisper_process_logits(
             }
         }
 
-        // populate the logprobs array (log_softmax)
-        whisper_compute_logprobs(logits, n_logits, logprobs);
+        // populate the logprobs and probs arrays (log_softmax)
+        whisper_compute_logprobs(logits, n_logits, logprobs, probs);
 
         // if sum of probability over timestamps is above any other token, sample timestamp
         // ref: https://github.com/openai/whisper/blob/0b1ba3d46ebf7fe6f953acfd8cad62a4f851b49f/whisper/decoding.py#L431-L437
         {
-            // logsumexp over timestamps
+            // logsumexp over timestamps, the probs are the exp of the logprobs
             float timestamp_logprob = -INFINITY;
             {
-                float logsumexp = 0.0f;
-                const float logprob_max = *std::max_element(logprobs.begin() + vocab.token_beg, logprobs.end());
+                float sum = 0.0f;
                 for (int i = vocab.token_beg; i < n_logits; ++i) {
-                    if (logprobs[i] > -INFINITY) {
-                        logsumexp += expf(logprobs[i] - logprob_max);
-                    }
+                    sum += probs[i];
                 }
-                if (logsumexp > 0.0f) {
-                    timestamp_logprob = logf(logsumexp) + logprob_max;
+                if (sum > 0.0f) {
+                    timestamp_logprob = logf(sum);
                 }
             }
 
-            const float max_text_token_logprob = *std::max_element(logprobs.begin(), logprobs.begin() + vocab.token_beg);
+            const float max_text_token_logprob = whisper_vec_max(logprobs.data(), vocab.token_beg);
 
             //WHISPER_LOG_INFO("timestamp_logprob=%f max_text_token_logprob=%f\n", timestamp_logprob, max_text_token_logprob);
 
             if (timestamp_logprob > max_text_token_logprob) {
-                for (int i = 0; i < vocab.token_beg; ++i) {
-                    logits[i]   = -INFINITY;
-                    logprobs[i] = -INFINITY;
-                }
+                std::fill(logits.begin(),   logits.begin()   + vocab.token_beg, -INFINITY);
+                std::fill(logprobs.begin(), logprobs.begin() + vocab.token_beg, -INFINITY);
+                std::fill(probs.begin(),    probs.begin()    + vocab.token_beg, 0.0f);
             } else {
                 if (params.n_grammar_rules > 0) {
                     whisper_suppress_invalid_grammar(ctx, params, logits, decoder.grammar);
 
-                    // populate the logprobs array (log_softmax)
-                    {
-                        const float logit_max = *std::max_element(logits.begin(), logits.end());
-                        float logsumexp = 0.0f;
-                        for (int i = 0; i < n_logits; ++i) {
-                            if (logits[i] > -INFINITY) {
-                                logsumexp += expf(logits[i] - logit_max);
-                            }
-                        }
-                        logsumexp = logf(logsumexp) + logit_max;
-
-                        for (int i = 0; i < n_logits; ++i) {
-                            if (logits[i] > -INFINITY) {
-                                logprobs[i] = logits[i] - logsumexp;
-                            } else {
-                                logprobs[i] = -INFINITY;
-                            }
-                        }
-                    }
+                    // populate the logprobs and probs arrays (log_softmax)
+                    whisper_compute_logprobs(logits, n_logits, logprobs, probs);
                 }
             }
         }
     }
 
-    // compute probs
-    whisper_compute_probs(logits, n_logits, logprobs, probs);
-
 #if 0
     // print first 100 logits - token string : logit
     //for (int i = 0; i < 10; i++) {
@@ -6458,12 +7679,11 @@ static whisper_token_data whisper_sample_token(
     }
 
     if (best) {
-        for (int i = 0; i < n_logits; ++i) {
-            if (result.p < probs[i]) {
-                result.id   = i;
-                result.p    = probs[i];
-                result.plog = logprobs[i];
-            }
+        const int id = whisper_vec_argmax(probs.data(), n_logits);
+        if (result.p < probs[id]) {
+            result.id   = id;
+            result.p    = probs[id];
+            result.plog = logprobs[id];
         }
     } else {
         std::discrete_distribution<> dist(probs.begin(), probs.end());
@@ -6789,6 +8009,247 @@ static bool whisper_vad(
     return true;
 }
 
+// Speculative decoding for one whisper_full_with_state() call. The draft model
+// keeps a KV cache of the prompt and the tokens accepted so far and greedily
+// proposes the next ones; the model scores all of them in one batch and the
+// sampling loop then takes the logits of that batch row by row for as long as
+// it samples the proposed tokens. The tokens are the ones the model picks
+// without a draft, unless the batched and the single-token decode round a
+// near-tie differently (tests/test_speculative compares the two).
+struct whisper_speculative {
+    whisper_context * dctx   = nullptr;
+    whisper_state   * dstate = nullptr;
+
+    // the draft state borrows the pool of the state for this call only
+    ggml_threadpool_t dstate_threadpool = nullptr;
+
+    ~whisper_speculative() {
+        if (dstate) {
+            dstate->threadpool = dstate_threadpool;
+        }
+    }
+
+    int n_draft = 0;
+
+    int  seek    = -1;    // window the draft encoder last ran for
+    bool encoded = false;
+
+    std::vector<whisper_token> prompt; // draft tokens of the current prompt
+    std::vector<whisper_token> cached; // draft tokens in the draft KV cache
+    std::vector<whisper_token> want;   // draft tokens the KV cache has to hold for the next proposal
+
+    std::vector<whisper_token> proposed; // tokens in the last verification batch after the sampled one
+    int n_used = 0;                      // proposed tokens the sampling loop has consumed
+};
+
+// Maps a token of src to the same token of dst, -1 if dst has none. Both
+// vocabularies have the same text tokens; the special ones can be shifted
+// (large-v3 adds a language, which moves everything after the languages).
+static whisper_token whisper_token_translate(const whisper_vocab & src, const whisper_vocab & dst, whisper_token id) {
+    if (id < src.token_eot) {
+        return id;
+    }
+    if (id >= src.token_beg) {
+        const whisper_token res = dst.token_beg + (id - src.token_beg);
+        return res < dst.n_vocab ? res : -1;
+    }
+    if (id > src.token_sot && id < src.token_translate) {
+        const int lang_id = id - src.token_sot - 1;
+        return lang_id < dst.num_languages() ? dst.token_sot + 1 + lang_id : -1;
+    }
+
+    if (id == src.token_eot)        return dst.token_eot;
+    if (id == src.token_sot)        return dst.token_sot;
+    if (id == src.token_translate)  return dst.token_translate;
+    if (id == src.token_transcribe) return dst.token_transcribe;
+    if (id == src.token_solm)       return dst.token_solm;
+    if (id == src.token_prev)       return dst.token_prev;
+    if (id == src.token_nosp)       return dst.token_nosp;
+    if (id == src.token_not)        return dst.token_not;
+
+    return -1;
+}
+
+static bool whisper_speculative_init(
+        whisper_speculative & spec,
+        whisper_context * ctx,
+        whisper_state * state,
+        const whisper_full_params & params,
+        const float * samples,
+        int n_samples) {
+    whisper_context * dctx   = params.speculative.ctx;
+    whisper_state   * dstate = params.speculative.state;
+
+    if (dctx == nullptr || dstate == nullptr || params.speculative.n_draft <= 0) {
+        return false;
+    }
+    if (dstate == state) {
+        WHISPER_LOG_WARN("%s: the draft model needs its own state, not using it\n", __func__);
+        return false;
+    }
+    if (dctx->vocab.token_eot != ctx->vocab.token_eot) {
+        WHISPER_LOG_WARN("%s: the draft model has different text tokens, not using it\n", __func__);
+        return false;
+    }
+    if (samples == nullptr || n_samples <= 0) {
+        // the caller set the mel of the state, the draft model has none
+        WHISPER_LOG_DEBUG("%s: no samples for the draft model, not using it\n", __func__);
+        return false;
+    }
+
+    const int64_t t_start_us = ggml_time_us();
+
+    // the draft mel is computed with the draft filters, the models can differ in n_mels
+    if (whisper_pcm_to_mel_with_state(dctx, dstate, samples, n_samples, params.n_threads) != 0) {
+        WHISPER_LOG_ERROR("%s: failed to compute the draft log mel spectrogram\n", __func__);
+        return false;
+    }
+
+    state->t_spec_draft_us += ggml_time_us() - t_start_us;
+
+    // the draft decodes run in between the decodes of this state, on the same threads
+    spec.dstate_threadpool  = dstate->threadpool;
+    dstate->threadpool      = state->threadpool;
+    dstate->exp_n_audio_ctx = params.audio_ctx;
+
+    spec.dctx    = dctx;
+    spec.dstate  = dstate;
+    spec.n_draft = params.speculative.n_draft;
+    spec.seek    = -1;
+    spec.encoded = false;
+
+    return true;
+}
+
+// Starts drafting for a new decoding pass over the window at seek.
+static bool whisper_speculative_begin(
+        whisper_speculative & spec,
+        const whisper_context & ctx,
+        const std::vector<whisper_token> & prompt,
+        int seek) {
+    spec.prompt.clear();
+    for (const whisper_token id : prompt) {
+        const whisper_token did = whisper_token_translate(ctx.vocab, spec.dctx->vocab, id);
+        if (did < 0) {
+            return false;
+        }
+        spec.prompt.push_back(did);
+    }
+
+    if (spec.seek != seek) {
+        spec.seek    = seek;
+        spec.encoded = false;
+    }
+
+    spec.cached.clear();
+    spec.proposed.clear();
+    spec.n_used = 0;
+
+    whisper_kv_cache_clear(spec.dstate->kv_self);
+
+    return true;
+}
+
+// Proposes up to n_max tokens following tokens. Returns false when the draft
+// model cannot follow this pass any more.
+static bool whisper_speculative_draft(
+        whisper_speculative & spec,
+        const whisper_context & ctx,
+        whisper_state & state,
+        const whisper_full_params & params,
+        const std::vector<whisper_token_data> & tokens,
+        int n_max) {
+    auto & dctx   = *spec.dctx;
+    auto & dstate = *spec.dstate;
+    auto & dvocab = dctx.vocab;
+
+    spec.proposed.clear();
+    spec.n_used = 0;
+
+    if (n_max <= 0) {
+        return true;
+    }
+
+    const int64_t t_start_us = ggml_time_us();
+
+    if (!spec.encoded) {
+        if (!whisper_encode_internal(dctx, dstate, spec.seek, params.n_threads, params.abort_callback, params.abort_callback_user_data)) {
+            return false;
+        }
+        spec.encoded = true;
+    }
+
+    spec.want = spec.prompt;
+    for (const auto & token : tokens) {
+        const whisper_token did = whisper_token_translate(ctx.vocab, dvocab, token.id);
+        if (did < 0) {
+            return false;
+        }
+        spec.want.push_back(did);
+    }
+
+    // keep the common prefix and decode the rest, at least the last token for its logits
+    const int n_want = spec.want.size();
+
+    int n_keep = 0;
+    while (n_keep < (int) spec.cached.size() && n_keep < n_want - 1 && spec.cached[n_keep] == spec.want[n_keep]) {
+        n_keep++;
+    }
+
+    whisper_kv_cache_seq_rm(dstate.kv_self, 0, n_keep, -1);
+
+    auto & batch = dstate.batch;
+
+    whisper_batch_prep_legacy(batch, spec.want.data() + n_keep, n_want - n_keep, n_keep, 0);
+
+    if (!whisper_decode_internal(dctx, dstate, batch, params.n_threads, false, params.abort_callback, params.abort_callback_user_data)) {
+        return false;
+    }
+
+    spec.cached = spec.want;
+
+    const int n_logits = dvocab.n_vocab;
+
+    // text tokens (and timestamps if sampled at all) only, the rest are never worth a guess
+    const int i_ts = params.no_timestamps ? n_logits : dvocab.token_beg;
+
+    for (int k = 0; k < n_max; ++k) {
+        const float * logits = dstate.logits.data() + (batch.n_tokens - 1)*n_logits;
+
+        whisper_token did = whisper_vec_argmax(logits, dvocab.token_eot + 1);
+        if (i_ts < n_logits) {
+            const whisper_token did_ts = i_ts + whisper_vec_argmax(logits + i_ts, n_logits - i_ts);
+            if (logits[did_ts] > logits[did]) {
+                did = did_ts;
+            }
+        }
+
+        const whisper_token id = whisper_token_translate(dvocab, ctx.vocab, did);
+        if (id < 0) {
+            break;
+        }
+
+        spec.proposed.push_back(id);
+
+        if (did == dvocab.token_eot || k == n_max - 1) {
+            break;
+        }
+
+        whisper_batch_prep_legacy(batch, &did, 1, spec.cached.size(), 0);
+
+        if (!whisper_decode_internal(dctx, dstate, batch, params.n_threads, false, params.abort_callback, params.abort_callback_user_data)) {
+            spec.proposed.clear();
+            return false;
+        }
+
+        spec.cached.push_back(did);
+    }
+
+    state.t_spec_draft_us += ggml_time_us() - t_start_us;
+
+    return true;
+}
+
 int whisper_full_with_state(
         struct whisper_context * ctx,
           struct whisper_state * state,
@@ -6800,6 +8261,11 @@ int whisper_full_with_state(
 
     result_all.clear();
 
+    state->n_spec_verify   = 0;
+    state->n_spec_drafted  = 0;
+    state->n_spec_accepted = 0;
+    state->t_spec_draft_us = 0;
+
     if (n_samples > 0) {
         // compute log mel spectrogram
         if (whisper_pcm_to_mel_with_state(ctx, state, samples, n_samples, params.n_threads) != 0) {
@@ -6808,11 +8274,22 @@ int whisper_full_with_state(
         }
     }
 
+    // overwrite audio_ctx, max allowed is hparams.n_audio_ctx
+    // (before language detection, so that its encoder run matches the first window's)
+    if (params.audio_ctx > whisper_n_audio_ctx(ctx)) {
+        WHISPER_LOG_ERROR("%s: audio_ctx is larger than the maximum allowed (%d > %d)\n", __func__, params.audio_ctx, whisper_n_audio_ctx(ctx));
+        return -5;
+    }
+    state->exp_n_audio_ctx = params.audio_ctx;
+
     // auto-detect language if not specified
     if (params.language == nullptr || strlen(params.language) == 0 || strcmp(params.language, "auto") == 0 || params.detect_language) {
         std::vector<float> probs(whisper_lang_max_id() + 1, 0.0f);
 
-        const auto lang_id = whisper_lang_auto_detect_with_state(ctx, state, 0, params.n_threads, probs.data());
+        // detect on the first window to transcribe, whose encoding the decode loop then reuses
+        const int offset_ms = params.offset_ms/10 < whisper_n_len_from_state(state) ? params.offset_ms : 0;
+
+        const auto lang_id = whisper_lang_auto_detect_with_state(ctx, state, offset_ms, params.n_threads, probs.data());
         if (lang_id < 0) {
             WHISPER_LOG_ERROR("%s: failed to auto-detect language\n", __func__);
             return -3;
@@ -6835,6 +8312,8 @@ int whisper_full_with_state(
         }
     }
 
+    whisper_suppress_init(*ctx, *state, params);
+
     const int seek_start = params.offset_ms/10;
     const int seek_end = params.duration_ms == 0 ? whisper_n_len_from_state(state) : seek_start + params.duration_ms/10;
 
@@ -6943,12 +8422,9 @@ int whisper_full_with_state(
         }
     }
 
-    // overwrite audio_ctx, max allowed is hparams.n_audio_ctx
-    if (params.audio_ctx > whisper_n_audio_ctx(ctx)) {
-        WHISPER_LOG_ERROR("%s: audio_ctx is larger than the maximum allowed (%d > %d)\n", __func__, params.audio_ctx, whisper_n_audio_ctx(ctx));
-        return -5;
-    }
-    state->exp_n_audio_ctx = params.audio_ctx;
+    whisper_speculative spec;
+
+    const bool spec_enabled = params.strategy == WHISPER_SAMPLING_GREEDY && whisper_speculative_init(spec, ctx, state, params, samples, n_samples);
 
     // these tokens determine the task that will be performed
     std::vector<whisper_token> prompt_init = { whisper_token_sot(ctx), };
@@ -7143,6 +8619,11 @@ int whisper_full_with_state(
 
                 whisper_batch_prep_legacy(state->batch, prompt.data(), prompt.size(), 0, 0);
 
+                // the no_speech probability is read at the sot token, as in OpenAI's
+                // decoder; only the rows asked for are copied out of the batch
+                const int i_sot = prompt.size() - prompt_init.size();
+                state->batch.logits[i_sot] = 1;
+
                 if (!whisper_decode_internal(*ctx, *state, state->batch, params.n_threads, false, params.abort_callback, params.abort_callback_user_data)) {
                     WHISPER_LOG_ERROR("%s: failed to decode\n", __func__);
                     return -8;
@@ -7152,12 +8633,9 @@ int whisper_full_with_state(
                 // This has to be done before any logit filtering. Hence we cannot use the probs from the whisper_process_logits.
                 {
                     const int n_logits = ctx->vocab.id_to_token.size();
-                    std::vector<float> logprobs(n_logits);
-                    std::vector<float> probs(n_logits);
+                    const float * logits = state->logits.data() + i_sot*n_logits;
 
-                    whisper_compute_logprobs(state->logits, n_logits, logprobs);
-                    whisper_compute_probs(state->logits, n_logits, logprobs, probs);
-                    state->no_speech_prob = probs[whisper_token_nosp(ctx)];
+                    state->no_speech_prob = expf(logits[whisper_token_nosp(ctx)] - whisper_logsumexp(logits, n_logits));
                 }
 
                 {
@@ -7181,6 +8659,9 @@ int whisper_full_with_state(
                 }
             }
 
+            // greedy decoding at temperature 0 is deterministic, so it can be verified in batches
+            bool use_spec = spec_enabled && t_cur < 1e-6f && n_decoders_cur == 1 && whisper_speculative_begin(spec, *ctx, prompt, seek);
+
             for (int i = 0, n_max = whisper_n_text_ctx(ctx)/2 - 4; i < n_max; ++i) {
                 const int64_t t_start_sample_us = ggml_time_us();
 
@@ -7434,30 +8915,70 @@ int whisper_full_with_state(
 
                     const int n_past = prompt.size() + i;
 
-                    for (int j = 0; j < n_decoders_cur; ++j) {
-                        auto & decoder = state->decoders[j];
+                    // the sampled token is the next proposed one: the last batch already
+                    // has it in the KV cache and its logits in the following row
+                    bool is_verified = false;
 
-                        if (decoder.failed || decoder.completed) {
-                            continue;
-                        }
+                    if (use_spec) {
+                        auto & decoder = state->decoders[0];
 
-                        //WHISPER_LOG_DEBUG("%s: decoder %d: token %d, seek_delta %d\n", __func__, j, decoder.sequence.tokens.back().id, decoder.seek_delta);
+                        if (spec.n_used < (int) spec.proposed.size() && spec.proposed[spec.n_used] == decoder.sequence.tokens.back().id) {
+                            decoder.i_batch = ++spec.n_used;
+                            state->n_spec_accepted++;
+                            is_verified = true;
+                        } else {
+                            // drop the rejected proposals, the sampled token goes in their place
+                            whisper_kv_cache_seq_rm(state->kv_self, 0, n_past, -1);
 
-                        decoder.i_batch = batch.n_tokens;
+                            const int n_draft = std::min(spec.n_draft, whisper_n_text_ctx(ctx) - 1 - n_past);
 
-                        batch.token   [batch.n_tokens]    = decoder.sequence.tokens.back().id;
-                        batch.pos     [batch.n_tokens]    = n_past;
-                        batch.n_seq_id[batch.n_tokens]    = 1;
-                        batch.seq_id  [batch.n_tokens][0] = j;
-                        batch.logits  [batch.n_tokens]    = 1;
-                        batch.n_tokens++;
+                            if (!whisper_speculative_draft(spec, *ctx, *state, params, decoder.sequence.tokens, n_draft)) {
+                                spec.proposed.clear();
+                                use_spec = false;
+                            }
+                        }
                     }
 
-                    assert(batch.n_tokens > 0);
+                    if (!is_verified) {
+                        for (int j = 0; j < n_decoders_cur; ++j) {
+                            auto & decoder = state->decoders[j];
+
+                            if (decoder.failed || decoder.completed) {
+                                continue;
+                            }
+
+                            //WHISPER_LOG_DEBUG("%s: decoder %d: token %d, seek_delta %d\n", __func__, j, decoder.sequence.tokens.back().id, decoder.seek_delta);
+
+                            decoder.i_batch = batch.n_tokens;
+
+                            batch.token   [batch.n_tokens]    = decoder.sequence.tokens.back().id;
+                            batch.pos     [batch.n_tokens]    = n_past;
+                            batch.n_seq_id[batch.n_tokens]    = 1;
+                            batch.seq_id  [batch.n_tokens][0] = j;
+                            batch.logits  [batch.n_tokens]    = 1;
+                            batch.n_tokens++;
+                        }
+
+                        assert(batch.n_tokens > 0);
 
-                    if (!whisper_decode_internal(*ctx, *state, state->batch, params.n_threads, false, params.abort_callback, params.abort_callback_user_data)) {
-                        WHISPER_LOG_ERROR("%s: failed to decode\n", __func__);
-                        return -9;
+                        if (use_spec && !spec.proposed.empty()) {
+                            for (int k = 0; k < (int) spec.proposed.size(); ++k) {
+                                batch.token   [batch.n_tokens]    = spec.proposed[k];
+                                batch.pos     [batch.n_tokens]    = n_past + 1 + k;
+                                batch.n_seq_id[batch.n_tokens]    = 1;
+                                batch.seq_id  [batch.n_tokens][0] = 0;
+                                batch.logits  [batch.n_tokens]    = 1;
+                                batch.n_tokens++;
+                            }
+
+                            state->n_spec_verify++;
+                            state->n_spec_drafted += spec.proposed.size();
+                        }
+
+                        if (!whisper_decode_internal(*ctx, *state, state->batch, params.n_threads, false, params.abort_callback, params.abort_callback_user_data)) {
+                            WHISPER_LOG_ERROR("%s: failed to decode\n", __func__);
+                            return -9;
+                        }
                     }
 
                     const int64_t t_start_sample_us = ggml_time_us();
@@ -8915,8 +10436,13 @@ static void whisper_exp_compute_token_level_timestamps_dtw(
     struct ggml_cgraph * gf = ggml_new_graph(gctx);
     ggml_build_forward_expand(gf, w);
 
-    ggml_backend_ptr backend { ggml_backend_init_by_type(GGML_BACKEND_DEVICE_TYPE_CPU, nullptr) };
-    ggml_backend_graph_compute(backend.get(), gf);
+    // On the state's CPU backend and threadpool, like the decodes, instead of
+    // a new backend spawning its own workers for every segment
+    if (!ggml_graph_compute_helper(state->backends.back(), gf, n_threads, state->threadpool)) {
+        WHISPER_LOG_ERROR("%s: failed to compute the alignment\n", __func__);
+        ggml_free(gctx);
+        return;
+    }
 
     ggml_tensor * alignment = dtw_and_backtrace(gctx, w);
 
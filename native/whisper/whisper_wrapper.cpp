@@ -1,17 +1,34 @@
 #include <iostream>
 #include <vector>
 #include <cstring>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <fstream>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 // Rename everything in the real whisper.h to avoid collision
 #define whisper_context real_whisper_context
 #define whisper_state real_whisper_state
 #define whisper_full_params real_whisper_full_params
 #define whisper_context_params real_whisper_context_params
+#define whisper_load_stats real_whisper_load_stats
+#define whisper_speculative_stats real_whisper_speculative_stats
 #define whisper_token_data real_whisper_token_data
 #define whisper_model_loader real_whisper_model_loader
 #define whisper_grammar_element real_whisper_grammar_element
 #define whisper_gretype real_whisper_gretype
 #define whisper_sampling_strategy real_whisper_sampling_strategy
+#define whisper_new_segment_callback real_whisper_new_segment_callback
+#define whisper_progress_callback real_whisper_progress_callback
+#define whisper_encoder_begin_callback real_whisper_encoder_begin_callback
+#define whisper_logits_filter_callback real_whisper_logits_filter_callback
 #define WHISPER_SAMPLING_GREEDY REAL_WHISPER_SAMPLING_GREEDY
 #define WHISPER_SAMPLING_BEAM_SEARCH REAL_WHISPER_SAMPLING_BEAM_SEARCH
 
@@ -31,12 +48,26 @@
 #define whisper_ctx_init_openvino_encoder real_whisper_ctx_init_openvino_encoder
 #define whisper_free real_whisper_free
 #define whisper_free_state real_whisper_free_state
+#define whisper_set_threadpool_with_state real_whisper_set_threadpool_with_state
+#define whisper_get_load_stats real_whisper_get_load_stats
+#define whisper_get_model_memory real_whisper_get_model_memory
+#define whisper_get_state_memory real_whisper_get_state_memory
+#define whisper_prefault_model real_whisper_prefault_model
+#define whisper_get_speculative_stats real_whisper_get_speculative_stats
 #define whisper_free_params real_whisper_free_params
 #define whisper_free_context_params real_whisper_free_context_params
 #define whisper_pcm_to_mel real_whisper_pcm_to_mel
 #define whisper_pcm_to_mel_with_state real_whisper_pcm_to_mel_with_state
 #define whisper_pcm_to_mel_phase_vocoder real_whisper_pcm_to_mel_phase_vocoder
 #define whisper_pcm_to_mel_phase_vocoder_with_state real_whisper_pcm_to_mel_phase_vocoder_with_state
+#define whisper_mel_stream_reset real_whisper_mel_stream_reset
+#define whisper_mel_stream_reset_with_state real_whisper_mel_stream_reset_with_state
+#define whisper_mel_stream_append real_whisper_mel_stream_append
+#define whisper_mel_stream_append_with_state real_whisper_mel_stream_append_with_state
+#define whisper_mel_stream_discard real_whisper_mel_stream_discard
+#define whisper_mel_stream_discard_with_state real_whisper_mel_stream_discard_with_state
+#define whisper_mel_stream_apply real_whisper_mel_stream_apply
+#define whisper_mel_stream_apply_with_state real_whisper_mel_stream_apply_with_state
 #define whisper_set_mel real_whisper_set_mel
 #define whisper_set_mel_with_state real_whisper_set_mel_with_state
 #define whisper_encode real_whisper_encode
@@ -44,6 +75,7 @@
 #define whisper_decode real_whisper_decode
 #define whisper_decode_with_state real_whisper_decode_with_state
 #define whisper_tokenize real_whisper_tokenize
+#define whisper_token_count real_whisper_token_count
 #define whisper_lang_max_id real_whisper_lang_max_id
 #define whisper_lang_id real_whisper_lang_id
 #define whisper_lang_str real_whisper_lang_str
@@ -73,6 +105,7 @@
 #define whisper_full_get_segment_t0_from_state real_whisper_full_get_segment_t0_from_state
 #define whisper_full_get_segment_t1 real_whisper_full_get_segment_t1
 #define whisper_full_get_segment_t1_from_state real_whisper_full_get_segment_t1_from_state
+#define whisper_full_get_segment_no_speech_prob_from_state real_whisper_full_get_segment_no_speech_prob_from_state
 #define whisper_full_get_segment_text real_whisper_full_get_segment_text
 #define whisper_full_get_segment_text_from_state real_whisper_full_get_segment_text_from_state
 #define whisper_full_n_tokens real_whisper_full_n_tokens
@@ -86,6 +119,7 @@
 #define whisper_full_get_token_p real_whisper_full_get_token_p
 #define whisper_full_get_token_p_from_state real_whisper_full_get_token_p_from_state
 #define whisper_print_system_info real_whisper_print_system_info
+#define whisper_version real_whisper_version
 
 #include "whisper.cpp/include/whisper.h"
 
@@ -94,11 +128,17 @@
 #undef whisper_state
 #undef whisper_full_params
 #undef whisper_context_params
+#undef whisper_load_stats
+#undef whisper_speculative_stats
 #undef whisper_token_data
 #undef whisper_model_loader
 #undef whisper_grammar_element
 #undef whisper_gretype
 #undef whisper_sampling_strategy
+#undef whisper_new_segment_callback
+#undef whisper_progress_callback
+#undef whisper_encoder_begin_callback
+#undef whisper_logits_filter_callback
 #undef WHISPER_SAMPLING_GREEDY
 #undef WHISPER_SAMPLING_BEAM_SEARCH
 
@@ -118,12 +158,26 @@
 #undef whisper_ctx_init_openvino_encoder
 #undef whisper_free
 #undef whisper_free_state
+#undef whisper_set_threadpool_with_state
+#undef whisper_get_load_stats
+#undef whisper_get_model_memory
+#undef whisper_get_state_memory
+#undef whisper_prefault_model
+#undef whisper_get_speculative_stats
 #undef whisper_free_params
 #undef whisper_free_context_params
 #undef whisper_pcm_to_mel
 #undef whisper_pcm_to_mel_with_state
 #undef whisper_pcm_to_mel_phase_vocoder
 #undef whisper_pcm_to_mel_phase_vocoder_with_state
+#undef whisper_mel_stream_reset
+#undef whisper_mel_stream_reset_with_state
+#undef whisper_mel_stream_append
+#undef whisper_mel_stream_append_with_state
+#undef whisper_mel_stream_discard
+#undef whisper_mel_stream_discard_with_state
+#undef whisper_mel_stream_apply
+#undef whisper_mel_stream_apply_with_state
 #undef whisper_set_mel
 #undef whisper_set_mel_with_state
 #undef whisper_encode
@@ -131,6 +185,7 @@
 #undef whisper_decode
 #undef whisper_decode_with_state
 #undef whisper_tokenize
+#undef whisper_token_count
 #undef whisper_lang_max_id
 #undef whisper_lang_id
 #undef whisper_lang_str
@@ -160,6 +215,7 @@
 #undef whisper_full_get_segment_t0_from_state
 #undef whisper_full_get_segment_t1
 #undef whisper_full_get_segment_t1_from_state
+#undef whisper_full_get_segment_no_speech_prob_from_state
 #undef whisper_full_get_segment_text
 #undef whisper_full_get_segment_text_from_state
 #undef whisper_full_n_tokens
@@ -173,18 +229,563 @@
 #undef whisper_full_get_token_p
 #undef whisper_full_get_token_p_from_state
 #undef whisper_print_system_info
+#undef whisper_version
 
 #include "whisper_wrapper.h"
 
+static real_whisper_full_params to_real_params(const whisper_full_params & params) {
+    real_whisper_full_params rparams = real_whisper_full_default_params((real_whisper_sampling_strategy) params.strategy);
+    
+    rparams.n_threads = params.n_threads;
+    rparams.n_max_text_ctx = params.n_max_text_ctx;
+    rparams.offset_ms = params.offset_ms;
+    rparams.duration_ms = params.duration_ms;
+    rparams.translate = params.translate;
+    rparams.no_context = params.no_context;
+    rparams.no_timestamps = params.no_timestamps;
+    rparams.single_segment = params.single_segment;
+    rparams.print_special = params.print_special;
+    rparams.print_progress = params.print_progress;
+    rparams.print_realtime = params.print_realtime;
+    rparams.print_timestamps = params.print_timestamps;
+    rparams.token_timestamps = params.token_timestamps;
+    rparams.thold_pt = params.thold_pt;
+    rparams.thold_ptsum = params.thold_ptsum;
+    rparams.max_len = params.max_len;
+    rparams.split_on_word = params.split_on_word;
+    rparams.max_tokens = params.max_tokens;
+    rparams.debug_mode = params.debug_mode;
+    rparams.audio_ctx = params.audio_ctx;
+    rparams.tdrz_enable = params.tdrz_enable;
+    rparams.initial_prompt = params.initial_prompt;
+    rparams.prompt_tokens = (const int32_t *) params.prompt_tokens;
+    rparams.prompt_n_tokens = params.prompt_n_tokens;
+    rparams.language = params.language;
+    rparams.detect_language = params.detect_language;
+    rparams.suppress_blank = params.suppress_blank;
+    rparams.suppress_nst = params.suppress_nst;
+    rparams.temperature = params.temperature;
+    rparams.max_initial_ts = params.max_initial_ts;
+    rparams.length_penalty = params.length_penalty;
+    rparams.temperature_inc = params.temperature_inc;
+    rparams.entropy_thold = params.entropy_thold;
+    rparams.logprob_thold = params.logprob_thold;
+    rparams.no_speech_thold = params.no_speech_thold;
+    rparams.greedy.best_of = params.greedy.best_of;
+    rparams.beam_search.beam_size = params.beam_search.beam_size;
+    rparams.beam_search.patience = params.beam_search.patience;
+    rparams.suppress_regex = params.suppress_regex;
+    rparams.carry_initial_prompt = params.carry_initial_prompt;
+    rparams.abort_callback = (ggml_abort_callback) params.abort_callback;
+    rparams.abort_callback_user_data = params.abort_callback_user_data;
+    rparams.grammar_rules = (const real_whisper_grammar_element **) params.grammar_rules;
+    rparams.n_grammar_rules = params.n_grammar_rules;
+    rparams.i_start_rule = params.i_start_rule;
+    rparams.grammar_penalty = params.grammar_penalty;
+    rparams.vad = params.vad;
+    rparams.vad_model_path = params.vad_model_path;
+    rparams.vad_params.threshold = params.vad_params.threshold;
+    rparams.vad_params.min_speech_duration_ms = params.vad_params.min_speech_duration_ms;
+    rparams.vad_params.min_silence_duration_ms = params.vad_params.min_silence_duration_ms;
+    rparams.vad_params.max_speech_duration_s = params.vad_params.max_speech_duration_s;
+    rparams.vad_params.speech_pad_ms = params.vad_params.speech_pad_ms;
+    rparams.vad_params.samples_overlap = params.vad_params.samples_overlap;
+
+    // Segment/progress/encoder/logits callbacks are installed by whisper_full_on,
+    // which knows the wrapper state they have to be called with
+    return rparams;
+}
+
+// Mirror of Dart_CObject from dart_api.h (a stable ABI), only the kinds posted here
+enum {
+    WHISPER_DART_INT64  = 3,
+    WHISPER_DART_STRING = 5,
+    WHISPER_DART_ARRAY  = 6,
+};
+
+struct whisper_dart_cobject {
+    int32_t type;
+    union {
+        int64_t as_int64;
+        const char * as_string;
+        struct {
+            intptr_t length;
+            whisper_dart_cobject ** values;
+        } as_array;
+        void * reserved[5]; // size of the full union in dart_api.h
+    } value;
+};
+
+typedef bool (*whisper_dart_post_cobject_fn)(int64_t port, whisper_dart_cobject * message);
+
+static std::atomic<whisper_dart_post_cobject_fn> g_dart_post_cobject{nullptr};
+
+// Routes whisper.cpp callbacks for one decode: C callbacks get the wrapper
+// context/state back, and new segments/progress are posted to Dart ports.
+struct whisper_callback_bridge {
+    whisper_context * ctx;
+    whisper_state * state;
+    const whisper_full_params * params;
+};
+
+static void whisper_bridge_new_segment(struct real_whisper_context * rctx, struct real_whisper_state * rstate, int n_new, void * user_data) {
+    const whisper_callback_bridge * bridge = (const whisper_callback_bridge *) user_data;
+    const whisper_full_params & params = *bridge->params;
+
+    if (params.new_segment_callback) {
+        ((whisper_new_segment_callback) params.new_segment_callback)(bridge->ctx, bridge->state, n_new, params.new_segment_callback_user_data);
+    }
+
+    whisper_dart_post_cobject_fn post = g_dart_post_cobject.load(std::memory_order_acquire);
+    if (params.new_segment_port == 0 || !post) {
+        return;
+    }
+
+    const int n_segments = real_whisper_full_n_segments_from_state(rstate);
+    for (int i = std::max(0, n_segments - n_new); i < n_segments; i++) {
+        whisper_dart_cobject index, t0, t1, text;
+        index.type = WHISPER_DART_INT64;
+        index.value.as_int64 = i;
+        t0.type = WHISPER_DART_INT64;
+        t0.value.as_int64 = real_whisper_full_get_segment_t0_from_state(rstate, i);
+        t1.type = WHISPER_DART_INT64;
+        t1.value.as_int64 = real_whisper_full_get_segment_t1_from_state(rstate, i);
+        text.type = WHISPER_DART_STRING;
+        text.value.as_string = real_whisper_full_get_segment_text_from_state(rstate, i);
+
+        whisper_dart_cobject * values[4] = { &index, &t0, &t1, &text };
+        whisper_dart_cobject message;
+        message.type = WHISPER_DART_ARRAY;
+        message.value.as_array.length = 4;
+        message.value.as_array.values = values;
+        post(params.new_segment_port, &message);
+    }
+    (void) rctx;
+}
+
+static void whisper_bridge_progress(struct real_whisper_context *, struct real_whisper_state *, int progress, void * user_data) {
+    const whisper_callback_bridge * bridge = (const whisper_callback_bridge *) user_data;
+    const whisper_full_params & params = *bridge->params;
+
+    if (params.progress_callback) {
+        ((whisper_progress_callback) params.progress_callback)(bridge->ctx, bridge->state, progress, params.progress_callback_user_data);
+    }
+
+    whisper_dart_post_cobject_fn post = g_dart_post_cobject.load(std::memory_order_acquire);
+    if (params.progress_port != 0 && post) {
+        whisper_dart_cobject message;
+        message.type = WHISPER_DART_INT64;
+        message.value.as_int64 = progress;
+        post(params.progress_port, &message);
+    }
+}
+
+static bool whisper_bridge_encoder_begin(struct real_whisper_context *, struct real_whisper_state *, void * user_data) {
+    const whisper_callback_bridge * bridge = (const whisper_callback_bridge *) user_data;
+    const whisper_full_params & params = *bridge->params;
+    return ((whisper_encoder_begin_callback) params.encoder_begin_callback)(bridge->ctx, bridge->state, params.encoder_begin_callback_user_data);
+}
+
+static void whisper_bridge_logits_filter(struct real_whisper_context *, struct real_whisper_state *, const real_whisper_token_data * tokens, int n_tokens, float * logits, void * user_data) {
+    const whisper_callback_bridge * bridge = (const whisper_callback_bridge *) user_data;
+    const whisper_full_params & params = *bridge->params;
+    ((whisper_logits_filter_callback) params.logits_filter_callback)(bridge->ctx, bridge->state, tokens, n_tokens, logits, params.logits_filter_callback_user_data);
+}
+
+struct whisper_state {
+    struct real_whisper_state * state = nullptr;
+    std::atomic<bool> abort{false};
+
+    // Persistent CPU workers, see whisper_state_set_threadpool. While not
+    // active the pool is paused after every decode so its workers sleep.
+    ggml_threadpool_t threadpool = nullptr;
+    int n_threadpool_threads = 0;
+    std::atomic<bool> active{false};
+    // Held by a decode, so the threadpool is not replaced under it
+    std::mutex decode_mutex;
+
+    // Caller's abort callback, chained behind the abort flag during a decode
+    ggml_abort_callback user_abort = nullptr;
+    void * user_abort_data = nullptr;
+};
+
+struct whisper_state_pool {
+    whisper_context * ctx;
+    std::mutex mutex;
+    whisper_state * states[WHISPER_STATE_PURPOSE_COUNT] = {};
+};
+
+static bool whisper_state_abort_callback(void * user_data) {
+    whisper_state * state = (whisper_state *) user_data;
+    if (state->abort.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    return state->user_abort && state->user_abort(state->user_abort_data);
+}
+
+// CPU affinity and scheduling policy of the calling thread
+struct whisper_thread_sched {
+    cpu_set_t cpus;
+    int policy;
+    sched_param param;
+};
+
+static bool whisper_thread_sched_save(whisper_thread_sched & sched) {
+    return pthread_getaffinity_np(pthread_self(), sizeof(sched.cpus), &sched.cpus) == 0 &&
+           pthread_getschedparam(pthread_self(), &sched.policy, &sched.param) == 0;
+}
+
+static void whisper_thread_sched_restore(const whisper_thread_sched & sched) {
+    pthread_setschedparam(pthread_self(), sched.policy, &sched.param);
+    pthread_setaffinity_np(pthread_self(), sizeof(sched.cpus), &sched.cpus);
+}
+
+// whisper_full on state, or on the default state when state is null. Only
+// the audio already turned into a mel is decoded when n_samples is 0. params
+// supplies the callbacks and ports, rparams everything else.
+static int whisper_full_on(struct real_whisper_context * rctx, whisper_state * state, const whisper_full_params & params,
+                           real_whisper_full_params rparams, const float * samples, int n_samples) {
+    whisper_callback_bridge bridge = { (whisper_context *) rctx, state, &params };
+    if (params.new_segment_callback || params.new_segment_port != 0) {
+        rparams.new_segment_callback = whisper_bridge_new_segment;
+        rparams.new_segment_callback_user_data = &bridge;
+    }
+    if (params.progress_callback || params.progress_port != 0) {
+        rparams.progress_callback = whisper_bridge_progress;
+        rparams.progress_callback_user_data = &bridge;
+    }
+    if (params.encoder_begin_callback) {
+        rparams.encoder_begin_callback = whisper_bridge_encoder_begin;
+        rparams.encoder_begin_callback_user_data = &bridge;
+    }
+    if (params.logits_filter_callback) {
+        rparams.logits_filter_callback = whisper_bridge_logits_filter;
+        rparams.logits_filter_callback_user_data = &bridge;
+    }
+
+    rparams.speculative.ctx = (struct real_whisper_context *) params.draft_ctx;
+    rparams.speculative.state = params.draft_state ? params.draft_state->state : nullptr;
+    rparams.speculative.n_draft = params.n_draft;
+
+    if (!state) {
+        return real_whisper_full(rctx, rparams, samples, n_samples);
+    }
+
+    std::lock_guard<std::mutex> decode_lock(state->decode_mutex);
+
+    state->abort.store(false, std::memory_order_relaxed);
+    state->user_abort = rparams.abort_callback;
+    state->user_abort_data = rparams.abort_callback_user_data;
+    rparams.abort_callback = whisper_state_abort_callback;
+    rparams.abort_callback_user_data = state;
+
+    // A pooled state always runs with the pool's width
+    if (state->threadpool) {
+        rparams.n_threads = state->n_threadpool_threads;
+    }
+
+    // Waking a paused pool moves the calling thread onto the pool's CPUs and
+    // priority for the compute. That thread is the caller's (a Dart isolate's),
+    // so it gets its own settings back afterwards.
+    whisper_thread_sched caller;
+    const bool restore = state->threadpool && whisper_thread_sched_save(caller);
+
+    const int ret = real_whisper_full_with_state(rctx, state->state, rparams, samples, n_samples);
+
+    if (state->threadpool && !state->active.load(std::memory_order_relaxed)) {
+        ggml_threadpool_pause(state->threadpool);
+    }
+    if (restore) {
+        whisper_thread_sched_restore(caller);
+    }
+
+    return ret;
+}
+
+// Parses a sysfs CPU list such as "0-7,16-23". Returns the number of CPUs set.
+static int whisper_parse_cpu_list(const std::string & list, bool * mask) {
+    int n = 0;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos) end = list.size();
+        const std::string range = list.substr(pos, end - pos);
+        const size_t dash = range.find('-');
+        const int first = std::atoi(range.c_str());
+        const int last = dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+        for (int cpu = first; cpu <= last && cpu < GGML_MAX_N_THREADS; cpu++) {
+            if (cpu >= 0 && !mask[cpu]) {
+                mask[cpu] = true;
+                n++;
+            }
+        }
+        pos = end + 1;
+    }
+    return n;
+}
+
+static long whisper_read_sysfs_long(const std::string & path) {
+    std::ifstream in(path);
+    long value = -1;
+    if (!(in >> value)) return -1;
+    return value;
+}
+
+// Selects the fastest cores: the P-cores listed by the hybrid PMU on Intel, or
+// the cores with the highest capacity/max frequency elsewhere. Returns false
+// when all cores are alike, so the default affinity is kept.
+static bool whisper_performance_cpus(bool * mask) {
+    {
+        std::ifstream in("/sys/devices/cpu_core/cpus");
+        std::string list;
+        if (std::getline(in, list) && whisper_parse_cpu_list(list, mask) > 0) {
+            return true;
+        }
+    }
+
+    std::vector<long> rank;
+    for (int cpu = 0; cpu < GGML_MAX_N_THREADS; cpu++) {
+        const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+        long value = whisper_read_sysfs_long(base + "/cpu_capacity");
+        if (value < 0) value = whisper_read_sysfs_long(base + "/cpufreq/cpuinfo_max_freq");
+        if (value < 0) break;
+        rank.push_back(value);
+    }
+    if (rank.empty()) return false;
+
+    const long best = *std::max_element(rank.begin(), rank.end());
+    if (*std::min_element(rank.begin(), rank.end()) == best) return false;
+
+    for (size_t cpu = 0; cpu < rank.size(); cpu++) {
+        mask[cpu] = rank[cpu] == best;
+    }
+    return true;
+}
+
+// Adaptive encoder context. One encoder frame covers 20 ms (320 samples).
+// Sizes are rounded up to the 256-frame padding the decoder already applies to
+// the cross-attention KV, so there are only a handful of distinct graph shapes.
+// The compute buffers are reserved for the full n_audio_ctx when the state is
+// created, so switching buckets only re-plans the graph and never allocates.
+#define WHISPER_AUDIO_CTX_SAMPLES_PER_FRAME 320
+#define WHISPER_AUDIO_CTX_BUCKET            256
+#define WHISPER_AUDIO_CTX_MARGIN            64   // ~1.3 s of headroom past the end of the audio
+
+static int whisper_adaptive_audio_ctx(struct real_whisper_context * ctx, int64_t n_samples) {
+    const int n_max = real_whisper_n_audio_ctx(ctx);
+    const int64_t needed = (n_samples + WHISPER_AUDIO_CTX_SAMPLES_PER_FRAME - 1) / WHISPER_AUDIO_CTX_SAMPLES_PER_FRAME
+                         + WHISPER_AUDIO_CTX_MARGIN;
+    const int64_t bucket = (needed + WHISPER_AUDIO_CTX_BUCKET - 1) / WHISPER_AUDIO_CTX_BUCKET * WHISPER_AUDIO_CTX_BUCKET;
+    return bucket >= n_max ? 0 : (int) bucket;
+}
+
+static void whisper_resolve_audio_ctx(real_whisper_full_params & rparams, struct real_whisper_context * ctx, int64_t n_samples) {
+    if (rparams.audio_ctx == WHISPER_AUDIO_CTX_AUTO) {
+        rparams.audio_ctx = whisper_adaptive_audio_ctx(ctx, n_samples);
+    } else if (rparams.audio_ctx < 0) {
+        rparams.audio_ctx = 0;
+    }
+}
+
+struct whisper_audio_buffer {
+    std::atomic<float *> data{nullptr};
+    int64_t capacity = 0;
+    std::atomic<int64_t> size{0};
+
+    // Mappings outgrown by appends. Views taken before a grow still point
+    // into them, so they are only unmapped by clear, discard and free.
+    std::vector<std::pair<float *, int64_t>> retired;
+};
+
+// Hands the pages of [from, capacity) back to the kernel; they are re-faulted as zeros on demand.
+static void whisper_audio_buffer_release_pages(whisper_audio_buffer * buffer, int64_t from) {
+    const int64_t page = 4096 / sizeof(float);
+    const int64_t start = (from + page - 1) / page * page;
+    if (start < buffer->capacity) {
+        madvise(buffer->data.load(std::memory_order_relaxed) + start, (buffer->capacity - start) * sizeof(float),
+                MADV_DONTNEED);
+    }
+}
+
+static float * whisper_audio_buffer_map(int64_t capacity) {
+    // Reserve address space only, pages are committed as samples get written
+    void * data = mmap(nullptr, capacity * sizeof(float), PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return data == MAP_FAILED ? nullptr : (float *) data;
+}
+
+static void whisper_audio_buffer_unmap_retired(whisper_audio_buffer * buffer) {
+    for (const auto & mapping : buffer->retired) {
+        munmap(mapping.first, mapping.second * sizeof(float));
+    }
+    buffer->retired.clear();
+}
+
+// Makes room for n_samples more. The samples move to a mapping twice as large;
+// the old one stays mapped for the views into it.
+static bool whisper_audio_buffer_reserve(whisper_audio_buffer * buffer, int64_t size, int n_samples) {
+    if (size + n_samples <= buffer->capacity) return true;
+
+    int64_t capacity = buffer->capacity * 2;
+    while (capacity < size + n_samples) capacity *= 2;
+    float * data = whisper_audio_buffer_map(capacity);
+    if (!data) {
+        std::cerr << "whisper_audio_buffer_append: failed to grow to " << capacity << " samples" << std::endl;
+        return false;
+    }
+
+    float * old = buffer->data.load(std::memory_order_relaxed);
+    std::memcpy(data, old, size * sizeof(float));
+    buffer->retired.emplace_back(old, buffer->capacity);
+    // Readers that see the new size also see the new mapping
+    buffer->data.store(data, std::memory_order_release);
+    buffer->capacity = capacity;
+    return true;
+}
+
+// Streaming tuning. Timestamps from whisper are in 10 ms units (160 samples at 16 kHz).
+#define WHISPER_STREAM_SAMPLES_PER_T     160
+#define WHISPER_STREAM_MIN_SAMPLES       4000    // 0.25 s, below this whisper produces noise
+#define WHISPER_STREAM_MAX_TAIL_SAMPLES  (16000 * 15)
+#define WHISPER_STREAM_PROMPT_CHARS      200
+
+struct whisper_stream {
+    whisper_context * ctx;
+    whisper_state * state;     // null for the context's default state
+    whisper_full_params params;
+    std::string language;
+    std::string initial_prompt;
+
+    // Uncommitted audio, starting right after the last committed segment. The
+    // samples themselves only live in the incremental mel of the default state.
+    size_t n_tail = 0;
+    size_t n_decoded = 0;      // n_tail at the last decode, to skip polls without new audio
+
+    std::string committed;
+    std::string partial;
+    std::vector<std::string> prev_segments; // uncommitted segments of the previous poll
+    std::string prompt;
+};
+
+static void whisper_stream_mel_reset(whisper_stream * stream) {
+    struct real_whisper_context * rctx = (struct real_whisper_context *) stream->ctx;
+    if (stream->state) {
+        real_whisper_mel_stream_reset_with_state(rctx, stream->state->state);
+    } else {
+        real_whisper_mel_stream_reset(rctx);
+    }
+}
+
+// Re-decodes the uncommitted tail. Segments that match the previous decode (or
+// everything but the last segment once the tail grows too long) are committed
+// and their audio is dropped. With commit_all the whole tail is committed.
+static int whisper_stream_decode(whisper_stream * stream, bool commit_all) {
+    stream->partial.clear();
+    if (stream->n_tail < WHISPER_STREAM_MIN_SAMPLES) {
+        stream->n_decoded = stream->n_tail;
+        stream->prev_segments.clear();
+        return 0;
+    }
+
+    real_whisper_full_params rparams = to_real_params(stream->params);
+    rparams.language = stream->language.c_str();
+    rparams.no_context = true;
+
+    // Carry the end of the committed text as prompt so the tail continues it
+    stream->prompt = stream->initial_prompt;
+    if (!stream->committed.empty()) {
+        size_t start = stream->committed.size() > WHISPER_STREAM_PROMPT_CHARS
+            ? stream->committed.size() - WHISPER_STREAM_PROMPT_CHARS : 0;
+        if (!stream->prompt.empty()) stream->prompt += " ";
+        stream->prompt += stream->committed.substr(start);
+    }
+    rparams.initial_prompt = stream->prompt.empty() ? nullptr : stream->prompt.c_str();
+
+    // Only the STFT frames of newly pushed audio were computed, apply them and
+    // decode from the state mel
+    struct real_whisper_context * rctx = (struct real_whisper_context *) stream->ctx;
+    struct real_whisper_state * rstate = stream->state ? stream->state->state : nullptr;
+    whisper_resolve_audio_ctx(rparams, rctx, (int64_t) stream->n_tail);
+    int ret = rstate ? real_whisper_mel_stream_apply_with_state(rctx, rstate) : real_whisper_mel_stream_apply(rctx);
+    if (ret == 0) {
+        ret = whisper_full_on(rctx, stream->state, stream->params, rparams, nullptr, 0);
+    }
+    if (ret != 0) {
+        return ret;
+    }
+
+    const int n_segments = rstate ? real_whisper_full_n_segments_from_state(rstate) : real_whisper_full_n_segments(rctx);
+    std::vector<std::string> segments;
+    std::vector<int64_t> ends;
+    segments.reserve(n_segments);
+    ends.reserve(n_segments);
+    for (int i = 0; i < n_segments; i++) {
+        if (rstate) {
+            segments.emplace_back(real_whisper_full_get_segment_text_from_state(rstate, i));
+            ends.push_back(real_whisper_full_get_segment_t1_from_state(rstate, i));
+        } else {
+            segments.emplace_back(real_whisper_full_get_segment_text(rctx, i));
+            ends.push_back(real_whisper_full_get_segment_t1(rctx, i));
+        }
+    }
+
+    int n_commit = 0;
+    if (commit_all) {
+        n_commit = n_segments;
+    } else {
+        const bool force = stream->n_tail > WHISPER_STREAM_MAX_TAIL_SAMPLES;
+        for (int i = 0; i + 1 < n_segments; i++) {
+            const bool stable = i < (int) stream->prev_segments.size() && stream->prev_segments[i] == segments[i];
+            if (!stable && !force) break;
+            n_commit = i + 1;
+        }
+    }
+
+    for (int i = 0; i < n_commit; i++) {
+        stream->committed += segments[i];
+    }
+
+    if (commit_all) {
+        whisper_stream_mel_reset(stream);
+        stream->n_tail = 0;
+        segments.clear();
+    } else if (n_commit > 0) {
+        // One mel frame per timestamp unit
+        const size_t n_frames = std::min((size_t) ends[n_commit - 1], stream->n_tail / WHISPER_STREAM_SAMPLES_PER_T);
+        if (rstate) {
+            real_whisper_mel_stream_discard_with_state(rctx, rstate, (int) n_frames);
+        } else {
+            real_whisper_mel_stream_discard(rctx, (int) n_frames);
+        }
+        stream->n_tail -= n_frames * WHISPER_STREAM_SAMPLES_PER_T;
+        segments.erase(segments.begin(), segments.begin() + n_commit);
+    }
+
+    for (const auto & segment : segments) {
+        stream->partial += segment;
+    }
+    stream->prev_segments = std::move(segments);
+    stream->n_decoded = stream->n_tail;
+
+    return 0;
+}
+
 extern "C" {
 
 const char * whisper_version(void) {
-    return "1.5.4-wrapper";
+    return real_whisper_version();
+}
+
+void whisper_dart_init(void * post_cobject) {
+    g_dart_post_cobject.store((whisper_dart_post_cobject_fn) post_cobject, std::memory_order_release);
 }
 
 whisper_context * whisper_init_from_file_with_params(const char * path_model, whisper_context_params params) {
     real_whisper_context_params cparams = real_whisper_context_default_params();
     cparams.use_gpu = params.use_gpu;
+    cparams.use_mmap = params.use_mmap;
+    cparams.use_mlock = params.use_mlock;
+    cparams.repack_cache_path = params.repack_cache_path;
     return (whisper_context *) real_whisper_init_from_file_with_params(path_model, cparams);
 }
 
@@ -197,6 +798,24 @@ void whisper_free(whisper_context * ctx) {
     real_whisper_free((struct real_whisper_context *) ctx);
 }
 
+whisper_load_stats whisper_get_load_stats(whisper_context * ctx) {
+    whisper_load_stats stats;
+    std::memset(&stats, 0, sizeof(stats));
+    stats.page_cache_hit = -1.0f;
+    if (!ctx) return stats;
+
+    real_whisper_load_stats rstats = real_whisper_get_load_stats((struct real_whisper_context *) ctx);
+    stats.t_load_us = rstats.t_load_us;
+    stats.n_bytes_mapped = rstats.n_bytes_mapped;
+    stats.n_bytes_copied = rstats.n_bytes_copied;
+    stats.n_bytes_repacked = rstats.n_bytes_repacked;
+    stats.n_bytes_repack_cached = rstats.n_bytes_repack_cached;
+    stats.page_cache_hit = rstats.page_cache_hit;
+    stats.use_mmap = rstats.use_mmap;
+    stats.use_mlock = rstats.use_mlock;
+    return stats;
+}
+
 whisper_full_params whisper_full_default_params(int strategy) {
     real_whisper_full_params rparams = real_whisper_full_default_params((real_whisper_sampling_strategy) strategy);
     whisper_full_params wparams;
@@ -241,6 +860,19 @@ whisper_full_params whisper_full_default_params(int strategy) {
     wparams.greedy.best_of = rparams.greedy.best_of;
     wparams.beam_search.beam_size = rparams.beam_search.beam_size;
     wparams.beam_search.patience = rparams.beam_search.patience;
+    wparams.suppress_regex = rparams.suppress_regex;
+    wparams.carry_initial_prompt = rparams.carry_initial_prompt;
+    wparams.i_start_rule = rparams.i_start_rule;
+    wparams.grammar_penalty = rparams.grammar_penalty;
+    wparams.vad = rparams.vad;
+    wparams.vad_model_path = rparams.vad_model_path;
+    wparams.vad_params.threshold = rparams.vad_params.threshold;
+    wparams.vad_params.min_speech_duration_ms = rparams.vad_params.min_speech_duration_ms;
+    wparams.vad_params.min_silence_duration_ms = rparams.vad_params.min_silence_duration_ms;
+    wparams.vad_params.max_speech_duration_s = rparams.vad_params.max_speech_duration_s;
+    wparams.vad_params.speech_pad_ms = rparams.vad_params.speech_pad_ms;
+    wparams.vad_params.samples_overlap = rparams.vad_params.samples_overlap;
+    wparams.n_draft = rparams.speculative.n_draft;
 
     return wparams;
 }
@@ -250,52 +882,520 @@ whisper_context_params whisper_context_default_params(void) {
     whisper_context_params wparams;
     std::memset(&wparams, 0, sizeof(wparams));
     wparams.use_gpu = rparams.use_gpu;
+    wparams.use_mmap = rparams.use_mmap;
+    wparams.use_mlock = rparams.use_mlock;
+    wparams.repack_cache_path = rparams.repack_cache_path;
     return wparams;
 }
 
 int whisper_full(whisper_context * ctx, whisper_full_params params, const float * samples, int n_samples) {
-    real_whisper_full_params rparams = real_whisper_full_default_params((real_whisper_sampling_strategy) params.strategy);
-    
-    rparams.n_threads = params.n_threads;
-    rparams.n_max_text_ctx = params.n_max_text_ctx;
-    rparams.offset_ms = params.offset_ms;
-    rparams.duration_ms = params.duration_ms;
-    rparams.translate = params.translate;
-    rparams.no_context = params.no_context;
-    rparams.no_timestamps = params.no_timestamps;
-    rparams.single_segment = params.single_segment;
-    rparams.print_special = params.print_special;
-    rparams.print_progress = params.print_progress;
-    rparams.print_realtime = params.print_realtime;
-    rparams.print_timestamps = params.print_timestamps;
-    rparams.token_timestamps = params.token_timestamps;
-    rparams.thold_pt = params.thold_pt;
-    rparams.thold_ptsum = params.thold_ptsum;
-    rparams.max_len = params.max_len;
-    rparams.split_on_word = params.split_on_word;
-    rparams.max_tokens = params.max_tokens;
-    rparams.debug_mode = params.debug_mode;
-    rparams.audio_ctx = params.audio_ctx;
-    rparams.tdrz_enable = params.tdrz_enable;
-    rparams.initial_prompt = params.initial_prompt;
-    rparams.prompt_tokens = (const int32_t *) params.prompt_tokens;
-    rparams.prompt_n_tokens = params.prompt_n_tokens;
-    rparams.language = params.language;
-    rparams.detect_language = params.detect_language;
-    rparams.suppress_blank = params.suppress_blank;
-    rparams.suppress_nst = params.suppress_nst;
-    rparams.temperature = params.temperature;
-    rparams.max_initial_ts = params.max_initial_ts;
-    rparams.length_penalty = params.length_penalty;
-    rparams.temperature_inc = params.temperature_inc;
-    rparams.entropy_thold = params.entropy_thold;
-    rparams.logprob_thold = params.logprob_thold;
-    rparams.no_speech_thold = params.no_speech_thold;
-    rparams.greedy.best_of = params.greedy.best_of;
-    rparams.beam_search.beam_size = params.beam_search.beam_size;
-    rparams.beam_search.patience = params.beam_search.patience;
+    real_whisper_full_params rparams = to_real_params(params);
+    whisper_resolve_audio_ctx(rparams, (struct real_whisper_context *) ctx, n_samples);
+    return whisper_full_on((struct real_whisper_context *) ctx, nullptr, params, rparams, samples, n_samples);
+}
+
+whisper_state * whisper_init_state(whisper_context * ctx) {
+    if (!ctx) return nullptr;
+
+    struct real_whisper_state * rstate = real_whisper_init_state((struct real_whisper_context *) ctx);
+    if (!rstate) return nullptr;
+
+    whisper_state * state = new whisper_state();
+    state->state = rstate;
+    return state;
+}
 
-    return real_whisper_full((struct real_whisper_context *) ctx, rparams, samples, n_samples);
+void whisper_free_state(whisper_state * state) {
+    if (!state) return;
+    real_whisper_free_state(state->state);
+    if (state->threadpool) {
+        ggml_threadpool_free(state->threadpool);
+    }
+    delete state;
+}
+
+void whisper_state_abort(whisper_state * state) {
+    if (!state) return;
+    state->abort.store(true, std::memory_order_relaxed);
+}
+
+whisper_threadpool_params whisper_threadpool_default_params(void) {
+    whisper_threadpool_params params;
+    params.n_threads = 4;
+    params.affinity = WHISPER_THREADPOOL_AFFINITY_ANY;
+    params.cpu_mask = 0;
+    params.prio = 0;
+    params.poll = 50;
+    return params;
+}
+
+int whisper_state_set_threadpool(whisper_state * state, whisper_threadpool_params params) {
+    if (!state || params.n_threads <= 0) return -1;
+
+    struct ggml_threadpool_params tpp = ggml_threadpool_params_default(params.n_threads);
+    tpp.prio = (enum ggml_sched_priority) params.prio;
+    tpp.poll = params.poll;
+    // Created parked; the first decode wakes it
+    tpp.paused = true;
+
+    if (params.affinity == WHISPER_THREADPOOL_AFFINITY_PERFORMANCE) {
+        if (!whisper_performance_cpus(tpp.cpumask)) {
+            std::fill(tpp.cpumask, tpp.cpumask + GGML_MAX_N_THREADS, false);
+        }
+    } else if (params.affinity == WHISPER_THREADPOOL_AFFINITY_MASK) {
+        for (int cpu = 0; cpu < 64; cpu++) {
+            tpp.cpumask[cpu] = (params.cpu_mask >> cpu) & 1;
+        }
+    }
+
+    // Freeing the old pool under a running decode would pull its workers away
+    std::unique_lock<std::mutex> decode_lock(state->decode_mutex, std::try_to_lock);
+    if (!decode_lock.owns_lock()) {
+        std::cerr << "whisper_state_set_threadpool: the state is decoding" << std::endl;
+        return -1;
+    }
+
+    ggml_threadpool_t threadpool = ggml_threadpool_new(&tpp);
+    if (!threadpool) return -1;
+
+    ggml_threadpool_t old = state->threadpool;
+    real_whisper_set_threadpool_with_state(state->state, threadpool);
+    state->threadpool = threadpool;
+    state->n_threadpool_threads = params.n_threads;
+    if (state->active.load(std::memory_order_relaxed)) {
+        ggml_threadpool_resume(threadpool);
+    }
+    if (old) {
+        ggml_threadpool_free(old);
+    }
+    return 0;
+}
+
+void whisper_state_set_active(whisper_state * state, bool active) {
+    if (!state) return;
+    state->active.store(active, std::memory_order_relaxed);
+    if (!state->threadpool) return;
+    if (active) {
+        ggml_threadpool_resume(state->threadpool);
+    } else {
+        ggml_threadpool_pause(state->threadpool);
+    }
+}
+
+int whisper_full_with_state(whisper_context * ctx, whisper_state * state, whisper_full_params params, const float * samples, int n_samples) {
+    if (!ctx || !state) return -1;
+    real_whisper_full_params rparams = to_real_params(params);
+    whisper_resolve_audio_ctx(rparams, (struct real_whisper_context *) ctx, n_samples);
+    return whisper_full_on((struct real_whisper_context *) ctx, state, params, rparams, samples, n_samples);
+}
+
+whisper_speculative_stats whisper_get_speculative_stats(whisper_state * state) {
+    whisper_speculative_stats stats;
+    std::memset(&stats, 0, sizeof(stats));
+    if (!state) return stats;
+
+    real_whisper_speculative_stats rstats = real_whisper_get_speculative_stats(state->state);
+    stats.n_verify = rstats.n_verify;
+    stats.n_drafted = rstats.n_drafted;
+    stats.n_accepted = rstats.n_accepted;
+    stats.t_draft_us = rstats.t_draft_us;
+    return stats;
+}
+
+int whisper_full_n_segments_from_state(whisper_state * state) {
+    if (!state) return 0;
+    return real_whisper_full_n_segments_from_state(state->state);
+}
+
+const char * whisper_full_get_segment_text_from_state(whisper_state * state, int i_segment) {
+    if (!state) return nullptr;
+    return real_whisper_full_get_segment_text_from_state(state->state, i_segment);
+}
+
+int64_t whisper_full_get_segment_t0_from_state(whisper_state * state, int i_segment) {
+    if (!state) return 0;
+    return real_whisper_full_get_segment_t0_from_state(state->state, i_segment);
+}
+
+int64_t whisper_full_get_segment_t1_from_state(whisper_state * state, int i_segment) {
+    if (!state) return 0;
+    return real_whisper_full_get_segment_t1_from_state(state->state, i_segment);
+}
+
+float whisper_full_get_segment_no_speech_prob_from_state(whisper_state * state, int i_segment) {
+    if (!state) return 0.0f;
+    return real_whisper_full_get_segment_no_speech_prob_from_state(state->state, i_segment);
+}
+
+static int whisper_warmup_on(whisper_context * ctx, whisper_state * state, int flags) {
+    struct real_whisper_context * rctx = (struct real_whisper_context *) ctx;
+    if (flags & WHISPER_WARMUP_PREFAULT) {
+        real_whisper_prefault_model(rctx);
+    }
+    if (!(flags & WHISPER_WARMUP_ENCODE)) return 0;
+
+    // Smallest bucket for short utterances, the full window last so every
+    // buffer reaches its worst-case size
+    const int n_max = real_whisper_n_audio_ctx(rctx);
+    std::vector<int> buckets;
+    for (int n = WHISPER_AUDIO_CTX_BUCKET; n < n_max; n += WHISPER_AUDIO_CTX_BUCKET) {
+        buckets.push_back(n);
+        if (!(flags & WHISPER_WARMUP_ALL_BUCKETS)) break;
+    }
+    buckets.push_back(0);
+
+    const bool beam = flags & WHISPER_WARMUP_BEAM_SEARCH;
+    whisper_full_params params = whisper_full_default_params(beam ? WHISPER_SAMPLING_BEAM_SEARCH : WHISPER_SAMPLING_GREEDY);
+    params.language = "en";
+    params.no_context = true;
+    params.single_segment = true;
+    params.no_timestamps = true;
+    params.max_tokens = 1;
+    params.print_progress = false;
+    params.temperature_inc = 0.0f; // no fallback reruns on silence
+
+    std::vector<float> silence(WHISPER_SAMPLE_RATE, 0.0f);
+    for (int audio_ctx : buckets) {
+        params.audio_ctx = audio_ctx;
+        const int ret = state ? whisper_full_with_state(ctx, state, params, silence.data(), (int) silence.size())
+                              : whisper_full(ctx, params, silence.data(), (int) silence.size());
+        if (ret != 0) return ret;
+    }
+    return 0;
+}
+
+int whisper_warmup(whisper_context * ctx, int flags) {
+    if (!ctx) return -1;
+    return whisper_warmup_on(ctx, nullptr, flags);
+}
+
+int whisper_warmup_with_state(whisper_context * ctx, whisper_state * state, int flags) {
+    if (!ctx || !state) return -1;
+    return whisper_warmup_on(ctx, state, flags);
+}
+
+whisper_state_pool * whisper_state_pool_init(whisper_context * ctx) {
+    if (!ctx) return nullptr;
+    whisper_state_pool * pool = new whisper_state_pool();
+    pool->ctx = ctx;
+    return pool;
+}
+
+void whisper_state_pool_free(whisper_state_pool * pool) {
+    if (!pool) return;
+    for (whisper_state * state : pool->states) {
+        whisper_free_state(state);
+    }
+    delete pool;
+}
+
+whisper_state * whisper_state_pool_get(whisper_state_pool * pool, int purpose) {
+    if (!pool || purpose < 0 || purpose >= WHISPER_STATE_PURPOSE_COUNT) return nullptr;
+
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    if (!pool->states[purpose]) {
+        pool->states[purpose] = whisper_init_state(pool->ctx);
+        if (!pool->states[purpose]) {
+            std::cerr << "whisper_state_pool_get: failed to create state for purpose " << purpose << std::endl;
+        }
+    }
+    return pool->states[purpose];
+}
+
+// A loaded model: its context and the state pool decoding on it. The slot
+// holds one reference while the model is current, every acquire another.
+struct whisper_model {
+    whisper_model_slot * slot = nullptr;
+    whisper_context * ctx = nullptr;
+    whisper_state_pool * pool = nullptr;
+    std::atomic<int> refs{1};
+    size_t n_bytes = 0;
+};
+
+struct whisper_model_slot {
+    std::mutex mutex;
+    whisper_model * current = nullptr;
+    // Current model plus retired ones that still have in-flight decodes
+    std::vector<whisper_model *> live;
+    size_t peak_bytes = 0;
+    size_t last_estimate = 0;
+
+    // Applied to the states of every model loaded into the slot. A swap
+    // re-applies the threadpool when its generation changed during the load
+    bool has_threadpool[WHISPER_STATE_PURPOSE_COUNT] = {};
+    whisper_threadpool_params threadpool[WHISPER_STATE_PURPOSE_COUNT];
+    unsigned threadpool_gen[WHISPER_STATE_PURPOSE_COUNT] = {};
+    bool active[WHISPER_STATE_PURPOSE_COUNT] = {};
+
+    // Signalled on every release, for whisper_model_slot_free
+    std::condition_variable released;
+
+    // One swap at a time
+    std::mutex swap_mutex;
+};
+
+static whisper_state * whisper_state_pool_peek(whisper_state_pool * pool, int purpose) {
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    return pool->states[purpose];
+}
+
+static size_t whisper_model_memory(whisper_model * model) {
+    size_t size = real_whisper_get_model_memory((struct real_whisper_context *) model->ctx);
+    for (int purpose = 0; purpose < WHISPER_STATE_PURPOSE_COUNT; purpose++) {
+        whisper_state * state = whisper_state_pool_peek(model->pool, purpose);
+        if (state) {
+            size += real_whisper_get_state_memory(state->state);
+        }
+    }
+    return size;
+}
+
+static size_t whisper_live_bytes(const whisper_model_slot * slot) {
+    size_t size = 0;
+    for (const whisper_model * model : slot->live) {
+        size += model->n_bytes;
+    }
+    return size;
+}
+
+static void whisper_model_destroy(whisper_model * model) {
+    whisper_state_pool_free(model->pool);
+    whisper_free(model->ctx);
+    delete model;
+}
+
+// MemAvailable from /proc/meminfo, 0 when unknown
+static size_t whisper_mem_available() {
+    std::ifstream meminfo("/proc/meminfo");
+    std::string key;
+    size_t value = 0;
+    std::string unit;
+    while (meminfo >> key >> value >> unit) {
+        if (key == "MemAvailable:") {
+            return value * 1024;
+        }
+    }
+    return 0;
+}
+
+// Loads a model and creates its states with the slot's threadpool settings,
+// returning their generations in threadpool_gen
+static whisper_model * whisper_model_load(whisper_model_slot * slot, const char * path_model, whisper_context_params params,
+                                          unsigned * threadpool_gen) {
+    bool has_threadpool[WHISPER_STATE_PURPOSE_COUNT];
+    whisper_threadpool_params threadpool[WHISPER_STATE_PURPOSE_COUNT];
+    {
+        std::lock_guard<std::mutex> lock(slot->mutex);
+        std::copy(slot->has_threadpool, slot->has_threadpool + WHISPER_STATE_PURPOSE_COUNT, has_threadpool);
+        std::copy(slot->threadpool, slot->threadpool + WHISPER_STATE_PURPOSE_COUNT, threadpool);
+        std::copy(slot->threadpool_gen, slot->threadpool_gen + WHISPER_STATE_PURPOSE_COUNT, threadpool_gen);
+    }
+
+    whisper_context * ctx = whisper_init_from_file_with_params(path_model, params);
+    if (!ctx) return nullptr;
+
+    whisper_model * model = new whisper_model();
+    model->slot = slot;
+    model->ctx = ctx;
+    model->pool = whisper_state_pool_init(ctx);
+
+    for (int purpose = 0; purpose < WHISPER_STATE_PURPOSE_COUNT; purpose++) {
+        whisper_state * state = whisper_state_pool_get(model->pool, purpose);
+        if (!state) {
+            whisper_model_destroy(model);
+            return nullptr;
+        }
+        if (has_threadpool[purpose]) {
+            whisper_state_set_threadpool(state, threadpool[purpose]);
+        }
+    }
+    return model;
+}
+
+// Every purpose state has its own graphs and buffers; the weights only need
+// faulting in once
+static int whisper_model_warmup(whisper_model * model, int flags) {
+    for (int purpose = 0; purpose < WHISPER_STATE_PURPOSE_COUNT; purpose++) {
+        whisper_state * state = whisper_state_pool_get(model->pool, purpose);
+        const int ret = whisper_warmup_with_state(model->ctx, state, flags);
+        if (ret != 0) return ret;
+        flags &= ~WHISPER_WARMUP_PREFAULT;
+    }
+    return 0;
+}
+
+whisper_model_slot * whisper_model_slot_init(const char * path_model, whisper_context_params params) {
+    whisper_model_slot * slot = new whisper_model_slot();
+    unsigned threadpool_gen[WHISPER_STATE_PURPOSE_COUNT];
+    whisper_model * model = whisper_model_load(slot, path_model, params, threadpool_gen);
+    if (!model) {
+        delete slot;
+        return nullptr;
+    }
+
+    model->n_bytes = whisper_model_memory(model);
+    slot->current = model;
+    slot->live.push_back(model);
+    slot->peak_bytes = model->n_bytes;
+    return slot;
+}
+
+void whisper_model_slot_free(whisper_model_slot * slot) {
+    if (!slot) return;
+    std::lock_guard<std::mutex> swap_lock(slot->swap_mutex);
+    {
+        std::unique_lock<std::mutex> lock(slot->mutex);
+        slot->released.wait(lock, [slot] {
+            return slot->live.size() == 1 && slot->current->refs.load(std::memory_order_acquire) == 1;
+        });
+    }
+    for (whisper_model * model : slot->live) {
+        whisper_model_destroy(model);
+    }
+    delete slot;
+}
+
+int whisper_model_slot_swap(whisper_model_slot * slot, const char * path_model, whisper_context_params params, size_t max_bytes) {
+    if (!slot || !path_model) return WHISPER_SWAP_ERR_LOAD;
+
+    std::unique_lock<std::mutex> swap_lock(slot->swap_mutex, std::try_to_lock);
+    if (!swap_lock.owns_lock()) return WHISPER_SWAP_ERR_BUSY;
+
+    // The new model is sized like the current one, scaled by the weights in
+    // the file: both live side by side until the old one is released
+    struct stat st;
+    if (stat(path_model, &st) != 0) return WHISPER_SWAP_ERR_LOAD;
+    size_t live_bytes;
+    {
+        std::lock_guard<std::mutex> lock(slot->mutex);
+        live_bytes = whisper_live_bytes(slot);
+        const size_t weights = real_whisper_get_model_memory((struct real_whisper_context *) slot->current->ctx);
+        const double overhead = weights > 0 ? (double) slot->current->n_bytes / weights : 1.0;
+        slot->last_estimate = (size_t) (st.st_size * overhead);
+    }
+
+    const size_t estimate = slot->last_estimate;
+    const size_t available = max_bytes > 0 ? (max_bytes > live_bytes ? max_bytes - live_bytes : 0) : whisper_mem_available();
+    if ((max_bytes > 0 || available > 0) && estimate > available) {
+        std::cerr << "whisper_model_slot_swap: refusing swap, needs about " << estimate / 1000000
+                  << " MB but only " << available / 1000000 << " MB are available" << std::endl;
+        return WHISPER_SWAP_ERR_MEMORY;
+    }
+
+    // Loads on the calling thread while the current model keeps serving
+    unsigned threadpool_gen[WHISPER_STATE_PURPOSE_COUNT];
+    whisper_model * model = whisper_model_load(slot, path_model, params, threadpool_gen);
+    if (!model) return WHISPER_SWAP_ERR_LOAD;
+
+    if (whisper_model_warmup(model, WHISPER_WARMUP_DEFAULT) != 0) {
+        whisper_model_destroy(model);
+        return WHISPER_SWAP_ERR_WARMUP;
+    }
+    model->n_bytes = whisper_model_memory(model);
+
+    whisper_model * old;
+    {
+        std::lock_guard<std::mutex> lock(slot->mutex);
+        old = slot->current;
+        slot->current = model;
+        slot->live.push_back(model);
+        slot->peak_bytes = std::max(slot->peak_bytes, whisper_live_bytes(slot));
+        for (int purpose = 0; purpose < WHISPER_STATE_PURPOSE_COUNT; purpose++) {
+            whisper_state * state = whisper_state_pool_peek(model->pool, purpose);
+            // Set on the old model while this one loaded; nothing decodes on it yet
+            if (slot->threadpool_gen[purpose] != threadpool_gen[purpose]) {
+                whisper_state_set_threadpool(state, slot->threadpool[purpose]);
+            }
+            whisper_state_set_active(state, slot->active[purpose]);
+        }
+    }
+
+    // Decodes already running keep the old model until they release it
+    whisper_model_release(old);
+    return WHISPER_SWAP_OK;
+}
+
+whisper_model * whisper_model_slot_acquire(whisper_model_slot * slot) {
+    if (!slot) return nullptr;
+    std::lock_guard<std::mutex> lock(slot->mutex);
+    slot->current->refs.fetch_add(1, std::memory_order_relaxed);
+    return slot->current;
+}
+
+void whisper_model_release(whisper_model * model) {
+    if (!model) return;
+    whisper_model_slot * slot = model->slot;
+    {
+        // Under the lock, so whisper_model_slot_free sees every release
+        std::lock_guard<std::mutex> lock(slot->mutex);
+        slot->released.notify_all();
+        if (model->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        slot->live.erase(std::remove(slot->live.begin(), slot->live.end(), model), slot->live.end());
+    }
+    whisper_model_destroy(model);
+}
+
+whisper_context * whisper_model_context(whisper_model * model) {
+    return model ? model->ctx : nullptr;
+}
+
+whisper_state * whisper_model_state(whisper_model * model, int purpose) {
+    if (!model) return nullptr;
+    return whisper_state_pool_get(model->pool, purpose);
+}
+
+int whisper_model_slot_set_threadpool(whisper_model_slot * slot, int purpose, whisper_threadpool_params params) {
+    if (!slot || purpose < 0 || purpose >= WHISPER_STATE_PURPOSE_COUNT) return -1;
+    std::lock_guard<std::mutex> lock(slot->mutex);
+    // Kept for later models only once the current one took it
+    const int ret = whisper_state_set_threadpool(whisper_state_pool_get(slot->current->pool, purpose), params);
+    if (ret != 0) return ret;
+    slot->has_threadpool[purpose] = true;
+    slot->threadpool[purpose] = params;
+    slot->threadpool_gen[purpose]++;
+    return 0;
+}
+
+void whisper_model_slot_set_active(whisper_model_slot * slot, int purpose, bool active) {
+    if (!slot || purpose < 0 || purpose >= WHISPER_STATE_PURPOSE_COUNT) return;
+    std::lock_guard<std::mutex> lock(slot->mutex);
+    slot->active[purpose] = active;
+    for (whisper_model * model : slot->live) {
+        whisper_state_set_active(whisper_state_pool_peek(model->pool, purpose), active);
+    }
+}
+
+void whisper_model_slot_abort(whisper_model_slot * slot, int purpose) {
+    if (!slot || purpose < 0 || purpose >= WHISPER_STATE_PURPOSE_COUNT) return;
+    std::lock_guard<std::mutex> lock(slot->mutex);
+    for (whisper_model * model : slot->live) {
+        whisper_state_abort(whisper_state_pool_peek(model->pool, purpose));
+    }
+}
+
+whisper_model_slot_memory whisper_model_slot_get_memory(whisper_model_slot * slot) {
+    whisper_model_slot_memory memory;
+    std::memset(&memory, 0, sizeof(memory));
+    if (!slot) return memory;
+
+    std::lock_guard<std::mutex> lock(slot->mutex);
+    // State buffers grow with the audio decoded, so the current model is re-measured
+    slot->current->n_bytes = whisper_model_memory(slot->current);
+    memory.live_bytes = whisper_live_bytes(slot);
+    memory.peak_bytes = std::max(slot->peak_bytes, memory.live_bytes);
+    memory.last_estimate = slot->last_estimate;
+    memory.n_live = (int) slot->live.size();
+    slot->peak_bytes = memory.peak_bytes;
+    return memory;
+}
+
+int whisper_model_slot_warmup(whisper_model_slot * slot, int purpose, int flags) {
+    if (!slot || purpose < 0 || purpose >= WHISPER_STATE_PURPOSE_COUNT) return -1;
+
+    whisper_model * model = whisper_model_slot_acquire(slot);
+    const int ret = whisper_warmup_with_state(model->ctx, whisper_model_state(model, purpose), flags);
+    whisper_model_release(model);
+    return ret;
 }
 
 int whisper_full_n_segments(whisper_context * ctx) {
@@ -326,6 +1426,14 @@ int whisper_full_lang_id(whisper_context * ctx) {
     return real_whisper_full_lang_id((struct real_whisper_context *) ctx);
 }
 
+int whisper_tokenize(whisper_context * ctx, const char * text, int * tokens, int n_max_tokens) {
+    return real_whisper_tokenize((struct real_whisper_context *) ctx, text, tokens, n_max_tokens);
+}
+
+int whisper_token_count(whisper_context * ctx, const char * text) {
+    return real_whisper_token_count((struct real_whisper_context *) ctx, text);
+}
+
 int whisper_n_vocab(whisper_context * ctx) {
     return real_whisper_n_vocab((struct real_whisper_context *) ctx);
 }
@@ -342,4 +1450,156 @@ int whisper_is_multilingual(whisper_context * ctx) {
     return real_whisper_is_multilingual((struct real_whisper_context *) ctx);
 }
 
+
+whisper_audio_buffer * whisper_audio_buffer_create(int64_t capacity) {
+    if (capacity <= 0) return nullptr;
+
+    float * data = whisper_audio_buffer_map(capacity);
+    if (!data) {
+        std::cerr << "whisper_audio_buffer_create: failed to reserve " << capacity << " samples" << std::endl;
+        return nullptr;
+    }
+
+    whisper_audio_buffer * buffer = new whisper_audio_buffer();
+    buffer->data.store(data, std::memory_order_relaxed);
+    buffer->capacity = capacity;
+    return buffer;
+}
+
+void whisper_audio_buffer_free(whisper_audio_buffer * buffer) {
+    if (!buffer) return;
+    whisper_audio_buffer_unmap_retired(buffer);
+    munmap(buffer->data.load(std::memory_order_relaxed), buffer->capacity * sizeof(float));
+    delete buffer;
+}
+
+int whisper_audio_buffer_append(whisper_audio_buffer * buffer, const float * samples, int n_samples) {
+    if (!buffer || !samples || n_samples < 0) return -1;
+
+    const int64_t size = buffer->size.load(std::memory_order_relaxed);
+    if (!whisper_audio_buffer_reserve(buffer, size, n_samples)) return -2;
+
+    std::memcpy(buffer->data.load(std::memory_order_relaxed) + size, samples, n_samples * sizeof(float));
+    buffer->size.store(size + n_samples, std::memory_order_release);
+    return 0;
+}
+
+int whisper_audio_buffer_append_pcm16(whisper_audio_buffer * buffer, const void * pcm, int n_samples) {
+    if (!buffer || !pcm || n_samples < 0) return -1;
+
+    const int64_t size = buffer->size.load(std::memory_order_relaxed);
+    if (!whisper_audio_buffer_reserve(buffer, size, n_samples)) return -2;
+
+    // Capture chunks are not guaranteed to be 2-byte aligned
+    const uint8_t * bytes = (const uint8_t *) pcm;
+    float * dst = buffer->data.load(std::memory_order_relaxed) + size;
+    for (int i = 0; i < n_samples; i++) {
+        const int16_t sample = (int16_t) (bytes[2*i] | (bytes[2*i + 1] << 8));
+        dst[i] = sample / 32768.0f;
+    }
+    buffer->size.store(size + n_samples, std::memory_order_release);
+    return 0;
+}
+
+int64_t whisper_audio_buffer_size(whisper_audio_buffer * buffer) {
+    if (!buffer) return 0;
+    return buffer->size.load(std::memory_order_acquire);
+}
+
+const float * whisper_audio_buffer_view(whisper_audio_buffer * buffer, int64_t offset, int n_samples) {
+    if (!buffer || offset < 0 || n_samples < 0) return nullptr;
+    if (offset + n_samples > buffer->size.load(std::memory_order_acquire)) return nullptr;
+    return buffer->data.load(std::memory_order_acquire) + offset;
+}
+
+void whisper_audio_buffer_discard(whisper_audio_buffer * buffer, int64_t n_samples) {
+    if (!buffer || n_samples <= 0) return;
+
+    const int64_t size = buffer->size.load(std::memory_order_relaxed);
+    if (n_samples >= size) {
+        whisper_audio_buffer_clear(buffer);
+        return;
+    }
+    float * data = buffer->data.load(std::memory_order_relaxed);
+    std::memmove(data, data + n_samples, (size - n_samples) * sizeof(float));
+    buffer->size.store(size - n_samples, std::memory_order_release);
+    whisper_audio_buffer_release_pages(buffer, size - n_samples);
+    whisper_audio_buffer_unmap_retired(buffer);
+}
+
+void whisper_audio_buffer_clear(whisper_audio_buffer * buffer) {
+    if (!buffer) return;
+    buffer->size.store(0, std::memory_order_release);
+    whisper_audio_buffer_release_pages(buffer, 0);
+    whisper_audio_buffer_unmap_retired(buffer);
+}
+
+whisper_stream * whisper_stream_begin(whisper_context * ctx, whisper_full_params params) {
+    return whisper_stream_begin_with_state(ctx, nullptr, params);
+}
+
+whisper_stream * whisper_stream_begin_with_state(whisper_context * ctx, whisper_state * state, whisper_full_params params) {
+    if (!ctx) return nullptr;
+
+    whisper_stream * stream = new whisper_stream();
+    stream->ctx = ctx;
+    stream->state = state;
+    stream->params = params;
+    stream->language = params.language ? params.language : "en";
+    stream->initial_prompt = params.initial_prompt ? params.initial_prompt : "";
+    stream->params.language = nullptr;
+    stream->params.initial_prompt = nullptr;
+    whisper_stream_mel_reset(stream);
+    return stream;
+}
+
+int whisper_stream_push(whisper_stream * stream, const float * samples, int n_samples) {
+    if (!stream || !samples || n_samples < 0) return -1;
+    struct real_whisper_context * rctx = (struct real_whisper_context *) stream->ctx;
+    const int ret = stream->state
+        ? real_whisper_mel_stream_append_with_state(rctx, stream->state->state, samples, n_samples)
+        : real_whisper_mel_stream_append(rctx, samples, n_samples);
+    if (ret != 0) {
+        return -1;
+    }
+    stream->n_tail += n_samples;
+    return 0;
+}
+
+int whisper_stream_poll(whisper_stream * stream, const char ** partial, const char ** committed) {
+    if (!stream) return -1;
+
+    int ret = 0;
+    if (stream->n_tail != stream->n_decoded) {
+        ret = whisper_stream_decode(stream, false);
+    }
+
+    if (partial) *partial = stream->partial.c_str();
+    if (committed) *committed = stream->committed.c_str();
+    return ret;
+}
+
+const char * whisper_stream_end(whisper_stream * stream) {
+    if (!stream) return "";
+
+    if (stream->n_tail != stream->n_decoded) {
+        if (whisper_stream_decode(stream, true) != 0) {
+            std::cerr << "whisper_stream_end: failed to decode the remaining audio" << std::endl;
+        }
+    } else {
+        stream->committed += stream->partial;
+        whisper_stream_mel_reset(stream);
+        stream->n_tail = 0;
+    }
+    stream->partial.clear();
+    stream->prev_segments.clear();
+    stream->n_decoded = 0;
+
+    return stream->committed.c_str();
+}
+
+void whisper_stream_free(whisper_stream * stream) {
+    delete stream;
+}
+
 }
@@ -12,12 +12,78 @@ extern "C" {
 typedef struct whisper_context whisper_context;
 typedef struct whisper_full_params whisper_full_params;
 typedef struct whisper_context_params whisper_context_params;
+typedef struct whisper_stream whisper_stream;
+typedef struct whisper_audio_buffer whisper_audio_buffer;
+typedef struct whisper_state whisper_state;
+typedef struct whisper_state_pool whisper_state_pool;
+typedef struct whisper_model whisper_model;
+typedef struct whisper_model_slot whisper_model_slot;
+
+// Pass as whisper_full_params.audio_ctx to size the encoder context from the
+// number of samples instead of always encoding a full 30 s window.
+#define WHISPER_AUDIO_CTX_AUTO -1
 
 typedef enum {
     WHISPER_SAMPLING_GREEDY,
     WHISPER_SAMPLING_BEAM_SEARCH,
 } whisper_sampling_strategy;
 
+typedef enum {
+    WHISPER_THREADPOOL_AFFINITY_ANY,          // Default scheduler placement
+    WHISPER_THREADPOOL_AFFINITY_PERFORMANCE,  // Only the fastest cores, e.g. P-cores on hybrid CPUs
+    WHISPER_THREADPOOL_AFFINITY_MASK,         // The CPUs in cpu_mask
+} whisper_threadpool_affinity;
+
+typedef struct whisper_threadpool_params {
+    int n_threads;
+    int affinity;       // whisper_threadpool_affinity
+    uint64_t cpu_mask;  // CPUs 0-63, for WHISPER_THREADPOOL_AFFINITY_MASK
+    int prio;           // -1 low, 0 normal, 1 medium, 2 high, 3 realtime
+    uint32_t poll;      // 0-100, how long idle workers spin before sleeping while active
+} whisper_threadpool_params;
+
+typedef enum {
+    WHISPER_STATE_INTERIM,
+    WHISPER_STATE_FINAL,
+    WHISPER_STATE_PURPOSE_COUNT,
+} whisper_state_purpose;
+
+typedef enum {
+    WHISPER_SWAP_OK = 0,
+    WHISPER_SWAP_ERR_LOAD = -1,     // The new model failed to load
+    WHISPER_SWAP_ERR_MEMORY = -2,   // Old and new model would not fit side by side
+    WHISPER_SWAP_ERR_WARMUP = -3,   // The warm-up decode on the new model failed
+    WHISPER_SWAP_ERR_BUSY = -4,     // Another swap is in progress
+} whisper_swap_status;
+
+// What whisper_warmup pays for up front, so the first real decode does not
+typedef enum {
+    WHISPER_WARMUP_PREFAULT    = 1 << 0,  // Fault in every page of a mapped model
+    WHISPER_WARMUP_ENCODE      = 1 << 1,  // Silent encode and one-token decode at the smallest and the full audio_ctx
+    WHISPER_WARMUP_ALL_BUCKETS = 1 << 2,  // With ENCODE, at every WHISPER_AUDIO_CTX_AUTO bucket
+    WHISPER_WARMUP_BEAM_SEARCH = 1 << 3,  // With ENCODE, decode with beam search so the KV cache grows to its decoders
+    WHISPER_WARMUP_DEFAULT     = WHISPER_WARMUP_PREFAULT | WHISPER_WARMUP_ENCODE,
+} whisper_warmup_flags;
+
+typedef struct whisper_model_slot_memory {
+    size_t live_bytes;     // Weights and state buffers of the current model and of retired ones still in use
+    size_t peak_bytes;     // Highest live_bytes so far, reached while two models overlap in a swap
+    size_t last_estimate;  // What the last swap expected the new model to need
+    int n_live;
+} whisper_model_slot_memory;
+
+// Callback signatures for the void * callback fields of whisper_full_params.
+// They receive the wrapper context and the state the decode runs on (NULL for
+// the context's default state), so the *_from_state getters can be used.
+typedef void (*whisper_new_segment_callback)(whisper_context * ctx, whisper_state * state, int n_new, void * user_data);
+typedef void (*whisper_progress_callback)(whisper_context * ctx, whisper_state * state, int progress, void * user_data);
+// Returning false skips the decode of the current window.
+typedef bool (*whisper_encoder_begin_callback)(whisper_context * ctx, whisper_state * state, void * user_data);
+// tokens points to whisper_token_data from whisper.cpp's whisper.h.
+typedef void (*whisper_logits_filter_callback)(whisper_context * ctx, whisper_state * state, const void * tokens, int n_tokens, float * logits, void * user_data);
+// Returning true aborts the decode; checked between graph nodes as well.
+typedef bool (*whisper_abort_callback)(void * user_data);
+
 typedef struct whisper_context_params {
     bool  use_gpu;
     bool  flash_attn;
@@ -27,8 +93,33 @@ typedef struct whisper_context_params {
     int   dtw_n_top;
     void* dtw_aheads;
     size_t dtw_mem_size;
+    // Map the model and use CPU weights straight from the page cache, shared
+    // with any other process using the same file. mlock keeps them resident.
+    bool  use_mmap;
+    bool  use_mlock;
+    // File caching the weights the CPU backend repacks at load, rewritten when
+    // stale (see whisper.h). NULL disables it; only read while loading.
+    const char * repack_cache_path;
 } whisper_context_params;
 
+typedef struct whisper_load_stats {
+    int64_t t_load_us;
+    size_t  n_bytes_mapped;  // Weights used in place from the mapping
+    size_t  n_bytes_copied;  // Weights read into allocated buffers
+    size_t  n_bytes_repacked;       // Weights repacked for the CPU backend while loading
+    size_t  n_bytes_repack_cached;  // Repacked weights mapped from the repack cache instead
+    float   page_cache_hit;  // Fraction of the file cached before loading (warm start), -1 if not mapped
+    bool    use_mmap;
+    bool    use_mlock;
+} whisper_load_stats;
+
+typedef struct whisper_speculative_stats {
+    int     n_verify;    // Batched decodes that verified draft tokens
+    int     n_drafted;   // Tokens proposed by the draft model
+    int     n_accepted;  // Proposed tokens the model sampled as well
+    int64_t t_draft_us;  // Time spent in the draft model
+} whisper_speculative_stats;
+
 typedef void* whisper_ahead_ffi;
 typedef struct {
     size_t n_heads;
@@ -91,6 +182,7 @@ struct whisper_full_params {
     void * abort_callback_user_data;
     void * logits_filter_callback;
     void * logits_filter_callback_user_data;
+    // const whisper_grammar_element ** from whisper.cpp's whisper.h
     void ** grammar_rules;
     size_t n_grammar_rules;
     size_t i_start_rule;
@@ -105,13 +197,30 @@ struct whisper_full_params {
         int speech_pad_ms;
         float samples_overlap;
     } vad_params;
+    // Dart native ports, 0 when unused; whisper_dart_init must be called first.
+    // Each new segment is posted as [index, t0, t1, text] and progress as an int.
+    // For stream sessions, indices and timestamps are relative to the decoded tail.
+    int64_t new_segment_port;
+    int64_t progress_port;
+    // Speculative decoding (greedy at temperature 0, same output): a smaller
+    // model with the same text tokens proposes up to n_draft tokens at a time
+    // that are verified in one batch. draft_state is a state of draft_ctx that
+    // no other decode uses; it runs on the threads of the decode. Not used for
+    // stream sessions, which keep no PCM for the draft model.
+    whisper_context * draft_ctx;
+    whisper_state * draft_state;
+    int n_draft;
 };
 
+// Hands the wrapper Dart's NativeApi.postCObject so decodes can post to native ports.
+void whisper_dart_init(void * post_cobject);
+
 const char * whisper_version(void);
 
 whisper_context * whisper_init_from_file_with_params(const char * path_model, whisper_context_params params);
 whisper_context * whisper_init_from_file(const char * path_model);
 void whisper_free(whisper_context * ctx);
+whisper_load_stats whisper_get_load_stats(whisper_context * ctx);
 
 whisper_full_params whisper_full_default_params(int strategy);
 whisper_context_params whisper_context_default_params(void);
@@ -126,11 +235,117 @@ int whisper_full_n_tokens(whisper_context * ctx, int i_segment);
 const char * whisper_full_get_token_text(whisper_context * ctx, int i_segment, int i_token);
 int whisper_full_lang_id(whisper_context * ctx);
 
+// Decoding states. Each state has its own KV caches and mel, so different
+// states of one context can decode concurrently from different threads.
+whisper_state * whisper_init_state(whisper_context * ctx);
+void whisper_free_state(whisper_state * state);
+// Makes a decode currently running on state return early with a non-zero code.
+// Safe to call from any thread; a decode started afterwards is not affected.
+void whisper_state_abort(whisper_state * state);
+
+// Gives state its own persistent CPU threadpool, replacing any previous one.
+// Returns -1 while the state is decoding. Decodes then always use
+// params.n_threads. The thread running a decode takes part in it with the
+// pool's affinity and priority, and gets its own back when the decode returns.
+whisper_threadpool_params whisper_threadpool_default_params(void);
+int whisper_state_set_threadpool(whisper_state * state, whisper_threadpool_params params);
+// While active (e.g. during a recording) the workers spin between graphs for
+// low wake-up latency. Inactive pools are parked after each decode.
+void whisper_state_set_active(whisper_state * state, bool active);
+
+int whisper_full_with_state(whisper_context * ctx, whisper_state * state, whisper_full_params params, const float * samples, int n_samples);
+
+// Runs the first-decode costs (graph reservation, weight repacking, page
+// faults, buffer growth) ahead of time; flags are whisper_warmup_flags.
+// Returns 0, or the whisper_full error of the warm-up decode.
+int whisper_warmup(whisper_context * ctx, int flags);
+int whisper_warmup_with_state(whisper_context * ctx, whisper_state * state, int flags);
+// Counters of the last decode on state; n_accepted / n_drafted is the accept rate.
+whisper_speculative_stats whisper_get_speculative_stats(whisper_state * state);
+int whisper_full_n_segments_from_state(whisper_state * state);
+const char * whisper_full_get_segment_text_from_state(whisper_state * state, int i_segment);
+int64_t whisper_full_get_segment_t0_from_state(whisper_state * state, int i_segment);
+int64_t whisper_full_get_segment_t1_from_state(whisper_state * state, int i_segment);
+// Probability of the no-speech token at the start-of-transcript position of the segment's window
+float whisper_full_get_segment_no_speech_prob_from_state(whisper_state * state, int i_segment);
+
+// One persistent state per whisper_state_purpose, created on first use and
+// reused for every later decode with that purpose.
+whisper_state_pool * whisper_state_pool_init(whisper_context * ctx);
+void whisper_state_pool_free(whisper_state_pool * pool);
+whisper_state * whisper_state_pool_get(whisper_state_pool * pool, int purpose);
+
+// Double-buffered model holder. Decodes acquire the current model (context
+// and state pool) and release it when done. A swap loads the next model on
+// the calling thread while the current one keeps serving, warms it up and
+// makes it current atomically; the old model is freed by its last release.
+whisper_model_slot * whisper_model_slot_init(const char * path_model, whisper_context_params params);
+// Blocks until every acquired model has been released and a running swap
+// has finished.
+void whisper_model_slot_free(whisper_model_slot * slot);
+// Refused with WHISPER_SWAP_ERR_MEMORY when the new model is estimated not to
+// fit next to the live ones: in max_bytes total, or in MemAvailable if 0.
+int whisper_model_slot_swap(whisper_model_slot * slot, const char * path_model, whisper_context_params params, size_t max_bytes);
+whisper_model * whisper_model_slot_acquire(whisper_model_slot * slot);
+void whisper_model_release(whisper_model * model);
+whisper_context * whisper_model_context(whisper_model * model);
+whisper_state * whisper_model_state(whisper_model * model, int purpose);
+// Per-purpose settings, applied to the current model and every later one.
+// set_threadpool returns -1, changing nothing, while purpose is decoding.
+int whisper_model_slot_set_threadpool(whisper_model_slot * slot, int purpose, whisper_threadpool_params params);
+void whisper_model_slot_set_active(whisper_model_slot * slot, int purpose, bool active);
+// Aborts decodes running for purpose on any live model.
+void whisper_model_slot_abort(whisper_model_slot * slot, int purpose);
+whisper_model_slot_memory whisper_model_slot_get_memory(whisper_model_slot * slot);
+// Warms the current model's state for purpose; call from the thread that
+// decodes for that purpose. Swaps warm every state of the new model with
+// WHISPER_WARMUP_DEFAULT before publishing it.
+int whisper_model_slot_warmup(whisper_model_slot * slot, int purpose, int flags);
+
+// Tokens of text, as for initial_prompt. Returns the count, or minus the count
+// when n_max_tokens is too small. Recent results are cached per context, so a
+// fixed prompt can be tokenized on every call.
+int whisper_tokenize(whisper_context * ctx, const char * text, int * tokens, int n_max_tokens);
+int whisper_token_count(whisper_context * ctx, const char * text);
+
 int whisper_n_vocab(whisper_context * ctx);
 int whisper_n_text_ctx(whisper_context * ctx);
 int whisper_n_audio_ctx(whisper_context * ctx);
 int whisper_is_multilingual(whisper_context * ctx);
 
+// Native-owned 16 kHz float sample store shared between isolates. It starts
+// with room for capacity samples and doubles when an append needs more. A view
+// stays valid while more audio is appended, even across a grow: outgrown
+// storage is kept until the next clear/discard. Only clear/discard invalidate
+// views and must not race with readers.
+whisper_audio_buffer * whisper_audio_buffer_create(int64_t capacity);
+void whisper_audio_buffer_free(whisper_audio_buffer * buffer);
+// Returns 0, or -2 without appending anything when the buffer cannot grow.
+int whisper_audio_buffer_append(whisper_audio_buffer * buffer, const float * samples, int n_samples);
+// Appends little-endian PCM16 samples, converting to float in place. Returns as append.
+int whisper_audio_buffer_append_pcm16(whisper_audio_buffer * buffer, const void * pcm, int n_samples);
+int64_t whisper_audio_buffer_size(whisper_audio_buffer * buffer);
+// Returns a pointer to [offset, offset + n_samples), or NULL if that range was not written yet.
+const float * whisper_audio_buffer_view(whisper_audio_buffer * buffer, int64_t offset, int n_samples);
+// Drops the first n_samples and shifts the rest to the front.
+void whisper_audio_buffer_discard(whisper_audio_buffer * buffer, int64_t n_samples);
+void whisper_audio_buffer_clear(whisper_audio_buffer * buffer);
+
+// Streaming session: audio is pushed incrementally and only the uncommitted
+// tail is re-decoded on each poll. Segments that are stable across two polls
+// are committed (frozen) and their audio is dropped from the tail.
+// The log mel spectrogram is built incrementally in the decoding state, so only
+// one stream per state can be active at a time.
+whisper_stream * whisper_stream_begin(whisper_context * ctx, whisper_full_params params);
+// Same as whisper_stream_begin, decoding on state instead of the default state.
+whisper_stream * whisper_stream_begin_with_state(whisper_context * ctx, whisper_state * state, whisper_full_params params);
+int whisper_stream_push(whisper_stream * stream, const float * samples, int n_samples);
+// Decodes the tail if new audio arrived. Returned strings stay valid until the next poll/end.
+int whisper_stream_poll(whisper_stream * stream, const char ** partial, const char ** committed);
+// Decodes and commits whatever is left. Returns the full committed text.
+const char * whisper_stream_end(whisper_stream * stream);
+void whisper_stream_free(whisper_stream * stream);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,145 @@
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:localvoicesync/core/llm/ollama_client.dart';
+
+/// Serves /api/generate on loopback. Each request is answered by [respond],
+/// which writes the NDJSON body in whatever pieces the test wants.
+class _StubOllama {
+  final HttpServer _server;
+  final List<Map<String, dynamic>> requests = [];
+
+  _StubOllama._(this._server);
+
+  static Future<_StubOllama> start(Future<void> Function(HttpResponse response) respond) async {
+    final server = await HttpServer.bind(InternetAddress.loopbackIPv4, 0);
+    final stub = _StubOllama._(server);
+    server.listen((request) async {
+      final body = await utf8.decoder.bind(request).join();
+      stub.requests.add(jsonDecode(body) as Map<String, dynamic>);
+      if (request.uri.path != '/api/generate') {
+        request.response.statusCode = HttpStatus.notFound;
+        await request.response.close();
+        return;
+      }
+      request.response.headers.contentType = ContentType('application', 'x-ndjson');
+      await respond(request.response);
+    });
+    return stub;
+  }
+
+  String get baseUrl => 'http://${_server.address.address}:${_server.port}';
+
+  Future<void> close() => _server.close(force: true);
+}
+
+String _line(Map<String, dynamic> chunk) => '${jsonEncode(chunk)}\n';
+
+Future<void> _writeFlushed(HttpResponse response, List<List<int>> pieces) async {
+  for (final piece in pieces) {
+    response.add(piece);
+    await response.flush();
+  }
+}
+
+void main() {
+  group('OllamaClient.streamText', () {
+    late _StubOllama stub;
+
+    tearDown(() => stub.close());
+
+    test('yields each response piece in order and stops at done', () async {
+      stub = await _StubOllama.start((response) async {
+        await _writeFlushed(response, [
+          utf8.encode(_line({'response': 'Hello', 'done': false})),
+          utf8.encode(_line({'response': ', world', 'done': false})),
+          utf8.encode(_line({'response': '.', 'done': true})),
+          // Anything after done is not part of the reply
+          utf8.encode(_line({'response': ' extra', 'done': false})),
+        ]);
+        await response.close();
+      });
+
+      final client = OllamaClient(baseUrl: stub.baseUrl);
+      final pieces = await client.streamText(model: 'stub', prompt: 'hi').toList();
+
+      expect(pieces, ['Hello', ', world', '.']);
+      expect(stub.requests.single['stream'], isTrue);
+      expect(stub.requests.single['model'], 'stub');
+    });
+
+    test('joins lines and characters split across network chunks', () async {
+      // A blank keep-alive line between the two is skipped
+      final body = utf8.encode('${_line({'response': 'Café ', 'done': false})}\n'
+          '${_line({'response': 'déjà vu', 'done': true})}');
+      stub = await _StubOllama.start((response) async {
+        // One byte at a time splits every line and both two-byte characters
+        await _writeFlushed(response, [for (final byte in body) [byte]]);
+        await response.close();
+      });
+
+      final client = OllamaClient(baseUrl: stub.baseUrl);
+      final pieces = await client.streamText(model: 'stub', prompt: 'hi').toList();
+
+      expect(pieces.join(), 'Café déjà vu');
+    });
+
+    test('throws on an error chunk after the pieces before it', () async {
+      stub = await _StubOllama.start((response) async {
+        await _writeFlushed(response, [
+          utf8.encode(_line({'response': 'Partial', 'done': false})),
+          utf8.encode(_line({'error': 'model unloaded'})),
+        ]);
+        await response.close();
+      });
+
+      final client = OllamaClient(baseUrl: stub.baseUrl);
+      final pieces = <String>[];
+      Object? error;
+      try {
+        await for (final piece in client.streamText(model: 'stub', prompt: 'hi')) {
+          pieces.add(piece);
+        }
+      } catch (e) {
+        error = e;
+      }
+
+      expect(pieces, ['Partial']);
+      expect(error, isA<OllamaException>());
+      expect(error.toString(), contains('model unloaded'));
+    });
+
+    test('throws when the stream breaks off mid-line', () async {
+      stub = await _StubOllama.start((response) async {
+        await _writeFlushed(response, [
+          utf8.encode(_line({'response': 'Partial', 'done': false})),
+          utf8.encode('{"response": " cut'),
+        ]);
+        await response.close();
+      });
+
+      final client = OllamaClient(baseUrl: stub.baseUrl);
+      final pieces = <String>[];
+      await expectLater(
+        client.streamText(model: 'stub', prompt: 'hi').forEach(pieces.add),
+        throwsA(isA<OllamaException>()),
+      );
+      expect(pieces, ['Partial']);
+    });
+
+    test('throws when the server rejects the request', () async {
+      stub = await _StubOllama.start((response) async {
+        response.statusCode = HttpStatus.internalServerError;
+        await response.close();
+      });
+
+      final client = OllamaClient(baseUrl: stub.baseUrl);
+      await expectLater(
+        client.streamText(model: 'stub', prompt: 'hi').toList(),
+        throwsA(isA<OllamaException>()),
+      );
+    });
+  });
+}